@@ -0,0 +1,176 @@
+/**
+ * Fast Math Benchmark
+ *
+ * Compares the fast kernels with the standard library per built-in
+ * function and checks their error against long double references. The
+ * trigonometric functions are also checked next to multiples of pi/2, where
+ * the reduced argument nearly cancels, and pow with exponents large enough
+ * to take the result to the ends of the double range, where any error in
+ * its logarithm is multiplied.
+ * Reports nanoseconds per value and the worst error in ULP, and exits with
+ * 1 if any error exceeds kFastMathMaxUlps.
+ */
+
+#include "equation/fast_math.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+using plot_genius::ApplyFast;
+using plot_genius::OpCode;
+
+constexpr std::size_t kValues = 1 << 16;
+constexpr int kRounds = 64;
+
+// Keeps the optimizer from discarding benchmark results
+volatile double g_sink = 0.0;
+
+struct Inputs {
+    std::vector<double> a;
+    std::vector<double> b;
+};
+
+// Error of a result in units in the last place of the correctly rounded one
+double ErrorUlps(double result, long double reference) {
+    const double rounded = static_cast<double>(reference);
+    if (std::isnan(rounded) || std::isinf(rounded)) {
+        return (std::isnan(result) && std::isnan(rounded)) || result == rounded ? 0.0 : INFINITY;
+    }
+    const double spacing = std::nextafter(std::fabs(rounded), INFINITY) - std::fabs(rounded);
+    return static_cast<double>(std::fabs(static_cast<long double>(result) - reference) / spacing);
+}
+
+long double Reference(OpCode op, double a, double b) {
+    const long double x = a;
+    switch (op) {
+        case OpCode::Sin:   return sinl(x);
+        case OpCode::Cos:   return cosl(x);
+        case OpCode::Tan:   return tanl(x);
+        case OpCode::Exp:   return expl(x);
+        case OpCode::Log:   return logl(x);
+        case OpCode::Sqrt:  return sqrtl(x);
+        case OpCode::Power: return powl(x, static_cast<long double>(b));
+        default:            return NAN;
+    }
+}
+
+template<typename Function>
+double BestNanoseconds(Function&& function) {
+    double best = 1e300;
+    for (int run = 0; run < 5; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, std::chrono::duration<double, std::nano>(elapsed).count() / kValues);
+    }
+    return best;
+}
+
+// Prints one line and returns false if the bound does not hold
+template<typename Generate>
+bool Run(const char* name, OpCode op, Generate&& generate) {
+    std::mt19937_64 random(12345);
+    Inputs inputs{std::vector<double>(kValues), std::vector<double>(kValues, 0.0)};
+    std::vector<double> out(kValues);
+    double worst = 0.0;
+    double worstA = 0.0;
+    double worstB = 0.0;
+    for (int round = 0; round < kRounds; ++round) {
+        for (std::size_t i = 0; i < kValues; ++i) {
+            generate(random, inputs.a[i], inputs.b[i]);
+        }
+        ApplyFast(op, inputs.a.data(), inputs.b.data(), out.data(), kValues);
+        for (std::size_t i = 0; i < kValues; ++i) {
+            const double error = ErrorUlps(out[i], Reference(op, inputs.a[i], inputs.b[i]));
+            if (!(error <= worst)) {
+                worst = error;
+                worstA = inputs.a[i];
+                worstB = inputs.b[i];
+            }
+        }
+    }
+
+    const double fastNs = BestNanoseconds([&] {
+        ApplyFast(op, inputs.a.data(), inputs.b.data(), out.data(), kValues);
+        g_sink = g_sink + out[kValues / 2];
+    });
+    const double preciseNs = BestNanoseconds([&] {
+        for (std::size_t i = 0; i < kValues; ++i) {
+            out[i] = plot_genius::ApplyOp(op, inputs.a[i], inputs.b[i]);
+        }
+        g_sink = g_sink + out[kValues / 2];
+    });
+
+    const bool holds = worst <= plot_genius::kFastMathMaxUlps;
+    std::printf("%-22s %8.2f ns precise %8.2f ns fast %8.3f ulp%s\n", name, preciseNs, fastNs, worst,
+                holds ? "" : "  EXCEEDS BOUND");
+    if (!holds) {
+        std::printf("    at a = %.17g, b = %.17g\n", worstA, worstB);
+    }
+    return holds;
+}
+
+double Uniform(std::mt19937_64& random, double lo, double hi) {
+    return std::uniform_real_distribution<double>(lo, hi)(random);
+}
+
+// k*pi/2 for k up to kFastTrigLimit/(pi/2), rounded, then moved by up to two doubles either way
+double NearHalfPiMultiple(std::mt19937_64& random) {
+    constexpr long double kHalfPi = 1.570796326794896619231321691639751442L;
+    const auto multiples = static_cast<std::uint64_t>(plot_genius::kFastTrigLimit / kHalfPi);
+    double x = static_cast<double>(static_cast<long double>(random() % multiples + 1) * kHalfPi);
+    for (int step = static_cast<int>(random() % 5) - 2; step != 0; step += step < 0 ? 1 : -1) {
+        x = std::nextafter(x, step < 0 ? 0.0 : INFINITY);
+    }
+    return random() % 2 == 0 ? x : -x;
+}
+
+} // namespace
+
+int main() {
+    std::printf("Fast math kernels on %s, %zu values per call, bound %.0f ulp\n\n",
+                plot_genius::GetFastMathTarget(), kValues, plot_genius::kFastMathMaxUlps);
+
+    bool holds = true;
+    holds &= Run("sin", OpCode::Sin, [](auto& random, double& a, double&) { a = Uniform(random, -100.0, 100.0); });
+    holds &= Run("sin (large)", OpCode::Sin, [](auto& random, double& a, double&) {
+        a = Uniform(random, -2.0 * plot_genius::kFastTrigLimit, 2.0 * plot_genius::kFastTrigLimit);
+    });
+    holds &= Run("cos", OpCode::Cos, [](auto& random, double& a, double&) { a = Uniform(random, -100.0, 100.0); });
+    holds &= Run("tan", OpCode::Tan, [](auto& random, double& a, double&) { a = Uniform(random, -100.0, 100.0); });
+    holds &= Run("sin (near k*pi/2)", OpCode::Sin, [](auto& random, double& a, double&) {
+        a = NearHalfPiMultiple(random);
+    });
+    holds &= Run("cos (near k*pi/2)", OpCode::Cos, [](auto& random, double& a, double&) {
+        a = NearHalfPiMultiple(random);
+    });
+    holds &= Run("tan (near k*pi/2)", OpCode::Tan, [](auto& random, double& a, double&) {
+        a = NearHalfPiMultiple(random);
+    });
+    holds &= Run("exp", OpCode::Exp, [](auto& random, double& a, double&) { a = Uniform(random, -745.0, 709.0); });
+    holds &= Run("log", OpCode::Log, [](auto& random, double& a, double&) {
+        a = std::exp2(Uniform(random, -1074.0, 1024.0));
+    });
+    holds &= Run("sqrt", OpCode::Sqrt, [](auto& random, double& a, double&) { a = Uniform(random, 0.0, 1e6); });
+    holds &= Run("pow", OpCode::Power, [](auto& random, double& a, double& b) {
+        a = Uniform(random, 0.0, 100.0);
+        b = Uniform(random, -5.0, 5.0);
+    });
+
+    // Exponents chosen so b*log(a) spans the whole range of exp, e.g. pow(0.704, -1841.76)
+    holds &= Run("pow (large exponent)", OpCode::Power, [](auto& random, double& a, double& b) {
+        a = std::exp2(Uniform(random, -1022.0, 1023.0));
+        if (random() % 2 == 0) {
+            a = Uniform(random, 0.5, 2.0);
+        }
+        b = Uniform(random, -745.0, 709.0) / std::log(a);
+    });
+
+    return holds ? 0 : 1;
+}
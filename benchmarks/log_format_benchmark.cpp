@@ -0,0 +1,136 @@
+/**
+ * Log Format Benchmark
+ *
+ * Compares the previous stringstream-based Logger::FormatString with
+ * core::FormatTo, and measures the cost of a log call below the active
+ * level. Reports nanoseconds and heap allocations per call.
+ */
+
+#include "core/format.hpp"
+#include "core/logger.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+
+namespace {
+
+std::atomic<std::size_t> g_allocations{0};
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+using plot_genius::core::FormatTo;
+using plot_genius::core::InlineFormatBuffer;
+
+// The formatter core::Logger used before, kept here as the baseline
+std::string LegacyFormatString(const std::string& format) {
+    return format;
+}
+
+template<typename T, typename... Args>
+std::string LegacyFormatString(const std::string& format, T value, Args... args) {
+    std::string result;
+    std::size_t pos = format.find("{}");
+    if (pos != std::string::npos) {
+        std::stringstream ss;
+        ss << value;
+        result = format.substr(0, pos) + ss.str() + LegacyFormatString(format.substr(pos + 2), args...);
+    } else {
+        result = format;
+    }
+    return result;
+}
+
+// Keeps the optimizer from discarding benchmark results
+volatile std::size_t g_sink = 0;
+
+template<typename Function>
+void Run(const char* name, int iterations, Function&& function) {
+    // Warm up, then report the best of several runs
+    for (int i = 0; i < iterations / 10; ++i) {
+        function(i);
+    }
+
+    double bestNs = 1e300;
+    std::size_t allocations = 0;
+    for (int run = 0; run < 5; ++run) {
+        std::size_t allocationsBefore = g_allocations.load();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            function(i);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        allocations = g_allocations.load() - allocationsBefore;
+
+        double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+        if (ns < bestNs) {
+            bestNs = ns;
+        }
+    }
+
+    std::printf("%-34s %10.1f ns/call %8.2f allocations/call\n",
+                name, bestNs, static_cast<double>(allocations) / iterations);
+}
+
+} // namespace
+
+int main() {
+    constexpr int kIterations = 200000;
+    const std::string equation = "y=sin(x)*cos(2*x)";
+
+    std::printf("Formatting \"Failed to evaluate point at x = {}: {} ({})\"\n\n");
+
+    Run("legacy FormatString", kIterations, [&](int i) {
+        std::string text = LegacyFormatString("Failed to evaluate point at x = {}: {} ({})",
+                                              i * 0.25, "Division by zero", equation);
+        g_sink += text.size();
+    });
+
+    Run("core::FormatTo (stack buffer)", kIterations, [&](int i) {
+        InlineFormatBuffer<480> buffer;
+        FormatTo(buffer, "Failed to evaluate point at x = {}: {} ({})",
+                 i * 0.25, "Division by zero", equation);
+        g_sink += buffer.View().size();
+    });
+
+    Run("legacy FormatString (integers)", kIterations, [&](int i) {
+        std::string text = LegacyFormatString("Sampled {} points for {} equations", i, i & 7);
+        g_sink += text.size();
+    });
+
+    Run("core::FormatTo (integers)", kIterations, [&](int i) {
+        InlineFormatBuffer<480> buffer;
+        FormatTo(buffer, "Sampled {} points for {} equations", i, i & 7);
+        g_sink += buffer.View().size();
+    });
+
+    // A Debug call in a build whose minimum level is Info compiles to nothing;
+    // with Debug compiled in, it costs one runtime level check
+    plot_genius::core::Logger::GetInstance().SetLevel(plot_genius::core::LogLevel::Warning);
+    Run("PLOT_GENIUS_LOG_DEBUG (filtered)", kIterations * 10, [&](int i) {
+        PLOT_GENIUS_LOG_DEBUG("Sampled {} points for {}", i, equation);
+    });
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+/**
+ * Plot Genius C API Implementation
+ *
+ * Wraps the graph engine behind the C interface. Exceptions never cross the
+ * boundary; they are turned into status codes here.
+ */
+
+#include "plot_genius.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include "../graph/graph.hpp"
+
+struct pg_program {
+    plot_genius::Graph graph;
+};
+
+namespace {
+
+void CopyError(const std::string& message, char* error, size_t errorSize) {
+    if (!error || errorSize == 0) {
+        return;
+    }
+    size_t length = std::min(message.size(), errorSize - 1);
+    std::memcpy(error, message.data(), length);
+    error[length] = '\0';
+}
+
+} // namespace
+
+extern "C" {
+
+int pg_api_version(void) {
+    return PG_API_VERSION;
+}
+
+pg_status pg_compile(const char* equation, pg_program** program, char* error, size_t error_size) {
+    if (!equation || !program) {
+        CopyError("Null argument", error, error_size);
+        return PG_INVALID_ARGUMENT;
+    }
+    *program = nullptr;
+
+    try {
+        auto compiled = std::make_unique<pg_program>();
+        if (!compiled->graph.SetEquation(equation)) {
+            CopyError(compiled->graph.GetLastError(), error, error_size);
+            return PG_PARSE_ERROR;
+        }
+        *program = compiled.release();
+        return PG_OK;
+    } catch (const std::exception& e) {
+        CopyError(e.what(), error, error_size);
+        return PG_INTERNAL_ERROR;
+    }
+}
+
+pg_status pg_evaluate(const pg_program* program, const double* x, double* y, size_t count) {
+    if (!program || (count > 0 && (!x || !y))) {
+        return PG_INVALID_ARGUMENT;
+    }
+    try {
+        program->graph.EvaluateBatch(x, y, count);
+        return PG_OK;
+    } catch (const std::exception&) {
+        return PG_INTERNAL_ERROR;
+    }
+}
+
+pg_status pg_sample(const pg_program* program, double x_min, double x_max, size_t count, double* x, double* y) {
+    if (!program || !y || count < 2 || !std::isfinite(x_min) || !std::isfinite(x_max)) {
+        return PG_INVALID_ARGUMENT;
+    }
+    try {
+        program->graph.SampleInto(x_min, x_max, count, x, y);
+        return PG_OK;
+    } catch (const std::exception&) {
+        return PG_INTERNAL_ERROR;
+    }
+}
+
+void pg_free(pg_program* program) {
+    delete program;
+}
+
+} // extern "C"
@@ -0,0 +1,111 @@
+/**
+ * Plot Genius C API
+ *
+ * Stable C interface to the headless compute core: the same parser, compiler
+ * and sampler the application uses, without any GUI dependency. Results are
+ * written into caller-provided buffers; the library never allocates memory
+ * the caller has to free, except for programs released with pg_free.
+ *
+ * Compiled programs are immutable, so one program may be evaluated from any
+ * number of threads at once. No function throws or aborts on bad input; each
+ * reports failure through its return value.
+ */
+
+#ifndef PLOT_GENIUS_H
+#define PLOT_GENIUS_H
+
+#include <stddef.h>
+
+#if defined(_WIN32) && defined(PLOT_GENIUS_CORE_SHARED)
+#ifdef PLOT_GENIUS_CORE_BUILD
+#define PG_API __declspec(dllexport)
+#else
+#define PG_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define PG_API __attribute__((visibility("default")))
+#else
+#define PG_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Version of this interface; bumped only on incompatible changes */
+#define PG_API_VERSION 1
+
+/**
+ * Result codes
+ */
+typedef enum pg_status {
+    PG_OK = 0,                  /**< Success */
+    PG_INVALID_ARGUMENT = 1,    /**< A null pointer or out-of-range argument */
+    PG_PARSE_ERROR = 2,         /**< The equation could not be compiled */
+    PG_INTERNAL_ERROR = 3       /**< Unexpected failure inside the library */
+} pg_status;
+
+/**
+ * Compiled equation (opaque)
+ */
+typedef struct pg_program pg_program;
+
+/**
+ * Gets the interface version the library was built with
+ *
+ * @return PG_API_VERSION of the library
+ */
+PG_API int pg_api_version(void);
+
+/**
+ * Compiles an equation
+ *
+ * Named parameters such as a in "y=a*x" evaluate as 1.
+ *
+ * @param equation Null-terminated equation in the application's syntax, e.g. "y=sin(x)*2"
+ * @param program Receives the compiled program on success
+ * @param error Receives a null-terminated message on failure; may be null
+ * @param error_size Size of the error buffer in bytes
+ * @return PG_OK, PG_INVALID_ARGUMENT or PG_PARSE_ERROR
+ */
+PG_API pg_status pg_compile(const char* equation, pg_program** program, char* error, size_t error_size);
+
+/**
+ * Evaluates a program at many x values
+ *
+ * @param program Compiled program
+ * @param x Input values
+ * @param y Receives count results; may not overlap x
+ * @param count Number of values
+ * @return PG_OK, PG_INVALID_ARGUMENT or PG_INTERNAL_ERROR (e.g. out of memory)
+ */
+PG_API pg_status pg_evaluate(const pg_program* program, const double* x, double* y, size_t count);
+
+/**
+ * Samples a program on count evenly spaced points from x_min to x_max
+ *
+ * Uses the same grid as the application's plots.
+ *
+ * @param program Compiled program
+ * @param x_min First x value
+ * @param x_max Last x value
+ * @param count Number of points (at least 2)
+ * @param x Receives the x values; may be null
+ * @param y Receives the results
+ * @return PG_OK, PG_INVALID_ARGUMENT or PG_INTERNAL_ERROR (e.g. out of memory)
+ */
+PG_API pg_status pg_sample(const pg_program* program, double x_min, double x_max, size_t count,
+                           double* x, double* y);
+
+/**
+ * Releases a program
+ *
+ * @param program Program from pg_compile; null is ignored
+ */
+PG_API void pg_free(pg_program* program);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLOT_GENIUS_H */
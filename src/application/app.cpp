@@ -6,6 +6,8 @@
  */
 
 #include "app.hpp"
+#include "../config/config.hpp"
+#include "../core/profiler.hpp"
 #include <GLFW/glfw3.h>
 
 namespace plot_genius {
@@ -18,7 +20,10 @@ App& App::GetInstance() {
 
 App::App()
     : m_running(false)
+    , m_onDemand(true)
+    , m_frameDue(false)
     , m_fps(0.0)
+    , m_displayedFps(-1)
     , m_window(nullptr) {}
 
 App::~App() {
@@ -27,6 +32,11 @@ App::~App() {
 
 bool App::Initialize() {
     core::Logger::GetInstance().Log(core::LogLevel::Info, "Initializing application");
+    PLOT_GENIUS_TRACE_THREAD_NAME("Main");
+
+    // Load settings here, on the main thread, before anything reads them
+    config::Config& config = config::Config::GetInstance();
+    config.LoadFromFile();
 
     m_window = std::make_unique<Window>();
     if (!m_window->Initialize()) {
@@ -34,6 +44,16 @@ bool App::Initialize() {
         return false;
     }
 
+    // Bring back the previous session's equations and view
+    const std::string& sessionFile = config.GetUISettings().sessionFile;
+    if (!sessionFile.empty()) {
+        m_window->LoadSession(sessionFile);
+    }
+
+    // Pick up edits to config.txt while running; wake the loop so they apply at once
+    config.SetChangeCallback([] { glfwPostEmptyEvent(); });
+    config.StartWatching();
+    
     m_running = true;
     return true;
 }
@@ -46,6 +66,12 @@ void App::Run() {
     int frameCount = 0;
 
     while (m_running && !m_window->ShouldClose()) {
+        // Blocks while idle in on-demand mode
+        HandleEvents();
+        if (!m_frameDue) {
+            continue;
+        }
+        
         double currentTime = glfwGetTime();
         double deltaTime = currentTime - lastTime;
         lastTime = currentTime;
@@ -60,16 +86,27 @@ void App::Run() {
             frameCount = 0;
         }
 
-        HandleEvents();
-        Update();
-        Render();
+        {
+            PLOT_GENIUS_PROFILE_SCOPE("Frame");
+            Update();
+            Render();
+        }
+        PLOT_GENIUS_PROFILE_END_FRAME();
     }
 }
 
 void App::Shutdown() {
     core::Logger::GetInstance().Log(core::LogLevel::Info, "Shutting down application");
 
+    // The watcher's callback posts GLFW events, so stop it before terminating GLFW
+    config::Config::GetInstance().StopWatching();
+
     if (m_window) {
+        // Only a window that ran has a session worth keeping
+        const config::Config::UISettings& ui = config::Config::GetInstance().GetUISettings();
+        if (m_running && !ui.sessionFile.empty()) {
+            m_window->SaveSession(ui.sessionFile, ui.sessionSamples);
+        }
         m_window->Shutdown();
         m_window.reset();
     }
@@ -79,15 +116,24 @@ void App::Shutdown() {
 }
 
 void App::HandleEvents() {
-    // Handle any input events here
+    // Only draw when something changed instead of spinning at the refresh rate
+    m_onDemand = config::Config::GetInstance().GetUISettings().onDemandRendering;
+    m_frameDue = m_window->WaitForFrame(m_onDemand);
 }
 
 void App::Update() {
-    m_window->SetTitle("Plot Genius - FPS: " + std::to_string(static_cast<int>(m_fps)));
+    // Setting the title is a round trip to the compositor, so only do it on change
+    int fps = static_cast<int>(m_fps);
+    if (fps != m_displayedFps) {
+        m_displayedFps = fps;
+        m_window->SetTitle("Plot Genius - FPS: " + std::to_string(fps));
+    }
 }
 
 void App::Render() {
     m_window->Render();
+    
+    PLOT_GENIUS_PROFILE_SCOPE("Swap");
     m_window->SwapBuffers();
 }
 
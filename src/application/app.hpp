@@ -46,7 +46,7 @@ private:
     ~App();
 
     /**
-     * Processes pending application events
+     * Processes pending application events, waiting for input while idle
      */
     void HandleEvents();
     
@@ -61,7 +61,10 @@ private:
     void Render();
 
     bool m_running;
+    bool m_onDemand;      ///< Render only when input, sampling results or animation require it
+    bool m_frameDue;      ///< Set by HandleEvents when a frame should be drawn
     double m_fps;
+    int m_displayedFps;   ///< FPS value currently shown in the title
     std::unique_ptr<Window> m_window;
 };
 
@@ -0,0 +1,136 @@
+/**
+ * Daemon Mode Implementation
+ *
+ * Blocks SIGINT and SIGTERM before any thread starts, so every service
+ * thread inherits the mask and the main thread can wait for them with
+ * sigwait instead of doing work inside a signal handler.
+ */
+
+#include "daemon.hpp"
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include "../core/logger.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <pthread.h>
+#endif
+
+namespace plot_genius {
+namespace application {
+
+namespace {
+
+bool ParseCount(const std::string& text, std::size_t& value) {
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+} // namespace
+
+bool IsDaemonRequested(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--daemon") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* GetDaemonUsage() {
+    return "Usage: plot_genius --daemon [options]\n"
+           "  --socket PATH      Unix socket to listen on (default: /tmp/plot_genius.sock)\n"
+           "  --threads N        Worker threads (default: every core)\n"
+           "  --cache-mb N       Memory for cached samples (default: 256)\n"
+           "  --pipeline N       Requests in flight per connection (default: 64)\n"
+           "  --help             Show this help\n"
+           "Requests are lines on the socket; each gets one response:\n"
+           "  ID samples XMIN XMAX POINTS EQUATION...\n"
+           "  ID png|svg XMIN XMAX YMIN YMAX WIDTH HEIGHT EQUATION...\n"
+           "  ID stats\n"
+           "  -> ID ok BYTES LATENCY_US, then BYTES bytes of payload\n"
+           "  -> ID error MESSAGE\n";
+}
+
+bool ParseDaemonOptions(int argc, char** argv, DaemonOptions& options, std::string& error) {
+    service::ServerOptions& server = options.server;
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        auto value = [&](std::string& out) {
+            if (i + 1 >= argc) {
+                error = argument + " needs a value";
+                return false;
+            }
+            out = argv[++i];
+            return true;
+        };
+
+        std::string text;
+        if (argument == "--daemon") {
+            continue;
+        } else if (argument == "--help") {
+            options.showHelp = true;
+        } else if (argument == "--socket") {
+            if (!value(server.socketPath)) return false;
+        } else if (argument == "--threads") {
+            if (!value(text)) return false;
+            if (!ParseCount(text, server.threads)) {
+                error = "--threads needs an integer";
+                return false;
+            }
+        } else if (argument == "--cache-mb") {
+            std::size_t megabytes = 0;
+            if (!value(text)) return false;
+            if (!ParseCount(text, megabytes) || megabytes > (SIZE_MAX >> 20)) {
+                error = "--cache-mb needs an integer";
+                return false;
+            }
+            server.sampleCacheBytes = megabytes << 20;
+        } else if (argument == "--pipeline") {
+            if (!value(text)) return false;
+            if (!ParseCount(text, server.maxPipelined) || server.maxPipelined == 0) {
+                error = "--pipeline needs an integer of at least 1";
+                return false;
+            }
+        } else {
+            error = "Unknown option " + argument;
+            return false;
+        }
+    }
+    return true;
+}
+
+int RunDaemon(const DaemonOptions& options) {
+#if defined(__unix__) || defined(__APPLE__)
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+
+    // A client hanging up must not kill the service
+    std::signal(SIGPIPE, SIG_IGN);
+
+    service::Server server(options.server);
+    std::string error;
+    if (!server.Start(error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    int signal = 0;
+    sigwait(&stopSignals, &signal);
+    PLOT_GENIUS_LOG_INFO("Received signal {}, stopping", signal);
+    server.Stop();
+    return 0;
+#else
+    (void)options;
+    std::fprintf(stderr, "Daemon mode needs Unix domain sockets, which this platform does not provide\n");
+    return 1;
+#endif
+}
+
+} // namespace application
+} // namespace plot_genius
@@ -0,0 +1,62 @@
+/**
+ * Daemon Mode Header
+ *
+ * Defines `plot_genius --daemon`, which runs the plot service on a Unix
+ * domain socket until interrupted.
+ */
+
+#pragma once
+
+#include <string>
+#include "../service/server.hpp"
+
+namespace plot_genius {
+namespace application {
+
+/**
+ * Settings of a daemon run, filled from the command line
+ */
+struct DaemonOptions {
+    service::ServerOptions server;
+    bool showHelp = false;  ///< Print the usage instead of running
+};
+
+/**
+ * Checks whether the command line asks for daemon mode
+ *
+ * @param argc Argument count
+ * @param argv Argument values
+ * @return True if --daemon is present
+ */
+bool IsDaemonRequested(int argc, char** argv);
+
+/**
+ * Parses the daemon command line
+ *
+ * @param argc Argument count
+ * @param argv Argument values
+ * @param options Receives the settings
+ * @param error Receives the reason on failure
+ * @return True if all arguments were valid
+ */
+bool ParseDaemonOptions(int argc, char** argv, DaemonOptions& options, std::string& error);
+
+/**
+ * Gets the command line help for daemon mode
+ *
+ * @return Usage text
+ */
+const char* GetDaemonUsage();
+
+/**
+ * Serves requests until SIGINT or SIGTERM
+ *
+ * Logs the request and cache statistics when stopping.
+ *
+ * @param options Settings of the run
+ * @return Process exit code: 0 after a clean stop, 1 if the socket could not be opened
+ */
+int RunDaemon(const DaemonOptions& options);
+
+} // namespace application
+} // namespace plot_genius
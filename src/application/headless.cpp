@@ -0,0 +1,448 @@
+/**
+ * Headless Batch Mode Implementation
+ *
+ * The main thread reads and compiles equations and splits each into jobs of
+ * at most kChunkPoints points. Workers sample and encode the jobs; the main
+ * thread writes finished jobs in input order. At most kJobsPerThread jobs
+ * per worker are in flight, which bounds memory regardless of input size.
+ *
+ * Input lines hold one equation, optionally followed by its own range:
+ *
+ *     y=sin(x)
+ *     y=x*x ; -2 2 500        (xMin xMax [points])
+ *
+ * Blank lines and lines starting with '#' are skipped. Equations are
+ * numbered from 0 in input order, counting those that fail to compile.
+ */
+
+#include "headless.hpp"
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#include "../core/latency_histogram.hpp"
+#include "../core/logger.hpp"
+#include "../core/thread_pool.hpp"
+#include "../graph/graph.hpp"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace plot_genius {
+namespace application {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Points sampled and encoded by one job; bounds the memory of a job
+constexpr std::size_t kChunkPoints = 65536;
+
+// Jobs queued or waiting to be written, per worker thread
+constexpr std::size_t kJobsPerThread = 4;
+
+constexpr std::size_t kOutputBufferSize = 1 << 20;
+
+/**
+ * A compiled input equation and the grid to sample it on
+ */
+struct Equation {
+    std::uint32_t index;
+    Graph graph;
+    double xMin;
+    double step;
+    std::size_t points;
+    Clock::time_point readTime;  // Start of its latency
+};
+
+/**
+ * A contiguous part of one equation's grid
+ */
+struct Job {
+    std::shared_ptr<const Equation> equation;
+    std::size_t first;  // Index of the first grid point
+    std::size_t count;
+    bool last;          // Final job of its equation
+    std::string output;
+    bool done{false};   // Guarded by the runner's mutex
+};
+
+template<typename T>
+void AppendRaw(std::string& out, const T* values, std::size_t count) {
+    out.append(reinterpret_cast<const char*>(values), count * sizeof(T));
+}
+
+void AppendNumber(std::string& out, double value) {
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<std::size_t>(result.ptr - digits));
+}
+
+/**
+ * Samples a job and encodes it; runs on a worker thread
+ */
+void EncodeJob(Job& job, HeadlessOptions::Format format) {
+    thread_local std::vector<double> xs;
+    thread_local std::vector<double> ys;
+    xs.resize(job.count);
+    ys.resize(job.count);
+
+    const Equation& equation = *job.equation;
+    for (std::size_t i = 0; i < job.count; ++i) {
+        xs[i] = equation.xMin + static_cast<double>(job.first + i) * equation.step;
+    }
+    equation.graph.EvaluateBatch(xs.data(), ys.data(), job.count);
+
+    if (format == HeadlessOptions::Format::Binary) {
+        const std::uint32_t header[2] = {equation.index, static_cast<std::uint32_t>(job.count)};
+        thread_local std::vector<float> column;
+        column.resize(job.count);
+
+        job.output.reserve(sizeof(header) + 2 * job.count * sizeof(float));
+        AppendRaw(job.output, header, 2);
+        std::copy(xs.begin(), xs.end(), column.begin());
+        AppendRaw(job.output, column.data(), job.count);
+        std::copy(ys.begin(), ys.end(), column.begin());
+        AppendRaw(job.output, column.data(), job.count);
+    } else {
+        char index[16];
+        auto indexEnd = std::to_chars(index, index + sizeof(index), equation.index).ptr;
+
+        job.output.reserve(job.count * 40);
+        for (std::size_t i = 0; i < job.count; ++i) {
+            job.output.append(index, indexEnd);
+            job.output += ',';
+            AppendNumber(job.output, xs[i]);
+            job.output += ',';
+            AppendNumber(job.output, ys[i]);
+            job.output += '\n';
+        }
+    }
+}
+
+bool ParseNumber(const std::string& text, double& value) {
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return !text.empty() && *end == '\0' && std::isfinite(value);
+}
+
+bool ParseCount(const std::string& text, std::size_t& value) {
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+bool ValidRange(double xMin, double xMax, std::size_t points) {
+    return xMin < xMax && points >= 2 && points <= UINT32_MAX;
+}
+
+/**
+ * Reads equations and turns them into jobs
+ */
+class EquationReader {
+public:
+    EquationReader(std::istream& input, const HeadlessOptions& options) : m_input(input), m_options(options) {}
+
+    // Gets the next job, or false at the end of the input
+    bool Next(std::shared_ptr<Job>& job) {
+        while (!m_current || m_nextPoint >= m_current->points) {
+            if (!ReadEquation()) {
+                return false;
+            }
+        }
+
+        job = std::make_shared<Job>();
+        job->equation = m_current;
+        job->first = m_nextPoint;
+        job->count = std::min(kChunkPoints, m_current->points - m_nextPoint);
+        m_nextPoint += job->count;
+        job->last = m_nextPoint == m_current->points;
+        return true;
+    }
+
+    std::uint64_t GetFailures() const { return m_failures; }
+
+private:
+    bool ReadEquation() {
+        std::string line;
+        while (std::getline(m_input, line)) {
+            ++m_lineNumber;
+            std::size_t start = line.find_first_not_of(" \t\r");
+            if (start == std::string::npos || line[start] == '#') {
+                continue;
+            }
+
+            const auto readTime = Clock::now();
+            const auto index = m_nextIndex++;
+
+            double xMin = m_options.xMin;
+            double xMax = m_options.xMax;
+            std::size_t points = m_options.points;
+            std::size_t separator = line.find(';');
+            if (separator != std::string::npos) {
+                std::istringstream fields(line.substr(separator + 1));
+                std::string xMinText, xMaxText, pointsText, extra;
+                fields >> xMinText >> xMaxText >> pointsText >> extra;
+                bool valid = ParseNumber(xMinText, xMin) && ParseNumber(xMaxText, xMax) &&
+                             (pointsText.empty() || ParseCount(pointsText, points)) && extra.empty();
+                if (!valid || !ValidRange(xMin, xMax, points)) {
+                    Fail("expected '; xMin xMax [points]' with xMin < xMax and at least 2 points");
+                    continue;
+                }
+                line.resize(separator);
+            }
+
+            auto equation = std::make_shared<Equation>();
+            if (!equation->graph.SetEquation(line.substr(start))) {
+                Fail(equation->graph.GetLastError());
+                continue;
+            }
+            equation->index = index;
+            equation->xMin = xMin;
+            equation->step = (xMax - xMin) / static_cast<double>(points - 1);
+            equation->points = points;
+            equation->readTime = readTime;
+
+            m_current = std::move(equation);
+            m_nextPoint = 0;
+            return true;
+        }
+        return false;
+    }
+
+    void Fail(const std::string& reason) {
+        ++m_failures;
+        std::fprintf(stderr, "%s:%zu: %s\n", m_options.input.c_str(), m_lineNumber, reason.c_str());
+    }
+
+    std::istream& m_input;
+    const HeadlessOptions& m_options;
+    std::shared_ptr<const Equation> m_current;
+    std::size_t m_nextPoint{0};
+    std::size_t m_lineNumber{0};
+    std::uint32_t m_nextIndex{0};
+    std::uint64_t m_failures{0};
+};
+
+} // namespace
+
+bool IsHeadlessRequested(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* GetHeadlessUsage() {
+    return "Usage: plot_genius --headless [options]\n"
+           "  --input FILE       Equations, one per line (default: stdin)\n"
+           "  --output FILE      Results (default: stdout)\n"
+           "  --range XMIN XMAX  Default sampling range (default: -10 10)\n"
+           "  --points N         Default points per equation (default: 1000)\n"
+           "  --format FORMAT    binary or csv (default: binary)\n"
+           "  --threads N        Worker threads (default: every core)\n"
+           "  --help             Show this help\n"
+           "A line may override the range: 'y=x*x ; -2 2 500'.\n"
+           "Binary output is a sequence of blocks: uint32 equation, uint32 count,\n"
+           "float x[count], float y[count] (native byte order).\n";
+}
+
+bool ParseHeadlessOptions(int argc, char** argv, HeadlessOptions& options, std::string& error) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        auto value = [&](std::string& out) {
+            if (i + 1 >= argc) {
+                error = argument + " needs a value";
+                return false;
+            }
+            out = argv[++i];
+            return true;
+        };
+
+        std::string text;
+        if (argument == "--headless") {
+            continue;
+        } else if (argument == "--help") {
+            options.showHelp = true;
+        } else if (argument == "--input") {
+            if (!value(options.input)) return false;
+        } else if (argument == "--output") {
+            if (!value(options.output)) return false;
+        } else if (argument == "--range") {
+            std::string maxText;
+            if (!value(text) || !value(maxText)) return false;
+            if (!ParseNumber(text, options.xMin) || !ParseNumber(maxText, options.xMax) ||
+                options.xMin >= options.xMax) {
+                error = "--range needs two numbers with XMIN < XMAX";
+                return false;
+            }
+        } else if (argument == "--points") {
+            if (!value(text)) return false;
+            if (!ParseCount(text, options.points) || !ValidRange(0.0, 1.0, options.points)) {
+                error = "--points needs an integer of at least 2";
+                return false;
+            }
+        } else if (argument == "--format") {
+            if (!value(text)) return false;
+            if (text == "binary") {
+                options.format = HeadlessOptions::Format::Binary;
+            } else if (text == "csv") {
+                options.format = HeadlessOptions::Format::Csv;
+            } else {
+                error = "--format must be binary or csv";
+                return false;
+            }
+        } else if (argument == "--threads") {
+            if (!value(text)) return false;
+            if (!ParseCount(text, options.threads)) {
+                error = "--threads needs an integer";
+                return false;
+            }
+        } else {
+            error = "Unknown option " + argument;
+            return false;
+        }
+    }
+    return true;
+}
+
+int RunHeadless(const HeadlessOptions& options) {
+    // Stdout may carry the results, so diagnostics go to stderr
+    core::Logger::GetInstance().SetConsoleStream(stderr);
+
+    std::ifstream file;
+    if (options.input != "-") {
+        file.open(options.input);
+        if (!file.is_open()) {
+            std::fprintf(stderr, "Cannot open %s\n", options.input.c_str());
+            return 1;
+        }
+    } else {
+        std::ios::sync_with_stdio(false);
+    }
+    std::istream& input = options.input == "-" ? std::cin : file;
+
+    std::FILE* output = stdout;
+    if (options.output != "-") {
+        output = std::fopen(options.output.c_str(), "wb");
+        if (!output) {
+            std::fprintf(stderr, "Cannot create %s\n", options.output.c_str());
+            return 1;
+        }
+    } else {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    }
+    std::setvbuf(output, nullptr, _IOFBF, kOutputBufferSize);
+
+    if (options.format == HeadlessOptions::Format::Csv) {
+        std::fputs("equation,x,y\n", output);
+    }
+
+    // Declared before the pool so they outlive its workers
+    std::mutex mutex;
+    std::condition_variable jobDone;
+
+    core::ThreadPool pool(options.threads);
+    const std::size_t maxInFlight = kJobsPerThread * pool.GetThreadCount();
+    std::deque<std::shared_ptr<Job>> inFlight;  // Submission order, which is output order
+
+    EquationReader reader(input, options);
+    core::LatencyHistogram latency;
+    std::uint64_t equations = 0;
+    std::uint64_t points = 0;
+    std::uint64_t bytes = 0;
+    bool writeFailed = false;
+    bool inputDone = false;
+    const auto start = Clock::now();
+
+    while (!writeFailed) {
+        // Keep every worker busy, within the memory bound
+        while (!inputDone && inFlight.size() < maxInFlight) {
+            std::shared_ptr<Job> job;
+            if (!reader.Next(job)) {
+                inputDone = true;
+                break;
+            }
+            inFlight.push_back(job);
+            pool.Submit([job, &mutex, &jobDone, format = options.format] {
+                try {
+                    EncodeJob(*job, format);
+                } catch (const std::exception& e) {
+                    PLOT_GENIUS_LOG_ERROR("Failed to sample equation {}: {}", job->equation->index, e.what());
+                    job->output.clear();
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    job->done = true;
+                }
+                jobDone.notify_one();
+            });
+        }
+        if (inFlight.empty()) {
+            break;
+        }
+
+        // Write strictly in input order
+        std::shared_ptr<Job> job = inFlight.front();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobDone.wait(lock, [&] { return job->done; });
+        }
+        inFlight.pop_front();
+
+        if (std::fwrite(job->output.data(), 1, job->output.size(), output) != job->output.size()) {
+            writeFailed = true;
+        }
+        bytes += job->output.size();
+        points += job->count;
+        if (job->last) {
+            ++equations;
+            latency.Add(Clock::now() - job->equation->readTime);
+        }
+    }
+
+    // Jobs still queued after a write failure must finish before their state goes away
+    pool.WaitIdle();
+
+    if (std::fflush(output) != 0) {
+        writeFailed = true;
+    }
+    if (output != stdout) {
+        writeFailed = std::fclose(output) != 0 || writeFailed;
+    }
+    if (writeFailed) {
+        std::fprintf(stderr, "Failed to write %s\n", options.output == "-" ? "stdout" : options.output.c_str());
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::fprintf(stderr,
+                 "Sampled %llu equations (%llu failed), %llu points in %.3f s on %zu threads: "
+                 "%.0f points/s, %.1f MB/s\n"
+                 "Equation latency: p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+                 static_cast<unsigned long long>(equations), static_cast<unsigned long long>(reader.GetFailures()),
+                 static_cast<unsigned long long>(points), seconds, pool.GetThreadCount(),
+                 seconds > 0.0 ? static_cast<double>(points) / seconds : 0.0,
+                 seconds > 0.0 ? static_cast<double>(bytes) / seconds / 1e6 : 0.0,
+                 latency.PercentileMs(0.5), latency.PercentileMs(0.99), latency.MaxMs());
+
+    return writeFailed || reader.GetFailures() > 0 ? 1 : 0;
+}
+
+} // namespace application
+} // namespace plot_genius
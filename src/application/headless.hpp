@@ -0,0 +1,77 @@
+/**
+ * Headless Batch Mode Header
+ *
+ * Defines `plot_genius --headless`, which samples equations read from a file
+ * or stdin and streams the points as binary float columns or CSV, without a
+ * window or GL context.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace plot_genius {
+namespace application {
+
+/**
+ * Settings of a headless run, filled from the command line
+ */
+struct HeadlessOptions {
+    /**
+     * Output encoding
+     */
+    enum class Format {
+        Binary,  ///< Per block: uint32 equation, uint32 count, float x[count], float y[count]
+        Csv      ///< "equation,x,y" rows
+    };
+
+    std::string input = "-";       ///< Equation file, "-" for stdin
+    std::string output = "-";      ///< Result file, "-" for stdout
+    double xMin = -10.0;           ///< Default range start
+    double xMax = 10.0;            ///< Default range end
+    std::size_t points = 1000;     ///< Default points per equation (at least 2)
+    Format format = Format::Binary;
+    std::size_t threads = 0;       ///< Worker threads, 0 for every core
+    bool showHelp = false;         ///< Print the usage instead of running
+};
+
+/**
+ * Checks whether the command line asks for headless mode
+ *
+ * @param argc Argument count
+ * @param argv Argument values
+ * @return True if --headless is present
+ */
+bool IsHeadlessRequested(int argc, char** argv);
+
+/**
+ * Parses the headless command line
+ *
+ * @param argc Argument count
+ * @param argv Argument values
+ * @param options Receives the settings
+ * @param error Receives the reason on failure
+ * @return True if all arguments were valid
+ */
+bool ParseHeadlessOptions(int argc, char** argv, HeadlessOptions& options, std::string& error);
+
+/**
+ * Gets the command line help for headless mode
+ *
+ * @return Usage text
+ */
+const char* GetHeadlessUsage();
+
+/**
+ * Samples every equation of the input and writes the results
+ *
+ * Prints throughput and latency statistics to stderr when done.
+ *
+ * @param options Settings of the run
+ * @return Process exit code: 0 on success, 1 if any equation failed or output could not be written
+ */
+int RunHeadless(const HeadlessOptions& options);
+
+} // namespace application
+} // namespace plot_genius
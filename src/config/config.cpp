@@ -1,168 +1,396 @@
 #include "config.hpp"
+#include "../core/logger.hpp"
 #include <fstream>
-#include <sstream>
 #include <algorithm>
 #include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
 
 namespace plot_genius {
 namespace config {
 
+namespace {
+
+// Editors often write a file in several steps; wait for them to settle
+constexpr int kReloadDebounceMs = 100;
+
+std::string Trim(const std::string& text) {
+    auto begin = std::find_if(text.begin(), text.end(), [](unsigned char ch) {
+        return !std::isspace(ch);
+    });
+    auto end = std::find_if(text.rbegin(), text.rend(), [](unsigned char ch) {
+        return !std::isspace(ch);
+    }).base();
+    return begin < end ? std::string(begin, end) : std::string();
+}
+
+// Typed value parsing; each returns false if the whole text is not a valid value
+bool ParseValue(const std::string& text, double& value) {
+    char* end = nullptr;
+    double parsed = std::strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0' || !std::isfinite(parsed)) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+bool ParseValue(const std::string& text, float& value) {
+    double parsed = 0.0;
+    if (!ParseValue(text, parsed)) {
+        return false;
+    }
+    value = static_cast<float>(parsed);
+    return true;
+}
+
+bool ParseValue(const std::string& text, int& value) {
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+bool ParseValue(const std::string& text, bool& value) {
+    if (text == "true") {
+        value = true;
+    } else if (text == "false") {
+        value = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ParseValue(const std::string& text, std::string& value) {
+    value = text;
+    return true;
+}
+
+std::string FormatValue(double value) { return std::to_string(value); }
+std::string FormatValue(float value) { return std::to_string(value); }
+std::string FormatValue(int value) { return std::to_string(value); }
+std::string FormatValue(bool value) { return value ? "true" : "false"; }
+std::string FormatValue(const std::string& value) { return value; }
+
+template<typename T>
+struct Identity {
+    using Type = T;
+};
+
+/**
+ * One config key bound to a settings member
+ */
+struct Field {
+    const char* key;
+    const char* expected;  // Shown when a value is rejected
+    std::function<bool(Config::Snapshot&, const std::string&)> parse;
+    std::function<std::string(const Config::Snapshot&)> format;
+};
+
+template<typename Section, typename T>
+Field MakeField(const char* key, const char* expected, Section Config::Snapshot::*section, T Section::*member,
+                bool (*valid)(const typename Identity<T>::Type&) = nullptr) {
+    return {
+        key,
+        expected,
+        [=](Config::Snapshot& snapshot, const std::string& text) {
+            T value{};
+            if (!ParseValue(text, value) || (valid && !valid(value))) {
+                return false;
+            }
+            (snapshot.*section).*member = value;
+            return true;
+        },
+        [=](const Config::Snapshot& snapshot) {
+            return FormatValue((snapshot.*section).*member);
+        }
+    };
+}
+
+bool IsHexColor(const std::string& value) {
+    return value.size() == 7 && value[0] == '#' &&
+        std::all_of(value.begin() + 1, value.end(), [](unsigned char ch) { return std::isxdigit(ch); });
+}
+
+const std::vector<Field>& GetFields() {
+    using Snapshot = Config::Snapshot;
+    using Graph = Config::GraphSettings;
+    using UI = Config::UISettings;
+
+    static const std::vector<Field> fields = {
+        // Graph settings
+        MakeField("graph.defaultXMin", "a number", &Snapshot::graph, &Graph::defaultXMin),
+        MakeField("graph.defaultXMax", "a number", &Snapshot::graph, &Graph::defaultXMax),
+        MakeField("graph.defaultNumPoints", "an integer in [2, 1000000]", &Snapshot::graph, &Graph::defaultNumPoints,
+                  [](const int& value) { return value >= 2 && value <= 1000000; }),
+        MakeField("graph.showGrid", "true or false", &Snapshot::graph, &Graph::showGrid),
+        MakeField("graph.lineColor", "a #RRGGBB color", &Snapshot::graph, &Graph::lineColor, IsHexColor),
+        MakeField("graph.lineWidth", "a number in (0, 20]", &Snapshot::graph, &Graph::lineWidth,
+                  [](const float& value) { return value > 0.0f && value <= 20.0f; }),
+
+        // UI settings
+        MakeField("ui.windowWidth", "an integer in [100, 16384]", &Snapshot::ui, &UI::windowWidth,
+                  [](const int& value) { return value >= 100 && value <= 16384; }),
+        MakeField("ui.windowHeight", "an integer in [100, 16384]", &Snapshot::ui, &UI::windowHeight,
+                  [](const int& value) { return value >= 100 && value <= 16384; }),
+        MakeField("ui.theme", "dark, light or classic", &Snapshot::ui, &UI::theme,
+                  [](const std::string& value) { return value == "dark" || value == "light" || value == "classic"; }),
+        MakeField("ui.showFPS", "true or false", &Snapshot::ui, &UI::showFPS),
+        MakeField("ui.onDemandRendering", "true or false", &Snapshot::ui, &UI::onDemandRendering),
+        MakeField("ui.showProfiler", "true or false", &Snapshot::ui, &UI::showProfiler),
+        MakeField("ui.sessionFile", "a file path, or nothing to disable sessions", &Snapshot::ui, &UI::sessionFile),
+        MakeField("ui.sessionSamples", "true or false", &Snapshot::ui, &UI::sessionSamples),
+        MakeField("ui.sampleExport", "a shared-memory name such as /plot_genius_samples, or nothing",
+                  &Snapshot::ui, &UI::sampleExport,
+                  [](const std::string& value) {
+                      return value.empty() ||
+                          (value.size() > 1 && value[0] == '/' && value.find('/', 1) == std::string::npos);
+                  }),
+        MakeField("ui.animationBudgetMs", "a number in (0, 1000]", &Snapshot::ui, &UI::animationBudgetMs,
+                  [](const float& value) { return value > 0.0f && value <= 1000.0f; }),
+    };
+    return fields;
+}
+
+} // namespace
+
 Config& Config::GetInstance() {
     static Config instance;
     return instance;
 }
 
 Config::Config() {
-    // Initialize default settings
-    m_graphSettings = GraphSettings();
-    m_uiSettings = UISettings();
-    
-    // Try to load from default config file
-    LoadFromFile();
+    // Start from defaults; the file is loaded explicitly by the application
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Publish(Snapshot());
+}
+
+Config::~Config() {
+    StopWatching();
 }
 
 bool Config::LoadFromFile(const std::string& filename) {
     std::lock_guard<std::mutex> lock(m_mutex);
-    
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+
+    // Keys missing from the file keep their current values
+    Snapshot next = GetSnapshot();
+    if (!ParseFile(filename, next)) {
         return false;
     }
-    
-    std::string line;
-    while (std::getline(file, line)) {
-        ParseConfigLine(line);
-    }
-    
-    UpdateSettingsFromMap();
+
+    Publish(std::move(next));
     return true;
 }
 
-bool Config::SaveToFile(const std::string& filename) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
-    UpdateMapFromSettings();
-    
+bool Config::SaveToFile(const std::string& filename) const {
+    const Snapshot& snapshot = GetSnapshot();
+
     std::ofstream file(filename);
     if (!file.is_open()) {
         return false;
     }
-    
-    for (const auto& [key, value] : m_configMap) {
-        file << FormatConfigLine(key, value) << '\n';
+
+    for (const Field& field : GetFields()) {
+        file << field.key << " = " << field.format(snapshot) << '\n';
     }
-    
+
     return true;
 }
 
-void Config::ParseConfigLine(const std::string& line) {
-    if (line.empty() || line[0] == '#') {
-        return;
+bool Config::ParseFile(const std::string& filename, Snapshot& snapshot) const {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
     }
-    
-    size_t pos = line.find('=');
-    if (pos == std::string::npos) {
-        return;
+
+    const Snapshot previous = snapshot;
+    const auto& fields = GetFields();
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        line = Trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        size_t pos = line.find('=');
+        if (pos == std::string::npos) {
+            PLOT_GENIUS_LOG_WARNING("{}:{}: expected 'key = value'", filename, lineNumber);
+            continue;
+        }
+
+        std::string key = Trim(line.substr(0, pos));
+        std::string value = Trim(line.substr(pos + 1));
+
+        auto field = std::find_if(fields.begin(), fields.end(), [&](const Field& f) { return key == f.key; });
+        if (field == fields.end()) {
+            PLOT_GENIUS_LOG_WARNING("{}:{}: unknown setting '{}'", filename, lineNumber, key);
+        } else if (!field->parse(snapshot, value)) {
+            PLOT_GENIUS_LOG_WARNING("{}:{}: invalid value '{}' for {} (expected {})",
+                                    filename, lineNumber, value, key, field->expected);
+        }
     }
-    
-    std::string key = line.substr(0, pos);
-    std::string value = line.substr(pos + 1);
-    
-    // Trim whitespace
-    key.erase(key.begin(), std::find_if(key.begin(), key.end(), [](unsigned char ch) {
-        return !std::isspace(ch);
-    }));
-    key.erase(std::find_if(key.rbegin(), key.rend(), [](unsigned char ch) {
-        return !std::isspace(ch);
-    }).base(), key.end());
-    
-    value.erase(value.begin(), std::find_if(value.begin(), value.end(), [](unsigned char ch) {
-        return !std::isspace(ch);
-    }));
-    value.erase(std::find_if(value.rbegin(), value.rend(), [](unsigned char ch) {
-        return !std::isspace(ch);
-    }).base(), value.end());
-    
-    m_configMap[key] = value;
+
+    // Settings that are only valid together
+    if (snapshot.graph.defaultXMin >= snapshot.graph.defaultXMax) {
+        PLOT_GENIUS_LOG_WARNING("{}: graph.defaultXMin must be less than graph.defaultXMax", filename);
+        snapshot.graph.defaultXMin = previous.graph.defaultXMin;
+        snapshot.graph.defaultXMax = previous.graph.defaultXMax;
+    }
+
+    return true;
 }
 
-std::string Config::FormatConfigLine(const std::string& key, const std::string& value) const {
-    return key + " = " + value;
+void Config::Publish(Snapshot snapshot) {
+    // Caller holds m_mutex
+    const Snapshot* current = m_current.load(std::memory_order_relaxed);
+    snapshot.version = current ? current->version + 1 : 1;
+
+    auto published = std::make_unique<const Snapshot>(std::move(snapshot));
+    m_current.store(published.get(), std::memory_order_release);
+    m_snapshots.push_back(std::move(published));
 }
 
-void Config::UpdateSettingsFromMap() {
-    // Graph settings
-    if (m_configMap.count("graph.defaultXMin")) {
-        m_graphSettings.defaultXMin = std::stod(m_configMap["graph.defaultXMin"]);
-    }
-    if (m_configMap.count("graph.defaultXMax")) {
-        m_graphSettings.defaultXMax = std::stod(m_configMap["graph.defaultXMax"]);
-    }
-    if (m_configMap.count("graph.defaultNumPoints")) {
-        m_graphSettings.defaultNumPoints = std::stoi(m_configMap["graph.defaultNumPoints"]);
-    }
-    if (m_configMap.count("graph.showGrid")) {
-        m_graphSettings.showGrid = (m_configMap["graph.showGrid"] == "true");
-    }
-    if (m_configMap.count("graph.lineColor")) {
-        m_graphSettings.lineColor = m_configMap["graph.lineColor"];
+void Config::SetGraphSettings(const GraphSettings& settings) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Snapshot next = GetSnapshot();
+    next.graph = settings;
+    Publish(std::move(next));
+}
+
+void Config::SetUISettings(const UISettings& settings) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Snapshot next = GetSnapshot();
+    next.ui = settings;
+    Publish(std::move(next));
+}
+
+void Config::SetChangeCallback(std::function<void()> callback) {
+    // Set before StartWatching; the watcher thread reads it without locking
+    m_changeCallback = std::move(callback);
+}
+
+#ifdef __linux__
+
+bool Config::StartWatching(const std::string& filename) {
+    if (m_watcher.joinable()) {
+        return true;
     }
-    if (m_configMap.count("graph.lineWidth")) {
-        m_graphSettings.lineWidth = std::stof(m_configMap["graph.lineWidth"]);
+
+    m_wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (m_wakeFd < 0) {
+        PLOT_GENIUS_LOG_WARNING("Config hot reload unavailable: eventfd failed");
+        return false;
     }
-    
-    // UI settings
-    if (m_configMap.count("ui.windowWidth")) {
-        m_uiSettings.windowWidth = std::stoi(m_configMap["ui.windowWidth"]);
+
+    m_stopWatching.store(false);
+    m_watcher = std::thread([this, filename] { WatchLoop(filename); });
+    return true;
+}
+
+void Config::StopWatching() {
+    if (!m_watcher.joinable()) {
+        return;
     }
-    if (m_configMap.count("ui.windowHeight")) {
-        m_uiSettings.windowHeight = std::stoi(m_configMap["ui.windowHeight"]);
+
+    m_stopWatching.store(true);
+    std::uint64_t one = 1;
+    if (write(m_wakeFd, &one, sizeof(one)) < 0) {
+        PLOT_GENIUS_LOG_WARNING("Failed to wake the config watcher");
     }
-    if (m_configMap.count("ui.theme")) {
-        m_uiSettings.theme = m_configMap["ui.theme"];
+    m_watcher.join();
+
+    close(m_wakeFd);
+    m_wakeFd = -1;
+}
+
+void Config::WatchLoop(std::string filename) {
+    // Watch the directory: editors often replace the file instead of writing it
+    std::filesystem::path path(filename);
+    std::string directory = path.has_parent_path() ? path.parent_path().string() : ".";
+    std::string name = path.filename().string();
+
+    int inotifyFd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (inotifyFd < 0 || inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        PLOT_GENIUS_LOG_WARNING("Config hot reload unavailable: cannot watch {}", directory);
+        if (inotifyFd >= 0) {
+            close(inotifyFd);
+        }
+        return;
     }
-    if (m_configMap.count("ui.showFPS")) {
-        m_uiSettings.showFPS = (m_configMap["ui.showFPS"] == "true");
+    PLOT_GENIUS_LOG_INFO("Watching {} for changes", filename);
+
+    // Returns true if any queued event concerns the config file
+    auto drainEvents = [&] {
+        bool changed = false;
+        alignas(inotify_event) char buffer[4096];
+        for (;;) {
+            ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+            if (length <= 0) {
+                return changed;
+            }
+            for (char* p = buffer; p < buffer + length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(p);
+                if (event->len > 0 && name == event->name) {
+                    changed = true;
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+    };
+
+    pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {m_wakeFd, POLLIN, 0}};
+    while (!m_stopWatching.load()) {
+        if (poll(fds, 2, -1) < 0) {
+            continue;  // EINTR
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+        if (!drainEvents()) {
+            continue;
+        }
+
+        // Let the writer finish, then fold in whatever else arrived meanwhile
+        if (poll(&fds[1], 1, kReloadDebounceMs) > 0) {
+            break;
+        }
+        drainEvents();
+
+        if (LoadFromFile(filename)) {
+            PLOT_GENIUS_LOG_INFO("Reloaded {}", filename);
+            if (m_changeCallback) {
+                m_changeCallback();
+            }
+        }
     }
-}
 
-void Config::UpdateMapFromSettings() {
-    // Graph settings
-    m_configMap["graph.defaultXMin"] = std::to_string(m_graphSettings.defaultXMin);
-    m_configMap["graph.defaultXMax"] = std::to_string(m_graphSettings.defaultXMax);
-    m_configMap["graph.defaultNumPoints"] = std::to_string(m_graphSettings.defaultNumPoints);
-    m_configMap["graph.showGrid"] = m_graphSettings.showGrid ? "true" : "false";
-    m_configMap["graph.lineColor"] = m_graphSettings.lineColor;
-    m_configMap["graph.lineWidth"] = std::to_string(m_graphSettings.lineWidth);
-    
-    // UI settings
-    m_configMap["ui.windowWidth"] = std::to_string(m_uiSettings.windowWidth);
-    m_configMap["ui.windowHeight"] = std::to_string(m_uiSettings.windowHeight);
-    m_configMap["ui.theme"] = m_uiSettings.theme;
-    m_configMap["ui.showFPS"] = m_uiSettings.showFPS ? "true" : "false";
+    close(inotifyFd);
 }
 
-Config::GraphSettings Config::GetGraphSettings() const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_graphSettings;
-}
+#else
 
-Config::UISettings Config::GetUISettings() const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_uiSettings;
+bool Config::StartWatching(const std::string& filename) {
+    PLOT_GENIUS_LOG_INFO("Config hot reload is only supported on Linux; not watching {}", filename);
+    return false;
 }
 
-void Config::SetGraphSettings(const GraphSettings& settings) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_graphSettings = settings;
-    UpdateMapFromSettings();
-}
+void Config::StopWatching() {}
 
-void Config::SetUISettings(const UISettings& settings) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_uiSettings = settings;
-    UpdateMapFromSettings();
-}
+void Config::WatchLoop(std::string) {}
+
+#endif
 
 } // namespace config
-} // namespace plot_genius 
\ No newline at end of file
+} // namespace plot_genius
@@ -1,9 +1,13 @@
 #pragma once
 
-#include <string>
-#include <map>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace plot_genius {
 namespace config {
@@ -28,39 +32,65 @@ public:
         int windowHeight = 600;
         std::string theme = "dark";
         bool showFPS = true;
+        bool onDemandRendering = true;  // Sleep until input arrives instead of redrawing every vsync
+        bool showProfiler = false;      // Show the frame profiler overlay at startup (F3 toggles)
+        std::string sessionFile = "plot_genius.session";  // Restored at startup, saved on exit ("" disables)
+        bool sessionSamples = true;     // Store sampled points so the plot appears without resampling
+        std::string sampleExport;       // Shared-memory ring the sampler publishes to, read at startup ("" disables)
+        float animationBudgetMs = 8.0f; // Sampling time per playback frame before curves get fewer points
+    };
+
+    // Immutable set of all settings; every change publishes a new one
+    struct Snapshot {
+        GraphSettings graph;
+        UISettings ui;
+        std::uint64_t version = 0;  // Increments with every published snapshot
     };
 
-    // Getters
-    GraphSettings GetGraphSettings() const;
-    UISettings GetUISettings() const;
+    // Getters: a single atomic load, safe from any thread. Published snapshots
+    // are never freed before the Config, so the references stay valid.
+    const Snapshot& GetSnapshot() const { return *m_current.load(std::memory_order_acquire); }
+    const GraphSettings& GetGraphSettings() const { return GetSnapshot().graph; }
+    const UISettings& GetUISettings() const { return GetSnapshot().ui; }
+    std::uint64_t GetVersion() const { return GetSnapshot().version; }
 
-    // Setters
+    // Setters (publish a new snapshot)
     void SetGraphSettings(const GraphSettings& settings);
     void SetUISettings(const UISettings& settings);
 
-    // Config file operations
+    // Config file operations; call from the main thread during startup
     bool LoadFromFile(const std::string& filename = "config.txt");
-    bool SaveToFile(const std::string& filename = "config.txt");
+    bool SaveToFile(const std::string& filename = "config.txt") const;
+
+    // Hot reload: reloads the file and publishes a snapshot whenever it changes
+    bool StartWatching(const std::string& filename = "config.txt");
+    void StopWatching();
+
+    // Invoked on the watcher thread after a reload published new settings
+    void SetChangeCallback(std::function<void()> callback);
 
 private:
     Config();
-    ~Config() = default;
+    ~Config();
 
     // Prevent copying
     Config(const Config&) = delete;
     Config& operator=(const Config&) = delete;
 
     // Internal helper methods
-    void ParseConfigLine(const std::string& line);
-    std::string FormatConfigLine(const std::string& key, const std::string& value) const;
-    void UpdateSettingsFromMap();
-    void UpdateMapFromSettings();
-
-    GraphSettings m_graphSettings;
-    UISettings m_uiSettings;
-    std::map<std::string, std::string> m_configMap;
-    mutable std::mutex m_mutex;
+    bool ParseFile(const std::string& filename, Snapshot& snapshot) const;
+    void Publish(Snapshot snapshot);
+    void WatchLoop(std::string filename);
+
+    std::atomic<const Snapshot*> m_current{nullptr};
+    std::vector<std::unique_ptr<const Snapshot>> m_snapshots;  // Every snapshot ever published
+    mutable std::mutex m_mutex;                                // Serializes writers
+
+    std::function<void()> m_changeCallback;
+    std::thread m_watcher;
+    std::atomic<bool> m_stopWatching{false};
+    int m_wakeFd = -1;  // Interrupts the watcher's poll (Linux)
 };
 
 } // namespace config
-} // namespace plot_genius 
\ No newline at end of file
+} // namespace plot_genius
@@ -0,0 +1,316 @@
+/**
+ * Format Header
+ *
+ * Defines the string formatting used by the logger. Placeholders are written
+ * as {} ({{ and }} produce literal braces). Output goes into caller-provided
+ * storage, usually a stack buffer, and is truncated rather than grown, so
+ * formatting never allocates.
+ *
+ * Any type can be formatted: built-in types have dedicated formatters, other
+ * types use their operator<<, and a type can opt into a faster path by
+ * specializing core::Formatter.
+ */
+
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace plot_genius {
+namespace core {
+
+/**
+ * Fixed-capacity output for formatted text over caller storage
+ */
+class FormatBuffer {
+public:
+    /**
+     * Creates an empty buffer over the given storage
+     *
+     * @param data Storage to write into
+     * @param capacity Size of the storage in bytes
+     */
+    FormatBuffer(char* data, std::size_t capacity) : m_data(data), m_capacity(capacity) {}
+
+    FormatBuffer(const FormatBuffer&) = delete;
+    FormatBuffer& operator=(const FormatBuffer&) = delete;
+
+    /**
+     * Appends text, truncating once the buffer is full
+     *
+     * @param text Text to append
+     */
+    void Append(std::string_view text) {
+        std::size_t length = text.size();
+        if (length > m_capacity - m_size) {
+            length = m_capacity - m_size;
+            m_truncated = true;
+        }
+        std::memcpy(m_data + m_size, text.data(), length);
+        m_size += length;
+    }
+
+    /**
+     * Appends a single character
+     *
+     * @param c Character to append
+     */
+    void Append(char c) {
+        if (m_size < m_capacity) {
+            m_data[m_size++] = c;
+        } else {
+            m_truncated = true;
+        }
+    }
+
+    /**
+     * Gets the formatted text
+     *
+     * @return View of the bytes written so far
+     */
+    std::string_view View() const { return std::string_view(m_data, m_size); }
+
+    /**
+     * Checks whether output was cut off
+     *
+     * @return True if any text did not fit
+     */
+    bool IsTruncated() const { return m_truncated; }
+
+private:
+    char* m_data;
+    std::size_t m_capacity;
+    std::size_t m_size{0};
+    bool m_truncated{false};
+};
+
+/**
+ * Format buffer with its own inline storage
+ *
+ * @tparam Capacity Storage size in bytes
+ */
+template<std::size_t Capacity>
+class InlineFormatBuffer : public FormatBuffer {
+public:
+    InlineFormatBuffer() : FormatBuffer(m_storage, Capacity) {}
+
+private:
+    char m_storage[Capacity];
+};
+
+/**
+ * Writes a value into a format buffer
+ *
+ * The primary template uses the type's operator<< through a stream that
+ * writes straight into the buffer. Specialize it to format a type directly.
+ *
+ * @tparam T Value type
+ */
+template<typename T, typename Enable = void>
+struct Formatter {
+    static void Format(FormatBuffer& out, const T& value) {
+        // Stream adapter appending to the buffer without intermediate strings
+        class BufferStreambuf : public std::streambuf {
+        public:
+            explicit BufferStreambuf(FormatBuffer& buffer) : m_buffer(buffer) {}
+
+        protected:
+            int_type overflow(int_type c) override {
+                if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                    m_buffer.Append(traits_type::to_char_type(c));
+                }
+                return traits_type::not_eof(c);
+            }
+
+            std::streamsize xsputn(const char* s, std::streamsize count) override {
+                m_buffer.Append(std::string_view(s, static_cast<std::size_t>(count)));
+                return count;
+            }
+
+        private:
+            FormatBuffer& m_buffer;
+        };
+
+        BufferStreambuf streambuf(out);
+        std::ostream stream(&streambuf);
+        stream << value;
+    }
+};
+
+template<>
+struct Formatter<bool> {
+    static void Format(FormatBuffer& out, bool value) {
+        out.Append(value ? std::string_view("true") : std::string_view("false"));
+    }
+};
+
+template<>
+struct Formatter<char> {
+    static void Format(FormatBuffer& out, char value) {
+        out.Append(value);
+    }
+};
+
+template<typename T>
+struct Formatter<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>>> {
+    static void Format(FormatBuffer& out, T value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        out.Append(std::string_view(digits, static_cast<std::size_t>(result.ptr - digits)));
+    }
+};
+
+template<typename T>
+struct Formatter<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+    static void Format(FormatBuffer& out, T value) {
+        // Same output as the default ostream formatting (6 significant digits)
+        char digits[32];
+        int length = std::snprintf(digits, sizeof(digits), "%g", static_cast<double>(value));
+        out.Append(std::string_view(digits, static_cast<std::size_t>(length)));
+    }
+};
+
+template<typename T>
+struct Formatter<T, std::enable_if_t<std::is_enum_v<T>>> {
+    static void Format(FormatBuffer& out, T value) {
+        Formatter<std::underlying_type_t<T>>::Format(out, static_cast<std::underlying_type_t<T>>(value));
+    }
+};
+
+template<>
+struct Formatter<const char*> {
+    static void Format(FormatBuffer& out, const char* value) {
+        out.Append(value ? std::string_view(value) : std::string_view("(null)"));
+    }
+};
+
+template<>
+struct Formatter<char*> : Formatter<const char*> {};
+
+template<>
+struct Formatter<std::string_view> {
+    static void Format(FormatBuffer& out, std::string_view value) {
+        out.Append(value);
+    }
+};
+
+template<>
+struct Formatter<std::string> {
+    static void Format(FormatBuffer& out, const std::string& value) {
+        out.Append(std::string_view(value));
+    }
+};
+
+/**
+ * Counts the {} placeholders of a format string
+ *
+ * @param format Format string
+ * @return Placeholder count, or -1 if a brace is unmatched
+ */
+constexpr int CountFormatPlaceholders(std::string_view format) {
+    int count = 0;
+    for (std::size_t i = 0; i < format.size(); ++i) {
+        if (format[i] == '{') {
+            if (i + 1 < format.size() && format[i + 1] == '{') {
+                ++i;
+            } else if (i + 1 < format.size() && format[i + 1] == '}') {
+                ++count;
+                ++i;
+            } else {
+                return -1;
+            }
+        } else if (format[i] == '}') {
+            if (i + 1 < format.size() && format[i + 1] == '}') {
+                ++i;
+            } else {
+                return -1;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * Counts arguments in an unevaluated context (used with decltype)
+ */
+template<typename... Args>
+std::integral_constant<int, sizeof...(Args)> CountFormatArgs(const Args&...);
+
+namespace detail {
+
+using ArgWriter = void (*)(FormatBuffer&, const void*);
+
+template<typename T>
+void WriteArg(FormatBuffer& out, const void* value) {
+    Formatter<T>::Format(out, *static_cast<const T*>(value));
+}
+
+// String literals and other arrays are formatted through their decayed pointer
+template<typename T>
+const T& NormalizeArg(const T& value) {
+    return value;
+}
+
+template<std::size_t N>
+const char* NormalizeArg(const char (&value)[N]) {
+    return value;
+}
+
+template<typename... Args>
+void FormatArgs(FormatBuffer& out, std::string_view format, const Args&... args) {
+    // One type-erased writer per argument keeps the instantiation small
+    const void* values[] = {static_cast<const void*>(&args)..., nullptr};
+    const ArgWriter writers[] = {&WriteArg<Args>..., nullptr};
+    std::size_t next = 0;
+
+    std::size_t literalStart = 0;
+    for (std::size_t i = 0; i < format.size(); ++i) {
+        const char c = format[i];
+        const char following = i + 1 < format.size() ? format[i + 1] : '\0';
+        const bool placeholder = c == '{' && following == '}';
+        const bool escaped = (c == '{' || c == '}') && following == c;
+        if (!placeholder && !escaped) {
+            continue;
+        }
+
+        out.Append(format.substr(literalStart, i - literalStart));
+        if (placeholder) {
+            if (next < sizeof...(Args)) {
+                writers[next](out, values[next]);
+                ++next;
+            }
+        } else {
+            out.Append(c);
+        }
+        ++i;
+        literalStart = i + 1;
+    }
+    out.Append(format.substr(literalStart));
+}
+
+} // namespace detail
+
+/**
+ * Formats arguments into a buffer
+ *
+ * Use the logging macros for compile-time placeholder checks; this function
+ * ignores surplus arguments and leaves surplus placeholders empty.
+ *
+ * @param out Buffer receiving the text
+ * @param format Format string with {} placeholders
+ * @param args Values to format
+ */
+template<typename... Args>
+void FormatTo(FormatBuffer& out, std::string_view format, const Args&... args) {
+    detail::FormatArgs(out, format, detail::NormalizeArg(args)...);
+}
+
+} // namespace core
+} // namespace plot_genius
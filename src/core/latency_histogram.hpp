@@ -0,0 +1,96 @@
+/**
+ * Latency Histogram Header
+ *
+ * Defines a constant-memory latency distribution used for the throughput
+ * and latency reports of the batch and service modes.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace plot_genius {
+namespace core {
+
+/**
+ * Latency distribution in power-of-two microsecond buckets
+ *
+ * Percentiles are reported as the upper bound of their bucket, so they are
+ * accurate to within a factor of two. Not thread-safe.
+ */
+class LatencyHistogram {
+public:
+    /**
+     * Adds one measurement
+     *
+     * @param latency Measured duration
+     */
+    template<typename Rep, typename Period>
+    void Add(std::chrono::duration<Rep, Period> latency) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+        std::size_t bucket = 0;
+        while (bucket + 1 < m_buckets.size() && (std::int64_t{1} << bucket) <= us) {
+            ++bucket;
+        }
+        ++m_buckets[bucket];
+        ++m_count;
+        m_maxUs = std::max(m_maxUs, static_cast<double>(us));
+    }
+
+    /**
+     * Merges another histogram into this one
+     *
+     * @param other Histogram to add
+     */
+    void Merge(const LatencyHistogram& other) {
+        for (std::size_t bucket = 0; bucket < m_buckets.size(); ++bucket) {
+            m_buckets[bucket] += other.m_buckets[bucket];
+        }
+        m_count += other.m_count;
+        m_maxUs = std::max(m_maxUs, other.m_maxUs);
+    }
+
+    /**
+     * Gets a percentile
+     *
+     * @param fraction Percentile as a fraction, e.g. 0.99
+     * @return Upper bound of the bucket holding that percentile, in milliseconds
+     */
+    double PercentileMs(double fraction) const {
+        auto target = static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(m_count)));
+        std::uint64_t seen = 0;
+        for (std::size_t bucket = 0; bucket < m_buckets.size(); ++bucket) {
+            seen += m_buckets[bucket];
+            if (seen >= target && seen > 0) {
+                return std::min(static_cast<double>(std::int64_t{1} << bucket), m_maxUs) / 1000.0;
+            }
+        }
+        return m_maxUs / 1000.0;
+    }
+
+    /**
+     * Gets the largest measurement
+     *
+     * @return Maximum latency in milliseconds
+     */
+    double MaxMs() const { return m_maxUs / 1000.0; }
+
+    /**
+     * Gets the number of measurements
+     *
+     * @return Measurement count
+     */
+    std::uint64_t GetCount() const { return m_count; }
+
+private:
+    std::array<std::uint64_t, 40> m_buckets{};  ///< Bucket i counts latencies below 2^i us
+    std::uint64_t m_count{0};
+    double m_maxUs{0.0};
+};
+
+} // namespace core
+} // namespace plot_genius
@@ -1,27 +1,96 @@
 /**
  * Logger System Implementation
- * 
- * Implements a thread-safe singleton logger that supports console and file output
- * with timestamp and severity level formatting.
+ *
+ * Implements the asynchronous logger. Producers copy messages into ring
+ * records; a single writer thread adds timestamp and severity formatting and
+ * writes whole batches to the console and file, flushing once per batch.
  */
 
 #include "logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <ctime>
-#include <iomanip>
-#include <iostream>
-#include <sstream>
+#include <functional>
 
 namespace plot_genius {
 namespace core {
 
+namespace {
+
+// About 500 KB of queued messages before producers start dropping
+constexpr std::size_t kRingCapacity = 1024;
+
+// Batches are written out once they reach this size
+constexpr std::size_t kBatchSize = 64 * 1024;
+
+// Identical consecutive messages from one thread beyond kRepeatBurst within
+// kRepeatWindow are counted instead of logged
+constexpr int kRepeatBurst = 3;
+constexpr std::int64_t kRepeatWindowNs = 1000000000;
+
+#ifdef NDEBUG
+constexpr LogLevel kDefaultLevel = LogLevel::Info;
+#else
+constexpr LogLevel kDefaultLevel = LogLevel::Debug;
+#endif
+
+std::int64_t WallClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+const char* LevelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug:   return "DEBUG";
+        case LogLevel::Info:    return "INFO";
+        case LogLevel::Warning: return "WARNING";
+        case LogLevel::Error:   return "ERROR";
+    }
+    return "";
+}
+
+} // namespace
+
+struct Logger::RepeatState {
+    std::size_t hash{0};
+    LogLevel level{LogLevel::Debug};
+    std::int64_t windowStartNs{0};
+    int count{0};
+    int suppressed{0};
+
+    // Report repeats still pending when the thread exits
+    ~RepeatState() {
+        if (suppressed > 0) {
+            Logger::GetInstance().EnqueueRepeatSummary(level, suppressed);
+        }
+    }
+};
+
+Logger::RepeatState& Logger::GetRepeatState() {
+    thread_local RepeatState state;
+    return state;
+}
+
 Logger& Logger::GetInstance() {
     static Logger instance;
     return instance;
 }
 
-Logger::Logger() : m_useFile(false) {}
+Logger::Logger() : m_ring(kRingCapacity), m_level(kDefaultLevel), m_useFile(false) {
+    m_batch.reserve(kBatchSize + LogRecord::kMaxLength + 64);
+    m_writer = std::thread([this] { WriterLoop(); });
+}
 
 Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping = true;
+    }
+    m_wakeup.notify_one();
+    m_writer.join();
+
     if (m_useFile) {
         m_logFile.close();
     }
@@ -36,72 +105,134 @@ void Logger::SetLogFile(const std::string& filename) {
     m_useFile = m_logFile.is_open();
 }
 
-void Logger::Log(LogLevel level, const std::string& message) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
-    // Get current time
-    auto now = std::time(nullptr);
-    auto tm = std::localtime(&now);
-    
-    // Format timestamp
-    std::stringstream ss;
-    ss << std::put_time(tm, "%Y-%m-%d %H:%M:%S");
-    
-    // Format log level
-    const char* levelStr = "";
-    switch (level) {
-        case LogLevel::Debug:   levelStr = "DEBUG"; break;
-        case LogLevel::Info:    levelStr = "INFO"; break;
-        case LogLevel::Warning: levelStr = "WARNING"; break;
-        case LogLevel::Error:   levelStr = "ERROR"; break;
+void Logger::Log(LogLevel level, std::string_view message) {
+    if (!IsEnabled(level)) {
+        return;
     }
-    
-    // Format final message
-    std::string formatted = "[" + ss.str() + "] [" + levelStr + "] " + message + "\n";
-    
-    // Output to console
-    std::cout << formatted;
-    
-    // Output to file if enabled
-    if (m_useFile) {
-        m_logFile << formatted;
-        m_logFile.flush();
+
+    // Collapse bursts of the same message from this thread
+    const std::int64_t now = WallClockNs();
+    const std::size_t hash = std::hash<std::string_view>{}(message);
+    RepeatState& repeat = GetRepeatState();
+    if (hash == repeat.hash && now - repeat.windowStartNs < kRepeatWindowNs) {
+        if (++repeat.count > kRepeatBurst) {
+            ++repeat.suppressed;
+            return;
+        }
+    } else {
+        if (repeat.suppressed > 0) {
+            EnqueueRepeatSummary(repeat.level, repeat.suppressed);
+        }
+        repeat.hash = hash;
+        repeat.level = level;
+        repeat.windowStartNs = now;
+        repeat.count = 1;
+        repeat.suppressed = 0;
     }
+
+    Enqueue(level, message.data(), message.size());
 }
 
-/**
- * Base case implementation for the template string formatter
- */
-std::string Logger::FormatString(const std::string& format) {
-    return format;
+void Logger::EnqueueRepeatSummary(LogLevel level, int count) {
+    char summary[96];
+    int length = std::snprintf(summary, sizeof(summary), "Previous message repeated %d more times", count);
+    Enqueue(level, summary, static_cast<std::size_t>(length));
 }
 
-/**
- * Recursive implementation of the string formatter
- * Replaces {} placeholders with string representations of values
- */
-template<typename T, typename... Args>
-std::string Logger::FormatString(const std::string& format, T value, Args... args) {
-    std::string result;
-    std::size_t pos = format.find("{}");
-    if (pos != std::string::npos) {
-        std::stringstream ss;
-        ss << value;
-        result = format.substr(0, pos) + ss.str() + FormatString(format.substr(pos + 2), args...);
-    } else {
-        result = format;
+void Logger::Enqueue(LogLevel level, const char* text, std::size_t length) {
+    LogRecord record;
+    record.level = level;
+    record.timeNs = WallClockNs();
+    record.length = static_cast<std::uint32_t>(std::min(length, LogRecord::kMaxLength));
+    std::memcpy(record.text, text, record.length);
+
+    if (!m_ring.Push(record)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Only the first record after a drain needs to wake the writer
+    if (!m_pending.exchange(true, std::memory_order_acq_rel)) {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wakeup.notify_one();
     }
-    return result;
 }
 
-// Explicit template instantiations for common types
-template std::string Logger::FormatString<double, const char*>(const std::string&, double, const char*);
-template std::string Logger::FormatString<std::size_t, std::string>(const std::string&, std::size_t, std::string);
-template std::string Logger::FormatString<const char*>(const std::string&, const char*);
-template std::string Logger::FormatString<int>(const std::string&, int);
-template std::string Logger::FormatString<double>(const std::string&, double);
-template std::string Logger::FormatString<float>(const std::string&, float);
-template std::string Logger::FormatString<std::string>(const std::string&, std::string);
+void Logger::WriterLoop() {
+    for (;;) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wakeup.wait(lock, [this] { return m_stopping || m_pending.load(std::memory_order_acquire); });
+            stopping = m_stopping;
+        }
+
+        m_pending.store(false, std::memory_order_release);
+        Drain();
+
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+void Logger::Drain() {
+    std::time_t cachedSecond = -1;
+    char timestamp[32] = "";
+
+    auto writeBatch = [this] {
+        if (m_batch.empty()) {
+            return;
+        }
+        if (std::FILE* console = m_console.load(std::memory_order_relaxed)) {
+            std::fwrite(m_batch.data(), 1, m_batch.size(), console);
+            std::fflush(console);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_useFile) {
+            m_logFile.write(m_batch.data(), static_cast<std::streamsize>(m_batch.size()));
+            m_logFile.flush();
+        }
+        m_batch.clear();
+    };
+
+    auto append = [&](LogLevel level, std::int64_t timeNs, const char* text, std::size_t length) {
+        // Only the writer formats timestamps, once per distinct second
+        auto seconds = static_cast<std::time_t>(timeNs / 1000000000);
+        if (seconds != cachedSecond) {
+            cachedSecond = seconds;
+            std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", std::localtime(&seconds));
+        }
+
+        m_batch += '[';
+        m_batch += timestamp;
+        m_batch += "] [";
+        m_batch += LevelName(level);
+        m_batch += "] ";
+        m_batch.append(text, length);
+        m_batch += '\n';
+
+        if (m_batch.size() >= kBatchSize) {
+            writeBatch();
+        }
+    };
+
+    LogRecord record;
+    while (m_ring.Pop(record)) {
+        append(record.level, record.timeNs, record.text, record.length);
+    }
+
+    std::uint64_t dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        char notice[96];
+        int length = std::snprintf(notice, sizeof(notice),
+            "%llu log messages dropped (queue full)", static_cast<unsigned long long>(dropped));
+        append(LogLevel::Warning, WallClockNs(), notice, static_cast<std::size_t>(length));
+    }
+
+    writeBatch();
+}
 
 } // namespace core
-} // namespace plot_genius 
\ No newline at end of file
+} // namespace plot_genius
@@ -1,16 +1,37 @@
 /**
  * Logger System Header
- * 
+ *
  * Defines a thread-safe singleton logger system that supports multiple log levels
  * and can output to both console and file.
+ *
+ * Logging is asynchronous: callers copy the message into a fixed-size record
+ * on a lock-free ring, and a background thread timestamps, batches and
+ * writes the records. Messages below the active level are rejected before
+ * any formatting, and bursts of identical messages are rate limited.
+ *
+ * Formatted messages go through the PLOT_GENIUS_LOG_* macros:
+ *
+ *     PLOT_GENIUS_LOG_ERROR("Failed to evaluate point at x = {}: {}", x, e.what());
+ *
+ * A placeholder/argument mismatch is a compile error, and calls below
+ * PLOT_GENIUS_LOG_MIN_LEVEL (Info in NDEBUG builds, Debug otherwise) compile
+ * to nothing, including their argument expressions.
  */
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include "format.hpp"
+#include "mpsc_ring.hpp"
 
 namespace plot_genius {
 namespace core {
@@ -25,6 +46,18 @@ enum class LogLevel {
     Error    ///< Serious problems that prevent normal operation
 };
 
+/**
+ * A message waiting to be written, stored inline so queuing never allocates
+ */
+struct LogRecord {
+    static constexpr std::size_t kMaxLength = 480;  ///< Longer messages are truncated
+
+    LogLevel level;           ///< Severity level
+    std::int64_t timeNs;      ///< Wall clock time in nanoseconds since the epoch
+    std::uint32_t length;     ///< Number of valid bytes in text
+    char text[kMaxLength];    ///< Message bytes (not null-terminated)
+};
+
 /**
  * Thread-safe singleton logger class
  */
@@ -32,68 +65,74 @@ class Logger {
 public:
     /**
      * Returns the singleton instance of the logger
-     * 
+     *
      * @return Reference to the logger instance
      */
     static Logger& GetInstance();
-    
+
     /**
      * Sets the output file for logging
-     * 
+     *
      * @param filename Path to the log file
      */
     void SetLogFile(const std::string& filename);
-    
+
     /**
-     * Logs a message with the specified severity level
-     * 
-     * @param level Severity level of the message
-     * @param message Content to log
+     * Sets the console stream, e.g. stderr when stdout carries data
+     *
+     * @param stream Stream to write to, or nullptr to disable console output
      */
-    void Log(LogLevel level, const std::string& message);
-    
+    void SetConsoleStream(std::FILE* stream) {
+        m_console.store(stream, std::memory_order_relaxed);
+    }
+
     /**
-     * Logs a formatted debug message
-     * 
-     * @param format Format string
-     * @param args Arguments to format into the string
+     * Sets the minimum level that is recorded
+     *
+     * @param level Messages below this level are discarded
      */
-    template<typename... Args>
-    void Debug(const std::string& format, Args... args) {
-        Log(LogLevel::Debug, FormatString(format, args...));
+    void SetLevel(LogLevel level) {
+        m_level.store(level, std::memory_order_relaxed);
     }
-    
+
     /**
-     * Logs a formatted informational message
-     * 
-     * @param format Format string
-     * @param args Arguments to format into the string
+     * Checks whether messages of a level are recorded
+     *
+     * @param level Severity level to test
+     * @return True if the level is at or above the active level
      */
-    template<typename... Args>
-    void Info(const std::string& format, Args... args) {
-        Log(LogLevel::Info, FormatString(format, args...));
+    bool IsEnabled(LogLevel level) const {
+        return level >= m_level.load(std::memory_order_relaxed);
     }
-    
+
     /**
-     * Logs a formatted warning message
-     * 
-     * @param format Format string
-     * @param args Arguments to format into the string
+     * Logs a message with the specified severity level
+     *
+     * Never blocks on I/O; the message is written by the background thread.
+     *
+     * @param level Severity level of the message
+     * @param message Content to log
      */
-    template<typename... Args>
-    void Warning(const std::string& format, Args... args) {
-        Log(LogLevel::Warning, FormatString(format, args...));
-    }
-    
+    void Log(LogLevel level, std::string_view message);
+
     /**
-     * Logs a formatted error message
-     * 
-     * @param format Format string
-     * @param args Arguments to format into the string
+     * Formats and logs a message without allocating
+     *
+     * Prefer the PLOT_GENIUS_LOG_* macros, which check the placeholders at
+     * compile time and drop calls below PLOT_GENIUS_LOG_MIN_LEVEL entirely.
+     *
+     * @param level Severity level of the message
+     * @param format Format string with {} placeholders
+     * @param args Values to format
      */
     template<typename... Args>
-    void Error(const std::string& format, Args... args) {
-        Log(LogLevel::Error, FormatString(format, args...));
+    void LogFormat(LogLevel level, std::string_view format, const Args&... args) {
+        if (!IsEnabled(level)) {
+            return;
+        }
+        InlineFormatBuffer<LogRecord::kMaxLength> buffer;
+        FormatTo(buffer, format, args...);
+        Log(level, buffer.View());
     }
 
 private:
@@ -101,35 +140,90 @@ private:
      * Private constructor for singleton pattern
      */
     Logger();
-    
+
     /**
-     * Private destructor for singleton pattern
+     * Private destructor for singleton pattern; writes pending records
      */
     ~Logger();
-    
+
+    /**
+     * Per-thread state of the repeated-message limiter
+     */
+    struct RepeatState;
+
+    /**
+     * Gets the calling thread's limiter state
+     */
+    static RepeatState& GetRepeatState();
+
     /**
-     * Base case for template recursion in string formatting
-     * 
-     * @param format Format string
-     * @return Formatted string
+     * Queues a note that a message was suppressed by the rate limiter
+     *
+     * @param level Severity level of the suppressed message
+     * @param count Number of suppressed repeats
      */
-    std::string FormatString(const std::string& format);
-    
+    void EnqueueRepeatSummary(LogLevel level, int count);
+
     /**
-     * Recursive template function for string formatting
-     * 
-     * @param format Format string
-     * @param value Current value to format
-     * @param args Remaining arguments
-     * @return Formatted string
+     * Copies a message into a record and queues it for the writer
+     *
+     * @param level Severity level of the message
+     * @param text Message bytes
+     * @param length Number of bytes
      */
-    template<typename T, typename... Args>
-    std::string FormatString(const std::string& format, T value, Args... args);
-    
+    void Enqueue(LogLevel level, const char* text, std::size_t length);
+
+    /**
+     * Background thread draining the ring
+     */
+    void WriterLoop();
+
+    /**
+     * Formats all queued records and writes them in one batch
+     */
+    void Drain();
+
+    MpscRing<LogRecord> m_ring;                  ///< Records awaiting the writer
+    std::atomic<LogLevel> m_level;               ///< Minimum recorded level
+    std::atomic<std::uint64_t> m_dropped{0};     ///< Records rejected by a full ring
+    std::atomic<bool> m_pending{false};          ///< Records were queued since the last drain
+    bool m_stopping{false};                      ///< Set on destruction (guarded by m_wakeMutex)
+    std::mutex m_wakeMutex;                      ///< Pairs with m_wakeup
+    std::condition_variable m_wakeup;            ///< Wakes the writer
+
+    std::atomic<std::FILE*> m_console{stdout};  ///< Console stream, nullptr if disabled
     std::ofstream m_logFile;   ///< File stream for log output
-    std::mutex m_mutex;        ///< Mutex for thread safety
+    std::mutex m_mutex;        ///< Guards the file against SetLogFile
     bool m_useFile;            ///< Flag indicating if file logging is enabled
+    std::string m_batch;       ///< Writer-owned output buffer
+    std::thread m_writer;      ///< Background writer thread
 };
 
 } // namespace core
-} // namespace plot_genius 
\ No newline at end of file
+} // namespace plot_genius
+
+#ifndef PLOT_GENIUS_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define PLOT_GENIUS_LOG_MIN_LEVEL 1
+#else
+#define PLOT_GENIUS_LOG_MIN_LEVEL 0
+#endif
+#endif
+
+/**
+ * Logs a formatted message at the given level
+ */
+#define PLOT_GENIUS_LOG(level, format, ...)                                                        \
+    do {                                                                                           \
+        static_assert(::plot_genius::core::CountFormatPlaceholders(format) ==                      \
+                      decltype(::plot_genius::core::CountFormatArgs(__VA_ARGS__))::value,          \
+                      "Log format placeholders do not match the number of arguments");             \
+        if constexpr (static_cast<int>(level) >= PLOT_GENIUS_LOG_MIN_LEVEL) {                      \
+            ::plot_genius::core::Logger::GetInstance().LogFormat(level, format, ##__VA_ARGS__);    \
+        }                                                                                          \
+    } while (false)
+
+#define PLOT_GENIUS_LOG_DEBUG(format, ...) PLOT_GENIUS_LOG(::plot_genius::core::LogLevel::Debug, format, ##__VA_ARGS__)
+#define PLOT_GENIUS_LOG_INFO(format, ...) PLOT_GENIUS_LOG(::plot_genius::core::LogLevel::Info, format, ##__VA_ARGS__)
+#define PLOT_GENIUS_LOG_WARNING(format, ...) PLOT_GENIUS_LOG(::plot_genius::core::LogLevel::Warning, format, ##__VA_ARGS__)
+#define PLOT_GENIUS_LOG_ERROR(format, ...) PLOT_GENIUS_LOG(::plot_genius::core::LogLevel::Error, format, ##__VA_ARGS__)
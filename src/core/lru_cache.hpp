@@ -0,0 +1,130 @@
+/**
+ * LRU Cache Header
+ *
+ * Defines a thread-safe least-recently-used cache with a cost budget, used to
+ * share compiled equations and sampled points between service requests.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace plot_genius {
+namespace core {
+
+/**
+ * Thread-safe LRU cache of immutable values
+ *
+ * Values are handed out as shared pointers, so an entry evicted while a
+ * caller still uses it stays alive until released. Two callers missing on
+ * the same key at once both compute the value; the later Put wins.
+ */
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    /**
+     * Hit and size counters
+     */
+    struct Stats {
+        std::uint64_t hits{0};
+        std::uint64_t misses{0};
+        std::size_t entries{0};
+        std::size_t cost{0};  ///< Sum of the entry costs
+    };
+
+    /**
+     * Creates an empty cache
+     *
+     * @param capacity Largest total cost kept; older entries are evicted beyond it
+     */
+    explicit LruCache(std::size_t capacity) : m_capacity(capacity) {}
+
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+
+    /**
+     * Looks up a value and marks it most recently used
+     *
+     * @param key Key to find
+     * @return The value, or nullptr on a miss
+     */
+    std::shared_ptr<const Value> Get(const Key& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it == m_index.end()) {
+            ++m_stats.misses;
+            return nullptr;
+        }
+        ++m_stats.hits;
+        m_order.splice(m_order.begin(), m_order, it->second);
+        return it->second->value;
+    }
+
+    /**
+     * Inserts or replaces a value
+     *
+     * @param key Key to store under
+     * @param value Value to share
+     * @param cost Weight against the capacity, e.g. its size in bytes
+     */
+    void Put(const Key& key, std::shared_ptr<const Value> value, std::size_t cost = 1) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_stats.cost -= it->second->cost;
+            m_order.erase(it->second);
+            m_index.erase(it);
+        }
+
+        // A value larger than the whole budget is not worth keeping
+        if (cost > m_capacity) {
+            return;
+        }
+        while (!m_order.empty() && m_stats.cost + cost > m_capacity) {
+            const Entry& oldest = m_order.back();
+            m_stats.cost -= oldest.cost;
+            m_index.erase(oldest.key);
+            m_order.pop_back();
+        }
+
+        m_order.push_front(Entry{key, std::move(value), cost});
+        m_index.emplace(key, m_order.begin());
+        m_stats.cost += cost;
+        m_stats.entries = m_order.size();
+    }
+
+    /**
+     * Gets the hit and size counters
+     *
+     * @return Snapshot of the counters
+     */
+    Stats GetStats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats stats = m_stats;
+        stats.entries = m_order.size();
+        return stats;
+    }
+
+private:
+    struct Entry {
+        Key key;
+        std::shared_ptr<const Value> value;
+        std::size_t cost;
+    };
+
+    std::size_t m_capacity;
+    std::list<Entry> m_order;  ///< Most recently used first
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> m_index;
+    Stats m_stats;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace core
+} // namespace plot_genius
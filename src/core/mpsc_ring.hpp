@@ -0,0 +1,107 @@
+/**
+ * MPSC Ring Header
+ *
+ * Defines a bounded multi-producer, single-consumer ring buffer with per-cell
+ * sequence numbers. Producers claim a cell with one compare-and-swap and
+ * never block; when the ring is full the value is rejected rather than
+ * waiting. Used by the profiler and the logger to hand records from any
+ * thread to a single consumer.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace plot_genius {
+namespace core {
+
+/**
+ * Bounded multi-producer, single-consumer ring buffer
+ *
+ * @tparam T Trivially copyable value type
+ */
+template<typename T>
+class MpscRing {
+public:
+    /**
+     * Creates a ring with the given capacity, rounded up to a power of two
+     *
+     * @param capacity Minimum number of values the ring can hold
+     */
+    explicit MpscRing(std::size_t capacity) {
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+
+        m_cells = std::make_unique<Cell[]>(size);
+        m_mask = size - 1;
+        for (std::size_t i = 0; i < size; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Appends a value; safe to call from any thread
+     *
+     * @param value Value to store
+     * @return False if the ring was full and the value was dropped
+     */
+    bool Push(const T& value) {
+        std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = m_cells[pos & m_mask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+            if (difference == 0) {
+                // Cell is free for this position; claim it
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                // The consumer has not freed this cell yet: the ring is full
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Removes the oldest value; must only be called by the consumer
+     *
+     * @param value Receives the value
+     * @return False if the ring was empty
+     */
+    bool Pop(T& value) {
+        Cell& cell = m_cells[m_dequeuePos & m_mask];
+        std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence != m_dequeuePos + 1) {
+            return false;
+        }
+
+        value = cell.value;
+        cell.sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+        ++m_dequeuePos;
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;  ///< Publication sequence number
+        T value;                            ///< Stored value
+    };
+
+    std::unique_ptr<Cell[]> m_cells;                       ///< Ring storage
+    std::size_t m_mask;                                    ///< Capacity - 1
+    alignas(64) std::atomic<std::size_t> m_enqueuePos{0};  ///< Next producer slot
+    alignas(64) std::size_t m_dequeuePos{0};               ///< Next consumer slot
+};
+
+} // namespace core
+} // namespace plot_genius
@@ -0,0 +1,113 @@
+/**
+ * Profiler Implementation
+ *
+ * Implements stage registration and the main-thread aggregation of ring
+ * samples into rolling windows.
+ */
+
+#include "profiler.hpp"
+#include <algorithm>
+
+namespace plot_genius {
+namespace core {
+
+namespace {
+
+// Enough for several frames of samples from every worker thread
+constexpr std::size_t kRingCapacity = 1 << 14;
+
+double Percentile(const std::vector<float>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    auto index = static_cast<std::size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+} // namespace
+
+Profiler& Profiler::GetInstance() {
+    static Profiler instance;
+    return instance;
+}
+
+Profiler::Profiler() : m_ring(kRingCapacity) {}
+
+ProfileStage Profiler::RegisterStage(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_registryMutex);
+
+    auto it = m_stageIds.find(name);
+    if (it != m_stageIds.end()) {
+        return it->second;
+    }
+    if (m_stageNames.size() >= kMaxStages) {
+        return kNoProfileStage;
+    }
+
+    auto stage = static_cast<ProfileStage>(m_stageNames.size());
+    m_stageNames.push_back(name);
+    m_stageIds.emplace(name, stage);
+    return stage;
+}
+
+void Profiler::EndFrame() {
+    ProfileSample sample;
+    while (m_ring.Pop(sample)) {
+        if (sample.stage >= m_histories.size()) {
+            m_histories.resize(sample.stage + 1);
+        }
+
+        StageHistory& history = m_histories[sample.stage];
+        float durationMs = static_cast<float>(sample.durationNs * 1e-6);
+        if (history.samplesMs.size() < kHistoryLength) {
+            history.samplesMs.push_back(durationMs);
+        } else {
+            history.samplesMs[history.next] = durationMs;
+        }
+        history.next = (history.next + 1) % kHistoryLength;
+        history.lastMs = durationMs;
+        ++history.count;
+    }
+}
+
+std::vector<std::string> Profiler::GetStageNames() const {
+    std::lock_guard<std::mutex> lock(m_registryMutex);
+    return m_stageNames;
+}
+
+std::vector<StageStatistics> Profiler::GetStatistics() const {
+    const std::vector<std::string> names = GetStageNames();
+
+    std::vector<StageStatistics> statistics;
+    std::vector<float> sorted;
+    for (std::size_t stage = 0; stage < m_histories.size() && stage < names.size(); ++stage) {
+        const StageHistory& history = m_histories[stage];
+        if (history.count == 0) {
+            continue;
+        }
+
+        sorted = history.samplesMs;
+        std::sort(sorted.begin(), sorted.end());
+
+        StageStatistics stats;
+        stats.name = names[stage];
+        stats.count = history.count;
+        stats.lastMs = history.lastMs;
+        stats.p50Ms = Percentile(sorted, 0.50);
+        stats.p90Ms = Percentile(sorted, 0.90);
+        stats.p99Ms = Percentile(sorted, 0.99);
+        stats.maxMs = sorted.back();
+
+        if (stats.maxMs > 0.0) {
+            for (float value : sorted) {
+                auto bin = static_cast<int>(value / stats.maxMs * (StageStatistics::kHistogramBins - 1));
+                stats.histogram[std::clamp(bin, 0, StageStatistics::kHistogramBins - 1)] += 1.0f;
+            }
+        }
+        statistics.push_back(std::move(stats));
+    }
+    return statistics;
+}
+
+} // namespace core
+} // namespace plot_genius
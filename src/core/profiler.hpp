@@ -0,0 +1,249 @@
+/**
+ * Profiler Header
+ *
+ * Defines a lightweight frame profiler. Scoped timers on any thread push
+ * samples into a lock-free ring buffer; the main thread drains it once per
+ * frame into rolling per-stage windows that the overlay turns into
+ * percentiles and histograms.
+ *
+ * While trace recording is enabled, the same scopes are also written to the
+ * timeline (see trace.hpp).
+ *
+ * Instrumentation goes through the PLOT_GENIUS_PROFILE_* macros, which
+ * expand to nothing unless PLOT_GENIUS_WITH_PROFILER is defined (never in
+ * Release builds).
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "mpsc_ring.hpp"
+#include "trace.hpp"
+
+namespace plot_genius {
+namespace core {
+
+/**
+ * Identifier of a registered profiling stage
+ */
+using ProfileStage = std::uint16_t;
+
+/**
+ * Stage identifier that records nothing
+ */
+constexpr ProfileStage kNoProfileStage = 0xFFFF;
+
+/**
+ * A single timed scope
+ */
+struct ProfileSample {
+    ProfileStage stage;        ///< Stage the time is attributed to
+    std::uint64_t durationNs;  ///< Elapsed time in nanoseconds
+};
+
+/**
+ * Ring carrying samples from any thread to the main thread
+ */
+using ProfileRing = MpscRing<ProfileSample>;
+
+/**
+ * Rolling statistics of one stage, in milliseconds
+ */
+struct StageStatistics {
+    static constexpr int kHistogramBins = 32;  ///< Buckets between 0 and max
+
+    std::string name;           ///< Stage name
+    std::uint64_t count{0};     ///< Samples recorded since startup
+    double lastMs{0.0};         ///< Most recent sample
+    double p50Ms{0.0};          ///< Median of the rolling window
+    double p90Ms{0.0};          ///< 90th percentile of the rolling window
+    double p99Ms{0.0};          ///< 99th percentile of the rolling window
+    double maxMs{0.0};          ///< Maximum of the rolling window
+    std::array<float, kHistogramBins> histogram{};  ///< Sample counts per bucket
+};
+
+/**
+ * Singleton collecting stage timings from all threads
+ */
+class Profiler {
+public:
+    static constexpr std::size_t kMaxStages = 1024;     ///< Registration limit
+    static constexpr std::size_t kHistoryLength = 240;  ///< Samples kept per stage
+
+    /**
+     * Returns the singleton instance of the profiler
+     *
+     * @return Reference to the profiler
+     */
+    static Profiler& GetInstance();
+
+    /**
+     * Registers a stage name, returning the existing id if already known
+     *
+     * @param name Display name of the stage
+     * @return Stage identifier (kNoProfileStage once the limit is reached)
+     */
+    ProfileStage RegisterStage(const std::string& name);
+
+    /**
+     * Records a sample; lock-free and safe to call from any thread
+     *
+     * @param stage Stage the time belongs to
+     * @param durationNs Elapsed time in nanoseconds
+     */
+    void Record(ProfileStage stage, std::uint64_t durationNs) {
+        if (stage != kNoProfileStage && !m_ring.Push({stage, durationNs})) {
+            m_droppedSamples.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Drains pending samples into the rolling windows (main thread only)
+     */
+    void EndFrame();
+
+    /**
+     * Computes statistics for every stage that has samples (main thread only)
+     *
+     * @return Statistics ordered by stage registration
+     */
+    std::vector<StageStatistics> GetStatistics() const;
+
+    /**
+     * Gets the names of all registered stages
+     *
+     * @return Names indexed by stage identifier
+     */
+    std::vector<std::string> GetStageNames() const;
+
+    /**
+     * Gets the number of samples lost because the ring was full
+     *
+     * @return Dropped sample count
+     */
+    std::uint64_t GetDroppedSamples() const {
+        return m_droppedSamples.load(std::memory_order_relaxed);
+    }
+
+private:
+    Profiler();
+
+    /**
+     * Consumer-side rolling window of one stage
+     */
+    struct StageHistory {
+        std::vector<float> samplesMs;  ///< Circular window of durations
+        std::size_t next{0};           ///< Next slot to overwrite
+        std::uint64_t count{0};        ///< Total samples seen
+        float lastMs{0.0f};            ///< Most recent duration
+    };
+
+    ProfileRing m_ring;                             ///< Samples awaiting EndFrame
+    std::atomic<std::uint64_t> m_droppedSamples{0}; ///< Samples rejected by a full ring
+
+    mutable std::mutex m_registryMutex;             ///< Guards stage registration
+    std::unordered_map<std::string, ProfileStage> m_stageIds;  ///< Name lookup
+    std::vector<std::string> m_stageNames;          ///< Names indexed by stage
+
+    std::vector<StageHistory> m_histories;          ///< Owned by the main thread
+};
+
+/**
+ * Records the lifetime of a scope into the profiler and, while recording,
+ * the trace
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(ProfileStage stage)
+        : m_stage(stage), m_startNs(TraceRecorder::Now()) {}
+
+    ~ScopedTimer() {
+        const std::uint64_t durationNs = TraceRecorder::Now() - m_startNs;
+        Profiler::GetInstance().Record(m_stage, durationNs);
+
+        TraceRecorder& recorder = TraceRecorder::GetInstance();
+        if (recorder.IsRecording() && m_stage != kNoProfileStage) {
+            recorder.Record({m_stage, TraceEvent::Phase::Complete, m_startNs, durationNs, 0});
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    ProfileStage m_stage;
+    std::uint64_t m_startNs;
+};
+
+} // namespace core
+} // namespace plot_genius
+
+#define PLOT_GENIUS_PROFILE_CONCAT_INNER(a, b) a##b
+#define PLOT_GENIUS_PROFILE_CONCAT(a, b) PLOT_GENIUS_PROFILE_CONCAT_INNER(a, b)
+
+#if defined(PLOT_GENIUS_WITH_PROFILER)
+
+/**
+ * Times the enclosing scope under a fixed stage name (a string literal)
+ */
+#define PLOT_GENIUS_PROFILE_SCOPE(name)                                                          \
+    static const ::plot_genius::core::ProfileStage PLOT_GENIUS_PROFILE_CONCAT(pgStage_, __LINE__) = \
+        ::plot_genius::core::Profiler::GetInstance().RegisterStage(name);                        \
+    ::plot_genius::core::ScopedTimer PLOT_GENIUS_PROFILE_CONCAT(pgTimer_, __LINE__)(            \
+        PLOT_GENIUS_PROFILE_CONCAT(pgStage_, __LINE__))
+
+/**
+ * Times the enclosing scope under a previously registered stage
+ */
+#define PLOT_GENIUS_PROFILE_STAGE(stage) \
+    ::plot_genius::core::ScopedTimer PLOT_GENIUS_PROFILE_CONCAT(pgTimer_, __LINE__)(stage)
+
+/**
+ * Registers a stage with a runtime name, e.g. one per equation
+ */
+#define PLOT_GENIUS_PROFILE_REGISTER(name) ::plot_genius::core::Profiler::GetInstance().RegisterStage(name)
+
+/**
+ * Marks the end of a frame on the main thread
+ */
+#define PLOT_GENIUS_PROFILE_END_FRAME() ::plot_genius::core::Profiler::GetInstance().EndFrame()
+
+/**
+ * Starts a trace flow arrow from the enclosing scope; evaluates to its id
+ */
+#define PLOT_GENIUS_TRACE_FLOW_BEGIN(name)                                                 \
+    ([] {                                                                                  \
+        static const ::plot_genius::core::ProfileStage stage =                             \
+            ::plot_genius::core::Profiler::GetInstance().RegisterStage(name);              \
+        return ::plot_genius::core::TraceRecorder::GetInstance().BeginFlow(stage);         \
+    }())
+
+/**
+ * Ends a trace flow arrow at the enclosing scope
+ */
+#define PLOT_GENIUS_TRACE_FLOW_END(flowId) ::plot_genius::core::TraceRecorder::GetInstance().EndFlow(flowId)
+
+/**
+ * Names the calling thread in traces
+ */
+#define PLOT_GENIUS_TRACE_THREAD_NAME(name) ::plot_genius::core::TraceRecorder::GetInstance().SetThreadName(name)
+
+#else
+
+#define PLOT_GENIUS_PROFILE_SCOPE(name) ((void)0)
+#define PLOT_GENIUS_PROFILE_STAGE(stage) ((void)0)
+#define PLOT_GENIUS_PROFILE_REGISTER(name) ::plot_genius::core::kNoProfileStage
+#define PLOT_GENIUS_PROFILE_END_FRAME() ((void)0)
+#define PLOT_GENIUS_TRACE_FLOW_BEGIN(name) (std::uint64_t{0})
+#define PLOT_GENIUS_TRACE_FLOW_END(flowId) ((void)(flowId))
+#define PLOT_GENIUS_TRACE_THREAD_NAME(name) ((void)0)
+
+#endif
@@ -0,0 +1,145 @@
+/**
+ * Thread Pool Implementation
+ *
+ * Implements the worker pool with a single mutex-protected FIFO queue. Tasks
+ * are coarse (a whole sampling pass), so queue contention is negligible.
+ */
+
+#include "thread_pool.hpp"
+#include "logger.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace plot_genius {
+namespace core {
+
+ThreadPool& ThreadPool::GetInstance() {
+    static ThreadPool instance;
+    return instance;
+}
+
+ThreadPool::ThreadPool(std::size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_workers.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back([this, i] { WorkerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_taskAvailable.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_taskAvailable.notify_one();
+}
+
+void ThreadPool::ParallelFor(std::size_t count, const std::function<void(std::size_t)>& body) {
+    // Shared with the helper tasks, which may only start after the loop is over
+    struct Loop {
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> done{0};
+        std::size_t count{0};
+        const std::function<void(std::size_t)>* body{nullptr};
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+
+    if (count == 0) {
+        return;
+    }
+
+    auto loop = std::make_shared<Loop>();
+    loop->count = count;
+    loop->body = &body;
+
+    // body is only dereferenced after claiming an index, which cannot happen once all are done
+    auto work = [](Loop& state) {
+        for (std::size_t i = state.next.fetch_add(1); i < state.count; i = state.next.fetch_add(1)) {
+            try {
+                (*state.body)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (!state.error) {
+                    state.error = std::current_exception();
+                }
+            }
+            if (state.done.fetch_add(1) + 1 == state.count) {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.finished.notify_all();
+            }
+        }
+    };
+
+    const std::size_t helpers = std::min(m_workers.size(), count - 1);
+    for (std::size_t i = 0; i < helpers; ++i) {
+        Submit([loop, work] { work(*loop); });
+    }
+    work(*loop);
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->finished.wait(lock, [&] { return loop->done.load() == count; });
+    if (loop->error) {
+        std::rethrow_exception(loop->error);
+    }
+}
+
+void ThreadPool::WaitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_tasks.empty() && m_running == 0; });
+}
+
+void ThreadPool::WorkerLoop([[maybe_unused]] std::size_t index) {
+    PLOT_GENIUS_TRACE_THREAD_NAME("Worker " + std::to_string(index));
+    
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskAvailable.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            ++m_running;
+        }
+
+        try {
+            PLOT_GENIUS_PROFILE_SCOPE("Pool Task");
+            task();
+        } catch (const std::exception& e) {
+            PLOT_GENIUS_LOG_ERROR("Worker task failed: {}", e.what());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_running;
+            if (m_tasks.empty() && m_running == 0) {
+                m_idle.notify_all();
+            }
+        }
+    }
+}
+
+} // namespace core
+} // namespace plot_genius
@@ -0,0 +1,98 @@
+/**
+ * Thread Pool Header
+ *
+ * Defines a fixed-size worker pool used for background work such as
+ * equation sampling, keeping the render thread free.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace plot_genius {
+namespace core {
+
+/**
+ * Fixed-size pool of worker threads executing queued tasks in FIFO order
+ */
+class ThreadPool {
+public:
+    /**
+     * Returns the application-wide pool, sized to the hardware concurrency
+     *
+     * @return Reference to the shared pool
+     */
+    static ThreadPool& GetInstance();
+
+    /**
+     * Starts the worker threads
+     *
+     * @param threadCount Number of workers (0 selects the hardware concurrency)
+     */
+    explicit ThreadPool(std::size_t threadCount = 0);
+
+    /**
+     * Finishes queued tasks and joins the workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Queues a task for execution on a worker thread
+     *
+     * @param task Callable to run; exceptions escaping it are logged and dropped
+     */
+    void Submit(std::function<void()> task);
+
+    /**
+     * Runs body(i) for every i in [0, count) on the calling thread and the workers
+     *
+     * The caller works through indices as well, so this may be called from
+     * a pool task even when every other worker is busy. Returns once every
+     * index has run.
+     *
+     * @param count Number of indices
+     * @param body Callable run once per index, possibly concurrently
+     * @throws Rethrows the first exception thrown by body
+     */
+    void ParallelFor(std::size_t count, const std::function<void(std::size_t)>& body);
+
+    /**
+     * Blocks until the queue is empty and no task is running
+     */
+    void WaitIdle();
+
+    /**
+     * Gets the number of worker threads
+     *
+     * @return Worker count
+     */
+    std::size_t GetThreadCount() const { return m_workers.size(); }
+
+private:
+    /**
+     * Worker loop pulling tasks until the pool stops
+     *
+     * @param index Worker number, used to name the thread in traces
+     */
+    void WorkerLoop(std::size_t index);
+
+    std::vector<std::thread> m_workers;          ///< Worker threads
+    std::deque<std::function<void()>> m_tasks;   ///< Pending tasks
+    std::mutex m_mutex;                          ///< Guards the queue and counters
+    std::condition_variable m_taskAvailable;     ///< Signalled when a task is queued
+    std::condition_variable m_idle;              ///< Signalled when the pool drains
+    std::size_t m_running{0};                    ///< Tasks currently executing
+    bool m_stopping{false};                      ///< Set when shutting down
+};
+
+} // namespace core
+} // namespace plot_genius
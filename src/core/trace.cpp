@@ -0,0 +1,203 @@
+/**
+ * Trace Recorder Implementation
+ *
+ * Implements per-thread event buffers and the Chrome trace JSON export.
+ * Stage names are resolved through the profiler registry at export time, so
+ * recording an event never touches a string.
+ */
+
+#include "trace.hpp"
+#include "profiler.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+namespace plot_genius {
+namespace core {
+
+namespace {
+
+thread_local void* t_threadBuffer = nullptr;
+
+// Flow ids carry their stage in the top bits so both ends share a name
+constexpr int kFlowStageShift = 32;
+
+// Chrome traces use microseconds
+double ToMicroseconds(std::uint64_t ns) {
+    return static_cast<double>(ns) * 1e-3;
+}
+
+void WriteEscaped(std::ostream& out, const std::string& text) {
+    for (char c : text) {
+        switch (c) {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\t': out << "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) >= 0x20) {
+                out << c;
+            }
+            break;
+        }
+    }
+}
+
+} // namespace
+
+TraceRecorder& TraceRecorder::GetInstance() {
+    static TraceRecorder instance;
+    return instance;
+}
+
+std::uint64_t TraceRecorder::Now() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void TraceRecorder::Start() {
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        for (auto& buffer : m_buffers) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            buffer->events.clear();
+        }
+    }
+
+    m_droppedEvents.store(0, std::memory_order_relaxed);
+    m_startNs.store(Now(), std::memory_order_relaxed);
+    m_recording.store(true, std::memory_order_release);
+    Logger::GetInstance().Log(LogLevel::Info, "Trace recording started");
+}
+
+bool TraceRecorder::Stop(const std::string& path) {
+    if (!m_recording.exchange(false)) {
+        return false;
+    }
+
+    // Collect every thread's events; each buffer lock is held only for a swap
+    struct ThreadEvents {
+        std::uint32_t threadId;
+        std::string name;
+        std::vector<TraceEvent> events;
+    };
+    std::vector<ThreadEvents> threads;
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        for (auto& buffer : m_buffers) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            threads.push_back({buffer->threadId, buffer->name, {}});
+            threads.back().events.swap(buffer->events);
+        }
+    }
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        PLOT_GENIUS_LOG_ERROR("Failed to write trace file: {}", path);
+        return false;
+    }
+
+    const std::vector<std::string> stageNames = Profiler::GetInstance().GetStageNames();
+    const std::uint64_t startNs = m_startNs.load(std::memory_order_relaxed);
+    std::size_t eventCount = 0;
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Plot Genius\"}}";
+
+    for (const auto& thread : threads) {
+        if (!thread.name.empty()) {
+            file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.threadId
+                 << ",\"args\":{\"name\":\"";
+            WriteEscaped(file, thread.name);
+            file << "\"}}";
+        }
+
+        for (const auto& event : thread.events) {
+            // Scopes that began before Start are clipped to the start of the trace
+            const std::uint64_t begin = std::max(event.startNs, startNs);
+
+            file << ",\n{\"name\":\"";
+            WriteEscaped(file, event.stage < stageNames.size() ? stageNames[event.stage] : "Unknown");
+            file << "\",\"pid\":1,\"tid\":" << thread.threadId << ",\"ts\":" << ToMicroseconds(begin - startNs);
+
+            switch (event.phase) {
+            case TraceEvent::Phase::Complete:
+                file << ",\"cat\":\"scope\",\"ph\":\"X\",\"dur\":"
+                     << ToMicroseconds(event.durationNs - (begin - event.startNs)) << "}";
+                break;
+            case TraceEvent::Phase::FlowStart:
+                file << ",\"cat\":\"flow\",\"ph\":\"s\",\"id\":" << event.flowId << "}";
+                break;
+            case TraceEvent::Phase::FlowEnd:
+                file << ",\"cat\":\"flow\",\"ph\":\"f\",\"bp\":\"e\",\"id\":" << event.flowId << "}";
+                break;
+            }
+            ++eventCount;
+        }
+    }
+    file << "\n]}\n";
+
+    if (!file) {
+        PLOT_GENIUS_LOG_ERROR("Failed to write trace file: {}", path);
+        return false;
+    }
+
+    PLOT_GENIUS_LOG_INFO("Wrote {} trace events to {} ({} dropped)", eventCount, path, GetDroppedEvents());
+    return true;
+}
+
+void TraceRecorder::Record(const TraceEvent& event) {
+    ThreadBuffer& buffer = GetThreadBuffer();
+
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.events.size() >= kMaxEventsPerThread) {
+        m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.events.push_back(event);
+}
+
+std::uint64_t TraceRecorder::BeginFlow(std::uint16_t stage) {
+    if (!IsRecording() || stage == kNoProfileStage) {
+        return 0;
+    }
+
+    const std::uint64_t sequence = m_nextFlowId.fetch_add(1, std::memory_order_relaxed);
+    const std::uint64_t flowId = (static_cast<std::uint64_t>(stage) << kFlowStageShift) | (sequence & 0xFFFFFFFFu);
+    Record({stage, TraceEvent::Phase::FlowStart, Now(), 0, flowId});
+    return flowId;
+}
+
+void TraceRecorder::EndFlow(std::uint64_t flowId) {
+    if (flowId == 0 || !IsRecording()) {
+        return;
+    }
+
+    const auto stage = static_cast<std::uint16_t>(flowId >> kFlowStageShift);
+    Record({stage, TraceEvent::Phase::FlowEnd, Now(), 0, flowId});
+}
+
+void TraceRecorder::SetThreadName(const std::string& name) {
+    ThreadBuffer& buffer = GetThreadBuffer();
+
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.name = name;
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::GetThreadBuffer() {
+    if (!t_threadBuffer) {
+        auto buffer = std::make_unique<ThreadBuffer>();
+
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        buffer->threadId = static_cast<std::uint32_t>(m_buffers.size() + 1);
+        t_threadBuffer = buffer.get();
+        m_buffers.push_back(std::move(buffer));
+    }
+    return *static_cast<ThreadBuffer*>(t_threadBuffer);
+}
+
+} // namespace core
+} // namespace plot_genius
@@ -0,0 +1,155 @@
+/**
+ * Trace Recorder Header
+ *
+ * Defines the timeline recorder behind the profiler. While recording, every
+ * profiled scope is also appended to a buffer owned by the calling thread;
+ * stopping writes all buffers as a Chrome trace (JSON) that can be opened in
+ * chrome://tracing or Perfetto.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace plot_genius {
+namespace core {
+
+/**
+ * A single timeline entry
+ */
+struct TraceEvent {
+    /**
+     * Chrome trace event phase
+     */
+    enum class Phase : std::uint8_t {
+        Complete,   ///< Scope with a start and a duration ("X")
+        FlowStart,  ///< Start of an arrow to another thread ("s")
+        FlowEnd     ///< End of an arrow, bound to the enclosing scope ("f")
+    };
+
+    std::uint16_t stage;      ///< Profiler stage naming the event
+    Phase phase;              ///< Event kind
+    std::uint64_t startNs;    ///< Steady clock timestamp in nanoseconds
+    std::uint64_t durationNs; ///< Duration of complete events
+    std::uint64_t flowId;     ///< Flow identifier of flow events
+};
+
+/**
+ * Singleton recording trace events from all threads
+ *
+ * Each thread appends to its own buffer, so recording never takes a lock
+ * shared with other threads. Buffers are registered on a thread's first
+ * event and live as long as the recorder.
+ */
+class TraceRecorder {
+public:
+    static constexpr std::size_t kMaxEventsPerThread = 1 << 20;  ///< Memory bound per thread
+
+    /**
+     * Returns the singleton instance of the recorder
+     *
+     * @return Reference to the recorder
+     */
+    static TraceRecorder& GetInstance();
+
+    /**
+     * Checks whether events are being recorded
+     *
+     * @return True between Start and Stop
+     */
+    bool IsRecording() const {
+        return m_recording.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Discards previous events and starts recording
+     */
+    void Start();
+
+    /**
+     * Stops recording and writes the trace
+     *
+     * @param path Output file path
+     * @return True if the file was written
+     */
+    bool Stop(const std::string& path);
+
+    /**
+     * Appends an event to the calling thread's buffer
+     *
+     * @param event Event to record
+     */
+    void Record(const TraceEvent& event);
+
+    /**
+     * Starts a flow arrow from the enclosing scope
+     *
+     * @param stage Stage naming the flow
+     * @return Flow identifier to hand to the receiving work, or 0 when not recording
+     */
+    std::uint64_t BeginFlow(std::uint16_t stage);
+
+    /**
+     * Ends a flow arrow at the enclosing scope, under the name it started with
+     *
+     * @param flowId Identifier returned by BeginFlow (0 is ignored)
+     */
+    void EndFlow(std::uint64_t flowId);
+
+    /**
+     * Names the calling thread in exported traces
+     *
+     * @param name Thread name
+     */
+    void SetThreadName(const std::string& name);
+
+    /**
+     * Gets the number of events lost because a thread buffer was full
+     *
+     * @return Dropped event count
+     */
+    std::uint64_t GetDroppedEvents() const {
+        return m_droppedEvents.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Gets the current steady clock time in nanoseconds
+     *
+     * @return Timestamp comparable with TraceEvent::startNs
+     */
+    static std::uint64_t Now();
+
+private:
+    TraceRecorder() = default;
+
+    /**
+     * Events of one thread; the mutex is only contended while exporting
+     */
+    struct ThreadBuffer {
+        std::mutex mutex;                ///< Guards events against Start/Stop
+        std::vector<TraceEvent> events;  ///< Recorded events
+        std::uint32_t threadId{0};       ///< Id written to the trace
+        std::string name;                ///< Thread name written to the trace
+    };
+
+    /**
+     * Gets the calling thread's buffer, registering it on first use
+     */
+    ThreadBuffer& GetThreadBuffer();
+
+    std::atomic<bool> m_recording{false};          ///< Recording toggle
+    std::atomic<std::uint64_t> m_startNs{0};       ///< Timestamp of Start
+    std::atomic<std::uint64_t> m_nextFlowId{1};    ///< Flow id source
+    std::atomic<std::uint64_t> m_droppedEvents{0}; ///< Events rejected by a full buffer
+
+    std::mutex m_buffersMutex;                           ///< Guards buffer registration
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers; ///< One buffer per thread seen
+};
+
+} // namespace core
+} // namespace plot_genius
@@ -0,0 +1,173 @@
+/**
+ * Chebyshev Proxy Implementation
+ *
+ * A piece samples the program at the kProxyDegree + 1 Chebyshev nodes of
+ * the first kind, whose discrete cosine transform gives the coefficients,
+ * and is then compared with the program at the extrema of the next
+ * Chebyshev polynomial, which fall between the nodes and include both
+ * ends. Interval evaluation rejects pieces around poles and undefined
+ * stretches that the point checks might step over.
+ */
+
+#include "chebyshev.hpp"
+#include "interval.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace plot_genius {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr ::std::size_t kNodes = kProxyDegree + 1;
+
+// Halvings of the range before a piece falls back to the program (at most 256 pieces)
+constexpr int kMaxProxyDepth = 8;
+
+// Sums a Chebyshev series at t in [-1, 1]
+double Clenshaw(const double* c, double t) {
+    double b1 = 0.0;
+    double b2 = 0.0;
+    for (::std::size_t j = kNodes - 1; j > 0; --j) {
+        const double b = c[j] + 2.0 * t * b1 - b2;
+        b2 = b1;
+        b1 = b;
+    }
+    return c[0] + t * b1 - b2;
+}
+
+double GetOpCost(OpCode op) {
+    switch (op) {
+        case OpCode::Power:
+            return 30.0;
+        case OpCode::Sin:
+        case OpCode::Cos:
+        case OpCode::Tan:
+        case OpCode::Log:
+        case OpCode::Exp:
+            return 20.0;
+        case OpCode::Divide:
+        case OpCode::Sqrt:
+            return 5.0;
+        default:
+            return 1.0;
+    }
+}
+
+} // namespace
+
+double EstimateEvaluationCost(const Program& program) {
+    // Instructions not depending on x run once per batch, so only the others count
+    const auto& code = program.GetInstructions();
+    ::std::vector<bool> varies(code.size(), false);
+    double cost = 0.0;
+    for (::std::size_t i = 0; i < code.size(); ++i) {
+        const Instruction& instruction = code[i];
+        const int operands = GetOperandCount(instruction.op);
+        varies[i] = instruction.op == OpCode::Variable || (operands >= 1 && varies[instruction.lhs]) ||
+                    (operands == 2 && varies[instruction.rhs]);
+        if (varies[i]) {
+            cost += GetOpCost(instruction.op);
+        }
+    }
+    return cost;
+}
+
+ChebyshevProxy::ChebyshevProxy(const Program& program, double xMin, double xMax, double tolerance,
+                               ::std::vector<double> parameters)
+    : m_program(program), m_parameters(::std::move(parameters)), m_xMin(xMin), m_xMax(xMax),
+      m_tolerance(tolerance) {
+    if (program.GetInstructions().empty()) {
+        throw ::std::runtime_error("No equation has been compiled");
+    }
+    Fit(xMin, xMax, 0);
+}
+
+void ChebyshevProxy::Fit(double lo, double hi, int depth) {
+    const double* parameters = m_parameters.empty() ? nullptr : m_parameters.data();
+    const double mid = 0.5 * (lo + hi);
+    const double half = 0.5 * (hi - lo);
+
+    double nodes[kNodes];
+    double values[kNodes];
+    for (::std::size_t k = 0; k < kNodes; ++k) {
+        nodes[k] = mid + half * ::std::cos(kPi * (2.0 * k + 1.0) / (2.0 * kNodes));
+    }
+
+    // A bounded enclosure with no undefined part rules out poles and gaps between the check points
+    const Interval range = EvaluateInterval(m_program, {lo, hi, false}, parameters);
+    bool fits = range.IsBounded() && !range.partial;
+    double coefficients[kNodes] = {};
+    if (fits) {
+        m_program.EvaluateBatch(nodes, values, kNodes, parameters);
+        for (::std::size_t j = 0; j < kNodes; ++j) {
+            double sum = 0.0;
+            for (::std::size_t k = 0; k < kNodes; ++k) {
+                sum += values[k] * ::std::cos(kPi * j * (2.0 * k + 1.0) / (2.0 * kNodes));
+            }
+            coefficients[j] = 2.0 * sum / kNodes;
+        }
+        coefficients[0] /= 2.0;
+
+        constexpr ::std::size_t kChecks = kNodes + 1;
+        double checks[kChecks];
+        double exact[kChecks];
+        for (::std::size_t i = 0; i < kChecks; ++i) {
+            checks[i] = mid + half * ::std::cos(kPi * i / kNodes);
+        }
+        m_program.EvaluateBatch(checks, exact, kChecks, parameters);
+        for (::std::size_t i = 0; i < kChecks && fits; ++i) {
+            const double t = ::std::cos(kPi * i / kNodes);
+            fits = ::std::abs(Clenshaw(coefficients, t) - exact[i]) <= m_tolerance;
+        }
+    }
+
+    if (fits) {
+        m_pieces.push_back({lo, hi, false, m_coefficients.size()});
+        m_coefficients.insert(m_coefficients.end(), coefficients, coefficients + kNodes);
+        return;
+    }
+    if (depth < kMaxProxyDepth) {
+        Fit(lo, mid, depth + 1);
+        Fit(mid, hi, depth + 1);
+        return;
+    }
+
+    // Neighbouring pieces left to the program are merged into one
+    if (!m_pieces.empty() && m_pieces.back().exact) {
+        m_pieces.back().hi = hi;
+    } else {
+        m_pieces.push_back({lo, hi, true, 0});
+    }
+}
+
+void ChebyshevProxy::Evaluate(const double* x, double* y, ::std::size_t count) const {
+    const double* parameters = m_parameters.empty() ? nullptr : m_parameters.data();
+
+    // Inputs usually increase, so the piece of the previous value is the place to start looking
+    ::std::size_t index = 0;
+    for (::std::size_t i = 0; i < count; ++i) {
+        while (index + 1 < m_pieces.size() && x[i] > m_pieces[index].hi) {
+            ++index;
+        }
+        while (index > 0 && x[i] < m_pieces[index].lo) {
+            --index;
+        }
+
+        const Piece& piece = m_pieces[index];
+        if (piece.exact) {
+            y[i] = m_program.Evaluate(x[i], parameters);
+            continue;
+        }
+        const double t = ::std::clamp((2.0 * x[i] - piece.lo - piece.hi) / (piece.hi - piece.lo), -1.0, 1.0);
+        y[i] = Clenshaw(m_coefficients.data() + piece.offset, t);
+    }
+}
+
+::std::size_t ChebyshevProxy::GetExactPieceCount() const {
+    return static_cast<::std::size_t>(
+        ::std::count_if(m_pieces.begin(), m_pieces.end(), [](const Piece& piece) { return piece.exact; }));
+}
+
+} // namespace plot_genius
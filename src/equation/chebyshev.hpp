@@ -0,0 +1,128 @@
+/**
+ * Chebyshev Proxy Header
+ *
+ * Defines a piecewise polynomial stand-in for a compiled program over a
+ * fixed x range. Each piece interpolates the program at Chebyshev nodes
+ * and is checked against it before use, so the proxy is within a given
+ * tolerance wherever it is used. Evaluating a piece costs a couple of
+ * dozen multiply-adds, far less than an equation full of sin and exp,
+ * which keeps panning and zooming smooth while exact samples are pending.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "program.hpp"
+
+namespace plot_genius {
+
+/// Degree of the polynomial on each piece
+constexpr int kProxyDegree = 16;
+
+/// Estimated cost per x value above which a program is worth approximating
+constexpr double kMinProxyCost = 64.0;
+
+/**
+ * Estimates the cost of evaluating a program at one x value
+ *
+ * @param program Program to estimate
+ * @return Cost in rough units of one addition
+ */
+double EstimateEvaluationCost(const Program& program);
+
+/**
+ * Piecewise Chebyshev approximation of a program
+ */
+class ChebyshevProxy {
+public:
+    /**
+     * Fits the program over a range
+     *
+     * Pieces are halved until their interpolant is within tolerance at
+     * check points between the nodes. Pieces that never get there, or that
+     * hit undefined values or poles, fall back to the program itself.
+     *
+     * @param program Program to approximate; copied so the proxy stands alone
+     * @param xMin Start of the range
+     * @param xMax End of the range
+     * @param tolerance Largest error allowed between proxy and program
+     * @param parameters Values of the program's parameters, empty for defaults
+     * @throws std::runtime_error if the program is empty
+     */
+    ChebyshevProxy(const Program& program, double xMin, double xMax, double tolerance,
+                   std::vector<double> parameters);
+
+    /**
+     * Evaluates the proxy at many x values
+     *
+     * @param x Input values within the range of the proxy
+     * @param y Receives one value per input
+     * @param count Number of values
+     */
+    void Evaluate(const double* x, double* y, std::size_t count) const;
+
+    /**
+     * Checks whether the proxy spans a range
+     *
+     * @param xMin Start of the range
+     * @param xMax End of the range
+     * @return True if the range lies within the fitted one
+     */
+    bool Covers(double xMin, double xMax) const { return m_xMin <= xMin && xMax <= m_xMax; }
+
+    /**
+     * Checks whether the proxy was fitted with the given parameter values
+     *
+     * @param parameters Values of the program's parameters, empty for defaults
+     * @return True if they match the fitted ones
+     */
+    bool Matches(const std::vector<double>& parameters) const { return parameters == m_parameters; }
+
+    /**
+     * Gets the tolerance the proxy was fitted to
+     *
+     * @return Largest error between proxy and program
+     */
+    double GetTolerance() const { return m_tolerance; }
+
+    /**
+     * Gets the number of pieces
+     *
+     * @return Pieces the range was split into
+     */
+    std::size_t GetPieceCount() const { return m_pieces.size(); }
+
+    /**
+     * Gets the number of pieces evaluated exactly
+     *
+     * @return Pieces that could not be approximated within tolerance
+     */
+    std::size_t GetExactPieceCount() const;
+
+private:
+    /**
+     * One stretch of the range with its own polynomial
+     */
+    struct Piece {
+        double lo;           ///< Start of the piece
+        double hi;           ///< End of the piece
+        bool exact;          ///< Evaluate the program instead of a polynomial
+        std::size_t offset;  ///< First coefficient in m_coefficients
+    };
+
+    /**
+     * Fits [lo, hi], splitting it until each part is within tolerance
+     */
+    void Fit(double lo, double hi, int depth);
+
+    Program m_program;                        ///< Program approximated
+    std::vector<double> m_parameters;         ///< Parameter values fitted with
+    double m_xMin;                            ///< Start of the fitted range
+    double m_xMax;                            ///< End of the fitted range
+    double m_tolerance;                       ///< Allowed error
+    std::vector<Piece> m_pieces;              ///< Pieces in increasing x
+    std::vector<double> m_coefficients;       ///< kProxyDegree + 1 Chebyshev coefficients per piece
+};
+
+} // namespace plot_genius
@@ -0,0 +1,353 @@
+/**
+ * Compiled Program Implementation
+ *
+ * Kernels are templates over the operation and the kind of each operand,
+ * so the loop of every instantiation is a plain array operation the
+ * compiler can vectorize. Translation picks an instantiation per
+ * instruction and assigns blocks by liveness.
+ */
+
+#include "compiled_program.hpp"
+#include "execute.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace plot_genius {
+
+namespace {
+
+// Working values of one block should fit in L1
+constexpr ::std::size_t kBlockBytes = 32 * 1024;
+constexpr ::std::size_t kMinBlock = 8;
+constexpr ::std::size_t kMaxBlock = 512;
+
+// Shapes of a fused multiply-add: a*b + c, a*b - c and c - a*b
+enum class Fusion { Add, SubtractAddend, SubtractProduct };
+
+bool IsUnary(OpCode op) {
+    return GetOperandCount(op) == 1;
+}
+
+} // namespace
+
+// Kernels only need Step, so they are defined where it is visible
+struct CompiledKernels {
+    using Step = CompiledProgram::Step;
+    using Kernel = CompiledProgram::Kernel;
+
+    static void Load(const Step& step, double* blocks, const double*, const double* x, ::std::size_t stride,
+                     ::std::size_t n) {
+        ::std::copy(x, x + n, blocks + step.out * stride);
+    }
+
+    template <OpCode Op>
+    static void Unary(const Step& step, double* blocks, const double*, const double*, ::std::size_t stride,
+                      ::std::size_t n) {
+        const double* a = blocks + step.a * stride;
+        double* out = blocks + step.out * stride;
+        for (::std::size_t i = 0; i < n; ++i) {
+            out[i] = ApplyOp(Op, a[i], 0.0);
+        }
+    }
+
+    template <OpCode Op, bool ScalarA, bool ScalarB>
+    static void Binary(const Step& step, double* blocks, const double* scalars, const double*,
+                       ::std::size_t stride, ::std::size_t n) {
+        double* out = blocks + step.out * stride;
+        if constexpr (ScalarA) {
+            const double a = scalars[step.a];
+            const double* b = blocks + step.b * stride;
+            for (::std::size_t i = 0; i < n; ++i) {
+                out[i] = ApplyOp(Op, a, b[i]);
+            }
+        } else if constexpr (ScalarB) {
+            const double* a = blocks + step.a * stride;
+            const double b = scalars[step.b];
+            for (::std::size_t i = 0; i < n; ++i) {
+                out[i] = ApplyOp(Op, a[i], b);
+            }
+        } else {
+            const double* a = blocks + step.a * stride;
+            const double* b = blocks + step.b * stride;
+            for (::std::size_t i = 0; i < n; ++i) {
+                out[i] = ApplyOp(Op, a[i], b[i]);
+            }
+        }
+    }
+
+    // One pass instead of two; where the target has FMA the compiler may also contract it, changing the last bit
+    template <Fusion Form, bool ScalarB, bool ScalarC>
+    static void MultiplyAdd(const Step& step, double* blocks, const double* scalars, const double*,
+                            ::std::size_t stride, ::std::size_t n) {
+        const double* a = blocks + step.a * stride;
+        const double* b = ScalarB ? nullptr : blocks + step.b * stride;
+        const double* c = ScalarC ? nullptr : blocks + step.c * stride;
+        const double bScalar = ScalarB ? scalars[step.b] : 0.0;
+        const double cScalar = ScalarC ? scalars[step.c] : 0.0;
+        double* out = blocks + step.out * stride;
+        for (::std::size_t i = 0; i < n; ++i) {
+            const double product = a[i] * (ScalarB ? bScalar : b[i]);
+            const double addend = ScalarC ? cScalar : c[i];
+            if constexpr (Form == Fusion::Add) {
+                out[i] = product + addend;
+            } else if constexpr (Form == Fusion::SubtractAddend) {
+                out[i] = product - addend;
+            } else {
+                out[i] = addend - product;
+            }
+        }
+    }
+
+    // Vectorized built-in functions for MathPrecision::Fast
+    template <OpCode Op>
+    static void FastUnary(const Step& step, double* blocks, const double*, const double*, ::std::size_t stride,
+                          ::std::size_t n) {
+        const double* a = blocks + step.a * stride;
+        ApplyFast(Op, a, a, blocks + step.out * stride, n);
+    }
+
+    // An invariant operand is spread over a block first, since the kernels take arrays
+    template <bool ScalarA, bool ScalarB>
+    static void FastPower(const Step& step, double* blocks, const double* scalars, const double*,
+                          ::std::size_t stride, ::std::size_t n) {
+        double spread[kMaxBlock];
+        const double* a = blocks + step.a * stride;
+        const double* b = blocks + step.b * stride;
+        if constexpr (ScalarA) {
+            ::std::fill(spread, spread + n, scalars[step.a]);
+            a = spread;
+        } else if constexpr (ScalarB) {
+            ::std::fill(spread, spread + n, scalars[step.b]);
+            b = spread;
+        }
+        ApplyFast(OpCode::Power, a, b, blocks + step.out * stride, n);
+    }
+
+    static Kernel SelectUnary(OpCode op) {
+        switch (op) {
+            case OpCode::Negate: return &Unary<OpCode::Negate>;
+            case OpCode::Sin:    return &Unary<OpCode::Sin>;
+            case OpCode::Cos:    return &Unary<OpCode::Cos>;
+            case OpCode::Tan:    return &Unary<OpCode::Tan>;
+            case OpCode::Sqrt:   return &Unary<OpCode::Sqrt>;
+            case OpCode::Log:    return &Unary<OpCode::Log>;
+            case OpCode::Exp:    return &Unary<OpCode::Exp>;
+            case OpCode::Abs:    return &Unary<OpCode::Abs>;
+            default:             throw ::std::runtime_error("Unsupported operation");
+        }
+    }
+
+    static Kernel SelectUnary(OpCode op, MathPrecision precision) {
+        if (precision == MathPrecision::Fast) {
+            switch (op) {
+                case OpCode::Sin:  return &FastUnary<OpCode::Sin>;
+                case OpCode::Cos:  return &FastUnary<OpCode::Cos>;
+                case OpCode::Tan:  return &FastUnary<OpCode::Tan>;
+                case OpCode::Sqrt: return &FastUnary<OpCode::Sqrt>;
+                case OpCode::Log:  return &FastUnary<OpCode::Log>;
+                case OpCode::Exp:  return &FastUnary<OpCode::Exp>;
+                default:           break;
+            }
+        }
+        return SelectUnary(op);
+    }
+
+    template <bool ScalarA, bool ScalarB>
+    static Kernel SelectBinary(OpCode op) {
+        switch (op) {
+            case OpCode::Add:      return &Binary<OpCode::Add, ScalarA, ScalarB>;
+            case OpCode::Subtract: return &Binary<OpCode::Subtract, ScalarA, ScalarB>;
+            case OpCode::Multiply: return &Binary<OpCode::Multiply, ScalarA, ScalarB>;
+            case OpCode::Divide:   return &Binary<OpCode::Divide, ScalarA, ScalarB>;
+            case OpCode::Power:    return &Binary<OpCode::Power, ScalarA, ScalarB>;
+            default:               throw ::std::runtime_error("Unsupported operation");
+        }
+    }
+
+    static Kernel SelectBinary(OpCode op, bool scalarA, bool scalarB, MathPrecision precision) {
+        if (op == OpCode::Power && precision == MathPrecision::Fast) {
+            if (scalarA) {
+                return &FastPower<true, false>;
+            }
+            return scalarB ? &FastPower<false, true> : &FastPower<false, false>;
+        }
+        if (scalarA) {
+            return SelectBinary<true, false>(op);
+        }
+        return scalarB ? SelectBinary<false, true>(op) : SelectBinary<false, false>(op);
+    }
+
+    template <Fusion Form>
+    static Kernel SelectMultiplyAdd(bool scalarB, bool scalarC) {
+        if (scalarB) {
+            return scalarC ? &MultiplyAdd<Form, true, true> : &MultiplyAdd<Form, true, false>;
+        }
+        return scalarC ? &MultiplyAdd<Form, false, true> : &MultiplyAdd<Form, false, false>;
+    }
+
+    static Kernel SelectMultiplyAdd(Fusion form, bool scalarB, bool scalarC) {
+        switch (form) {
+            case Fusion::Add:            return SelectMultiplyAdd<Fusion::Add>(scalarB, scalarC);
+            case Fusion::SubtractAddend: return SelectMultiplyAdd<Fusion::SubtractAddend>(scalarB, scalarC);
+            default:                     return SelectMultiplyAdd<Fusion::SubtractProduct>(scalarB, scalarC);
+        }
+    }
+};
+
+CompiledProgram::CompiledProgram(const Program& program) : m_code(program.GetInstructions()) {
+    const MathPrecision precision = program.GetPrecision();
+    if (m_code.empty()) {
+        throw ::std::runtime_error("No equation has been compiled");
+    }
+
+    const ::std::size_t size = m_code.size();
+    ::std::vector<bool> varies(size, false);
+    ::std::vector<::std::uint32_t> uses(size, 0);
+    for (::std::size_t i = 0; i < size; ++i) {
+        const Instruction& instruction = m_code[i];
+        const int operands = GetOperandCount(instruction.op);
+        varies[i] = instruction.op == OpCode::Variable || (operands >= 1 && varies[instruction.lhs]) ||
+                    (operands == 2 && varies[instruction.rhs]);
+        if (!varies[i]) {
+            m_invariant.push_back(static_cast<::std::uint32_t>(i));
+        }
+        if (operands >= 1) {
+            ++uses[instruction.lhs];
+        }
+        if (operands == 2) {
+            ++uses[instruction.rhs];
+        }
+    }
+    const ::std::uint32_t result = static_cast<::std::uint32_t>(size - 1);
+    m_varying = varies[result];
+    if (!m_varying) {
+        m_result = result;
+        return;
+    }
+
+    // A varying product used once, by an addition or subtraction, is computed inside it
+    auto fusible = [&](::std::uint32_t slot) {
+        return m_code[slot].op == OpCode::Multiply && varies[slot] && uses[slot] == 1 && slot != result;
+    };
+    ::std::vector<bool> fused(size, false);
+    for (::std::size_t i = 0; i < size; ++i) {
+        const Instruction& instruction = m_code[i];
+        if (!varies[i] || (instruction.op != OpCode::Add && instruction.op != OpCode::Subtract)) {
+            continue;
+        }
+        if (fusible(instruction.lhs)) {
+            fused[instruction.lhs] = true;
+        } else if (fusible(instruction.rhs)) {
+            fused[instruction.rhs] = true;
+        }
+    }
+
+    // Operand slots each remaining instruction reads, with fused products replaced by their factors
+    auto forEachOperand = [&](::std::size_t i, auto&& visit) {
+        const Instruction& instruction = m_code[i];
+        const int operands = GetOperandCount(instruction.op);
+        for (int k = 0; k < operands; ++k) {
+            const ::std::uint32_t slot = k == 0 ? instruction.lhs : instruction.rhs;
+            if (fused[slot]) {
+                visit(m_code[slot].lhs);
+                visit(m_code[slot].rhs);
+            } else {
+                visit(slot);
+            }
+        }
+    };
+
+    // Blocks are freed after the last step reading them; kernels are element-wise, so out may reuse an operand
+    ::std::vector<::std::size_t> lastUse(size, 0);
+    for (::std::size_t i = 0; i < size; ++i) {
+        if (varies[i] && !fused[i]) {
+            forEachOperand(i, [&](::std::uint32_t slot) { lastUse[slot] = i; });
+        }
+    }
+    ::std::vector<::std::uint32_t> blockOf(size, 0);
+    ::std::vector<::std::uint32_t> freeBlocks;
+    for (::std::size_t i = 0; i < size; ++i) {
+        if (!varies[i] || fused[i]) {
+            continue;
+        }
+        forEachOperand(i, [&](::std::uint32_t slot) {
+            if (varies[slot] && lastUse[slot] == i &&
+                ::std::find(freeBlocks.begin(), freeBlocks.end(), blockOf[slot]) == freeBlocks.end()) {
+                freeBlocks.push_back(blockOf[slot]);
+            }
+        });
+        ::std::uint32_t out;
+        if (freeBlocks.empty()) {
+            out = static_cast<::std::uint32_t>(m_blocks++);
+        } else {
+            out = freeBlocks.back();
+            freeBlocks.pop_back();
+        }
+        blockOf[i] = out;
+
+        const Instruction& instruction = m_code[i];
+        auto operand = [&](::std::uint32_t slot) { return varies[slot] ? blockOf[slot] : slot; };
+        Step step{nullptr, out, 0, 0, 0};
+        if (instruction.op == OpCode::Variable) {
+            step.kernel = &CompiledKernels::Load;
+        } else if (IsUnary(instruction.op)) {
+            step.kernel = CompiledKernels::SelectUnary(instruction.op, precision);
+            step.a = operand(instruction.lhs);
+        } else if (fused[instruction.lhs] || fused[instruction.rhs]) {
+            const bool productFirst = fused[instruction.lhs];
+            const Instruction& product = m_code[productFirst ? instruction.lhs : instruction.rhs];
+            const ::std::uint32_t addend = productFirst ? instruction.rhs : instruction.lhs;
+            const Fusion form = instruction.op == OpCode::Add ? Fusion::Add
+                                : productFirst                ? Fusion::SubtractAddend
+                                                              : Fusion::SubtractProduct;
+
+            // The product varies, so at least one factor is a block; it goes first
+            ::std::uint32_t a = product.lhs;
+            ::std::uint32_t b = product.rhs;
+            if (!varies[a]) {
+                ::std::swap(a, b);
+            }
+            step.kernel = CompiledKernels::SelectMultiplyAdd(form, !varies[b], !varies[addend]);
+            step.a = operand(a);
+            step.b = operand(b);
+            step.c = operand(addend);
+        } else {
+            step.kernel = CompiledKernels::SelectBinary(instruction.op, !varies[instruction.lhs],
+                                                        !varies[instruction.rhs], precision);
+            step.a = operand(instruction.lhs);
+            step.b = operand(instruction.rhs);
+        }
+        m_steps.push_back(step);
+    }
+    m_result = blockOf[result];
+
+    // Multiples of 8 keep the loops free of remainders
+    const ::std::size_t perValue = ::std::max<::std::size_t>(m_blocks, 1) * sizeof(double);
+    m_block = ::std::clamp(kBlockBytes / perValue / kMinBlock * kMinBlock, kMinBlock, kMaxBlock);
+}
+
+void CompiledProgram::EvaluateBatch(const double* x, double* y, ::std::size_t count,
+                                    const double* parameters) const {
+    thread_local ::std::vector<double> scalars;
+    scalars.resize(m_code.size());
+    for (::std::uint32_t i : m_invariant) {
+        scalars[i] = Execute(m_code[i], scalars.data(), 0.0, parameters);
+    }
+    if (!m_varying) {
+        ::std::fill(y, y + count, scalars[m_result]);
+        return;
+    }
+
+    thread_local ::std::vector<double> blocks;
+    blocks.resize(m_blocks * m_block);
+    const double* result = blocks.data() + m_result * m_block;
+    for (::std::size_t start = 0; start < count; start += m_block) {
+        const ::std::size_t n = ::std::min(m_block, count - start);
+        for (const Step& step : m_steps) {
+            step.kernel(step, blocks.data(), scalars.data(), x + start, m_block, n);
+        }
+        ::std::copy(result, result + n, y + start);
+    }
+}
+
+} // namespace plot_genius
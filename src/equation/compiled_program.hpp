@@ -0,0 +1,88 @@
+/**
+ * Compiled Program Header
+ *
+ * Defines the fastest execution tier of a program. Instead of dispatching
+ * on the operation of every instruction, the program is translated once
+ * into a list of kernel calls, each instantiated for its operation and
+ * for which of its operands are blocks of x-dependent values and which
+ * are single invariant values. Multiplications feeding a single addition
+ * are fused into one kernel, and blocks are reused as soon as their value
+ * is dead, so even long programs keep their working set in L1. Programs
+ * set to MathPrecision::Fast call the vectorized built-in functions.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "program.hpp"
+
+namespace plot_genius {
+
+/**
+ * Program translated into specialized kernels over blocks of x values
+ */
+class CompiledProgram {
+public:
+    /**
+     * Translates a program
+     *
+     * @param program Non-empty program; copied, so it need not outlive this
+     * @throws std::runtime_error if the program is empty
+     */
+    explicit CompiledProgram(const Program& program);
+
+    /**
+     * Evaluates the program at many x values; thread-safe
+     *
+     * @param x Input values
+     * @param y Receives one result per input value
+     * @param count Number of values
+     * @param parameters One value per parameter name, or nullptr to use kDefaultParameterValue
+     */
+    void EvaluateBatch(const double* x, double* y, std::size_t count, const double* parameters = nullptr) const;
+
+    /**
+     * Gets the number of kernel calls per block
+     *
+     * @return Steps, after fusion
+     */
+    std::size_t GetStepCount() const { return m_steps.size(); }
+
+    /**
+     * Gets the number of blocks the steps share
+     *
+     * @return Blocks of working values, after reuse
+     */
+    std::size_t GetBlockCount() const { return m_blocks; }
+
+private:
+    friend struct CompiledKernels;
+    struct Step;
+
+    /// Computes one step over n values; blocks are stride values apart
+    using Kernel = void (*)(const Step& step, double* blocks, const double* scalars, const double* x,
+                            std::size_t stride, std::size_t n);
+
+    /**
+     * One kernel call; operands index blocks or scalars depending on the kernel
+     */
+    struct Step {
+        Kernel kernel;      ///< Instantiated kernel
+        std::uint32_t out;  ///< Block receiving the result
+        std::uint32_t a;    ///< First operand
+        std::uint32_t b;    ///< Second operand
+        std::uint32_t c;    ///< Addend of a fused multiply-add
+    };
+
+    std::vector<Instruction> m_code;       ///< Program instructions, for the invariant ones
+    std::vector<std::uint32_t> m_invariant; ///< Instructions independent of x, run once per call
+    std::vector<Step> m_steps;             ///< Kernel calls per block, in order
+    std::size_t m_blocks{0};               ///< Blocks the steps use
+    std::size_t m_block{0};                ///< x values per block
+    bool m_varying{false};                 ///< The result depends on x
+    std::uint32_t m_result{0};             ///< Block of the result, or its scalar slot if invariant
+};
+
+} // namespace plot_genius
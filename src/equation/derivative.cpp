@@ -0,0 +1,263 @@
+/**
+ * Symbolic Differentiation Implementation
+ *
+ * Each rule builds its result through the simplifying constructors below.
+ * They only rewrite locally, in constant time, so simplification never
+ * costs more than building the tree; the node limit bounds what is left.
+ */
+
+#include "derivative.hpp"
+#include <stdexcept>
+
+namespace plot_genius {
+
+namespace {
+
+using Node = ::std::unique_ptr<ExpressionNode>;
+
+bool IsConstant(const Node& node, double value) {
+    return node->op == OpCode::Constant && node->value == value;
+}
+
+bool IsConstant(const Node& node) {
+    return node->op == OpCode::Constant;
+}
+
+// Checks whether a subtree depends on x; parameters are constants here
+bool DependsOnX(const ExpressionNode& node) {
+    if (node.op == OpCode::Variable) {
+        return true;
+    }
+    return (node.left && DependsOnX(*node.left)) || (node.right && DependsOnX(*node.right));
+}
+
+bool SameTree(const ExpressionNode& a, const ExpressionNode& b) {
+    if (a.op != b.op || (a.op == OpCode::Constant && a.value != b.value) ||
+        (a.op == OpCode::Parameter && a.name != b.name)) {
+        return false;
+    }
+    if (!a.left != !b.left || !a.right != !b.right) {
+        return false;
+    }
+    return (!a.left || SameTree(*a.left, *b.left)) && (!a.right || SameTree(*a.right, *b.right));
+}
+
+Node Copy(const ExpressionNode& node) {
+    return CloneExpression(node);
+}
+
+Node Negate(Node a) {
+    if (IsConstant(a)) {
+        return MakeConstant(-a->value);
+    }
+    if (a->op == OpCode::Negate) {
+        return ::std::move(a->left);
+    }
+    return MakeOperation(OpCode::Negate, ::std::move(a));
+}
+
+Node Add(Node a, Node b) {
+    if (IsConstant(a) && IsConstant(b)) {
+        return MakeConstant(a->value + b->value);
+    }
+    if (IsConstant(a, 0.0)) {
+        return b;
+    }
+    if (IsConstant(b, 0.0)) {
+        return a;
+    }
+    if (b->op == OpCode::Negate) {
+        return MakeOperation(OpCode::Subtract, ::std::move(a), ::std::move(b->left));
+    }
+    return MakeOperation(OpCode::Add, ::std::move(a), ::std::move(b));
+}
+
+Node Subtract(Node a, Node b) {
+    if (IsConstant(a) && IsConstant(b)) {
+        return MakeConstant(a->value - b->value);
+    }
+    if (IsConstant(b, 0.0)) {
+        return a;
+    }
+    if (IsConstant(a, 0.0)) {
+        return Negate(::std::move(b));
+    }
+    if (SameTree(*a, *b)) {
+        return MakeConstant(0.0);
+    }
+    if (b->op == OpCode::Negate) {
+        return MakeOperation(OpCode::Add, ::std::move(a), ::std::move(b->left));
+    }
+    return MakeOperation(OpCode::Subtract, ::std::move(a), ::std::move(b));
+}
+
+Node Multiply(Node a, Node b) {
+    // Constants go first so that factors can be collected
+    if (IsConstant(b) && !IsConstant(a)) {
+        ::std::swap(a, b);
+    }
+    if (IsConstant(a)) {
+        if (IsConstant(b)) {
+            return MakeConstant(a->value * b->value);
+        }
+        if (a->value == 0.0) {
+            return a;
+        }
+        if (a->value == 1.0) {
+            return b;
+        }
+        if (a->value == -1.0) {
+            return Negate(::std::move(b));
+        }
+        if (b->op == OpCode::Multiply && IsConstant(b->left)) {
+            return Multiply(MakeConstant(a->value * b->left->value), ::std::move(b->right));
+        }
+    }
+    if (a->op == OpCode::Negate) {
+        return Negate(Multiply(::std::move(a->left), ::std::move(b)));
+    }
+    if (b->op == OpCode::Negate) {
+        return Negate(Multiply(::std::move(a), ::std::move(b->left)));
+    }
+    return MakeOperation(OpCode::Multiply, ::std::move(a), ::std::move(b));
+}
+
+Node Divide(Node a, Node b) {
+    if (IsConstant(a) && IsConstant(b)) {
+        return MakeConstant(a->value / b->value);
+    }
+    if (IsConstant(a, 0.0) || IsConstant(b, 1.0)) {
+        return a;
+    }
+    if (a->op == OpCode::Negate) {
+        return Negate(Divide(::std::move(a->left), ::std::move(b)));
+    }
+    return MakeOperation(OpCode::Divide, ::std::move(a), ::std::move(b));
+}
+
+Node Power(Node a, Node b) {
+    if (IsConstant(b, 1.0)) {
+        return a;
+    }
+    if (IsConstant(b, 0.0)) {
+        return MakeConstant(1.0);
+    }
+    if (IsConstant(a) && IsConstant(b)) {
+        return MakeConstant(ApplyOp(OpCode::Power, a->value, b->value));
+    }
+    return MakeOperation(OpCode::Power, ::std::move(a), ::std::move(b));
+}
+
+Node Apply(OpCode op, Node a) {
+    if (IsConstant(a)) {
+        return MakeConstant(ApplyOp(op, a->value, 0.0));
+    }
+    return MakeOperation(op, ::std::move(a));
+}
+
+Node Derive(const ExpressionNode& node);
+
+// Derivative of pow(u, v)
+Node DerivePower(const ExpressionNode& u, const ExpressionNode& v) {
+    // Constant exponent: v * u^(v-1) * u'; this also covers negative bases
+    if (!DependsOnX(v)) {
+        Node exponent = Subtract(Copy(v), MakeConstant(1.0));
+        return Multiply(Multiply(Copy(v), Power(Copy(u), ::std::move(exponent))), Derive(u));
+    }
+
+    // Constant base: u^v * log(u) * v'
+    Node power = Power(Copy(u), Copy(v));
+    if (!DependsOnX(u)) {
+        return Multiply(Multiply(::std::move(power), Apply(OpCode::Log, Copy(u))), Derive(v));
+    }
+
+    // General case: u^v * (v' log(u) + v u' / u)
+    Node logTerm = Multiply(Derive(v), Apply(OpCode::Log, Copy(u)));
+    Node ratioTerm = Divide(Multiply(Copy(v), Derive(u)), Copy(u));
+    return Multiply(::std::move(power), Add(::std::move(logTerm), ::std::move(ratioTerm)));
+}
+
+Node Derive(const ExpressionNode& node) {
+    switch (node.op) {
+        case OpCode::Constant:
+        case OpCode::Parameter:
+            return MakeConstant(0.0);
+        case OpCode::Variable:
+            return MakeConstant(1.0);
+        default:
+            break;
+    }
+    if (!DependsOnX(node)) {
+        return MakeConstant(0.0);
+    }
+
+    const ExpressionNode& u = *node.left;
+    switch (node.op) {
+        case OpCode::Add:
+            return Add(Derive(u), Derive(*node.right));
+        case OpCode::Subtract:
+            return Subtract(Derive(u), Derive(*node.right));
+        case OpCode::Multiply: {
+            const ExpressionNode& v = *node.right;
+            return Add(Multiply(Derive(u), Copy(v)), Multiply(Copy(u), Derive(v)));
+        }
+        case OpCode::Divide: {
+            const ExpressionNode& v = *node.right;
+            if (!DependsOnX(v)) {
+                return Divide(Derive(u), Copy(v));
+            }
+            // (u'v - uv') / v^2
+            Node numerator = Subtract(Multiply(Derive(u), Copy(v)), Multiply(Copy(u), Derive(v)));
+            return Divide(::std::move(numerator), Multiply(Copy(v), Copy(v)));
+        }
+        case OpCode::Power:
+            return DerivePower(u, *node.right);
+        case OpCode::Negate:
+            return Negate(Derive(u));
+        case OpCode::Sin:
+            return Multiply(Apply(OpCode::Cos, Copy(u)), Derive(u));
+        case OpCode::Cos:
+            return Negate(Multiply(Apply(OpCode::Sin, Copy(u)), Derive(u)));
+        case OpCode::Tan: {
+            // 1 + tan(u)^2 reuses the tan(u) the equation already computes
+            Node tangent = Apply(OpCode::Tan, Copy(u));
+            Node copy = Copy(*tangent);
+            Node square = Multiply(::std::move(copy), ::std::move(tangent));
+            return Multiply(Add(MakeConstant(1.0), ::std::move(square)), Derive(u));
+        }
+        case OpCode::Sqrt:
+            return Divide(Derive(u), Multiply(MakeConstant(2.0), Apply(OpCode::Sqrt, Copy(u))));
+        case OpCode::Log:
+            return Divide(Derive(u), Copy(u));
+        case OpCode::Exp:
+            return Multiply(Apply(OpCode::Exp, Copy(u)), Derive(u));
+        case OpCode::Abs:
+            // sign(u) * u', undefined at u = 0 like the derivative itself
+            return Multiply(Divide(Copy(u), Apply(OpCode::Abs, Copy(u))), Derive(u));
+        default:
+            throw ::std::runtime_error("Cannot differentiate this expression");
+    }
+}
+
+} // namespace
+
+::std::unique_ptr<ExpressionNode> Differentiate(const ExpressionNode& node) {
+    Node derivative = Derive(node);
+    if (CountNodes(*derivative) > kMaxDerivativeNodes) {
+        throw ::std::runtime_error("Derivative is too large");
+    }
+    return derivative;
+}
+
+::std::size_t CountNodes(const ExpressionNode& node) {
+    ::std::size_t count = 1;
+    if (node.left) {
+        count += CountNodes(*node.left);
+    }
+    if (node.right) {
+        count += CountNodes(*node.right);
+    }
+    return count;
+}
+
+} // namespace plot_genius
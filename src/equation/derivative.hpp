@@ -0,0 +1,42 @@
+/**
+ * Symbolic Differentiation Header
+ *
+ * Defines d/dx as a transform of expression trees. The derivative is an
+ * ordinary tree, so it is compiled and sampled like any typed equation;
+ * subtrees it repeats (the product and chain rules copy their operands)
+ * are evaluated once thanks to the compiler's common subexpression sharing.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include "expression.hpp"
+
+namespace plot_genius {
+
+/// Largest derivative tree, in nodes, before differentiation gives up
+constexpr std::size_t kMaxDerivativeNodes = 1 << 16;
+
+/**
+ * Differentiates an expression with respect to x
+ *
+ * Rules are applied through constructors that simplify as they build
+ * (constant folding, identities of 0 and 1, collected constant factors),
+ * so trivial terms never enter the tree.
+ *
+ * @param node Root of the expression
+ * @return Simplified derivative
+ * @throws std::runtime_error if the derivative exceeds kMaxDerivativeNodes
+ */
+std::unique_ptr<ExpressionNode> Differentiate(const ExpressionNode& node);
+
+/**
+ * Counts the nodes of a tree
+ *
+ * @param node Root of the tree
+ * @return Number of nodes
+ */
+std::size_t CountNodes(const ExpressionNode& node);
+
+} // namespace plot_genius
@@ -0,0 +1,187 @@
+/**
+ * Domain Analysis Implementation
+ *
+ * Both analyses only ever exclude x values that certainly give NaN, so
+ * their results may be larger than the true domain but never smaller.
+ */
+
+#include "domain.hpp"
+#include "interval.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace plot_genius {
+
+namespace {
+
+constexpr double kInfinity = ::std::numeric_limits<double>::infinity();
+
+// Relative slack on derived bounds, covering rounding in the affine coefficients
+constexpr double kBoundSlack = 1e-9;
+
+// Value of a slot as offset + slope * x, when it has that form
+struct Affine {
+    double offset{0.0};
+    double slope{0.0};
+    bool affine{false};
+
+    bool IsConstant() const { return affine && slope == 0.0; }
+};
+
+Affine Combine(OpCode op, const Affine& a, const Affine& b) {
+    if (a.IsConstant() && (GetOperandCount(op) == 1 || b.IsConstant())) {
+        return {ApplyOp(op, a.offset, b.offset), 0.0, true};
+    }
+    if (!a.affine || (GetOperandCount(op) == 2 && !b.affine)) {
+        return {};
+    }
+    switch (op) {
+        case OpCode::Add:
+            return {a.offset + b.offset, a.slope + b.slope, true};
+        case OpCode::Subtract:
+            return {a.offset - b.offset, a.slope - b.slope, true};
+        case OpCode::Multiply:
+            if (a.IsConstant()) {
+                return {a.offset * b.offset, a.offset * b.slope, true};
+            }
+            if (b.IsConstant()) {
+                return {a.offset * b.offset, a.slope * b.offset, true};
+            }
+            return {};
+        case OpCode::Divide:
+            if (b.IsConstant()) {
+                return {a.offset / b.offset, a.slope / b.offset, true};
+            }
+            return {};
+        case OpCode::Negate:
+            return {-a.offset, -a.slope, true};
+        default:
+            return {};
+    }
+}
+
+// Narrows bounds to the x with offset + slope * x >= 0
+void RequireNonNegative(const Affine& u, DomainBounds& bounds) {
+    if (!u.affine || !::std::isfinite(u.offset) || !::std::isfinite(u.slope)) {
+        return;
+    }
+    if (u.slope == 0.0) {
+        if (u.offset < 0.0) {
+            bounds = {kInfinity, -kInfinity};
+        }
+        return;
+    }
+    const double root = -u.offset / u.slope;
+    const double slack = kBoundSlack * (::std::abs(root) + 1.0);
+    if (u.slope > 0.0) {
+        bounds.lo = ::std::max(bounds.lo, root - slack);
+    } else {
+        bounds.hi = ::std::min(bounds.hi, root + slack);
+    }
+}
+
+// Checks whether NaN in an operand of pow is passed on; pow(NaN, 0) and pow(1, NaN) are 1
+bool PowerPassesNaN(const Affine& other, double absorbing) {
+    return other.IsConstant() && other.offset != absorbing;
+}
+
+// Splits [a, b] and collects the pieces that may have a value
+void CollectDefined(const Program& program, double a, double b, double minWidth, const double* parameters,
+                    ::std::vector<::std::pair<double, double>>& ranges) {
+    const Interval range = EvaluateInterval(program, {a, b, false}, parameters);
+    if (range.IsEmpty()) {
+        return;
+    }
+    const double middle = a + (b - a) / 2.0;
+    if (range.partial && b - a > minWidth && middle > a && middle < b) {
+        CollectDefined(program, a, middle, minWidth, parameters, ranges);
+        CollectDefined(program, middle, b, minWidth, parameters, ranges);
+        return;
+    }
+    if (!ranges.empty() && ranges.back().second == a) {
+        ranges.back().second = b;
+    } else {
+        ranges.emplace_back(a, b);
+    }
+}
+
+} // namespace
+
+DomainBounds AnalyzeDomain(const Program& program, const double* parameters) {
+    const auto& code = program.GetInstructions();
+    DomainBounds bounds{-kInfinity, kInfinity};
+    if (code.empty()) {
+        return bounds;
+    }
+
+    ::std::vector<Affine> forms(code.size());
+    for (::std::size_t i = 0; i < code.size(); ++i) {
+        const Instruction& instruction = code[i];
+        switch (instruction.op) {
+            case OpCode::Constant:
+                forms[i] = {instruction.value, 0.0, true};
+                break;
+            case OpCode::Variable:
+                forms[i] = {0.0, 1.0, true};
+                break;
+            case OpCode::Parameter:
+                forms[i] = {parameters ? parameters[instruction.lhs] : kDefaultParameterValue, 0.0, true};
+                break;
+            default:
+                forms[i] = Combine(instruction.op, forms[instruction.lhs], forms[instruction.rhs]);
+                break;
+        }
+    }
+
+    // Only NaN that reaches the result makes it undefined
+    ::std::vector<bool> reaches(code.size(), false);
+    reaches.back() = true;
+    for (::std::size_t i = code.size(); i-- > 0;) {
+        const Instruction& instruction = code[i];
+        const int operands = GetOperandCount(instruction.op);
+        if (!reaches[i] || operands == 0) {
+            continue;
+        }
+        if (instruction.op == OpCode::Power) {
+            reaches[instruction.lhs] = reaches[instruction.lhs] || PowerPassesNaN(forms[instruction.rhs], 0.0);
+            reaches[instruction.rhs] = reaches[instruction.rhs] || PowerPassesNaN(forms[instruction.lhs], 1.0);
+        } else {
+            reaches[instruction.lhs] = true;
+            if (operands == 2) {
+                reaches[instruction.rhs] = true;
+            }
+        }
+
+        // Operands that must not be negative
+        const Affine& operand = forms[instruction.lhs];
+        if (instruction.op == OpCode::Sqrt || instruction.op == OpCode::Log) {
+            RequireNonNegative(operand, bounds);
+        } else if (instruction.op == OpCode::Power) {
+            const Affine& exponent = forms[instruction.rhs];
+            if (exponent.IsConstant() && exponent.offset != ::std::floor(exponent.offset)) {
+                RequireNonNegative(operand, bounds);
+            }
+        }
+    }
+    return bounds;
+}
+
+::std::vector<::std::pair<double, double>> FindDefinedRanges(const Program& program, double xMin, double xMax,
+                                                             int cells, const double* parameters) {
+    ::std::vector<::std::pair<double, double>> ranges;
+    const DomainBounds bounds = AnalyzeDomain(program, parameters);
+    const double lo = ::std::max(xMin, bounds.lo);
+    const double hi = ::std::min(xMax, bounds.hi);
+    if (!(lo <= hi)) {
+        return ranges;
+    }
+    if (lo == hi) {
+        ranges.emplace_back(lo, hi);
+        return ranges;
+    }
+    CollectDefined(program, lo, hi, (xMax - xMin) / ::std::max(cells, 1), parameters, ranges);
+    return ranges;
+}
+
+} // namespace plot_genius
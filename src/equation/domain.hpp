@@ -0,0 +1,64 @@
+/**
+ * Domain Analysis Header
+ *
+ * Defines where a program can have a value, so that sampling does not
+ * spend evaluations (or storage) on x values that only give NaN, such as
+ * x < 1000 for sqrt(x-1000).
+ *
+ * Two analyses are combined. The static one tracks which slots are affine
+ * in x and turns the sign requirements of sqrt, log and fractional powers
+ * on them into bounds on x, without evaluating anything at sample points.
+ * The range one bisects what is left with interval evaluation and drops
+ * pieces on which no input has a value.
+ */
+
+#pragma once
+
+#include <utility>
+#include <vector>
+#include "program.hpp"
+
+namespace plot_genius {
+
+/// Pieces the range analysis splits a range into at most; finer gaps are evaluated as usual
+constexpr int kMaxDomainCells = 64;
+
+/**
+ * Interval of x outside which a program is provably undefined
+ */
+struct DomainBounds {
+    double lo;  ///< No value below this
+    double hi;  ///< No value above this; less than lo if the program never has a value
+
+    /**
+     * Checks whether the program has no value anywhere
+     *
+     * @return True if the bounds are empty
+     */
+    bool IsEmpty() const { return !(lo <= hi); }
+};
+
+/**
+ * Bounds the domain from the sign requirements on affine operands
+ *
+ * @param program Program to analyze
+ * @param parameters One value per parameter name, or nullptr to use kDefaultParameterValue
+ * @return Bounds containing every x at which the program may have a value
+ */
+DomainBounds AnalyzeDomain(const Program& program, const double* parameters = nullptr);
+
+/**
+ * Finds the parts of a range of x where a program may have a value
+ *
+ * @param program Program to analyze
+ * @param xMin Start of the range
+ * @param xMax End of the range
+ * @param cells Finest pieces the range is split into, in pieces across it
+ * @param parameters One value per parameter name, or nullptr to use kDefaultParameterValue
+ * @return Disjoint, increasing subranges of [xMin, xMax]; outside them the program is undefined
+ */
+std::vector<std::pair<double, double>> FindDefinedRanges(const Program& program, double xMin, double xMax,
+                                                         int cells = kMaxDomainCells,
+                                                         const double* parameters = nullptr);
+
+} // namespace plot_genius
@@ -0,0 +1,133 @@
+/**
+ * Dual Number Evaluation Implementation
+ *
+ * Sums and products follow the Leibniz rule; functions of one operand
+ * apply the chain rule f(u)'' = f''(u) u'^2 + f'(u) u''.
+ */
+
+#include "dual.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace plot_genius {
+
+namespace {
+
+// Applies a function with derivatives d1 and d2 at a.value to a
+Dual Chain(const Dual& a, double value, double d1, double d2) {
+    return {value, d1 * a.first, d2 * a.first * a.first + d1 * a.second};
+}
+
+Dual Multiply(const Dual& a, const Dual& b) {
+    return {a.value * b.value, a.first * b.value + a.value * b.first,
+            a.second * b.value + 2.0 * a.first * b.first + a.value * b.second};
+}
+
+Dual Divide(const Dual& a, const Dual& b) {
+    const double q = a.value / b.value;
+    const double q1 = (a.first - q * b.first) / b.value;
+    return {q, q1, (a.second - 2.0 * q1 * b.first - q * b.second) / b.value};
+}
+
+Dual Power(const Dual& a, const Dual& b) {
+    const double p = ::std::pow(a.value, b.value);
+
+    // A constant exponent also covers negative bases, where log(a) is undefined
+    if (b.first == 0.0 && b.second == 0.0) {
+        const double n = b.value;
+        const double d1 = n == 0.0 ? 0.0 : n * ::std::pow(a.value, n - 1.0);
+        const double d2 = n == 0.0 || n == 1.0 ? 0.0 : n * (n - 1.0) * ::std::pow(a.value, n - 2.0);
+        return Chain(a, p, d1, d2);
+    }
+
+    // a^b = exp(w) with w = b log(a)
+    const double log = ::std::log(a.value);
+    const double ratio = a.first / a.value;
+    const double w1 = b.first * log + b.value * ratio;
+    const double w2 = b.second * log + 2.0 * b.first * ratio + b.value * (a.second / a.value - ratio * ratio);
+    return {p, p * w1, p * (w2 + w1 * w1)};
+}
+
+Dual Apply(OpCode op, const Dual& a, const Dual& b) {
+    switch (op) {
+        case OpCode::Add:
+            return {a.value + b.value, a.first + b.first, a.second + b.second};
+        case OpCode::Subtract:
+            return {a.value - b.value, a.first - b.first, a.second - b.second};
+        case OpCode::Multiply:
+            return Multiply(a, b);
+        case OpCode::Divide:
+            return Divide(a, b);
+        case OpCode::Power:
+            return Power(a, b);
+        case OpCode::Negate:
+            return {-a.value, -a.first, -a.second};
+        case OpCode::Sin: {
+            const double s = ::std::sin(a.value);
+            const double c = ::std::cos(a.value);
+            return Chain(a, s, c, -s);
+        }
+        case OpCode::Cos: {
+            const double s = ::std::sin(a.value);
+            const double c = ::std::cos(a.value);
+            return Chain(a, c, -s, -c);
+        }
+        case OpCode::Tan: {
+            const double t = ::std::tan(a.value);
+            const double d1 = 1.0 + t * t;
+            return Chain(a, t, d1, 2.0 * t * d1);
+        }
+        case OpCode::Sqrt: {
+            const double s = ::std::sqrt(a.value);
+            const double d1 = 0.5 / s;
+            return Chain(a, s, d1, -0.5 * d1 / a.value);
+        }
+        case OpCode::Log: {
+            const double r = 1.0 / a.value;
+            return Chain(a, ::std::log(a.value), r, -r * r);
+        }
+        case OpCode::Exp: {
+            const double e = ::std::exp(a.value);
+            return Chain(a, e, e, e);
+        }
+        case OpCode::Abs: {
+            const double sign = a.value > 0.0 ? 1.0 : (a.value < 0.0 ? -1.0 : 0.0);
+            return Chain(a, ::std::abs(a.value), sign, 0.0);
+        }
+        default:
+            return {};
+    }
+}
+
+} // namespace
+
+Dual EvaluateDual(const Program& program, double x, const double* parameters) {
+    const auto& code = program.GetInstructions();
+    if (code.empty()) {
+        throw ::std::runtime_error("No equation has been compiled");
+    }
+
+    thread_local ::std::vector<Dual> slots;
+    slots.resize(code.size());
+    for (::std::size_t i = 0; i < code.size(); ++i) {
+        const Instruction& instruction = code[i];
+        switch (instruction.op) {
+            case OpCode::Constant:
+                slots[i] = {instruction.value, 0.0, 0.0};
+                break;
+            case OpCode::Variable:
+                slots[i] = {x, 1.0, 0.0};
+                break;
+            case OpCode::Parameter:
+                slots[i] = {parameters ? parameters[instruction.lhs] : kDefaultParameterValue, 0.0, 0.0};
+                break;
+            default:
+                slots[i] = Apply(instruction.op, slots[instruction.lhs], slots[instruction.rhs]);
+                break;
+        }
+    }
+    return slots.back();
+}
+
+} // namespace plot_genius
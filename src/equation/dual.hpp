@@ -0,0 +1,39 @@
+/**
+ * Dual Number Evaluation Header
+ *
+ * Defines forward-mode differentiation of a compiled program: every slot
+ * carries its value together with its first and second derivative with
+ * respect to x, so one pass gives f(x), f'(x) and f''(x) exactly, without
+ * the extra evaluations and cancellation of finite differences.
+ */
+
+#pragma once
+
+#include "program.hpp"
+
+namespace plot_genius {
+
+/**
+ * Value of a function together with its first two derivatives at a point
+ */
+struct Dual {
+    double value{0.0};   ///< f(x)
+    double first{0.0};   ///< f'(x)
+    double second{0.0};  ///< f''(x)
+};
+
+/**
+ * Evaluates a program and its derivatives at one x value
+ *
+ * Where a derivative does not exist (e.g. abs at 0 or sqrt at 0) the
+ * derivative fields are not finite or use the one-sided value.
+ *
+ * @param program Program to evaluate
+ * @param x Value of the variable
+ * @param parameters One value per parameter name, or nullptr to use kDefaultParameterValue
+ * @return f(x), f'(x) and f''(x)
+ * @throws std::runtime_error if the program is empty
+ */
+Dual EvaluateDual(const Program& program, double x, const double* parameters = nullptr);
+
+} // namespace plot_genius
@@ -0,0 +1,67 @@
+/**
+ * Instruction Execution Header
+ *
+ * Inline kernels shared by the evaluators of single programs and program
+ * groups. Internal to the equation code.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include "fast_math.hpp"
+#include "program.hpp"
+
+namespace plot_genius {
+
+/**
+ * Evaluates one instruction whose operands are already in their slots
+ *
+ * @param instruction Instruction to run
+ * @param slots Values of the earlier slots
+ * @param x Value of the variable
+ * @param parameters Parameter values, or nullptr for kDefaultParameterValue
+ * @return Value of the instruction's slot
+ */
+inline double Execute(const Instruction& instruction, const double* slots, double x, const double* parameters) {
+    switch (instruction.op) {
+        case OpCode::Constant:
+            return instruction.value;
+        case OpCode::Variable:
+            return x;
+        case OpCode::Parameter:
+            return parameters ? parameters[instruction.lhs] : kDefaultParameterValue;
+        default:
+            return ApplyOp(instruction.op, slots[instruction.lhs], slots[instruction.rhs]);
+    }
+}
+
+/**
+ * Applies an operation element-wise; the switch is outside the loops so they vectorize
+ *
+ * @param op Operation with one or two operands
+ * @param a First operands
+ * @param b Second operands (ignored by unary operations)
+ * @param out Receives n results
+ * @param n Number of elements
+ * @param precision Whether the built-in functions use the fast kernels
+ */
+inline void ApplyTile(OpCode op, const double* a, const double* b, double* out, ::std::size_t n,
+                      MathPrecision precision) {
+    if (precision == MathPrecision::Fast && HasFastKernel(op)) {
+        ApplyFast(op, a, b, out, n);
+        return;
+    }
+    switch (op) {
+        case OpCode::Add:      for (::std::size_t i = 0; i < n; ++i) out[i] = a[i] + b[i]; break;
+        case OpCode::Subtract: for (::std::size_t i = 0; i < n; ++i) out[i] = a[i] - b[i]; break;
+        case OpCode::Multiply: for (::std::size_t i = 0; i < n; ++i) out[i] = a[i] * b[i]; break;
+        case OpCode::Divide:   for (::std::size_t i = 0; i < n; ++i) out[i] = a[i] / b[i]; break;
+        case OpCode::Negate:   for (::std::size_t i = 0; i < n; ++i) out[i] = -a[i]; break;
+        case OpCode::Abs:      for (::std::size_t i = 0; i < n; ++i) out[i] = ::std::abs(a[i]); break;
+        case OpCode::Sqrt:     for (::std::size_t i = 0; i < n; ++i) out[i] = ::std::sqrt(a[i]); break;
+        default:               for (::std::size_t i = 0; i < n; ++i) out[i] = ApplyOp(op, a[i], b[i]); break;
+    }
+}
+
+} // namespace plot_genius
@@ -0,0 +1,124 @@
+/**
+ * Expression Tree Implementation
+ *
+ * Implements construction, copying and formatting of expression trees.
+ */
+
+#include "expression.hpp"
+#include <cstdio>
+
+namespace plot_genius {
+
+int GetOperandCount(OpCode op) {
+    switch (op) {
+        case OpCode::Constant:
+        case OpCode::Variable:
+        case OpCode::Parameter:
+            return 0;
+        case OpCode::Add:
+        case OpCode::Subtract:
+        case OpCode::Multiply:
+        case OpCode::Divide:
+        case OpCode::Power:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+const char* GetFunctionName(OpCode op) {
+    switch (op) {
+        case OpCode::Power: return "pow";
+        case OpCode::Sin:   return "sin";
+        case OpCode::Cos:   return "cos";
+        case OpCode::Tan:   return "tan";
+        case OpCode::Sqrt:  return "sqrt";
+        case OpCode::Log:   return "log";
+        case OpCode::Exp:   return "exp";
+        case OpCode::Abs:   return "abs";
+        default:            return nullptr;
+    }
+}
+
+::std::unique_ptr<ExpressionNode> MakeConstant(double value) {
+    auto node = ::std::make_unique<ExpressionNode>();
+    node->op = OpCode::Constant;
+    node->value = value;
+    return node;
+}
+
+::std::unique_ptr<ExpressionNode> MakeVariable() {
+    auto node = ::std::make_unique<ExpressionNode>();
+    node->op = OpCode::Variable;
+    return node;
+}
+
+::std::unique_ptr<ExpressionNode> MakeParameter(const ::std::string& name) {
+    auto node = ::std::make_unique<ExpressionNode>();
+    node->op = OpCode::Parameter;
+    node->name = name;
+    return node;
+}
+
+::std::unique_ptr<ExpressionNode> MakeOperation(OpCode op, ::std::unique_ptr<ExpressionNode> left,
+                                                ::std::unique_ptr<ExpressionNode> right) {
+    auto node = ::std::make_unique<ExpressionNode>();
+    node->op = op;
+    node->left = ::std::move(left);
+    node->right = ::std::move(right);
+    return node;
+}
+
+::std::unique_ptr<ExpressionNode> CloneExpression(const ExpressionNode& node) {
+    auto copy = ::std::make_unique<ExpressionNode>();
+    copy->op = node.op;
+    copy->value = node.value;
+    copy->name = node.name;
+    if (node.left) {
+        copy->left = CloneExpression(*node.left);
+    }
+    if (node.right) {
+        copy->right = CloneExpression(*node.right);
+    }
+    return copy;
+}
+
+/**
+ * Formats an expression tree
+ *
+ * Binary operators are always parenthesized so the text parses back into
+ * the same tree regardless of precedence.
+ *
+ * @param node Root of the tree
+ * @return Expression text
+ */
+::std::string FormatExpression(const ExpressionNode& node) {
+    switch (node.op) {
+        case OpCode::Constant: {
+            // Round-trips every double exactly
+            char digits[32];
+            ::std::snprintf(digits, sizeof(digits), "%.17g", node.value);
+            return node.value < 0 ? "(" + ::std::string(digits) + ")" : ::std::string(digits);
+        }
+        case OpCode::Variable:
+            return "x";
+        case OpCode::Parameter:
+            return node.name;
+        case OpCode::Add:
+            return "(" + FormatExpression(*node.left) + "+" + FormatExpression(*node.right) + ")";
+        case OpCode::Subtract:
+            return "(" + FormatExpression(*node.left) + "-" + FormatExpression(*node.right) + ")";
+        case OpCode::Multiply:
+            return "(" + FormatExpression(*node.left) + "*" + FormatExpression(*node.right) + ")";
+        case OpCode::Divide:
+            return "(" + FormatExpression(*node.left) + "/" + FormatExpression(*node.right) + ")";
+        case OpCode::Power:
+            return "pow(" + FormatExpression(*node.left) + "," + FormatExpression(*node.right) + ")";
+        case OpCode::Negate:
+            return "(-" + FormatExpression(*node.left) + ")";
+        default:
+            return ::std::string(GetFunctionName(node.op)) + "(" + FormatExpression(*node.left) + ")";
+    }
+}
+
+} // namespace plot_genius
@@ -0,0 +1,146 @@
+/**
+ * Expression Tree Header
+ *
+ * Defines the operations shared by parsed expression trees and compiled
+ * programs, and the tree representation the parser produces.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace plot_genius {
+
+/**
+ * Operations of expression trees and programs
+ *
+ * Values are stored in session files, so new operations go before Count.
+ */
+enum class OpCode : std::uint8_t {
+    Constant,  ///< Literal or named constant
+    Variable,  ///< The variable x
+    Add,
+    Subtract,
+    Multiply,
+    Divide,
+    Power,     ///< pow(a, b)
+    Negate,
+    Sin,
+    Cos,
+    Tan,
+    Sqrt,
+    Log,
+    Exp,
+    Abs,
+    Parameter, ///< Named parameter bound at evaluation time
+    Count      ///< Number of operations (not an operation)
+};
+
+/**
+ * Gets the number of operands an operation takes
+ *
+ * @param op Operation
+ * @return 0, 1 or 2
+ */
+int GetOperandCount(OpCode op);
+
+/**
+ * Gets the function name of a unary function (e.g. "sin")
+ *
+ * @param op Operation
+ * @return Function name, or nullptr if the operation is not a named function
+ */
+const char* GetFunctionName(OpCode op);
+
+/**
+ * Applies an operation to already evaluated operands
+ *
+ * @param op Operation other than Constant, Variable and Parameter
+ * @param a First operand
+ * @param b Second operand (ignored by unary operations)
+ * @return Result of the operation
+ */
+inline double ApplyOp(OpCode op, double a, double b) {
+    switch (op) {
+        case OpCode::Add:      return a + b;
+        case OpCode::Subtract: return a - b;
+        case OpCode::Multiply: return a * b;
+        case OpCode::Divide:   return a / b;
+        case OpCode::Power:    return std::pow(a, b);
+        case OpCode::Negate:   return -a;
+        case OpCode::Sin:      return std::sin(a);
+        case OpCode::Cos:      return std::cos(a);
+        case OpCode::Tan:      return std::tan(a);
+        case OpCode::Sqrt:     return std::sqrt(a);
+        case OpCode::Log:      return std::log(a);
+        case OpCode::Exp:      return std::exp(a);
+        case OpCode::Abs:      return std::abs(a);
+        default:               return 0.0;
+    }
+}
+
+/**
+ * Node of an expression tree
+ */
+struct ExpressionNode {
+    OpCode op{OpCode::Constant};            ///< Operation at this node
+    double value{0.0};                      ///< Value of a Constant node
+    std::string name;                       ///< Name of a Parameter node
+    std::unique_ptr<ExpressionNode> left;   ///< First operand
+    std::unique_ptr<ExpressionNode> right;  ///< Second operand of binary operations
+};
+
+/**
+ * Creates a constant node
+ *
+ * @param value Constant value
+ * @return New node
+ */
+std::unique_ptr<ExpressionNode> MakeConstant(double value);
+
+/**
+ * Creates a node for the variable x
+ *
+ * @return New node
+ */
+std::unique_ptr<ExpressionNode> MakeVariable();
+
+/**
+ * Creates a node for a named parameter
+ *
+ * @param name Parameter name
+ * @return New node
+ */
+std::unique_ptr<ExpressionNode> MakeParameter(const std::string& name);
+
+/**
+ * Creates an operation node
+ *
+ * @param op Unary or binary operation
+ * @param left First operand
+ * @param right Second operand (binary operations only)
+ * @return New node
+ */
+std::unique_ptr<ExpressionNode> MakeOperation(OpCode op, std::unique_ptr<ExpressionNode> left,
+                                              std::unique_ptr<ExpressionNode> right = nullptr);
+
+/**
+ * Deep-copies an expression tree
+ *
+ * @param node Root of the tree to copy
+ * @return Copy of the tree
+ */
+std::unique_ptr<ExpressionNode> CloneExpression(const ExpressionNode& node);
+
+/**
+ * Formats an expression tree as text the parser accepts (without "y=")
+ *
+ * @param node Root of the tree
+ * @return Fully parenthesized expression text
+ */
+std::string FormatExpression(const ExpressionNode& node);
+
+} // namespace plot_genius
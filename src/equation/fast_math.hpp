@@ -0,0 +1,79 @@
+/**
+ * Fast Math Header
+ *
+ * Defines vectorized versions of the built-in functions for evaluating
+ * many x values at once. The standard library computes sin, exp or pow
+ * one value per call, correctly rounded or nearly so, and that cost
+ * dominates most equations once the evaluators themselves are cheap. The
+ * fast kernels process two (SSE2) or four (AVX2) values per instruction
+ * and give up a few units in the last place, which no plot can show.
+ *
+ * Trigonometric arguments are reduced with pi/2 split in four parts, exp
+ * and log use table-free polynomials, and pow takes its logarithm from a
+ * table in double-double, since the exponent multiplies that error. The
+ * widest instruction set is picked at run time, and
+ * benchmarks/fast_math_benchmark checks the error bound.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "expression.hpp"
+
+namespace plot_genius {
+
+/**
+ * How programs compute the built-in functions
+ */
+enum class MathPrecision : std::uint8_t {
+    Precise,  ///< Standard library functions, within 1 ULP
+    Fast      ///< Vectorized kernels, within kFastMathMaxUlps
+};
+
+/// Largest error of the fast kernels, in units in the last place of the result
+constexpr double kFastMathMaxUlps = 4.0;
+
+/// Largest |x| sin, cos and tan reduce in vector code; beyond it they use the standard library
+constexpr double kFastTrigLimit = 1e5;
+
+/**
+ * Gets the display name of a precision
+ *
+ * @param precision Precision
+ * @return Lowercase name, e.g. "fast"
+ */
+const char* GetPrecisionName(MathPrecision precision);
+
+/**
+ * Checks whether an operation has a fast kernel
+ *
+ * @param op Operation
+ * @return True for sin, cos, tan, exp, log, sqrt and pow
+ */
+bool HasFastKernel(OpCode op);
+
+/**
+ * Applies an operation element-wise with the fast kernels
+ *
+ * The error bound holds for every input, including those where the
+ * kernels hand over to the standard library: zero, negative, infinite and
+ * NaN arguments of log and pow, and trigonometric arguments beyond
+ * kFastTrigLimit. sqrt is correctly rounded, as in the precise mode.
+ *
+ * @param op Operation for which HasFastKernel is true
+ * @param a First operands
+ * @param b Second operands, only read by pow
+ * @param out Receives n results; may be the same buffer as a or b
+ * @param n Number of elements
+ */
+void ApplyFast(OpCode op, const double* a, const double* b, double* out, std::size_t n);
+
+/**
+ * Gets the instruction set the fast kernels run on
+ *
+ * @return "avx2", "sse2", "vector" (128-bit vectors of another target) or "scalar"
+ */
+const char* GetFastMathTarget();
+
+} // namespace plot_genius
@@ -0,0 +1,58 @@
+/**
+ * Fast Math AVX2 Implementation
+ *
+ * The kernels at four doubles per vector. The build compiles this file,
+ * and only this file, for AVX2 and FMA; fast_math.cpp calls into it only
+ * on CPUs that have both. Nothing here may use inline functions shared
+ * with other files, since the linker could keep the AVX2 copy for all.
+ */
+
+#include "fast_math_kernels.hpp"
+
+#if PLOT_GENIUS_VECTOR_MATH && defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+
+namespace plot_genius {
+
+namespace {
+
+struct Vector256 {
+    typedef double Double __attribute__((vector_size(32)));
+    typedef ::std::uint64_t Bits __attribute__((vector_size(32)));
+
+    static constexpr bool kHasFma = true;
+
+    static Double Sqrt(Double v) {
+        return _mm256_sqrt_pd(v);
+    }
+
+    static Double Fma(Double a, Double b, Double c) {
+        return _mm256_fmadd_pd(a, b, c);
+    }
+};
+
+} // namespace
+
+void ApplyFastAvx2(OpCode op, const double* a, const double* b, double* out, ::std::size_t n) {
+    fast_math::Kernels<Vector256>::Apply(op, a, b, out, n);
+}
+
+bool HasAvx2Kernels() {
+    return true;
+}
+
+} // namespace plot_genius
+
+#else
+
+namespace plot_genius {
+
+void ApplyFastAvx2(OpCode, const double*, const double*, double*, ::std::size_t) {}
+
+bool HasAvx2Kernels() {
+    return false;
+}
+
+} // namespace plot_genius
+
+#endif
@@ -0,0 +1,460 @@
+/**
+ * Fast Math Kernels Header
+ *
+ * The algorithms of the fast kernels, written once over a vector type so
+ * each instruction set instantiates them at its own width. Internal to the
+ * equation code: only the translation units that define a vector type
+ * include it, each compiled for its instruction set, and they keep every
+ * instantiation local so no code built for AVX2 leaks into the others.
+ *
+ * The functions follow fdlibm: arguments are reduced with constants split
+ * so the products of their high parts are exact, then small polynomials
+ * finish the job. pow carries log(a) in two doubles, since any error in it
+ * is multiplied by b before the exponential; it looks up log(c) for a c
+ * near a in a table, as glibc does, so only the tiny log(a/c) is left to a
+ * polynomial and the sum is good to about 2^-68.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "expression.hpp"
+#include "fast_math.hpp"
+
+#if defined(__GNUC__)
+#define PLOT_GENIUS_VECTOR_MATH 1
+#endif
+
+namespace plot_genius {
+
+/**
+ * Applies an operation with 128-bit vectors (SSE2 on x86)
+ */
+void ApplyFastVector128(OpCode op, const double* a, const double* b, double* out, ::std::size_t n);
+
+/**
+ * Applies an operation with AVX2 and FMA; only call if HasAvx2Kernels and the CPU supports both
+ */
+void ApplyFastAvx2(OpCode op, const double* a, const double* b, double* out, ::std::size_t n);
+
+/**
+ * Checks whether the AVX2 kernels were built
+ *
+ * @return False if the compiler could not target AVX2
+ */
+bool HasAvx2Kernels();
+
+#if PLOT_GENIUS_VECTOR_MATH
+
+namespace fast_math {
+
+// Adding this rounds a double below 2^51 in magnitude to an integer, held in the low mantissa bits
+constexpr double kShifter = 6755399441055744.0;  // 1.5 * 2^52
+constexpr ::std::uint64_t kSignBit = 0x8000000000000000ull;
+constexpr ::std::uint64_t kMantissa = 0x000fffffffffffffull;
+
+// log(2) split so its high part times any exponent is exact
+constexpr double kLn2Hi = 6.93147180369123816490e-01;
+constexpr double kLn2Lo = 1.90821492927058770002e-10;
+constexpr double kLog2e = 1.44269504088896338700e+00;
+
+// Bits of sqrt(2)/2, the lower end of the mantissa range log works on
+constexpr ::std::uint64_t kSqrtHalfBits = 0x3fe6a09e667f3bcdull;
+
+// pi/2 in four parts (fdlibm pio2_1, pio2_2, pio2_3, pio2_3t); the first three have 33 bits, so n times them is
+// exact for n below 2^20, and together they hold pi/2 to about 2^-150
+constexpr double kTwoOverPi = 6.36619772367581382433e-01;
+constexpr double kPiOver2Part1 = 1.57079632673412561417e+00;
+constexpr double kPiOver2Part2 = 6.07710050630396597660e-11;
+constexpr double kPiOver2Part3 = 2.02226624871116645580e-21;
+constexpr double kPiOver2Part4 = 8.47842766036889956997e-32;
+
+// Minimax coefficients on [-pi/4, pi/4] (fdlibm __kernel_sin and __kernel_cos)
+constexpr double kSin[] = {-1.66666666666666324348e-01, 8.33333333332248946124e-03, -1.98412698298579493134e-04,
+                           2.75573137070700676789e-06, -2.50507602534068634195e-08, 1.58969099521155010221e-10};
+constexpr double kCos[] = {4.16666666666666019037e-02, -1.38888888888741095749e-03, 2.48015872894767294178e-05,
+                           -2.75573143513906633035e-07, 2.08757232129817482790e-09, -1.13596475577881948265e-11};
+
+// Minimax coefficients of log((1+s)/(1-s)) = 2s + s*R(s*s) (fdlibm __ieee754_log)
+constexpr double kLog[] = {6.666666666666735130e-01, 3.999999999940941908e-01, 2.857142874366239149e-01,
+                           2.222219843214978396e-01, 1.818357216161805012e-01, 1.531383769920937332e-01,
+                           1.479819860511658591e-01};
+
+// Taylor coefficients of log(1+r) - r + r*r/2 for k = 3..9; |r| < 2^-7 leaves an error below 2^-73
+constexpr double kLog1p[] = {1.0 / 3, -1.0 / 4, 1.0 / 5, -1.0 / 6, 1.0 / 7, -1.0 / 8, 1.0 / 9};
+
+// pow's logarithm splits the mantissa range [kLogTableOffset, 2 * kLogTableOffset) into kLogTableSize parts
+constexpr ::std::size_t kLogTableBits = 7;
+constexpr ::std::size_t kLogTableSize = ::std::size_t{1} << kLogTableBits;
+constexpr ::std::uint64_t kLogTableOffset = 0x3fe6955500000000ull;
+
+/**
+ * Point c of a part of the mantissa range, chosen so 1/c has few bits
+ */
+struct LogTableEntry {
+    double invc;      ///< 1/c, so z/c - 1 is exact with one multiply-add
+    double logc;      ///< log(c) rounded to 43 fractional bits, so k*ln(2) + logc is exact
+    double logcTail;  ///< log(c) - logc
+};
+
+/// Defined in fast_math.cpp
+extern const LogTableEntry kLogTable[kLogTableSize];
+
+// Taylor coefficients 1/k! of exp for k = 2..13; enough for |r| <= ln(2)/2
+constexpr double kExp[] = {1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720, 1.0 / 5040, 1.0 / 40320,
+                           1.0 / 362880, 1.0 / 3628800, 1.0 / 39916800, 1.0 / 479001600, 1.0 / 6227020800};
+
+// Beyond these exp has overflowed or underflowed completely
+constexpr double kExpMax = 720.0;
+constexpr double kExpMin = -760.0;
+
+/**
+ * Kernels over one vector type
+ *
+ * Traits provides Double (a GCC vector of doubles), Bits (the unsigned
+ * 64-bit vector of the same width), Sqrt, and Fma, which pow only uses
+ * where kHasFma says the target computes it in hardware.
+ */
+template <typename Traits>
+struct Kernels {
+    using Double = typename Traits::Double;
+    using Bits = typename Traits::Bits;
+    static constexpr ::std::size_t kLanes = sizeof(Double) / sizeof(double);
+
+    template <typename To, typename From>
+    static To Cast(const From& from) {
+        static_assert(sizeof(To) == sizeof(From), "Casts reinterpret whole vectors");
+        To to;
+        ::std::memcpy(&to, &from, sizeof(to));
+        return to;
+    }
+
+    static Double Splat(double value) {
+        Double v;
+        for (::std::size_t i = 0; i < kLanes; ++i) {
+            v[i] = value;
+        }
+        return v;
+    }
+
+    static Bits SplatBits(::std::uint64_t value) {
+        return Cast<Bits>(Splat(0.0)) | value;
+    }
+
+    // Comparisons give all ones per true lane; NaN compares false
+    static Bits Mask(decltype(Double{} < Double{}) comparison) {
+        return Cast<Bits>(comparison);
+    }
+
+    static Double Select(Bits mask, Double a, Double b) {
+        return Cast<Double>((mask & Cast<Bits>(a)) | (~mask & Cast<Bits>(b)));
+    }
+
+    static bool Any(Bits mask) {
+        ::std::uint64_t any = 0;
+        for (::std::size_t i = 0; i < kLanes; ++i) {
+            any |= mask[i];
+        }
+        return any != 0;
+    }
+
+    static Double Abs(Double v) {
+        return Cast<Double>(Cast<Bits>(v) & ~kSignBit);
+    }
+
+    static Double Load(const double* p) {
+        Double v;
+        ::std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static void Store(double* p, Double v) {
+        ::std::memcpy(p, &v, sizeof(v));
+    }
+
+    // a*b = p + e exactly; only used where the target has FMA
+    static Double TwoProduct(Double a, Double b, Double& e) {
+        const Double p = a * b;
+        e = Traits::Fma(a, b, -p);
+        return p;
+    }
+
+    // a+b = s + e exactly
+    static Double TwoSum(Double a, Double b, Double& e) {
+        const Double s = a + b;
+        const Double bb = s - a;
+        e = (a - (s - bb)) + (b - bb);
+        return s;
+    }
+
+    // exp(hi + lo), where lo is below an ulp of hi
+    static Double Exp(Double hi, Double lo) {
+        lo = Select(Mask(Abs(hi) <= Splat(kExpMax)), lo, Splat(0.0));
+        hi = Select(Mask(hi > Splat(kExpMax)), Splat(kExpMax), hi);
+        hi = Select(Mask(hi < Splat(kExpMin)), Splat(kExpMin), hi);
+
+        // hi = n*ln(2) + r with |r| <= ln(2)/2; NaN passes through r
+        const Double t = hi * kLog2e + kShifter;
+        const Double n = t - kShifter;
+        const Double r = (hi - n * kLn2Hi) + (lo - n * kLn2Lo);
+
+        // Estrin's scheme; Horner's rule would chain twelve multiply-adds
+        const Double r2 = r * r;
+        const Double r4 = r2 * r2;
+        const Double low = (kExp[0] + kExp[1] * r) + (kExp[2] + kExp[3] * r) * r2;
+        const Double middle = (kExp[4] + kExp[5] * r) + (kExp[6] + kExp[7] * r) * r2;
+        const Double high = (kExp[8] + kExp[9] * r) + (kExp[10] + kExp[11] * r) * r2;
+        const Double p = 1.0 + (r + r2 * (low + (middle + high * r4) * r4));
+
+        // 2^n in two factors, so results between the subnormals and overflow need no special case
+        const Bits shifter = SplatBits(Cast<::std::uint64_t>(kShifter));
+        const Bits k = Cast<Bits>(t) - shifter;
+        const Bits k1 = Cast<Bits>(n * 0.5 + kShifter) - shifter;
+        const Bits k2 = k - k1;
+        return p * Cast<Double>((k1 + 1023ull) << 52) * Cast<Double>((k2 + 1023ull) << 52);
+    }
+
+    // Splits a positive normal x into 2^k * m with m in [sqrt(2)/2, sqrt(2)); returns m - 1, exactly
+    static Double Reduce(Double x, Double& k) {
+        const Bits bits = Cast<Bits>(x) + (0x3ff0000000000000ull - kSqrtHalfBits);
+        k = Cast<Double>((bits >> 52) | 0x4330000000000000ull) - (4503599627370496.0 + 1023.0);
+        return Cast<Double>((bits & kMantissa) + kSqrtHalfBits) - 1.0;
+    }
+
+    // R of log((1+s)/(1-s)) = 2s + s*R, from z = s*s
+    static Double LogTail(Double z) {
+        const Double w = z * z;
+        const Double odd = z * (kLog[0] + w * (kLog[2] + w * (kLog[4] + w * kLog[6])));
+        const Double even = w * (kLog[1] + w * (kLog[3] + w * kLog[5]));
+        return odd + even;
+    }
+
+    // Positive normal x only
+    static Double Log(Double x) {
+        Double k;
+        const Double f = Reduce(x, k);
+        const Double s = f / (2.0 + f);
+        const Double halfSquare = 0.5 * f * f;
+        return k * kLn2Hi - ((halfSquare - (s * (halfSquare + LogTail(s * s)) + k * kLn2Lo)) - f);
+    }
+
+    // log(x) = hi + lo to about 2^-68 relative (glibc's pow_log_inline); positive normal x and FMA targets only
+    static Double Log(Double x, Double& lo) {
+        // x = 2^k * z with z in the table's range; k is biased by 2048 so it converts like an unsigned value
+        const Bits offset = Cast<Bits>(x) - kLogTableOffset;
+        const Double z = Cast<Double>(Cast<Bits>(x) - (offset & (0xfffull << 52)));
+        const Bits biased = (offset + (0x800ull << 52)) >> 52;
+        const Double k = Cast<Double>(biased | 0x4330000000000000ull) - (4503599627370496.0 + 2048.0);
+
+        Double invc;
+        Double logc;
+        Double logcTail;
+        for (::std::size_t lane = 0; lane < kLanes; ++lane) {
+            const LogTableEntry& entry = kLogTable[(offset[lane] >> (52 - kLogTableBits)) % kLogTableSize];
+            invc[lane] = entry.invc;
+            logc[lane] = entry.logc;
+            logcTail[lane] = entry.logcTail;
+        }
+
+        // log(x) = k*ln(2) + log(c) + log1p(r) with |r| < 2^-7; every rounding error is kept in lo
+        const Double r = Traits::Fma(z, invc, Splat(-1.0));
+        const Double t1 = k * kLn2Hi + logc;
+        const Double t2 = t1 + r;
+        const Double lo1 = k * kLn2Lo + logcTail;
+        const Double lo2 = (t1 - t2) + r;
+        const Double halfR = -0.5 * r;
+        const Double halfSquare = r * halfR;
+        const Double hi = t2 + halfSquare;
+        const Double lo3 = Traits::Fma(halfR, r, -halfSquare);
+        const Double lo4 = (t2 - hi) + halfSquare;
+
+        const Double r2 = r * r;
+        const Double high = (kLog1p[4] + r * kLog1p[5]) + r2 * kLog1p[6];
+        const Double p = r2 * r * ((kLog1p[0] + r * kLog1p[1]) + r2 * ((kLog1p[2] + r * kLog1p[3]) + r2 * high));
+        const Double tail = lo1 + lo2 + lo3 + lo4 + p;
+        const Double sum = hi + tail;
+        lo = (hi - sum) + tail;
+        return sum;
+    }
+
+    // Lanes of special are set where the caller must use the standard library
+    static Double Log(Double x, Bits& special) {
+        special = ~(Mask(x >= Splat(0x1p-1022)) & Mask(x <= Splat(0x1.fffffffffffffp1023)));
+        return Log(Select(special, Splat(1.0), x));
+    }
+
+    static Double Power(Double a, Double b, Bits& special) {
+        const Double base = Abs(a);
+        special = ~(Mask(base >= Splat(0x1p-1022)) & Mask(base <= Splat(0x1.fffffffffffffp1023)) &
+                    Mask(Abs(b) < Splat(0x1p51)));
+        const Double x = Select(special, Splat(1.0), base);
+        const Double y = Select(special, Splat(0.0), b);
+
+        Double logLo;
+        const Double logHi = Log(x, logLo);
+        Double productLo;
+        const Double product = TwoProduct(y, logHi, productLo);
+        Double result = Exp(product, productLo + y * logLo);
+
+        // Negative bases have real powers only at integer exponents, negative at odd ones
+        const Double rounded = y + kShifter;
+        const Bits integer = Mask(rounded - kShifter == y);
+        const Bits negative = Mask(a < Splat(0.0));
+        result = Cast<Double>(Cast<Bits>(result) ^ (negative & (Cast<Bits>(rounded) << 63)));
+        return Select(negative & ~integer, Splat(NAN), result);
+    }
+
+    enum class Trig { Sin, Cos, Tan };
+
+    template <Trig Function>
+    static Double Trigonometric(Double x, Bits& special) {
+        special = ~Mask(Abs(x) <= Splat(kFastTrigLimit));
+        const Double reduced = Select(special, Splat(0.0), x);
+
+        // x = n*pi/2 + r with |r| <= pi/4; the quadrant is in the low bits of t
+        const Double t = reduced * kTwoOverPi + kShifter;
+        const Double n = t - kShifter;
+        const Bits quadrant = Cast<Bits>(t);
+        // Next to a multiple of pi/2, r is as small as 2^-60, so the differences after the first, which is exact,
+        // keep their rounding errors; anything less loses up to 1e5 ulp below kFastTrigLimit
+        Double error2;
+        Double error3;
+        const Double r1 = reduced - n * kPiOver2Part1;
+        const Double r2 = TwoSum(r1, -(n * kPiOver2Part2), error2);
+        const Double r3 = TwoSum(r2, -(n * kPiOver2Part3), error3);
+        const Double r = r3 + ((error2 + error3) - n * kPiOver2Part4);
+
+        const Double z = r * r;
+        // r + r*z*... would turn -0 into +0
+        const Double s = Select(Mask(z == Splat(0.0)), r, r + r * z * (kSin[0] + z * (kSin[1] + z * (kSin[2] +
+                                                            z * (kSin[3] + z * (kSin[4] + z * kSin[5]))))));
+        const Double half = 0.5 * z;
+        const Double w = 1.0 - half;
+        const Double c = w + (((1.0 - w) - half) +
+                              z * z * (kCos[0] + z * (kCos[1] + z * (kCos[2] + z * (kCos[3] + z * (kCos[4] +
+                                                                                                  z * kCos[5]))))));
+
+        // Odd quadrants swap sin and cos
+        const Bits swap = 0ull - (quadrant & 1ull);
+        if constexpr (Function == Trig::Sin) {
+            return Cast<Double>(Cast<Bits>(Select(swap, c, s)) ^ ((quadrant & 2ull) << 62));
+        } else if constexpr (Function == Trig::Cos) {
+            return Cast<Double>(Cast<Bits>(Select(swap, s, c)) ^ (((quadrant + 1ull) & 2ull) << 62));
+        } else {
+            const Double ratio = Select(swap, c, s) / Select(swap, s, c);
+            return Cast<Double>(Cast<Bits>(ratio) ^ (swap & kSignBit));
+        }
+    }
+
+    // Applies a vector function, then the standard library to lanes it marks as special
+    template <typename Function, typename Fallback>
+    static void Map(const double* a, double* out, ::std::size_t n, Function function, Fallback fallback) {
+        auto step = [&](const double* in, double* result) {
+            const Double x = Load(in);
+            Bits special;
+            Store(result, function(x, special));
+            if (Any(special)) {
+                for (::std::size_t lane = 0; lane < kLanes; ++lane) {
+                    if (special[lane]) {
+                        result[lane] = fallback(x[lane]);
+                    }
+                }
+            }
+        };
+
+        ::std::size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes) {
+            step(a + i, out + i);
+        }
+        if (i < n) {
+            double in[kLanes];
+            double result[kLanes];
+            for (::std::size_t lane = 0; lane < kLanes; ++lane) {
+                in[lane] = i + lane < n ? a[i + lane] : 1.0;
+            }
+            step(in, result);
+            ::std::memcpy(out + i, result, (n - i) * sizeof(double));
+        }
+    }
+
+    static void MapPower(const double* a, const double* b, double* out, ::std::size_t n) {
+        auto step = [](const double* inA, const double* inB, double* result) {
+            const Double x = Load(inA);
+            const Double y = Load(inB);
+            Bits special;
+            Store(result, Power(x, y, special));
+            if (Any(special)) {
+                for (::std::size_t lane = 0; lane < kLanes; ++lane) {
+                    if (special[lane]) {
+                        result[lane] = ::std::pow(x[lane], y[lane]);
+                    }
+                }
+            }
+        };
+
+        ::std::size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes) {
+            step(a + i, b + i, out + i);
+        }
+        if (i < n) {
+            double inA[kLanes];
+            double inB[kLanes];
+            double result[kLanes];
+            for (::std::size_t lane = 0; lane < kLanes; ++lane) {
+                inA[lane] = i + lane < n ? a[i + lane] : 1.0;
+                inB[lane] = i + lane < n ? b[i + lane] : 1.0;
+            }
+            step(inA, inB, result);
+            ::std::memcpy(out + i, result, (n - i) * sizeof(double));
+        }
+    }
+
+    static void Apply(OpCode op, const double* a, const double* b, double* out, ::std::size_t n) {
+        const auto none = [](double) { return 0.0; };
+        switch (op) {
+            case OpCode::Sin:
+                Map(a, out, n, [](Double x, Bits& special) { return Trigonometric<Trig::Sin>(x, special); },
+                    [](double x) { return ::std::sin(x); });
+                break;
+            case OpCode::Cos:
+                Map(a, out, n, [](Double x, Bits& special) { return Trigonometric<Trig::Cos>(x, special); },
+                    [](double x) { return ::std::cos(x); });
+                break;
+            case OpCode::Tan:
+                Map(a, out, n, [](Double x, Bits& special) { return Trigonometric<Trig::Tan>(x, special); },
+                    [](double x) { return ::std::tan(x); });
+                break;
+            case OpCode::Exp:
+                Map(a, out, n, [](Double x, Bits& special) { special = Bits{}; return Exp(x, Splat(0.0)); }, none);
+                break;
+            case OpCode::Log:
+                Map(a, out, n, [](Double x, Bits& special) { return Log(x, special); },
+                    [](double x) { return ::std::log(x); });
+                break;
+            case OpCode::Sqrt:
+                Map(a, out, n, [](Double x, Bits& special) { special = Bits{}; return Traits::Sqrt(x); }, none);
+                break;
+            case OpCode::Power:
+                // Without FMA the exact products of the two-double logarithm cost more than the vectors save
+                if constexpr (Traits::kHasFma) {
+                    MapPower(a, b, out, n);
+                } else {
+                    for (::std::size_t i = 0; i < n; ++i) {
+                        out[i] = ::std::pow(a[i], b[i]);
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+} // namespace fast_math
+
+#endif
+
+} // namespace plot_genius
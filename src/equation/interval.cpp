@@ -0,0 +1,269 @@
+/**
+ * Interval Arithmetic Implementation
+ *
+ * Each operation maps operand ranges to a range enclosing every result.
+ * Monotonic functions only need their end points; sin, cos and tan also
+ * check which extrema and poles fall inside the range.
+ */
+
+#include "interval.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace plot_genius {
+
+namespace {
+
+constexpr double kInfinity = ::std::numeric_limits<double>::infinity();
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kTwoPi = 2.0 * kPi;
+
+// Beyond this magnitude a double cannot resolve a period of sin, so nothing is checked
+constexpr double kLargestReducible = 1e12;
+
+// Slack, in periods, when checking whether an extremum or pole lies inside a range
+constexpr double kPeriodSlack = 1e-9;
+
+Interval Empty() {
+    const double nan = ::std::numeric_limits<double>::quiet_NaN();
+    return {nan, nan, true};
+}
+
+Interval Entire(bool partial) {
+    return {-kInfinity, kInfinity, partial};
+}
+
+Interval Point(double value) {
+    return {value, value, false};
+}
+
+// Rounds bounds outward by one ulp; undetermined bounds (inf - inf) become unbounded
+Interval Widen(double lo, double hi, bool partial) {
+    lo = ::std::isnan(lo) ? -kInfinity : ::std::nextafter(lo, -kInfinity);
+    hi = ::std::isnan(hi) ? kInfinity : ::std::nextafter(hi, kInfinity);
+    return {lo, hi, partial};
+}
+
+// Range spanned by four candidate bounds; any NaN makes it unbounded
+Interval Hull(double a, double b, double c, double d, bool partial) {
+    if (::std::isnan(a) || ::std::isnan(b) || ::std::isnan(c) || ::std::isnan(d)) {
+        return Entire(partial);
+    }
+    return Widen(::std::min({a, b, c, d}), ::std::max({a, b, c, d}), partial);
+}
+
+// Product of bounds in which zero times infinity is zero
+double Product(double a, double b) {
+    return a == 0.0 || b == 0.0 ? 0.0 : a * b;
+}
+
+bool Contains(const Interval& range, double value) {
+    return range.lo <= value && value <= range.hi;
+}
+
+// Checks whether phase + k * period lies in [lo, hi] for some integer k
+bool ContainsPeriodic(double lo, double hi, double phase, double period) {
+    return ::std::floor((hi - phase) / period + kPeriodSlack) >= ::std::ceil((lo - phase) / period - kPeriodSlack);
+}
+
+Interval Multiply(const Interval& a, const Interval& b, bool partial) {
+    return Hull(Product(a.lo, b.lo), Product(a.lo, b.hi), Product(a.hi, b.lo), Product(a.hi, b.hi), partial);
+}
+
+Interval Divide(const Interval& a, const Interval& b, bool partial) {
+    if (b.lo > 0.0 || b.hi < 0.0) {
+        return Hull(a.lo / b.lo, a.lo / b.hi, a.hi / b.lo, a.hi / b.hi, partial);
+    }
+
+    // The divisor reaches zero: 0/0 has no value, anything else divided by 0 is infinite
+    partial = partial || Contains(a, 0.0);
+    if (a.lo == 0.0 && a.hi == 0.0) {
+        return {0.0, 0.0, partial};
+    }
+    if (b.lo == 0.0 && b.hi > 0.0) {
+        return Multiply(a, {::std::nextafter(1.0 / b.hi, 0.0), kInfinity, false}, partial);
+    }
+    if (b.hi == 0.0 && b.lo < 0.0) {
+        return Multiply(a, {-kInfinity, ::std::nextafter(1.0 / b.lo, 0.0), false}, partial);
+    }
+    return Entire(partial);
+}
+
+Interval IntegerPower(const Interval& a, double n, bool partial) {
+    if (n == 0.0) {
+        return {1.0, 1.0, partial};
+    }
+    if (n < 0.0) {
+        return Divide(Point(1.0), IntegerPower(a, -n, false), partial);
+    }
+
+    const double lo = ::std::pow(a.lo, n);
+    const double hi = ::std::pow(a.hi, n);
+    if (::std::fmod(n, 2.0) != 0.0 || a.lo >= 0.0) {
+        return Widen(lo, hi, partial);
+    }
+    if (a.hi <= 0.0) {
+        return Widen(hi, lo, partial);
+    }
+    return {0.0, ::std::nextafter(::std::max(lo, hi), kInfinity), partial};
+}
+
+Interval Power(const Interval& a, const Interval& b, bool partial) {
+    const bool pointExponent = b.lo == b.hi;
+    if (pointExponent && ::std::isfinite(b.lo) && b.lo == ::std::floor(b.lo)) {
+        return IntegerPower(a, b.lo, partial);
+    }
+
+    // Negative bases only have values at integer exponents
+    if (a.lo < 0.0) {
+        if (!pointExponent) {
+            return Entire(true);
+        }
+        if (a.hi < 0.0) {
+            return Empty();
+        }
+        partial = true;
+    }
+
+    // For a positive base, pow is monotonic in each operand, so the extremes are at the corners
+    const double base = ::std::max(a.lo, 0.0);
+    Interval result = Hull(::std::pow(base, b.lo), ::std::pow(base, b.hi), ::std::pow(a.hi, b.lo),
+                           ::std::pow(a.hi, b.hi), partial);
+    result.lo = ::std::max(result.lo, 0.0);
+    return result;
+}
+
+// Range of sin(x + phase) over a; its maxima lie at pi/2 - phase
+Interval Sine(const Interval& a, double phase, bool partial) {
+    if (!a.IsBounded() || a.hi - a.lo >= kTwoPi ||
+        ::std::max(::std::abs(a.lo), ::std::abs(a.hi)) > kLargestReducible) {
+        return {-1.0, 1.0, partial};
+    }
+
+    const double first = phase == 0.0 ? ::std::sin(a.lo) : ::std::cos(a.lo);
+    const double last = phase == 0.0 ? ::std::sin(a.hi) : ::std::cos(a.hi);
+    Interval result = Widen(::std::min(first, last), ::std::max(first, last), partial);
+    const double maximum = kPi / 2.0 - phase;
+    if (ContainsPeriodic(a.lo, a.hi, maximum, kTwoPi)) {
+        result.hi = 1.0;
+    }
+    if (ContainsPeriodic(a.lo, a.hi, maximum + kPi, kTwoPi)) {
+        result.lo = -1.0;
+    }
+    result.lo = ::std::max(result.lo, -1.0);
+    result.hi = ::std::min(result.hi, 1.0);
+    return result;
+}
+
+Interval Tangent(const Interval& a, bool partial) {
+    if (!a.IsBounded() || a.hi - a.lo >= kPi ||
+        ::std::max(::std::abs(a.lo), ::std::abs(a.hi)) > kLargestReducible ||
+        ContainsPeriodic(a.lo, a.hi, kPi / 2.0, kPi)) {
+        return Entire(partial);
+    }
+    const double lo = ::std::tan(a.lo);
+    const double hi = ::std::tan(a.hi);
+    return lo <= hi ? Widen(lo, hi, partial) : Entire(partial);
+}
+
+Interval Apply(OpCode op, const Interval& a, const Interval& b) {
+    // pow(NaN, 0) and pow(1, NaN) are 1, so these have a value even where the other operand has none
+    if (op == OpCode::Power && ((b.lo == 0.0 && b.hi == 0.0) || (a.lo == 1.0 && a.hi == 1.0))) {
+        return Point(1.0);
+    }
+
+    const int operands = GetOperandCount(op);
+    if (a.IsEmpty() || (operands == 2 && b.IsEmpty())) {
+        return Empty();
+    }
+
+    const bool partial = a.partial || (operands == 2 && b.partial);
+    switch (op) {
+        case OpCode::Add:
+            return Widen(a.lo + b.lo, a.hi + b.hi, partial);
+        case OpCode::Subtract:
+            return Widen(a.lo - b.hi, a.hi - b.lo, partial);
+        case OpCode::Multiply:
+            return Multiply(a, b, partial);
+        case OpCode::Divide:
+            return Divide(a, b, partial);
+        case OpCode::Power:
+            return Power(a, b, partial);
+        case OpCode::Negate:
+            return {-a.hi, -a.lo, partial};
+        case OpCode::Sin:
+            return Sine(a, 0.0, partial);
+        case OpCode::Cos:
+            return Sine(a, kPi / 2.0, partial);
+        case OpCode::Tan:
+            return Tangent(a, partial);
+        case OpCode::Sqrt: {
+            if (a.hi < 0.0) {
+                return Empty();
+            }
+            Interval result = Widen(::std::sqrt(::std::max(a.lo, 0.0)), ::std::sqrt(a.hi), partial || a.lo < 0.0);
+            result.lo = ::std::max(result.lo, 0.0);
+            return result;
+        }
+        case OpCode::Log:
+            if (a.hi < 0.0) {
+                return Empty();
+            }
+            return Widen(::std::log(::std::max(a.lo, 0.0)), ::std::log(a.hi), partial || a.lo < 0.0);
+        case OpCode::Exp: {
+            Interval result = Widen(::std::exp(a.lo), ::std::exp(a.hi), partial);
+            result.lo = ::std::max(result.lo, 0.0);
+            return result;
+        }
+        case OpCode::Abs:
+            if (a.lo >= 0.0) {
+                return a;
+            }
+            if (a.hi <= 0.0) {
+                return {-a.hi, -a.lo, partial};
+            }
+            return {0.0, ::std::max(-a.lo, a.hi), partial};
+        default:
+            return Entire(true);
+    }
+}
+
+} // namespace
+
+Interval EvaluateInterval(const Program& program, Interval x, const double* parameters) {
+    const auto& code = program.GetInstructions();
+    if (code.empty()) {
+        throw ::std::runtime_error("No equation has been compiled");
+    }
+
+    thread_local ::std::vector<Interval> slots;
+    slots.resize(code.size());
+    for (::std::size_t i = 0; i < code.size(); ++i) {
+        const Instruction& instruction = code[i];
+        switch (instruction.op) {
+            case OpCode::Constant:
+                slots[i] = Point(instruction.value);
+                break;
+            case OpCode::Variable:
+                slots[i] = x;
+                break;
+            case OpCode::Parameter:
+                slots[i] = Point(parameters ? parameters[instruction.lhs] : kDefaultParameterValue);
+                break;
+            case OpCode::Multiply:
+                // a*a is a square, never negative; lowered powers are built from these
+                slots[i] = instruction.lhs == instruction.rhs
+                               ? Apply(OpCode::Power, slots[instruction.lhs], Point(2.0))
+                               : Apply(OpCode::Multiply, slots[instruction.lhs], slots[instruction.rhs]);
+                break;
+            default:
+                slots[i] = Apply(instruction.op, slots[instruction.lhs], slots[instruction.rhs]);
+                break;
+        }
+    }
+    return slots.back();
+}
+
+} // namespace plot_genius
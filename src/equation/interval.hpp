@@ -0,0 +1,60 @@
+/**
+ * Interval Arithmetic Header
+ *
+ * Defines the evaluation of a compiled program over a whole range of x at
+ * once. The result encloses every value the program takes on that range,
+ * so a narrow enclosure proves a region flat, an unbounded one flags a
+ * possible pole, and a pixel column can be filled with exactly the values
+ * a dense oscillation passes through.
+ *
+ * Bounds are rounded outward by one ulp after every inexact step, which
+ * covers the rounding of the arithmetic and of the C library's functions
+ * as long as those are accurate to within one ulp.
+ */
+
+#pragma once
+
+#include <cmath>
+#include "program.hpp"
+
+namespace plot_genius {
+
+/**
+ * Closed range of values
+ *
+ * NaN bounds mean the range holds no defined value, e.g. sqrt over
+ * negative x only. Values that are undefined for part of the input are
+ * left out of the bounds and reported through partial.
+ */
+struct Interval {
+    double lo{0.0};
+    double hi{0.0};
+    bool partial{false};  ///< Some inputs give no value (NaN) and are not enclosed
+
+    /**
+     * Checks whether no input gives a defined value
+     *
+     * @return True if the bounds are NaN
+     */
+    bool IsEmpty() const { return !(lo <= hi); }
+
+    /**
+     * Checks whether both bounds are finite
+     *
+     * @return False for an empty or unbounded range
+     */
+    bool IsBounded() const { return std::isfinite(lo) && std::isfinite(hi); }
+};
+
+/**
+ * Evaluates a program over a range of x
+ *
+ * @param program Program to evaluate
+ * @param x Range of the variable; lo must not exceed hi
+ * @param parameters One value per parameter name, or nullptr to use kDefaultParameterValue
+ * @return Range enclosing every value the program takes for x in the range
+ * @throws std::runtime_error if the program is empty
+ */
+Interval EvaluateInterval(const Program& program, Interval x, const double* parameters = nullptr);
+
+} // namespace plot_genius
@@ -0,0 +1,64 @@
+/**
+ * Parameter Table Implementation
+ *
+ * Tables hold a handful of entries, so lookups are linear scans.
+ */
+
+#include "parameters.hpp"
+#include <algorithm>
+
+namespace plot_genius {
+
+ParameterBinding& ParameterTable::Bind(const ::std::string& name) {
+    for (ParameterBinding& binding : m_bindings) {
+        if (binding.name == name) {
+            return binding;
+        }
+    }
+    ParameterBinding binding;
+    binding.name = name;
+    if (name == kTimeParameter) {
+        binding.value = 0.0;
+        binding.min = 0.0;
+        binding.max = kDefaultTimeMax;
+    }
+    m_bindings.push_back(binding);
+    return m_bindings.back();
+}
+
+void ParameterTable::Set(const ParameterBinding& binding) {
+    ParameterBinding& stored = Bind(binding.name);
+    stored = binding;
+    stored.min = ::std::min(stored.min, stored.value);
+    stored.max = ::std::max(stored.max, stored.value);
+}
+
+const ParameterBinding* ParameterTable::Find(const ::std::string& name) const {
+    for (const ParameterBinding& binding : m_bindings) {
+        if (binding.name == name) {
+            return &binding;
+        }
+    }
+    return nullptr;
+}
+
+void ParameterTable::Resolve(const Program& program, ::std::vector<double>& values) const {
+    const auto& names = program.GetParameters();
+    values.resize(names.size());
+    for (::std::size_t i = 0; i < names.size(); ++i) {
+        const ParameterBinding* binding = Find(names[i]);
+        values[i] = binding ? binding->value : kDefaultParameterValue;
+    }
+}
+
+void ParameterTable::RemoveUnused(const ::std::vector<const Program*>& programs) {
+    auto unused = [&](const ParameterBinding& binding) {
+        return ::std::none_of(programs.begin(), programs.end(), [&](const Program* program) {
+            const auto& names = program->GetParameters();
+            return ::std::find(names.begin(), names.end(), binding.name) != names.end();
+        });
+    };
+    m_bindings.erase(::std::remove_if(m_bindings.begin(), m_bindings.end(), unused), m_bindings.end());
+}
+
+} // namespace plot_genius
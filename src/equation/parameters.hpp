@@ -0,0 +1,103 @@
+/**
+ * Parameter Table Header
+ *
+ * Defines the table that binds parameter names used in equations (such as
+ * a, b and c in y=a*sin(b*x+c)) to values. Programs only store the names;
+ * values are looked up whenever a sampling pass is requested, so changing
+ * one never requires parsing or compiling again.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "program.hpp"
+
+namespace plot_genius {
+
+/**
+ * Value and slider range of a named parameter
+ */
+struct ParameterBinding {
+    std::string name;
+    double value{kDefaultParameterValue};
+    double min{-10.0};  ///< Slider lower bound
+    double max{10.0};   ///< Slider upper bound
+    std::uint32_t sweepMembers{0};  ///< Curves spread over [min, max] instead of using value, 0 for none
+    bool envelope{false};           ///< Draw a swept family as the band between its bounds
+};
+
+/// Most members a swept family may have
+constexpr std::uint32_t kMaxSweepMembers = 10000;
+
+/// Parameter advanced by animation playback
+constexpr char kTimeParameter[] = "t";
+
+/// Default playback range of the time parameter, in seconds
+constexpr double kDefaultTimeMax = 10.0;
+
+/**
+ * Parameter bindings shared by all equations, in the order they were added
+ */
+class ParameterTable {
+public:
+    /**
+     * Adds a binding with default value and range unless the name is bound
+     *
+     * The time parameter starts at 0 with the range [0, kDefaultTimeMax].
+     *
+     * @param name Parameter name
+     * @return The binding for the name
+     */
+    ParameterBinding& Bind(const std::string& name);
+
+    /**
+     * Adds or replaces a binding
+     *
+     * @param binding Binding to store; its range is widened to contain the value
+     */
+    void Set(const ParameterBinding& binding);
+
+    /**
+     * Finds the binding of a name
+     *
+     * @param name Parameter name
+     * @return Binding, or nullptr if the name is not bound
+     */
+    const ParameterBinding* Find(const std::string& name) const;
+
+    /**
+     * Looks up the values of a program's parameters
+     *
+     * @param program Program to evaluate
+     * @param values Receives one value per program parameter; unbound names get kDefaultParameterValue
+     */
+    void Resolve(const Program& program, std::vector<double>& values) const;
+
+    /**
+     * Removes every binding whose name none of the programs uses
+     *
+     * @param programs Programs still in use
+     */
+    void RemoveUnused(const std::vector<const Program*>& programs);
+
+    /**
+     * Gets the bindings for editing
+     *
+     * @return Bindings in the order they were added
+     */
+    std::vector<ParameterBinding>& GetBindings() { return m_bindings; }
+
+    /**
+     * Gets the bindings
+     *
+     * @return Bindings in the order they were added
+     */
+    const std::vector<ParameterBinding>& GetBindings() const { return m_bindings; }
+
+private:
+    std::vector<ParameterBinding> m_bindings;
+};
+
+} // namespace plot_genius
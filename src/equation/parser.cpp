@@ -2,26 +2,44 @@
  * Equation Parser Implementation
  * 
  * Implements a recursive descent parser for mathematical expressions.
- * Parses expressions into an abstract syntax tree (AST) and provides 
- * evaluation functionality for any x value.
+ * Parses expressions into an abstract syntax tree (AST) and compiles it
+ * into a program for evaluation at any x value.
  * 
  * Supports:
- * - Basic arithmetic operations (+, -, *, /)
+ * - Basic arithmetic operations (+, -, *, /), powers (^) and signs
  * - Mathematical functions (sin, cos, tan, sqrt, log, exp, abs, pow)
  * - Constants (pi, e)
  * - Parenthesized expressions
  * - Variable substitution (x)
+ * - Named parameters (any other identifier, e.g. a, b, freq)
+ * - Derivatives d/dx(...) and dN/dxN(...), expanded symbolically
  */
 
 #include "parser.hpp"
+#include "derivative.hpp"
 #include <cmath>
-#include <sstream>
+#include <cstdlib>
 #include <cctype>
 #include <stdexcept>
 #include <algorithm>
 
 namespace plot_genius {
 
+namespace {
+
+const ::std::map<::std::string, OpCode>& GetFunctions() {
+    static const ::std::map<::std::string, OpCode> functions = {
+        {"sin", OpCode::Sin}, {"cos", OpCode::Cos}, {"tan", OpCode::Tan}, {"sqrt", OpCode::Sqrt},
+        {"log", OpCode::Log}, {"exp", OpCode::Exp}, {"abs", OpCode::Abs}, {"pow", OpCode::Power},
+    };
+    return functions;
+}
+
+// Highest order accepted in dN/dxN(...)
+constexpr int kMaxDerivativeOrder = 8;
+
+} // namespace
+
 EquationParser::EquationParser() : m_root(nullptr) {
     InitializeConstants();
 }
@@ -59,24 +77,33 @@ bool EquationParser::ValidateEquationFormat(const ::std::string& equation) {
 /**
  * Parses a mathematical equation into an AST
  * 
- * Validates the equation format, removes the 'y=' prefix, and
- * parses the right-hand side expression.
+ * Validates the equation format, removes the 'y=' prefix, parses the
+ * right-hand side expression and compiles it for evaluation.
  * 
  * @param equation The equation string to parse (should start with 'y=')
  * @return True if parsing succeeded, false otherwise with error message set
  */
 bool EquationParser::Parse(const ::std::string& equation) {
+    m_root.reset();
+    m_program = Program();
+
     try {
         if (!ValidateEquationFormat(equation)) {
             return false;
         }
 
-        // Remove 'y=' prefix and any whitespace
-        ::std::string expr = equation.substr(2);
-        expr.erase(::std::remove_if(expr.begin(), expr.end(), ::isspace), expr.end());
+        // Remove 'y=' prefix; whitespace is kept so that it separates tokens
+        m_input = equation.substr(2);
+        m_position = 0;
+
+        auto root = ParseExpression();
+        if (Peek() != '\0') {
+            throw ::std::runtime_error("Unexpected '" + ::std::string(1, m_input[m_position]) + "'");
+        }
 
-        m_root = ParseExpression(expr);
-        return m_root != nullptr;
+        m_program = Program::Compile(*root);
+        m_root = ::std::move(root);
+        return true;
     } catch (const ::std::exception& e) {
         m_lastError = e.what();
         return false;
@@ -87,14 +114,15 @@ bool EquationParser::Parse(const ::std::string& equation) {
  * Evaluates the parsed equation for a specific x value
  * 
  * @param x The value to substitute for the variable x
+ * @param parameters One value per parameter of the program, or nullptr for defaults
  * @return The result of evaluating the equation
  * @throws std::runtime_error if no equation has been successfully parsed
  */
-double EquationParser::Evaluate(double x) const {
+double EquationParser::Evaluate(double x, const double* parameters) const {
     if (!m_root) {
         throw ::std::runtime_error("No equation has been parsed yet");
     }
-    return m_root->Evaluate(x);
+    return m_program.Evaluate(x, parameters);
 }
 
 /**
@@ -102,31 +130,16 @@ double EquationParser::Evaluate(double x) const {
  * 
  * This handles the lowest precedence operators (+ and -).
  * 
- * @param expr The expression string to parse
  * @return Root node of the parsed expression subtree
  */
-::std::unique_ptr<EquationParser::Node> EquationParser::ParseExpression(const ::std::string& expr) {
-    auto node = ParseTerm(expr);
-    if (!node) return nullptr;
-
-    // Handle addition and subtraction
-    ::std::size_t pos = 0;
-    while (pos < expr.length()) {
-        if (expr[pos] == '+' || expr[pos] == '-') {
-            auto op = expr[pos];
-            auto right = ParseTerm(expr.substr(pos + 1));
-            if (!right) return nullptr;
-
-            auto binaryNode = ::std::make_unique<BinaryOpNode>();
-            binaryNode->left = ::std::move(node);
-            binaryNode->right = ::std::move(right);
-            binaryNode->op = (op == '+') ? 
-                [](double a, double b) { return a + b; } :
-                [](double a, double b) { return a - b; };
-            
-            node = ::std::move(binaryNode);
-        }
-        pos++;
+::std::unique_ptr<ExpressionNode> EquationParser::ParseExpression() {
+    auto node = ParseTerm();
+
+    // Handle addition and subtraction, left to right
+    while (Peek() == '+' || Peek() == '-') {
+        OpCode op = m_input[m_position] == '+' ? OpCode::Add : OpCode::Subtract;
+        ++m_position;
+        node = MakeOperation(op, ::std::move(node), ParseTerm());
     }
     return node;
 }
@@ -136,113 +149,152 @@ double EquationParser::Evaluate(double x) const {
  * 
  * This handles the medium precedence operators (* and /).
  * 
- * @param expr The expression string to parse
  * @return Root node of the parsed term subtree
  */
-::std::unique_ptr<EquationParser::Node> EquationParser::ParseTerm(const ::std::string& expr) {
-    auto node = ParseFactor(expr);
-    if (!node) return nullptr;
-
-    // Handle multiplication and division
-    ::std::size_t pos = 0;
-    while (pos < expr.length()) {
-        if (expr[pos] == '*' || expr[pos] == '/') {
-            auto op = expr[pos];
-            auto right = ParseFactor(expr.substr(pos + 1));
-            if (!right) return nullptr;
-
-            auto binaryNode = ::std::make_unique<BinaryOpNode>();
-            binaryNode->left = ::std::move(node);
-            binaryNode->right = ::std::move(right);
-            binaryNode->op = (op == '*') ? 
-                [](double a, double b) { return a * b; } :
-                [](double a, double b) { return a / b; };
-            
-            node = ::std::move(binaryNode);
-        }
-        pos++;
+::std::unique_ptr<ExpressionNode> EquationParser::ParseTerm() {
+    auto node = ParseFactor();
+
+    // Handle multiplication and division, left to right
+    while (Peek() == '*' || Peek() == '/') {
+        OpCode op = m_input[m_position] == '*' ? OpCode::Multiply : OpCode::Divide;
+        ++m_position;
+        node = MakeOperation(op, ::std::move(node), ParseFactor());
     }
     return node;
 }
 
 /**
- * Parses factors (highest precedence elements)
- * 
- * Handles parenthesized expressions, numbers, variables, 
- * constants, and function calls.
+ * Parses factors: signs applied to powers
  * 
- * @param expr The expression string to parse
  * @return Root node of the parsed factor subtree
+ * @throws std::runtime_error for syntax errors
+ */
+::std::unique_ptr<ExpressionNode> EquationParser::ParseFactor() {
+    // Handle signs; -x^2 is -(x^2)
+    const char c = Peek();
+    if (c == '-' || c == '+') {
+        ++m_position;
+        auto operand = ParseFactor();
+        return c == '-' ? MakeOperation(OpCode::Negate, ::std::move(operand)) : ::std::move(operand);
+    }
+    return ParsePower();
+}
+
+/**
+ * Parses powers, a^b as pow(a, b)
+ * 
+ * The exponent is a factor, so powers associate to the right (2^3^2 is
+ * 2^9) and may carry a sign (x^-2).
+ * 
+ * @return Root node of the parsed power subtree
+ * @throws std::runtime_error for syntax errors
+ */
+::std::unique_ptr<ExpressionNode> EquationParser::ParsePower() {
+    auto base = ParsePrimary();
+    if (Peek() == '^') {
+        ++m_position;
+        return MakeOperation(OpCode::Power, ::std::move(base), ParseFactor());
+    }
+    return base;
+}
+
+/**
+ * Parses primaries (highest precedence elements)
+ * 
+ * Handles parenthesized expressions, numbers, variables, constants,
+ * parameters and function calls.
+ * 
+ * @return Root node of the parsed primary subtree
  * @throws std::runtime_error for syntax errors like unmatched parentheses
  */
-::std::unique_ptr<EquationParser::Node> EquationParser::ParseFactor(const ::std::string& expr) {
-    if (expr.empty()) return nullptr;
+::std::unique_ptr<ExpressionNode> EquationParser::ParsePrimary() {
+    const char c = Peek();
+    if (c == '\0') {
+        throw ::std::runtime_error("Unexpected end of expression");
+    }
 
     // Handle parentheses
-    if (expr[0] == '(') {
-        ::std::size_t end = expr.find_last_of(')');
-        if (end == ::std::string::npos) {
-            throw ::std::runtime_error("Unmatched parentheses");
-        }
-        return ParseExpression(expr.substr(1, end - 1));
+    if (c == '(') {
+        ++m_position;
+        auto node = ParseExpression();
+        Expect(')');
+        return node;
     }
 
     // Handle numbers
-    if (::std::isdigit(expr[0]) || expr[0] == '.') {
-        return ParseNumber(expr);
+    if (::std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+        return ParseNumber();
     }
 
-    // Handle variable x
-    if (expr[0] == 'x') {
-        return ::std::make_unique<VariableNode>();
+    if (!::std::isalpha(static_cast<unsigned char>(c))) {
+        throw ::std::runtime_error("Unexpected '" + ::std::string(1, c) + "'");
     }
 
-    // Handle constants
-    if (::std::isalpha(expr[0])) {
-        auto constant = ParseConstant(expr);
-        if (constant) return constant;
+    // Read the whole identifier
+    ::std::size_t start = m_position;
+    while (m_position < m_input.length() && ::std::isalnum(static_cast<unsigned char>(m_input[m_position]))) {
+        ++m_position;
     }
+    ::std::string name = m_input.substr(start, m_position - start);
 
-    // Handle functions
-    if (::std::isalpha(expr[0])) {
-        return ParseFunction(expr);
+    // Handle derivatives
+    if (int order = ParseDerivativeOrder(name)) {
+        return ParseDerivative(order);
+    }
+
+    // Handle functions; sin x is not sin(x)
+    if (Peek() == '(') {
+        return ParseFunction(name);
+    }
+    if (GetFunctions().count(name) != 0) {
+        throw ::std::runtime_error("Expected '(' after " + name);
     }
 
-    return nullptr;
+    // Handle variable x
+    if (name == "x") {
+        return MakeVariable();
+    }
+
+    // Handle constants
+    auto constant = ParseConstant(name);
+    if (constant) return constant;
+
+    // Any other name is a parameter whose value is supplied when evaluating
+    if (name == "y") {
+        throw ::std::runtime_error("'" + name + "' cannot be used as a parameter");
+    }
+    return MakeParameter(name);
 }
 
 /**
  * Parses a numeric literal
  * 
- * @param expr The expression string starting with a numeric literal
- * @return NumberNode containing the parsed value
+ * @return Constant node containing the parsed value
+ * @throws std::runtime_error if no number starts at the parse position
  */
-::std::unique_ptr<EquationParser::Node> EquationParser::ParseNumber(const ::std::string& expr) {
-    ::std::istringstream iss(expr);
-    double value;
-    if (iss >> value) {
-        auto node = ::std::make_unique<NumberNode>();
-        node->value = value;
-        return node;
+::std::unique_ptr<ExpressionNode> EquationParser::ParseNumber() {
+    const char* begin = m_input.c_str() + m_position;
+    char* end = nullptr;
+    double value = ::std::strtod(begin, &end);
+    if (end == begin) {
+        throw ::std::runtime_error("Invalid number");
     }
-    return nullptr;
+    m_position += static_cast<::std::size_t>(end - begin);
+    return MakeConstant(value);
 }
 
 /**
  * Parses a named constant (e.g., pi, e)
  * 
- * @param expr The expression string potentially starting with a constant name
- * @return ConstantNode if a valid constant is found, nullptr otherwise
+ * @param name Identifier to look up
+ * @return Constant node if the name is a known constant, nullptr otherwise
  */
-::std::unique_ptr<EquationParser::Node> EquationParser::ParseConstant(const ::std::string& expr) {
-    for (const auto& [name, value] : m_constants) {
-        if (expr.substr(0, name.length()) == name) {
-            auto node = ::std::make_unique<ConstantNode>();
-            node->value = value;
-            return node;
-        }
+::std::unique_ptr<ExpressionNode> EquationParser::ParseConstant(const ::std::string& name) {
+    auto it = m_constants.find(name);
+    if (it == m_constants.end()) {
+        return nullptr;
     }
-    return nullptr;
+    return MakeConstant(it->second);
 }
 
 /**
@@ -251,60 +303,122 @@ double EquationParser::Evaluate(double x) const {
  * Supports various mathematical functions and handles
  * special cases like the two-argument pow function.
  * 
- * @param expr The expression string starting with a function name
- * @return UnaryOpNode (or BinaryOpNode for pow) representing the function
+ * @param name Function name; the parse position is at its opening parenthesis
+ * @return Operation node applying the function to its arguments
  * @throws std::runtime_error for invalid function syntax or unknown functions
  */
-::std::unique_ptr<EquationParser::Node> EquationParser::ParseFunction(const ::std::string& expr) {
-    ::std::size_t parenStart = expr.find('(');
-    if (parenStart == ::std::string::npos) {
-        throw ::std::runtime_error("Invalid function syntax");
+::std::unique_ptr<ExpressionNode> EquationParser::ParseFunction(const ::std::string& name) {
+    const auto& functions = GetFunctions();
+    auto function = functions.find(name);
+    if (function == functions.end()) {
+        throw ::std::runtime_error("Unknown function: " + name);
     }
 
-    ::std::string funcName = expr.substr(0, parenStart);
-    ::std::string arg = expr.substr(parenStart + 1, expr.find_last_of(')') - parenStart - 1);
-
-    auto argNode = ParseExpression(arg);
-    if (!argNode) return nullptr;
-
-    auto unaryNode = ::std::make_unique<UnaryOpNode>();
-    unaryNode->operand = ::std::move(argNode);
-
-    if (funcName == "sin") {
-        unaryNode->op = [](double x) { return ::std::sin(x); };
-    } else if (funcName == "cos") {
-        unaryNode->op = [](double x) { return ::std::cos(x); };
-    } else if (funcName == "tan") {
-        unaryNode->op = [](double x) { return ::std::tan(x); };
-    } else if (funcName == "sqrt") {
-        unaryNode->op = [](double x) { return ::std::sqrt(x); };
-    } else if (funcName == "log") {
-        unaryNode->op = [](double x) { return ::std::log(x); };
-    } else if (funcName == "exp") {
-        unaryNode->op = [](double x) { return ::std::exp(x); };
-    } else if (funcName == "abs") {
-        unaryNode->op = [](double x) { return ::std::abs(x); };
-    } else if (funcName == "pow") {
+    Expect('(');
+    auto argument = ParseExpression();
+
+    if (function->second == OpCode::Power) {
         // For pow, we need to parse two arguments
-        ::std::size_t comma = arg.find(',');
-        if (comma == ::std::string::npos) {
+        if (Peek() != ',') {
             throw ::std::runtime_error("pow function requires two arguments");
         }
-        auto base = ParseExpression(arg.substr(0, comma));
-        auto exponent = ParseExpression(arg.substr(comma + 1));
-        if (!base || !exponent) {
-            throw ::std::runtime_error("Invalid arguments for pow function");
-        }
-        auto binaryNode = ::std::make_unique<BinaryOpNode>();
-        binaryNode->left = ::std::move(base);
-        binaryNode->right = ::std::move(exponent);
-        binaryNode->op = [](double a, double b) { return ::std::pow(a, b); };
-        return binaryNode;
-    } else {
-        throw ::std::runtime_error("Unknown function: " + funcName);
+        ++m_position;
+        auto exponent = ParseExpression();
+        Expect(')');
+        return MakeOperation(OpCode::Power, ::std::move(argument), ::std::move(exponent));
+    }
+
+    Expect(')');
+    return MakeOperation(function->second, ::std::move(argument));
+}
+
+/**
+ * Recognizes the operator of a derivative, d/dx or dN/dxN
+ * 
+ * A name d followed by /dx and an opening parenthesis can be nothing
+ * else: dx(...) would be an unknown function.
+ * 
+ * @param name Identifier just read; the parse position is right after it
+ * @return Order of the derivative with the position at its parenthesis, or 0 if this is no derivative
+ * @throws std::runtime_error if the order is out of range
+ */
+int EquationParser::ParseDerivativeOrder(const ::std::string& name) {
+    if (name.empty() || name[0] != 'd') {
+        return 0;
+    }
+    const ::std::string digits = name.substr(1);
+    auto isDigit = [](char c) { return ::std::isdigit(static_cast<unsigned char>(c)) != 0; };
+    if (!::std::all_of(digits.begin(), digits.end(), isDigit)) {
+        return 0;
+    }
+    const ::std::size_t start = m_position;
+    const ::std::string variable = "dx" + digits;
+    bool matches = Peek() == '/';
+    if (matches) {
+        ++m_position;
+        Peek();
+        matches = m_input.compare(m_position, variable.length(), variable) == 0;
+    }
+    if (matches) {
+        m_position += variable.length();
+        matches = Peek() == '(';
+    }
+    if (!matches) {
+        m_position = start;
+        return 0;
+    }
+    
+    const int order = digits.empty() ? 1 : ::std::atoi(digits.c_str());
+    if (order < 1 || order > kMaxDerivativeOrder || digits.length() > 1) {
+        throw ::std::runtime_error("Derivative order must be 1 to " + ::std::to_string(kMaxDerivativeOrder));
     }
+    return order;
+}
+
+/**
+ * Parses the argument of a derivative and differentiates it
+ * 
+ * @param order Number of times to differentiate; the parse position is at the opening parenthesis
+ * @return Simplified derivative tree
+ * @throws std::runtime_error if the argument is invalid or its derivative too large
+ */
+::std::unique_ptr<ExpressionNode> EquationParser::ParseDerivative(int order) {
+    Expect('(');
+    auto node = ParseExpression();
+    Expect(')');
+    for (int i = 0; i < order; ++i) {
+        node = Differentiate(*node);
+    }
+    return node;
+}
 
-    return unaryNode;
+/**
+ * Skips whitespace to the next token
+ * 
+ * Whitespace ends identifiers and numbers, so sin x reads as the name sin
+ * followed by x rather than as a parameter sinx.
+ * 
+ * @return First character of the next token, or '\0' at the end
+ */
+char EquationParser::Peek() {
+    while (m_position < m_input.length() && ::std::isspace(static_cast<unsigned char>(m_input[m_position]))) {
+        ++m_position;
+    }
+    return m_position < m_input.length() ? m_input[m_position] : '\0';
+}
+
+/**
+ * Consumes an expected character
+ * 
+ * @param expected Character that must come next
+ * @throws std::runtime_error if a different character or the end follows
+ */
+void EquationParser::Expect(char expected) {
+    if (Peek() != expected) {
+        throw ::std::runtime_error(expected == ')' ? "Unmatched parentheses"
+                                                   : "Expected '" + ::std::string(1, expected) + "'");
+    }
+    ++m_position;
 }
 
-} // namespace plot_genius 
\ No newline at end of file
+} // namespace plot_genius
@@ -9,10 +9,10 @@
 
 #include <string>
 #include <memory>
-#include <functional>
-#include <cmath>
 #include <stdexcept>
 #include <map>
+#include "expression.hpp"
+#include "program.hpp"
 
 namespace plot_genius {
 
@@ -20,7 +20,8 @@ namespace plot_genius {
  * Class for parsing and evaluating mathematical expressions
  * 
  * Implements a recursive descent parser that constructs an abstract syntax tree (AST)
- * from the input expression, then evaluates the tree for specific x values.
+ * from the input expression, then compiles it into a program that is evaluated
+ * for specific x values.
  */
 class EquationParser {
 public:
@@ -46,10 +47,11 @@ public:
      * Evaluates the parsed expression at a specific x value
      * 
      * @param x The value to substitute for the variable x
+     * @param parameters One value per name in GetProgram().GetParameters(), or nullptr for defaults
      * @return The result of evaluating the expression
      * @throws std::runtime_error if the expression is invalid or empty
      */
-    double Evaluate(double x) const;
+    double Evaluate(double x, const double* parameters = nullptr) const;
 
     /**
      * Returns the error message from the last parsing operation
@@ -58,153 +60,116 @@ public:
      */
     const ::std::string& GetLastError() const { return m_lastError; }
 
-private:
-    /**
-     * Base abstract node class for the expression tree
-     */
-    struct Node {
-        virtual ~Node() = default;
-        
-        /**
-         * Evaluates this node with the given x value
-         * 
-         * @param x The value to substitute for variables
-         * @return The computed result
-         */
-        virtual double Evaluate(double x) const = 0;
-    };
-
-    /**
-     * Node representing a numeric literal
-     */
-    struct NumberNode : public Node {
-        double value;  ///< The numeric value
-        
-        /**
-         * Returns the stored numeric value
-         * 
-         * @param x Unused parameter (required by interface)
-         * @return The stored numeric value
-         */
-        double Evaluate([[maybe_unused]] double x) const override { return value; }
-    };
-
     /**
-     * Node representing a variable (x)
-     */
-    struct VariableNode : public Node {
-        /**
-         * Returns the value of x
-         * 
-         * @param x The variable value
-         * @return The value of x
-         */
-        double Evaluate(double x) const override { return x; }
-    };
-
-    /**
-     * Node representing a binary operation (e.g., addition, multiplication)
-     */
-    struct BinaryOpNode : public Node {
-        ::std::unique_ptr<Node> left;   ///< Left operand
-        ::std::unique_ptr<Node> right;  ///< Right operand
-        ::std::function<double(double, double)> op;  ///< Operation function
-        
-        /**
-         * Evaluates both operands and applies the operation
-         * 
-         * @param x The value to substitute for variables
-         * @return The result of the operation
-         */
-        double Evaluate(double x) const override {
-            return op(left->Evaluate(x), right->Evaluate(x));
-        }
-    };
-
-    /**
-     * Node representing a unary operation (e.g., negation, functions)
-     */
-    struct UnaryOpNode : public Node {
-        ::std::unique_ptr<Node> operand;  ///< The operand
-        ::std::function<double(double)> op;  ///< Operation function
-        
-        /**
-         * Evaluates the operand and applies the operation
-         * 
-         * @param x The value to substitute for variables
-         * @return The result of the operation
-         */
-        double Evaluate(double x) const override {
-            return op(operand->Evaluate(x));
-        }
-    };
+     * Returns the tree of the last successfully parsed expression
+     * 
+     * @return Root node, or nullptr if nothing has been parsed
+     */
+    const ExpressionNode* GetExpression() const { return m_root.get(); }
 
     /**
-     * Node representing a mathematical constant (e.g., π, e)
-     */
-    struct ConstantNode : public Node {
-        double value;  ///< The constant value
-        
-        /**
-         * Returns the stored constant value
-         * 
-         * @param x Unused parameter (required by interface)
-         * @return The constant value
-         */
-        double Evaluate([[maybe_unused]] double x) const override { return value; }
-    };
+     * Returns the compiled form of the last successfully parsed expression
+     * 
+     * @return Program, empty if nothing has been parsed
+     */
+    const Program& GetProgram() const { return m_program; }
 
-    ::std::unique_ptr<Node> m_root;  ///< Root node of the expression tree
+private:
+    ::std::unique_ptr<ExpressionNode> m_root;  ///< Root node of the expression tree
+    Program m_program;  ///< Compiled form of m_root
     ::std::string m_lastError;  ///< Last parsing error message
     ::std::map<::std::string, double> m_constants;  ///< Map of named constants
+    ::std::string m_input;  ///< Expression being parsed, whitespace included
+    ::std::size_t m_position{0};  ///< Parse position in m_input
 
     /**
      * Parses a complete expression (lowest precedence: addition/subtraction)
      * 
-     * @param expr The expression string
      * @return Pointer to the root node of the parsed expression
      */
-    ::std::unique_ptr<Node> ParseExpression(const ::std::string& expr);
+    ::std::unique_ptr<ExpressionNode> ParseExpression();
     
     /**
      * Parses a term (medium precedence: multiplication/division)
      * 
-     * @param expr The expression string
      * @return Pointer to the root node of the parsed term
      */
-    ::std::unique_ptr<Node> ParseTerm(const ::std::string& expr);
+    ::std::unique_ptr<ExpressionNode> ParseTerm();
     
     /**
-     * Parses a factor (highest precedence: exponentiation, functions, parentheses)
+     * Parses a factor (signs, then powers)
      * 
-     * @param expr The expression string
      * @return Pointer to the root node of the parsed factor
      */
-    ::std::unique_ptr<Node> ParseFactor(const ::std::string& expr);
+    ::std::unique_ptr<ExpressionNode> ParseFactor();
+    
+    /**
+     * Parses a power (right-associative ^, binding tighter than signs on its left)
+     * 
+     * @return Pointer to the root node of the parsed power
+     */
+    ::std::unique_ptr<ExpressionNode> ParsePower();
+    
+    /**
+     * Parses a primary (highest precedence: numbers, names, functions, parentheses)
+     * 
+     * @return Pointer to the root node of the parsed primary
+     */
+    ::std::unique_ptr<ExpressionNode> ParsePrimary();
     
     /**
      * Parses a numeric literal
      * 
-     * @param expr The expression string
-     * @return Pointer to a NumberNode representing the parsed value
+     * @return Pointer to a constant node holding the parsed value
      */
-    ::std::unique_ptr<Node> ParseNumber(const ::std::string& expr);
+    ::std::unique_ptr<ExpressionNode> ParseNumber();
     
     /**
      * Parses a function call (e.g., sin, cos)
      * 
-     * @param expr The expression string
-     * @return Pointer to a UnaryOpNode representing the function
+     * @param name Function name; the parse position is at its opening parenthesis
+     * @return Pointer to the operation node applying the function
+     */
+    ::std::unique_ptr<ExpressionNode> ParseFunction(const ::std::string& name);
+    
+    /**
+     * Recognizes d/dx or dN/dxN after the name d or dN
+     * 
+     * @param name Identifier just read
+     * @return Order of the derivative, or 0 if the name does not start one
      */
-    ::std::unique_ptr<Node> ParseFunction(const ::std::string& expr);
+    int ParseDerivativeOrder(const ::std::string& name);
+    
+    /**
+     * Parses the parenthesized argument of a derivative
+     * 
+     * @param order Number of times to differentiate the argument
+     * @return Pointer to the root of the differentiated expression
+     */
+    ::std::unique_ptr<ExpressionNode> ParseDerivative(int order);
     
     /**
      * Parses a named constant (e.g., pi, e)
      * 
-     * @param expr The expression string
-     * @return Pointer to a ConstantNode with the corresponding value
+     * @param name Identifier to look up
+     * @return Pointer to a constant node, or nullptr if the name is not a constant
+     */
+    ::std::unique_ptr<ExpressionNode> ParseConstant(const ::std::string& name);
+
+    /**
+     * Skips whitespace to the next token
+     * 
+     * @return First character of the next token, or '\0' at the end
+     */
+    char Peek();
+
+    /**
+     * Consumes an expected character
+     * 
+     * @param expected Character that must come next
+     * @throws std::runtime_error if a different character or the end follows
      */
-    ::std::unique_ptr<Node> ParseConstant(const ::std::string& expr);
+    void Expect(char expected);
     
     /**
      * Validates the overall format of the equation
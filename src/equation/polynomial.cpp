@@ -0,0 +1,351 @@
+/**
+ * Polynomial Rewriting Implementation
+ *
+ * One bottom-up pass keeps, for every subtree that is a polynomial in x,
+ * its coefficients instead of a tree; a tree is only emitted where a
+ * polynomial meets an operation that is not polynomial, or at the root.
+ * Subtrees without x are polynomials of degree 0, so their coefficient
+ * is simply the (rewritten) subtree itself.
+ */
+
+#include "polynomial.hpp"
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace plot_genius {
+
+namespace {
+
+using Node = ::std::unique_ptr<ExpressionNode>;
+
+// Coefficients from degree 0 up; nullptr stands for a zero coefficient
+using Coefficients = ::std::vector<Node>;
+
+// A rewritten subtree, kept as coefficients while it is a polynomial
+struct Rewritten {
+    Node tree;                  // Rewritten subtree, unless polynomial
+    bool polynomial{false};
+    Coefficients coefficients;  // Coefficients, if polynomial
+    bool varies{false};         // Depends on x
+};
+
+bool IsConstant(const Node& node) {
+    return node && node->op == OpCode::Constant;
+}
+
+bool IsConstant(const Node& node, double value) {
+    return IsConstant(node) && node->value == value;
+}
+
+Node Copy(const Node& node) {
+    return node ? CloneExpression(*node) : nullptr;
+}
+
+// Coefficient arithmetic, folding constants and treating nullptr as 0
+Node Sum(Node a, Node b) {
+    if (!a || IsConstant(a, 0.0)) {
+        return b;
+    }
+    if (!b || IsConstant(b, 0.0)) {
+        return a;
+    }
+    if (IsConstant(a) && IsConstant(b)) {
+        return MakeConstant(a->value + b->value);
+    }
+    return MakeOperation(OpCode::Add, ::std::move(a), ::std::move(b));
+}
+
+Node Product(Node a, Node b) {
+    if (!a || !b) {
+        return nullptr;
+    }
+    if (IsConstant(a) && IsConstant(b)) {
+        return MakeConstant(a->value * b->value);
+    }
+    if (IsConstant(a, 1.0)) {
+        return b;
+    }
+    if (IsConstant(b, 1.0)) {
+        return a;
+    }
+    return MakeOperation(OpCode::Multiply, ::std::move(a), ::std::move(b));
+}
+
+Node Negated(Node a) {
+    if (!a) {
+        return nullptr;
+    }
+    if (IsConstant(a)) {
+        return MakeConstant(-a->value);
+    }
+    return MakeOperation(OpCode::Negate, ::std::move(a));
+}
+
+Node Quotient(Node a, const Node& divisor) {
+    if (!a) {
+        return nullptr;
+    }
+    if (IsConstant(a) && IsConstant(divisor)) {
+        return MakeConstant(a->value / divisor->value);
+    }
+    return MakeOperation(OpCode::Divide, ::std::move(a), Copy(divisor));
+}
+
+// Computes base^n for n >= 1 by repeated squaring; the copies of base compile to shared slots
+Node RepeatedSquaring(const Node& base, int n) {
+    Node result;
+    Node square = Copy(base);
+    while (n > 0) {
+        if (n & 1) {
+            result = result ? Product(::std::move(result), Copy(square)) : Copy(square);
+        }
+        n >>= 1;
+        if (n > 0) {
+            Node copy = Copy(square);
+            square = Product(::std::move(copy), ::std::move(square));
+        }
+    }
+    return result;
+}
+
+// Gets the exponent as an integer if it is a constant small enough to lower
+bool GetLoweredExponent(const Node& exponent, int& n) {
+    if (!IsConstant(exponent) || exponent->value != ::std::floor(exponent->value) ||
+        ::std::abs(exponent->value) > kMaxLoweredExponent) {
+        return false;
+    }
+    n = static_cast<int>(exponent->value);
+    return true;
+}
+
+// pow(base, exponent), as multiplications when the exponent is a small integer
+Node Power(Node base, Node exponent) {
+    int n = 0;
+    if (!GetLoweredExponent(exponent, n)) {
+        return MakeOperation(OpCode::Power, ::std::move(base), ::std::move(exponent));
+    }
+    if (n == 0) {
+        return MakeConstant(1.0);  // pow(a, 0) is 1 even for NaN a
+    }
+    if (IsConstant(base)) {
+        return MakeConstant(::std::pow(base->value, n));
+    }
+    Node power = RepeatedSquaring(base, ::std::abs(n));
+    return n > 0 ? ::std::move(power) : MakeOperation(OpCode::Divide, MakeConstant(1.0), ::std::move(power));
+}
+
+// Checks whether every coefficient is a finite constant, so the polynomial is finite for every finite x
+bool IsFinite(const Coefficients& coefficients) {
+    for (const Node& coefficient : coefficients) {
+        if (coefficient && (!IsConstant(coefficient) || !::std::isfinite(coefficient->value))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Checks for a NaN or infinite constant, which spread over expanded terms would make inf * 0 out of inf * 1
+bool HasNonFiniteConstant(const Coefficients& coefficients) {
+    for (const Node& coefficient : coefficients) {
+        if (IsConstant(coefficient) && !::std::isfinite(coefficient->value)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+::std::size_t CountTerms(const Coefficients& coefficients) {
+    ::std::size_t terms = 0;
+    for (const Node& coefficient : coefficients) {
+        terms += coefficient && !IsConstant(coefficient, 0.0) ? 1 : 0;
+    }
+    return terms;
+}
+
+void Trim(Coefficients& coefficients) {
+    while (!coefficients.empty() && (!coefficients.back() || IsConstant(coefficients.back(), 0.0))) {
+        coefficients.pop_back();
+    }
+}
+
+Node Horner(Coefficients& coefficients) {
+    Node result = ::std::move(coefficients.back());
+    for (::std::size_t k = coefficients.size() - 1; k-- > 0;) {
+        result = Sum(Product(::std::move(result), MakeVariable()), ::std::move(coefficients[k]));
+    }
+    return result;
+}
+
+// Pairs terms as t0 + t1*x, then pairs those with x^2, x^4 and so on
+Node Estrin(Coefficients& coefficients) {
+    Coefficients terms = ::std::move(coefficients);
+    Node power = MakeVariable();
+    while (terms.size() > 1) {
+        Coefficients paired((terms.size() + 1) / 2);
+        for (::std::size_t i = 0; i < paired.size(); ++i) {
+            Node high = 2 * i + 1 < terms.size() ? Product(::std::move(terms[2 * i + 1]), Copy(power)) : nullptr;
+            paired[i] = Sum(::std::move(terms[2 * i]), ::std::move(high));
+        }
+        terms = ::std::move(paired);
+        if (terms.size() > 1) {
+            Node copy = Copy(power);
+            power = Product(::std::move(copy), ::std::move(power));
+        }
+    }
+    return terms.empty() || !terms[0] ? MakeConstant(0.0) : ::std::move(terms[0]);
+}
+
+// Builds the tree of a polynomial
+Node Emit(Coefficients coefficients) {
+    Trim(coefficients);
+    if (coefficients.empty()) {
+        return MakeConstant(0.0);
+    }
+    const int degree = static_cast<int>(coefficients.size()) - 1;
+    if (degree == 0) {
+        return ::std::move(coefficients[0]);
+    }
+    if (CountTerms(coefficients) == 1) {
+        return Product(::std::move(coefficients.back()), RepeatedSquaring(MakeVariable(), degree));
+    }
+    return degree < kEstrinDegree ? Horner(coefficients) : Estrin(coefficients);
+}
+
+Node Materialize(Rewritten& rewritten) {
+    return rewritten.polynomial ? Emit(::std::move(rewritten.coefficients)) : ::std::move(rewritten.tree);
+}
+
+Coefficients Multiply(const Coefficients& a, const Coefficients& b) {
+    Coefficients product(a.size() + b.size() - 1);
+    for (::std::size_t i = 0; i < a.size(); ++i) {
+        for (::std::size_t j = 0; j < b.size(); ++j) {
+            if (a[i] && b[j]) {
+                product[i + j] = Sum(::std::move(product[i + j]), Product(Copy(a[i]), Copy(b[j])));
+            }
+        }
+    }
+    return product;
+}
+
+// Combines polynomial operands; returns false, with the operands still intact, if the result is not polynomial
+bool Combine(OpCode op, Rewritten& left, Rewritten& right, Coefficients& result) {
+    Coefficients& a = left.coefficients;
+    Coefficients& b = right.coefficients;
+    Trim(a);
+    Trim(b);
+    switch (op) {
+        case OpCode::Add:
+        case OpCode::Subtract:
+            result.resize(::std::max(a.size(), b.size()));
+            for (::std::size_t k = 0; k < result.size(); ++k) {
+                Node term = k < b.size() ? ::std::move(b[k]) : nullptr;
+                result[k] = Sum(k < a.size() ? ::std::move(a[k]) : nullptr,
+                                op == OpCode::Add ? ::std::move(term) : Negated(::std::move(term)));
+            }
+            return true;
+        case OpCode::Negate:
+            for (Node& coefficient : a) {
+                coefficient = Negated(::std::move(coefficient));
+            }
+            result = ::std::move(a);
+            return true;
+        case OpCode::Multiply:
+            // 0 * p is only 0 where p is finite; a coefficient that may be NaN or infinite keeps the multiply
+            if (a.empty() || b.empty()) {
+                if (!IsFinite(a.empty() ? b : a)) {
+                    return false;
+                }
+                result.clear();
+                return true;
+            }
+            // Only scalings by a monomial are expanded; they cannot cancel
+            if ((CountTerms(a) > 1 && CountTerms(b) > 1) || HasNonFiniteConstant(a) || HasNonFiniteConstant(b) ||
+                static_cast<int>(a.size() + b.size()) - 2 > kMaxPolynomialDegree) {
+                return false;
+            }
+            result = Multiply(a, b);
+            return true;
+        case OpCode::Divide:
+            if (right.varies) {
+                return false;
+            }
+            // Division by a constant 0 or NaN, and of 0 by what may be 0, are kept as written
+            if (b.empty() || (IsConstant(b[0]) && !::std::isfinite(1.0 / b[0]->value)) || HasNonFiniteConstant(a) ||
+                (a.empty() && !IsConstant(b[0]))) {
+                return false;
+            }
+            for (Node& coefficient : a) {
+                coefficient = Quotient(::std::move(coefficient), b[0]);
+            }
+            result = ::std::move(a);
+            return true;
+        case OpCode::Power: {
+            int n = 0;
+            if (right.varies || b.size() != 1 || !GetLoweredExponent(b[0], n) || n < 0 || CountTerms(a) != 1 ||
+                static_cast<int>(a.size() - 1) * n > kMaxPolynomialDegree) {
+                return false;
+            }
+            result.resize((a.size() - 1) * n + 1);
+            result.back() = Power(::std::move(a.back()), MakeConstant(n));
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+Rewritten Visit(const ExpressionNode& node) {
+    Rewritten result;
+    switch (node.op) {
+        case OpCode::Constant:
+        case OpCode::Parameter:
+            result.polynomial = true;
+            result.coefficients.push_back(CloneExpression(node));
+            return result;
+        case OpCode::Variable:
+            result.polynomial = true;
+            result.varies = true;
+            result.coefficients.push_back(nullptr);
+            result.coefficients.push_back(MakeConstant(1.0));
+            return result;
+        default:
+            break;
+    }
+
+    const bool binary = GetOperandCount(node.op) == 2;
+    Rewritten left = Visit(*node.left);
+    Rewritten right = binary ? Visit(*node.right) : Rewritten();
+    result.varies = left.varies || right.varies;
+
+    if (left.polynomial && (!binary || right.polynomial) &&
+        Combine(node.op, left, right, result.coefficients)) {
+        result.polynomial = true;
+        return result;
+    }
+
+    Node a = Materialize(left);
+    Node b = binary ? Materialize(right) : nullptr;
+    Node tree = node.op == OpCode::Power ? Power(::std::move(a), ::std::move(b))
+                                         : MakeOperation(node.op, ::std::move(a), ::std::move(b));
+    if (result.varies) {
+        result.tree = ::std::move(tree);
+    } else {
+        // Fold constants, so the checks for NaN and infinite coefficients in Combine see them
+        if (IsConstant(tree->left) && (!binary || IsConstant(tree->right))) {
+            tree = MakeConstant(ApplyOp(tree->op, tree->left->value, binary ? tree->right->value : 0.0));
+        }
+        result.polynomial = true;
+        result.coefficients.push_back(::std::move(tree));
+    }
+    return result;
+}
+
+} // namespace
+
+::std::unique_ptr<ExpressionNode> RewritePolynomials(const ExpressionNode& node) {
+    Rewritten rewritten = Visit(node);
+    return Materialize(rewritten);
+}
+
+} // namespace plot_genius
@@ -0,0 +1,46 @@
+/**
+ * Polynomial Rewriting Header
+ *
+ * Defines the compiler pass that turns polynomials in x, typically long
+ * sums of x^n terms from generated equations, into Horner or Estrin form,
+ * and integer powers into multiplications. Each x^n otherwise costs a
+ * call to std::pow per sample; the rewritten tree needs one multiply and
+ * one add per degree.
+ */
+
+#pragma once
+
+#include <memory>
+#include "expression.hpp"
+
+namespace plot_genius {
+
+/// Highest degree collected into one polynomial
+constexpr int kMaxPolynomialDegree = 64;
+
+/// Degree from which Estrin's scheme is used; its dependency chains grow with log2 of the degree
+constexpr int kEstrinDegree = 8;
+
+/// Largest magnitude of an integer exponent lowered to multiplications
+constexpr int kMaxLoweredExponent = 64;
+
+/**
+ * Rewrites polynomials and integer powers of an expression
+ *
+ * Sums, differences and scalings of monomials c*x^n, where c may be any
+ * expression not involving x, are collected into one polynomial and
+ * evaluated in Horner form, or in Estrin form from kEstrinDegree on.
+ * Products of two polynomials with several terms each are not expanded,
+ * since expansion can cancel badly (think (x-1)^20 near 1); they are
+ * rewritten separately instead. Remaining pow(a, n) with integer n are
+ * computed by repeated squaring, with 1/a^|n| for negative n.
+ *
+ * Results can differ from the original tree in the last bits, as the
+ * operations are rounded in a different order.
+ *
+ * @param node Root of the expression
+ * @return Rewritten copy
+ */
+std::unique_ptr<ExpressionNode> RewritePolynomials(const ExpressionNode& node);
+
+} // namespace plot_genius
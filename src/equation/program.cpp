@@ -0,0 +1,488 @@
+/**
+ * Expression Program Implementation
+ *
+ * Implements compilation of expression trees into programs, their
+ * evaluation, validation of untrusted programs and decompilation.
+ */
+
+#include "program.hpp"
+#include "execute.hpp"
+#include "polynomial.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace plot_genius {
+
+namespace {
+
+// Programs up to this length evaluate without touching the heap
+constexpr ::std::size_t kInlineSlots = 64;
+
+// x values processed together by EvaluateSweep; a slot's tile stays within a few cache lines
+constexpr ::std::size_t kSweepTile = 64;
+
+// What a sweep instruction depends on; the classes are bit sets
+constexpr ::std::uint8_t kOnX = 1;
+constexpr ::std::uint8_t kOnSwept = 2;
+
+// Gets what every instruction depends on when one parameter is swept
+::std::vector<::std::uint8_t> ClassifySweep(const ::std::vector<Instruction>& code, ::std::uint32_t parameter) {
+    ::std::vector<::std::uint8_t> depends(code.size(), 0);
+    for (::std::size_t i = 0; i < code.size(); ++i) {
+        const Instruction& instruction = code[i];
+        const int operands = GetOperandCount(instruction.op);
+        ::std::uint8_t mask = 0;
+        if (instruction.op == OpCode::Variable) {
+            mask = kOnX;
+        } else if (instruction.op == OpCode::Parameter && instruction.lhs == parameter) {
+            mask = kOnSwept;
+        }
+        if (operands >= 1) {
+            mask |= depends[instruction.lhs];
+        }
+        if (operands == 2) {
+            mask |= depends[instruction.rhs];
+        }
+        depends[i] = mask;
+    }
+    return depends;
+}
+
+// Checks whether an operation gives the same result with its operands swapped
+bool IsCommutative(OpCode op) {
+    return op == OpCode::Add || op == OpCode::Multiply;
+}
+
+class Compiler {
+public:
+    ::std::uint32_t CompileNode(const ExpressionNode& node) {
+        Instruction instruction;
+        instruction.op = node.op;
+        if (node.op == OpCode::Constant) {
+            instruction.value = node.value;
+        }
+
+        if (node.op == OpCode::Parameter) {
+            instruction.lhs = GetParameterIndex(node.name);
+            return code.Add(instruction);
+        }
+
+        // Operands first, so they always occupy earlier slots
+        const int operands = GetOperandCount(node.op);
+        if (operands >= 1) {
+            instruction.lhs = CompileNode(*node.left);
+        }
+        if (operands == 2) {
+            instruction.rhs = CompileNode(*node.right);
+        }
+
+        // Constants left unused by folding are dropped when the code is finished
+        const bool folds = operands >= 1 && IsConstant(instruction.lhs) &&
+                           (operands == 1 || IsConstant(instruction.rhs));
+        if (folds) {
+            Instruction constant;
+            constant.value = ApplyOp(instruction.op, code.Get(instruction.lhs).value,
+                                     operands == 2 ? code.Get(instruction.rhs).value : 0.0);
+            return code.Add(constant);
+        }
+        return code.Add(instruction);
+    }
+
+    InstructionBuilder code;
+    ::std::vector<::std::string> parameters;
+
+private:
+    bool IsConstant(::std::uint32_t slot) const {
+        return code.Get(slot).op == OpCode::Constant;
+    }
+
+    ::std::uint32_t GetParameterIndex(const ::std::string& name) {
+        for (::std::size_t i = 0; i < parameters.size(); ++i) {
+            if (parameters[i] == name) {
+                return static_cast<::std::uint32_t>(i);
+            }
+        }
+        parameters.push_back(name);
+        return static_cast<::std::uint32_t>(parameters.size() - 1);
+    }
+};
+
+} // namespace
+
+::std::size_t InstructionHash::operator()(const Instruction& instruction) const {
+    ::std::size_t hash = static_cast<::std::size_t>(instruction.op);
+    auto mix = [&hash](::std::uint64_t value) {
+        hash ^= ::std::hash<::std::uint64_t>()(value) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    };
+    switch (instruction.op) {
+        case OpCode::Constant: {
+            ::std::uint64_t bits;
+            ::std::memcpy(&bits, &instruction.value, sizeof(bits));
+            mix(bits);
+            break;
+        }
+        case OpCode::Variable:
+            break;
+        default:
+            mix(instruction.lhs);
+            if (GetOperandCount(instruction.op) == 2) {
+                mix(instruction.rhs);
+            }
+            break;
+    }
+    return hash;
+}
+
+bool InstructionEqual::operator()(const Instruction& a, const Instruction& b) const {
+    if (a.op != b.op) {
+        return false;
+    }
+    switch (a.op) {
+        case OpCode::Constant:
+            return ::std::memcmp(&a.value, &b.value, sizeof(a.value)) == 0;
+        case OpCode::Variable:
+            return true;
+        default:
+            return a.lhs == b.lhs && (GetOperandCount(a.op) < 2 || a.rhs == b.rhs);
+    }
+}
+
+::std::uint32_t InstructionBuilder::Add(Instruction instruction) {
+    if (IsCommutative(instruction.op) && instruction.lhs > instruction.rhs) {
+        ::std::swap(instruction.lhs, instruction.rhs);
+    }
+    auto found = m_slots.find(instruction);
+    if (found != m_slots.end()) {
+        return found->second;
+    }
+    const auto slot = static_cast<::std::uint32_t>(m_code.size());
+    m_code.push_back(instruction);
+    m_slots.emplace(instruction, slot);
+    return slot;
+}
+
+::std::vector<Instruction> InstructionBuilder::Finish(::std::vector<::std::uint32_t>& roots) {
+    // Operands precede their users, so one backward pass marks everything needed
+    ::std::vector<bool> needed(m_code.size(), false);
+    for (::std::uint32_t root : roots) {
+        needed[root] = true;
+    }
+    for (::std::size_t i = m_code.size(); i-- > 0;) {
+        if (!needed[i]) {
+            continue;
+        }
+        const int operands = GetOperandCount(m_code[i].op);
+        if (operands >= 1) {
+            needed[m_code[i].lhs] = true;
+        }
+        if (operands == 2) {
+            needed[m_code[i].rhs] = true;
+        }
+    }
+
+    ::std::vector<::std::uint32_t> moved(m_code.size(), 0);
+    ::std::vector<Instruction> code;
+    for (::std::size_t i = 0; i < m_code.size(); ++i) {
+        if (!needed[i]) {
+            continue;
+        }
+        Instruction instruction = m_code[i];
+        const int operands = GetOperandCount(instruction.op);
+        if (operands >= 1) {
+            instruction.lhs = moved[instruction.lhs];
+        }
+        if (operands == 2) {
+            instruction.rhs = moved[instruction.rhs];
+        }
+        moved[i] = static_cast<::std::uint32_t>(code.size());
+        code.push_back(instruction);
+    }
+    for (::std::uint32_t& root : roots) {
+        root = moved[root];
+    }
+
+    m_code.clear();
+    m_slots.clear();
+    return code;
+}
+
+Program::Program(::std::vector<Instruction> code, ::std::vector<::std::string> parameters)
+    : m_code(::std::move(code)), m_parameters(::std::move(parameters)) {
+    // Split the instructions by whether they read x, directly or through an
+    // operand. Code read from files is validated after construction, so
+    // operands are range-checked here.
+    ::std::vector<bool> varies(m_code.size(), false);
+    auto reads = [&](::std::size_t i, ::std::uint32_t slot) { return slot < i && varies[slot]; };
+    for (::std::size_t i = 0; i < m_code.size(); ++i) {
+        const Instruction& instruction = m_code[i];
+        const int operands = GetOperandCount(instruction.op);
+        varies[i] = instruction.op == OpCode::Variable ||
+                    (operands >= 1 && reads(i, instruction.lhs)) ||
+                    (operands == 2 && reads(i, instruction.rhs));
+        (varies[i] ? m_varying : m_invariant).push_back(static_cast<::std::uint32_t>(i));
+    }
+}
+
+Program Program::Compile(const ExpressionNode& root) {
+    Compiler compiler;
+    // Everything the root needs comes before it, so it ends up in the last slot
+    ::std::vector<::std::uint32_t> roots{compiler.CompileNode(*RewritePolynomials(root))};
+    return Program(compiler.code.Finish(roots), ::std::move(compiler.parameters));
+}
+
+bool Program::Validate(const ::std::vector<Instruction>& code, ::std::size_t parameterCount,
+                       ::std::string& error) {
+    if (code.empty()) {
+        error = "Program is empty";
+        return false;
+    }
+
+    for (::std::size_t i = 0; i < code.size(); ++i) {
+        const Instruction& instruction = code[i];
+        if (instruction.op >= OpCode::Count) {
+            error = "Unknown operation at instruction " + ::std::to_string(i);
+            return false;
+        }
+
+        // Operands must already be computed when the instruction runs
+        const int operands = GetOperandCount(instruction.op);
+        if ((operands >= 1 && instruction.lhs >= i) || (operands == 2 && instruction.rhs >= i)) {
+            error = "Invalid operand at instruction " + ::std::to_string(i);
+            return false;
+        }
+        if (instruction.op == OpCode::Parameter && instruction.lhs >= parameterCount) {
+            error = "Invalid parameter at instruction " + ::std::to_string(i);
+            return false;
+        }
+    }
+    return true;
+}
+
+double Program::Evaluate(double x, const double* parameters) const {
+    double y = 0.0;
+    EvaluateBatch(&x, &y, 1, parameters);
+    return y;
+}
+
+void Program::EvaluateBatch(const double* x, double* y, ::std::size_t count, const double* parameters) const {
+    if (m_code.empty()) {
+        throw ::std::runtime_error("No equation has been compiled");
+    }
+
+    double inlineSlots[kInlineSlots];
+    double* slots = inlineSlots;
+    if (m_code.size() > kInlineSlots) {
+        thread_local ::std::vector<double> heapSlots;
+        heapSlots.resize(m_code.size());
+        slots = heapSlots.data();
+    }
+
+    // Constants, parameters and anything computed from them alone are the same for every x
+    for (::std::uint32_t i : m_invariant) {
+        slots[i] = Execute(m_code[i], slots, 0.0, parameters);
+    }
+
+    const ::std::size_t result = m_code.size() - 1;
+    if (m_varying.empty() || m_varying.back() != result) {
+        ::std::fill(y, y + count, slots[result]);
+        return;
+    }
+
+    for (::std::size_t k = 0; k < count; ++k) {
+        for (::std::uint32_t i : m_varying) {
+            slots[i] = Execute(m_code[i], slots, x[k], parameters);
+        }
+        y[k] = slots[result];
+    }
+}
+
+void Program::EvaluateSweep(const double* x, ::std::size_t count, const double* parameters,
+                            ::std::uint32_t sweptParameter, const double* sweptValues, ::std::size_t members,
+                            double* y, ::std::size_t stride) const {
+    if (m_code.empty()) {
+        throw ::std::runtime_error("No equation has been compiled");
+    }
+
+    // Group the instructions by dependency; each group only reads its own or smaller ones
+    const ::std::size_t size = m_code.size();
+    const ::std::vector<::std::uint8_t> depends = ClassifySweep(m_code, sweptParameter);
+    ::std::vector<::std::uint32_t> groups[4];
+    for (::std::size_t i = 0; i < size; ++i) {
+        groups[depends[i]].push_back(static_cast<::std::uint32_t>(i));
+    }
+
+    // Every slot has a tile; slots independent of x hold their value in each lane
+    thread_local ::std::vector<double> tiles;
+    tiles.resize(size * kSweepTile);
+    ::std::vector<double> scalars(size);
+    auto tile = [&](::std::uint32_t slot) { return tiles.data() + slot * kSweepTile; };
+
+    for (::std::uint32_t i : groups[0]) {
+        scalars[i] = Execute(m_code[i], scalars.data(), 0.0, parameters);
+        ::std::fill(tile(i), tile(i) + kSweepTile, scalars[i]);
+    }
+
+    const ::std::uint32_t result = static_cast<::std::uint32_t>(size - 1);
+    for (::std::size_t start = 0; start < count; start += kSweepTile) {
+        const ::std::size_t n = ::std::min(kSweepTile, count - start);
+
+        for (::std::uint32_t i : groups[kOnX]) {
+            const Instruction& instruction = m_code[i];
+            if (instruction.op == OpCode::Variable) {
+                ::std::copy(x + start, x + start + n, tile(i));
+            } else {
+                ApplyTile(instruction.op, tile(instruction.lhs), tile(instruction.rhs), tile(i), n, m_precision);
+            }
+        }
+
+        for (::std::size_t m = 0; m < members; ++m) {
+            for (::std::uint32_t i : groups[kOnSwept]) {
+                const Instruction& instruction = m_code[i];
+                scalars[i] = instruction.op == OpCode::Parameter
+                                 ? sweptValues[m]
+                                 : ApplyOp(instruction.op, scalars[instruction.lhs], scalars[instruction.rhs]);
+                ::std::fill(tile(i), tile(i) + n, scalars[i]);
+            }
+            for (::std::uint32_t i : groups[kOnX | kOnSwept]) {
+                const Instruction& instruction = m_code[i];
+                ApplyTile(instruction.op, tile(instruction.lhs), tile(instruction.rhs), tile(i), n, m_precision);
+            }
+            ::std::copy(tile(result), tile(result) + n, y + m * stride + start);
+        }
+    }
+}
+
+void Program::PrepareSweep(const double* x, ::std::size_t count, const double* parameters,
+                           ::std::uint32_t sweptParameter, SweepCache& cache) const {
+    if (m_code.empty()) {
+        throw ::std::runtime_error("No equation has been compiled");
+    }
+
+    const ::std::size_t size = m_code.size();
+    cache.parameter = sweptParameter;
+    cache.count = count;
+    cache.depends = ClassifySweep(m_code, sweptParameter);
+    cache.scalars.assign(size, 0.0);
+    cache.column.assign(size, 0);
+
+    ::std::vector<::std::uint32_t> columnSlots;
+    for (::std::size_t i = 0; i < size; ++i) {
+        if (cache.depends[i] == 0) {
+            cache.scalars[i] = Execute(m_code[i], cache.scalars.data(), 0.0, parameters);
+        } else if (cache.depends[i] == kOnX) {
+            cache.column[i] = static_cast<::std::uint32_t>(columnSlots.size());
+            columnSlots.push_back(static_cast<::std::uint32_t>(i));
+        }
+    }
+
+    // Runs once per grid, so a plain scalar pass is fast enough
+    cache.columns.resize(columnSlots.size() * count);
+    ::std::vector<double> slots(cache.scalars);
+    for (::std::size_t k = 0; k < count; ++k) {
+        for (::std::size_t c = 0; c < columnSlots.size(); ++c) {
+            const ::std::uint32_t i = columnSlots[c];
+            slots[i] = Execute(m_code[i], slots.data(), x[k], parameters);
+            cache.columns[c * count + k] = slots[i];
+        }
+    }
+}
+
+void Program::EvaluatePrepared(const SweepCache& cache, double value, double* y) const {
+    const ::std::size_t size = m_code.size();
+    if (size == 0 || cache.depends.size() != size) {
+        throw ::std::runtime_error("Sweep cache does not belong to this program");
+    }
+
+    thread_local ::std::vector<double> tiles;
+    tiles.resize(size * kSweepTile);
+    ::std::vector<double> scalars(cache.scalars);
+    auto tile = [&](::std::uint32_t slot) { return tiles.data() + slot * kSweepTile; };
+
+    // Slots that depend on neither input are constant across every tile
+    ::std::vector<::std::uint32_t> varying;
+    for (::std::uint32_t i = 0; i < size; ++i) {
+        const Instruction& instruction = m_code[i];
+        switch (cache.depends[i]) {
+            case 0:
+                ::std::fill(tile(i), tile(i) + kSweepTile, scalars[i]);
+                break;
+            case kOnSwept:
+                scalars[i] = instruction.op == OpCode::Parameter
+                                 ? value
+                                 : ApplyOp(instruction.op, scalars[instruction.lhs], scalars[instruction.rhs]);
+                ::std::fill(tile(i), tile(i) + kSweepTile, scalars[i]);
+                break;
+            case kOnX | kOnSwept:
+                varying.push_back(i);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Columns computed by PrepareSweep are read in place
+    const ::std::size_t count = cache.count;
+    auto operand = [&](::std::uint32_t slot, ::std::size_t start) -> const double* {
+        return cache.depends[slot] == kOnX ? cache.columns.data() + cache.column[slot] * count + start : tile(slot);
+    };
+
+    const ::std::uint32_t result = static_cast<::std::uint32_t>(size - 1);
+    for (::std::size_t start = 0; start < count; start += kSweepTile) {
+        const ::std::size_t n = ::std::min(kSweepTile, count - start);
+        for (::std::uint32_t i : varying) {
+            const Instruction& instruction = m_code[i];
+            ApplyTile(instruction.op, operand(instruction.lhs, start), operand(instruction.rhs, start), tile(i), n,
+                      m_precision);
+        }
+        const double* values = operand(result, start);
+        ::std::copy(values, values + n, y + start);
+    }
+}
+
+::std::unique_ptr<ExpressionNode> Program::Decompile() const {
+    if (m_code.empty()) {
+        return nullptr;
+    }
+
+    // A slot read by several instructions becomes a copied subtree
+    ::std::vector<int> uses(m_code.size(), 0);
+    for (const Instruction& instruction : m_code) {
+        const int operands = GetOperandCount(instruction.op);
+        if (operands >= 1) {
+            ++uses[instruction.lhs];
+        }
+        if (operands == 2) {
+            ++uses[instruction.rhs];
+        }
+    }
+
+    ::std::vector<::std::unique_ptr<ExpressionNode>> nodes(m_code.size());
+    auto take = [&](::std::uint32_t slot) {
+        return --uses[slot] > 0 ? CloneExpression(*nodes[slot]) : ::std::move(nodes[slot]);
+    };
+
+    for (::std::size_t i = 0; i < m_code.size(); ++i) {
+        const Instruction& instruction = m_code[i];
+        switch (GetOperandCount(instruction.op)) {
+            case 0:
+                if (instruction.op == OpCode::Parameter) {
+                    nodes[i] = MakeParameter(m_parameters[instruction.lhs]);
+                } else {
+                    nodes[i] = instruction.op == OpCode::Variable ? MakeVariable() : MakeConstant(instruction.value);
+                }
+                break;
+            case 1:
+                nodes[i] = MakeOperation(instruction.op, take(instruction.lhs));
+                break;
+            default: {
+                auto left = take(instruction.lhs);
+                nodes[i] = MakeOperation(instruction.op, ::std::move(left), take(instruction.rhs));
+                break;
+            }
+        }
+    }
+    return ::std::move(nodes.back());
+}
+
+} // namespace plot_genius
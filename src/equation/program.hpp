@@ -0,0 +1,281 @@
+/**
+ * Expression Program Header
+ *
+ * Defines the compiled form of an expression: a flat list of instructions
+ * evaluated in order, each writing one value slot. Programs have no pointers,
+ * so they are cheap to evaluate, copy and store in session files.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "expression.hpp"
+#include "fast_math.hpp"
+
+namespace plot_genius {
+
+/// Value of a parameter the caller supplies no binding for
+constexpr double kDefaultParameterValue = 1.0;
+
+/**
+ * One program step; its result goes to the slot with the same index
+ */
+struct Instruction {
+    OpCode op{OpCode::Constant};  ///< Operation
+    std::uint32_t lhs{0};         ///< Slot of the first operand, or parameter index of a Parameter instruction
+    std::uint32_t rhs{0};         ///< Slot of the second operand
+    double value{0.0};            ///< Value of a Constant instruction
+};
+
+/**
+ * Hash of the fields of an instruction that its operation uses
+ */
+struct InstructionHash {
+    ::std::size_t operator()(const Instruction& instruction) const;
+};
+
+/**
+ * Equality of instructions that compute the same value
+ *
+ * Constants are compared by bit pattern, so 0 and -0 stay distinct.
+ */
+struct InstructionEqual {
+    bool operator()(const Instruction& a, const Instruction& b) const;
+};
+
+/**
+ * Instruction list that stores every distinct instruction once
+ *
+ * Identical subexpressions, within one expression or across several,
+ * end up in the same slot and are evaluated once. The operands of
+ * commutative operations are put in slot order first, so a*b and b*a
+ * share a slot as well.
+ */
+class InstructionBuilder {
+public:
+    /**
+     * Adds an instruction unless an identical one exists
+     *
+     * @param instruction Instruction whose operands are earlier slots
+     * @return Slot holding the instruction's value
+     */
+    ::std::uint32_t Add(Instruction instruction);
+
+    /**
+     * Gets an added instruction
+     *
+     * @param slot Slot returned by Add
+     * @return Instruction in the slot
+     */
+    const Instruction& Get(::std::uint32_t slot) const { return m_code[slot]; }
+
+    /**
+     * Takes the instructions, dropping those none of the roots depends on
+     *
+     * @param roots Slots whose values are needed; rewritten to their final positions
+     * @return Instructions in evaluation order
+     */
+    ::std::vector<Instruction> Finish(::std::vector<::std::uint32_t>& roots);
+
+private:
+    ::std::vector<Instruction> m_code;
+    ::std::unordered_map<Instruction, ::std::uint32_t, InstructionHash, InstructionEqual> m_slots;
+};
+
+/**
+ * Values kept between evaluations that differ only in one parameter
+ *
+ * Filled by Program::PrepareSweep for fixed x values and fixed other
+ * parameters; Program::EvaluatePrepared then only computes the
+ * instructions that depend on the swept parameter.
+ */
+struct SweepCache {
+    ::std::uint32_t parameter{0};            ///< Index of the swept parameter
+    ::std::size_t count{0};                  ///< Number of x values
+    ::std::vector<::std::uint8_t> depends;   ///< Per slot: 1 if it depends on x, 2 on the parameter, 3 on both
+    ::std::vector<double> scalars;           ///< Values of the slots that depend on neither
+    ::std::vector<double> columns;           ///< count values per slot that depends on x only
+    ::std::vector<::std::uint32_t> column;   ///< Column of each x-only slot in columns
+
+    /**
+     * Checks whether the cache has been prepared
+     *
+     * @return True after PrepareSweep
+     */
+    bool IsPrepared() const { return !depends.empty(); }
+};
+
+/**
+ * Compiled expression
+ *
+ * Operands always refer to earlier slots and the last slot holds the result.
+ * Parameters are referred to by index into the program's parameter names;
+ * their values are passed to every evaluation, so changing a value never
+ * requires recompiling.
+ */
+class Program {
+public:
+    /**
+     * Creates an empty program
+     */
+    Program() = default;
+
+    /**
+     * Creates a program from instructions
+     *
+     * @param code Instructions; must pass Validate
+     * @param parameters Names of the parameters the instructions refer to
+     */
+    explicit Program(::std::vector<Instruction> code, ::std::vector<::std::string> parameters = {});
+
+    /**
+     * Compiles an expression tree
+     *
+     * Polynomials in x and integer powers are first rewritten by
+     * RewritePolynomials. Operations on constants only are folded into a
+     * single constant, and repeated subexpressions are computed once.
+     *
+     * @param root Root of the tree
+     * @return Program computing the same value
+     */
+    static Program Compile(const ExpressionNode& root);
+
+    /**
+     * Checks that instructions form a well-formed program
+     *
+     * @param code Instructions to check, e.g. read from a file
+     * @param parameterCount Number of parameter names that come with them
+     * @param error Receives the reason on failure
+     * @return True if the instructions can be evaluated safely
+     */
+    static bool Validate(const ::std::vector<Instruction>& code, ::std::size_t parameterCount,
+                         ::std::string& error);
+
+    /**
+     * Evaluates the program at a specific x value
+     *
+     * @param x The value to substitute for the variable x
+     * @param parameters One value per parameter name, or nullptr to use kDefaultParameterValue
+     * @return The result of the expression
+     * @throws std::runtime_error if the program is empty
+     */
+    double Evaluate(double x, const double* parameters = nullptr) const;
+
+    /**
+     * Evaluates the program at many x values with the same parameters
+     *
+     * Instructions that do not depend on x, such as products of parameters,
+     * run once per call instead of once per value.
+     *
+     * @param x Input values
+     * @param y Receives one result per input value; may be the same buffer as x
+     * @param count Number of values
+     * @param parameters One value per parameter name, or nullptr to use kDefaultParameterValue
+     * @throws std::runtime_error if the program is empty
+     */
+    void EvaluateBatch(const double* x, double* y, ::std::size_t count, const double* parameters = nullptr) const;
+
+    /**
+     * Evaluates the program for several values of one parameter at many x values
+     *
+     * Runs one instruction at a time across a tile of x values, so the inner
+     * loops are plain array operations, and computes what does not depend on
+     * the swept parameter once per tile for all members.
+     *
+     * @param x Input values
+     * @param count Number of x values
+     * @param parameters Values of all parameters (the swept one is ignored), or nullptr for defaults
+     * @param sweptParameter Index of the parameter to vary
+     * @param sweptValues One value of the swept parameter per member
+     * @param members Number of members
+     * @param y Receives the result of member m at x[i] in y[m * stride + i]
+     * @param stride Distance between members in y, at least count
+     * @throws std::runtime_error if the program is empty
+     */
+    void EvaluateSweep(const double* x, ::std::size_t count, const double* parameters,
+                       ::std::uint32_t sweptParameter, const double* sweptValues, ::std::size_t members,
+                       double* y, ::std::size_t stride) const;
+
+    /**
+     * Evaluates everything that does not depend on one parameter, for reuse
+     *
+     * @param x Input values
+     * @param count Number of x values
+     * @param parameters Values of all parameters (the swept one is ignored), or nullptr for defaults
+     * @param sweptParameter Index of the parameter that will vary
+     * @param cache Receives the values
+     * @throws std::runtime_error if the program is empty
+     */
+    void PrepareSweep(const double* x, ::std::size_t count, const double* parameters,
+                      ::std::uint32_t sweptParameter, SweepCache& cache) const;
+
+    /**
+     * Evaluates the program at the prepared x values for one value of the swept parameter
+     *
+     * @param cache Filled by PrepareSweep of this program
+     * @param value Value of the swept parameter
+     * @param y Receives cache.count results
+     * @throws std::runtime_error if the cache was prepared for another program
+     */
+    void EvaluatePrepared(const SweepCache& cache, double value, double* y) const;
+
+    /**
+     * Rebuilds an expression tree from the program
+     *
+     * @return Tree computing the same value, or nullptr for an empty program
+     */
+    ::std::unique_ptr<ExpressionNode> Decompile() const;
+
+    /**
+     * Gets the instructions
+     *
+     * @return Instructions in evaluation order
+     */
+    const ::std::vector<Instruction>& GetInstructions() const { return m_code; }
+
+    /**
+     * Gets the names of the parameters
+     *
+     * @return Names in the order evaluation expects their values
+     */
+    const ::std::vector<::std::string>& GetParameters() const { return m_parameters; }
+
+    /**
+     * Checks whether the program has no instructions
+     *
+     * @return True if empty
+     */
+    bool IsEmpty() const { return m_code.empty(); }
+
+    /**
+     * Sets how the built-in functions are computed over many x values
+     *
+     * Applies to the evaluators that run an instruction across a tile or
+     * block of values: sweeps, prepared sweeps, program groups and compiled
+     * programs. Evaluate and EvaluateBatch compute one value at a time and
+     * stay precise.
+     *
+     * @param precision Precision to use
+     */
+    void SetPrecision(MathPrecision precision) { m_precision = precision; }
+
+    /**
+     * Gets how the built-in functions are computed over many x values
+     *
+     * @return Precision set with SetPrecision, Precise by default
+     */
+    MathPrecision GetPrecision() const { return m_precision; }
+
+private:
+    ::std::vector<Instruction> m_code;             ///< Instructions in evaluation order
+    ::std::vector<::std::string> m_parameters;     ///< Parameter names referenced by index
+    ::std::vector<::std::uint32_t> m_invariant;    ///< Instructions independent of x
+    ::std::vector<::std::uint32_t> m_varying;      ///< Instructions depending on x
+    MathPrecision m_precision{MathPrecision::Precise};  ///< How tiles compute the built-in functions
+};
+
+} // namespace plot_genius
@@ -0,0 +1,190 @@
+/**
+ * Program Group Implementation
+ *
+ * Members are merged through an InstructionBuilder, which stores each
+ * distinct instruction once, and evaluated like one program with several
+ * results.
+ */
+
+#include "program_group.hpp"
+#include "execute.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace plot_genius {
+
+namespace {
+
+// Working values of one block should fit in L1 next to the outputs
+constexpr ::std::size_t kBlockBytes = 32 * 1024;
+constexpr ::std::size_t kMinBlock = 8;
+constexpr ::std::size_t kMaxBlock = 256;
+
+// Counts the nodes of a program written out as a tree, saturating on overflow
+::std::uint64_t CountTreeNodes(const ::std::vector<Instruction>& code) {
+    constexpr ::std::uint64_t kMax = ::std::numeric_limits<::std::uint64_t>::max();
+    auto add = [](::std::uint64_t a, ::std::uint64_t b) { return a > kMax - b ? kMax : a + b; };
+    ::std::vector<::std::uint64_t> nodes(code.size(), 1);
+    for (::std::size_t i = 0; i < code.size(); ++i) {
+        const int operands = GetOperandCount(code[i].op);
+        if (operands >= 1) {
+            nodes[i] = add(nodes[i], nodes[code[i].lhs]);
+        }
+        if (operands == 2) {
+            nodes[i] = add(nodes[i], nodes[code[i].rhs]);
+        }
+    }
+    return code.empty() ? 0 : nodes.back();
+}
+
+} // namespace
+
+ProgramGroup::ProgramGroup(const ::std::vector<const Program*>& programs) {
+    InstructionBuilder builder;
+    ::std::vector<::std::uint32_t> slots;
+    for (const Program* program : programs) {
+        if (program->GetPrecision() == MathPrecision::Precise) {
+            m_precision = MathPrecision::Precise;
+        }
+
+        // Parameters are merged by name
+        ::std::vector<::std::uint32_t> parameterMap;
+        for (const auto& name : program->GetParameters()) {
+            auto found = ::std::find(m_parameters.begin(), m_parameters.end(), name);
+            if (found == m_parameters.end()) {
+                found = m_parameters.insert(m_parameters.end(), name);
+            }
+            parameterMap.push_back(static_cast<::std::uint32_t>(found - m_parameters.begin()));
+        }
+
+        const auto& code = program->GetInstructions();
+        slots.assign(code.size(), 0);
+        for (::std::size_t i = 0; i < code.size(); ++i) {
+            Instruction instruction = code[i];
+            const int operands = GetOperandCount(instruction.op);
+            if (instruction.op == OpCode::Parameter) {
+                instruction.lhs = parameterMap[instruction.lhs];
+            } else if (operands >= 1) {
+                instruction.lhs = slots[instruction.lhs];
+                if (operands == 2) {
+                    instruction.rhs = slots[instruction.rhs];
+                }
+            }
+            slots[i] = builder.Add(instruction);
+        }
+
+        m_parameterMaps.push_back(::std::move(parameterMap));
+        m_outputs.push_back(code.empty() ? 0 : slots.back());
+        SharingStats stats;
+        stats.treeNodes = CountTreeNodes(code);
+        stats.instructions = code.size();
+        m_stats.push_back(stats);
+    }
+    m_code = builder.Finish(m_outputs);
+
+    // Count the members using each slot
+    ::std::vector<::std::uint32_t> users(m_code.size(), 0);
+    ::std::vector<::std::vector<bool>> uses(m_outputs.size());
+    for (::std::size_t member = 0; member < m_outputs.size(); ++member) {
+        auto& used = uses[member];
+        used.assign(m_code.size(), false);
+        if (m_code.empty()) {
+            continue;
+        }
+        used[m_outputs[member]] = true;
+        for (::std::size_t i = m_outputs[member] + 1; i-- > 0;) {
+            if (!used[i]) {
+                continue;
+            }
+            ++users[i];
+            const int operands = GetOperandCount(m_code[i].op);
+            if (operands >= 1) {
+                used[m_code[i].lhs] = true;
+            }
+            if (operands == 2) {
+                used[m_code[i].rhs] = true;
+            }
+        }
+    }
+    for (::std::size_t member = 0; member < m_outputs.size(); ++member) {
+        for (::std::size_t i = 0; i < m_code.size(); ++i) {
+            if (uses[member][i] && users[i] > 1) {
+                ++m_stats[member].shared;
+            }
+        }
+    }
+
+    ::std::vector<bool> varies(m_code.size(), false);
+    for (::std::size_t i = 0; i < m_code.size(); ++i) {
+        const Instruction& instruction = m_code[i];
+        const int operands = GetOperandCount(instruction.op);
+        varies[i] = instruction.op == OpCode::Variable ||
+                    (operands >= 1 && varies[instruction.lhs]) ||
+                    (operands == 2 && varies[instruction.rhs]);
+        (varies[i] ? m_varying : m_invariant).push_back(static_cast<::std::uint32_t>(i));
+    }
+    for (::std::size_t member = 0; member < m_outputs.size(); ++member) {
+        if (!m_code.empty() && varies[m_outputs[member]]) {
+            m_varyingMembers.push_back(member);
+        }
+    }
+
+    // Every slot gets a block of values; multiples of 8 keep the loops free of remainders
+    const ::std::size_t perValue = ::std::max<::std::size_t>(m_code.size(), 1) * sizeof(double);
+    m_block = ::std::clamp(kBlockBytes / perValue / kMinBlock * kMinBlock, kMinBlock, kMaxBlock);
+}
+
+void ProgramGroup::SetMemberParameters(::std::size_t member, const double* values, double* merged) const {
+    const auto& map = m_parameterMaps[member];
+    for (::std::size_t i = 0; i < map.size(); ++i) {
+        merged[map[i]] = values[i];
+    }
+}
+
+void ProgramGroup::EvaluateBatch(const double* x, ::std::size_t count, const double* parameters,
+                                 double* const* y) const {
+    if (m_code.empty()) {
+        throw ::std::runtime_error("No equation has been compiled");
+    }
+
+    thread_local ::std::vector<double> blocks;
+    blocks.resize(m_code.size() * m_block);
+    auto block = [&](::std::uint32_t slot) { return blocks.data() + slot * m_block; };
+
+    // Shared constants and parameter expressions are computed once for every member
+    // and spread over their blocks, so x-dependent instructions can read them element-wise
+    for (::std::uint32_t i : m_invariant) {
+        const Instruction& instruction = m_code[i];
+        const double value = GetOperandCount(instruction.op) == 0
+                                 ? Execute(instruction, nullptr, 0.0, parameters)
+                                 : ApplyOp(instruction.op, block(instruction.lhs)[0], block(instruction.rhs)[0]);
+        ::std::fill(block(i), block(i) + m_block, value);
+    }
+    for (::std::size_t member = 0; member < m_outputs.size(); ++member) {
+        if (!::std::binary_search(m_varyingMembers.begin(), m_varyingMembers.end(), member)) {
+            ::std::fill(y[member], y[member] + count, block(m_outputs[member])[0]);
+        }
+    }
+    if (m_varyingMembers.empty()) {
+        return;
+    }
+
+    for (::std::size_t start = 0; start < count; start += m_block) {
+        const ::std::size_t n = ::std::min(m_block, count - start);
+        for (::std::uint32_t i : m_varying) {
+            const Instruction& instruction = m_code[i];
+            if (instruction.op == OpCode::Variable) {
+                ::std::copy(x + start, x + start + n, block(i));
+            } else {
+                ApplyTile(instruction.op, block(instruction.lhs), block(instruction.rhs), block(i), n, m_precision);
+            }
+        }
+        for (::std::size_t member : m_varyingMembers) {
+            const double* values = block(m_outputs[member]);
+            ::std::copy(values, values + n, y[member] + start);
+        }
+    }
+}
+
+} // namespace plot_genius
@@ -0,0 +1,124 @@
+/**
+ * Program Group Header
+ *
+ * Defines a set of programs merged into one instruction list, so that
+ * subexpressions repeated across equations (say exp(-x*x/2) in dozens of
+ * generated ones) are evaluated once per x value for all of them.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "program.hpp"
+
+namespace plot_genius {
+
+/**
+ * How much of one member's work the group shares
+ */
+struct SharingStats {
+    std::uint64_t treeNodes{0};   ///< Nodes of the member written out as a tree (saturates)
+    std::size_t instructions{0};  ///< Instructions of the member's own program, repeats within it removed
+    std::size_t shared{0};        ///< Of those, instructions other members of the group use as well
+};
+
+/**
+ * Several programs evaluated together on common x values
+ */
+class ProgramGroup {
+public:
+    /**
+     * Creates an empty group
+     */
+    ProgramGroup() = default;
+
+    /**
+     * Merges programs into one instruction list
+     *
+     * Parameters with the same name are merged as well, since every
+     * program looks its values up by name. Shared instructions serve
+     * members of either precision, so the group uses the fast kernels only
+     * if every member's precision is MathPrecision::Fast.
+     *
+     * @param programs Non-empty programs; member i computes programs[i]
+     */
+    explicit ProgramGroup(const std::vector<const Program*>& programs);
+
+    /**
+     * Gets the number of members
+     *
+     * @return Number of programs merged
+     */
+    std::size_t GetSize() const { return m_outputs.size(); }
+
+    /**
+     * Gets the names of the merged parameters
+     *
+     * @return Names in the order evaluation expects their values
+     */
+    const std::vector<std::string>& GetParameters() const { return m_parameters; }
+
+    /**
+     * Stores one member's parameter values at their merged positions
+     *
+     * @param member Member index
+     * @param values One value per parameter of the member's program
+     * @param merged Values of the merged parameters to update
+     */
+    void SetMemberParameters(std::size_t member, const double* values, double* merged) const;
+
+    /**
+     * Evaluates every member at many x values
+     *
+     * Runs x-major: each block of x values goes through all merged
+     * instructions, one instruction at a time across the block, before the
+     * next block starts. Blocks are sized so the working values of the whole
+     * group stay in the L1 cache. Thread-safe.
+     *
+     * @param x Input values
+     * @param count Number of values
+     * @param parameters One value per merged parameter, or nullptr to use kDefaultParameterValue
+     * @param y One output column per member; the result at x[i] goes to y[member][i]
+     * @throws std::runtime_error if the group is empty
+     */
+    void EvaluateBatch(const double* x, std::size_t count, const double* parameters, double* const* y) const;
+
+    /**
+     * Gets the sharing figures of a member
+     *
+     * @param member Member index
+     * @return Figures of the member
+     */
+    const SharingStats& GetStats(std::size_t member) const { return m_stats[member]; }
+
+    /**
+     * Gets the number of merged instructions
+     *
+     * @return Instructions evaluated per x value for all members together
+     */
+    std::size_t GetInstructionCount() const { return m_code.size(); }
+
+    /**
+     * Gets how the group computes the built-in functions
+     *
+     * @return Fast if every member is fast, otherwise Precise
+     */
+    MathPrecision GetPrecision() const { return m_precision; }
+
+private:
+    std::vector<Instruction> m_code;                   ///< Merged instructions in evaluation order
+    std::vector<std::string> m_parameters;             ///< Merged parameter names
+    std::vector<std::vector<std::uint32_t>> m_parameterMaps;  ///< Per member: merged index of each parameter
+    std::vector<std::uint32_t> m_outputs;              ///< Per member: slot of its result
+    std::vector<std::size_t> m_varyingMembers;         ///< Members whose result depends on x
+    std::vector<SharingStats> m_stats;                 ///< Per member: sharing figures
+    std::vector<std::uint32_t> m_invariant;            ///< Instructions independent of x
+    std::vector<std::uint32_t> m_varying;              ///< Instructions depending on x
+    std::size_t m_block{0};                            ///< x values evaluated together
+    MathPrecision m_precision{MathPrecision::Fast};    ///< Precise as soon as one member is
+};
+
+} // namespace plot_genius
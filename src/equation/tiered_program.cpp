@@ -0,0 +1,120 @@
+/**
+ * Tiered Program Implementation
+ *
+ * Each batch is timed, so the cost per sample on the current tier is
+ * known when deciding on the next. The code of a tier is stored before
+ * the tier itself is published with release ordering, so a thread that
+ * sees the new tier also sees its code.
+ */
+
+#include "tiered_program.hpp"
+#include "compiled_program.hpp"
+#include "program_group.hpp"
+#include <chrono>
+
+namespace plot_genius {
+
+namespace {
+
+using Clock = ::std::chrono::steady_clock;
+
+} // namespace
+
+const char* GetTierName(ExecutionTier tier) {
+    switch (tier) {
+        case ExecutionTier::Interpreter: return "interpreter";
+        case ExecutionTier::Bytecode:    return "bytecode";
+        case ExecutionTier::Compiled:    return "compiled";
+    }
+    return "unknown";
+}
+
+TieredProgram::TieredProgram(const Program& program) : m_program(program) {}
+
+TieredProgram::~TieredProgram() = default;
+
+void TieredProgram::EvaluateBatch(const double* x, double* y, ::std::size_t count, const double* parameters) const {
+    const Clock::time_point start = Clock::now();
+    switch (m_tier.load(::std::memory_order_acquire)) {
+        case ExecutionTier::Interpreter:
+            m_program.EvaluateBatch(x, y, count, parameters);
+            break;
+        case ExecutionTier::Bytecode:
+            m_bytecode->EvaluateBatch(x, count, parameters, &y);
+            break;
+        case ExecutionTier::Compiled:
+            m_compiled->EvaluateBatch(x, y, count, parameters);
+            break;
+    }
+    const auto elapsed = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(Clock::now() - start);
+    m_samples.fetch_add(count, ::std::memory_order_relaxed);
+    m_nanoseconds.fetch_add(static_cast<::std::uint64_t>(elapsed.count()), ::std::memory_order_relaxed);
+}
+
+bool TieredProgram::TakePromotion(ExecutionTier& tier) const {
+    const TierStats stats = GetStats();
+    switch (stats.tier) {
+        case ExecutionTier::Interpreter:
+            if (stats.samples < kBytecodeSamples) {
+                return false;
+            }
+            tier = ExecutionTier::Bytecode;
+            break;
+        case ExecutionTier::Bytecode:
+            // Cheap equations are already fast enough; compiling them would only cost memory
+            if (stats.samples < kCompileSamples || stats.nanosecondsPerSample < kCompileMinNanoseconds) {
+                return false;
+            }
+            tier = ExecutionTier::Compiled;
+            break;
+        case ExecutionTier::Compiled:
+            return false;
+    }
+    bool expected = false;
+    return m_promoting.compare_exchange_strong(expected, true);
+}
+
+void TieredProgram::Promote(ExecutionTier tier) const {
+    const double previous = GetStats().nanosecondsPerSample;
+    try {
+        if (tier == ExecutionTier::Bytecode && !m_bytecode) {
+            m_bytecode = ::std::make_unique<const ProgramGroup>(::std::vector<const Program*>{&m_program});
+        } else if (tier == ExecutionTier::Compiled && !m_compiled) {
+            m_compiled = ::std::make_unique<const CompiledProgram>(m_program);
+        }
+    } catch (...) {
+        // Stay on the current tier and measure afresh, so the build is retried after another round of samples
+        m_samples.store(0, ::std::memory_order_relaxed);
+        m_nanoseconds.store(0, ::std::memory_order_relaxed);
+        m_promoting.store(false);
+        throw;
+    }
+    m_samples.store(0, ::std::memory_order_relaxed);
+    m_nanoseconds.store(0, ::std::memory_order_relaxed);
+    m_promotedFrom.store(previous, ::std::memory_order_relaxed);
+    m_tier.store(tier, ::std::memory_order_release);
+    m_promoting.store(false);
+}
+
+void TieredProgram::Reset() {
+    m_tier.store(ExecutionTier::Interpreter);
+    m_bytecode.reset();
+    m_compiled.reset();
+    m_samples.store(0);
+    m_nanoseconds.store(0);
+    m_promotedFrom.store(0.0);
+    m_promoting.store(false);
+}
+
+TierStats TieredProgram::GetStats() const {
+    TierStats stats;
+    stats.tier = m_tier.load(::std::memory_order_acquire);
+    stats.samples = m_samples.load(::std::memory_order_relaxed);
+    const ::std::uint64_t nanoseconds = m_nanoseconds.load(::std::memory_order_relaxed);
+    stats.nanosecondsPerSample = stats.samples > 0 ? static_cast<double>(nanoseconds) / stats.samples : 0.0;
+    stats.promotedFrom = m_promotedFrom.load(::std::memory_order_relaxed);
+    stats.promoting = m_promoting.load();
+    return stats;
+}
+
+} // namespace plot_genius
@@ -0,0 +1,136 @@
+/**
+ * Tiered Program Header
+ *
+ * Defines execution of a program that starts on the cheapest tier and
+ * moves to faster ones as it proves hot. A fresh equation is evaluated by
+ * the interpreter right away; once it has computed enough samples it is
+ * rebuilt as block bytecode, and if it then still costs enough per sample,
+ * as compiled kernels. Rebuilding runs off the evaluating threads and the
+ * new tier is switched in atomically, so evaluation never waits for it.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "program.hpp"
+
+namespace plot_genius {
+
+class CompiledProgram;
+class ProgramGroup;
+
+/**
+ * How a program is executed, from cheapest to build to fastest to run
+ */
+enum class ExecutionTier : std::uint8_t {
+    Interpreter,  ///< Program::EvaluateBatch: every instruction once per x value
+    Bytecode,     ///< Each instruction across a block of x values, with invariant work hoisted
+    Compiled      ///< Kernels specialized for their operands, fused multiply-adds, reused blocks
+};
+
+/**
+ * Gets the display name of a tier
+ *
+ * @param tier Tier
+ * @return Lowercase name, e.g. "bytecode"
+ */
+const char* GetTierName(ExecutionTier tier);
+
+/// Samples the interpreter computes before the program is rebuilt as bytecode
+constexpr std::uint64_t kBytecodeSamples = 4096;
+
+/// Samples the bytecode computes before the program may be compiled
+constexpr std::uint64_t kCompileSamples = 1 << 16;
+
+/// Bytecode cost per sample, in nanoseconds, below which compiling is not worth it
+constexpr double kCompileMinNanoseconds = 8.0;
+
+/**
+ * Where a program's execution stands
+ */
+struct TierStats {
+    ExecutionTier tier{ExecutionTier::Interpreter};  ///< Tier evaluating the program
+    std::uint64_t samples{0};         ///< Samples computed on the current tier
+    double nanosecondsPerSample{0.0}; ///< Measured cost on the current tier, 0 before any sample
+    double promotedFrom{0.0};         ///< Cost per sample on the previous tier when it was left, 0 if none
+    bool promoting{false};            ///< The next tier is being built
+};
+
+/**
+ * Program evaluated on the tier its measured use calls for
+ *
+ * Evaluation is thread-safe. The caller drives promotion: TakePromotion
+ * claims a due promotion at most once, and Promote, typically run on a
+ * worker, builds the tier and switches evaluation over.
+ */
+class TieredProgram {
+public:
+    /**
+     * Starts executing a program on the interpreter
+     *
+     * @param program Program to execute; must outlive this and stay unchanged
+     */
+    explicit TieredProgram(const Program& program);
+
+    /**
+     * Releases the built tiers
+     */
+    ~TieredProgram();
+
+    TieredProgram(const TieredProgram&) = delete;
+    TieredProgram& operator=(const TieredProgram&) = delete;
+
+    /**
+     * Evaluates the program at many x values on the current tier, counting the samples and their time
+     *
+     * @param x Input values
+     * @param y Receives one result per input value
+     * @param count Number of values
+     * @param parameters One value per parameter name, or nullptr to use kDefaultParameterValue
+     * @throws std::runtime_error if the program is empty
+     */
+    void EvaluateBatch(const double* x, double* y, std::size_t count, const double* parameters = nullptr) const;
+
+    /**
+     * Claims the promotion to the next tier if the measurements call for it
+     *
+     * @param tier Receives the tier to build
+     * @return True if the caller must now call Promote(tier)
+     */
+    bool TakePromotion(ExecutionTier& tier) const;
+
+    /**
+     * Builds a tier and switches evaluation to it
+     *
+     * @param tier Tier claimed by TakePromotion
+     * @throws std::exception if the tier cannot be built; the promotion is released and can be claimed again
+     */
+    void Promote(ExecutionTier tier) const;
+
+    /**
+     * Goes back to the interpreter after the program changed; not thread-safe
+     */
+    void Reset();
+
+    /**
+     * Gets the current tier and its measurements
+     *
+     * @return Snapshot of the figures
+     */
+    TierStats GetStats() const;
+
+private:
+    const Program& m_program;                                  ///< Program executed
+    mutable std::unique_ptr<const ProgramGroup> m_bytecode;    ///< Bytecode tier, once built
+    mutable std::unique_ptr<const CompiledProgram> m_compiled; ///< Compiled tier, once built
+    mutable std::atomic<ExecutionTier> m_tier{ExecutionTier::Interpreter};  ///< Published after its code
+    mutable std::atomic<std::uint64_t> m_samples{0};           ///< Samples on the current tier
+    mutable std::atomic<std::uint64_t> m_nanoseconds{0};       ///< Time spent on them
+    mutable std::atomic<double> m_promotedFrom{0.0};           ///< Cost per sample on the previous tier
+    mutable std::atomic<bool> m_promoting{false};              ///< A promotion has been claimed
+};
+
+} // namespace plot_genius
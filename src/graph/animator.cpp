@@ -0,0 +1,163 @@
+/**
+ * Animator Implementation
+ *
+ * Frames are sampled synchronously: playback needs the points of the frame
+ * being drawn, and the budget keeps the wait bounded.
+ */
+
+#include "animator.hpp"
+#include "../core/logger.hpp"
+#include "../core/profiler.hpp"
+#include "../core/thread_pool.hpp"
+#include <algorithm>
+
+namespace plot_genius {
+
+namespace {
+
+// Lowering the density doubles the cost, so it must fit well within the budget
+constexpr double kRaiseDensityHeadroom = 0.75;
+
+// Checks whether two parameter lists are equal apart from the time value
+bool SameParameters(const ::std::vector<double>& a, const ::std::vector<double>& b, ::std::uint32_t time) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (::std::size_t i = 0; i < a.size(); ++i) {
+        if (i != time && a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+Animator::Animator(core::ThreadPool& pool) : m_pool(pool) {}
+
+void Animator::SetGrid(double xMin, double xMax, int numPoints) {
+    if (xMin == m_xMin && xMax == m_xMax && numPoints == m_numPoints) {
+        return;
+    }
+    m_xMin = xMin;
+    m_xMax = xMax;
+    m_numPoints = ::std::max(numPoints, 2);
+    for (Track& track : m_tracks) {
+        track.cache = SweepCache();
+    }
+}
+
+void Animator::SetTracks(::std::vector<AnimationTrack> tracks) {
+    ::std::vector<Track> updated;
+    updated.reserve(tracks.size());
+    for (AnimationTrack& track : tracks) {
+        Track entry{::std::move(track), {}};
+        for (Track& old : m_tracks) {
+            if (old.track.id == entry.track.id && old.track.graph == entry.track.graph &&
+                old.track.timeParameter == entry.track.timeParameter &&
+                SameParameters(old.track.parameters, entry.track.parameters, entry.track.timeParameter)) {
+                entry.cache = ::std::move(old.cache);
+                break;
+            }
+        }
+        updated.push_back(::std::move(entry));
+    }
+    m_tracks = ::std::move(updated);
+    m_stats.tracks = m_tracks.size();
+}
+
+void Animator::Sample(double time, ::std::vector<SampleResult::Curve>& curves) {
+    PLOT_GENIUS_PROFILE_SCOPE("Animate");
+
+    const Clock::time_point start = Clock::now();
+    UpdateRate(start);
+
+    const ::std::size_t count = static_cast<::std::size_t>(GetPointCount());
+    if (count < 2) {
+        curves.clear();
+        return;
+    }
+    ::std::vector<double> xs(count);
+    const double step = (m_xMax - m_xMin) / static_cast<double>(count - 1);
+    for (::std::size_t i = 0; i < count; ++i) {
+        xs[i] = m_xMin + static_cast<double>(i) * step;
+    }
+
+    curves.resize(m_tracks.size());
+    ::std::vector<char> rebuilt(m_tracks.size(), 0);
+    auto sampleTrack = [&](::std::size_t index) {
+        Track& entry = m_tracks[index];
+        SampleResult::Curve& curve = curves[index];
+        curve = SampleResult::Curve();
+        curve.id = entry.track.id;
+        try {
+            const Program& program = entry.track.graph->GetProgram();
+            const double* parameters = entry.track.parameters.empty() ? nullptr : entry.track.parameters.data();
+            if (!entry.cache.IsPrepared() || entry.cache.count != count) {
+                program.PrepareSweep(xs.data(), count, parameters, entry.track.timeParameter, entry.cache);
+                rebuilt[index] = 1;
+            }
+            thread_local ::std::vector<double> values;
+            values.resize(count);
+            program.EvaluatePrepared(entry.cache, time, values.data());
+            curve.points.resize(count);
+            for (::std::size_t i = 0; i < count; ++i) {
+                curve.points[i] = {xs[i], values[i]};
+            }
+        } catch (const ::std::exception& e) {
+            PLOT_GENIUS_LOG_ERROR("Failed to animate {}: {}", entry.track.graph->GetEquation(), e.what());
+            curve.points.clear();
+        }
+    };
+
+    if (m_tracks.size() > 1) {
+        m_pool.ParallelFor(m_tracks.size(), sampleTrack);
+    } else if (!m_tracks.empty()) {
+        sampleTrack(0);
+    }
+
+    const double elapsedMs = ::std::chrono::duration<double, ::std::milli>(Clock::now() - start).count();
+    m_stats.lastSampleMs = elapsedMs;
+
+    // Frames that rebuilt caches are not representative of playback
+    const bool anyRebuilt = ::std::find(rebuilt.begin(), rebuilt.end(), 1) != rebuilt.end();
+    if (!anyRebuilt) {
+        if (elapsedMs > m_budgetMs && GetPointCount() > kMinAnimationPoints) {
+            ++m_level;
+        } else if (m_level > 0 && elapsedMs * 2.0 < m_budgetMs * kRaiseDensityHeadroom) {
+            --m_level;
+        }
+    }
+    m_stats.densityLevel = m_level;
+    m_stats.pointsPerCurve = GetPointCount();
+}
+
+void Animator::Reset() {
+    m_level = 0;
+    m_rateFrames = 0;
+    m_rateStart = Clock::time_point{};
+    m_stats.fps = 0.0;
+    m_stats.densityLevel = 0;
+    m_stats.pointsPerCurve = GetPointCount();
+}
+
+int Animator::GetPointCount() const {
+    return ::std::max(::std::min(m_numPoints, kMinAnimationPoints), m_numPoints >> m_level);
+}
+
+void Animator::UpdateRate(Clock::time_point now) {
+    if (m_rateStart == Clock::time_point{}) {
+        m_rateStart = now;
+        m_rateFrames = 0;
+        return;
+    }
+    ++m_rateFrames;
+    const double seconds = ::std::chrono::duration<double>(now - m_rateStart).count();
+    if (seconds >= 1.0) {
+        m_stats.fps = m_rateFrames / seconds;
+        m_rateStart = now;
+        m_rateFrames = 0;
+    }
+}
+
+} // namespace plot_genius
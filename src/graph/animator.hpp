@@ -0,0 +1,143 @@
+/**
+ * Animator Header
+ *
+ * Defines the playback engine for equations that use the time parameter.
+ * Each frame only the animated equations are evaluated, on the render
+ * thread with help from the worker pool, and everything in them that does
+ * not depend on time is computed once per view and reused. When a frame
+ * exceeds its budget the number of points per curve is halved rather than
+ * letting the frame rate drop, and restored once there is room again.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "graph.hpp"
+#include "sampler.hpp"
+
+namespace plot_genius {
+
+namespace core {
+class ThreadPool;
+}
+
+/// Fewest points per curve the animator degrades to
+constexpr int kMinAnimationPoints = 16;
+
+/**
+ * An equation to animate
+ */
+struct AnimationTrack {
+    int id;                               ///< Caller-defined identifier
+    std::shared_ptr<const Graph> graph;   ///< Immutable graph snapshot
+    std::vector<double> parameters;       ///< Values of the graph's parameters; the time value is ignored
+    std::uint32_t timeParameter{0};       ///< Index of the time parameter in the program
+};
+
+/**
+ * Playback figures for the profiler
+ */
+struct AnimationStats {
+    double fps{0.0};           ///< Frames sampled per second over the last second
+    int densityLevel{0};       ///< Points per curve are divided by 2^densityLevel
+    int pointsPerCurve{0};     ///< Points per curve at the current level
+    double lastSampleMs{0.0};  ///< Time spent on the last frame
+    std::size_t tracks{0};     ///< Animated equations
+};
+
+/**
+ * Samples animated equations once per frame within a time budget
+ *
+ * Not thread-safe; call everything from the render thread.
+ */
+class Animator {
+public:
+    /**
+     * Creates an animator without tracks
+     *
+     * @param pool Pool sharing the work of each frame
+     */
+    explicit Animator(core::ThreadPool& pool);
+
+    /**
+     * Sets how long sampling one frame may take before density is reduced
+     *
+     * @param milliseconds Budget per frame
+     */
+    void SetFrameBudget(double milliseconds) { m_budgetMs = milliseconds; }
+
+    /**
+     * Sets the x range and full point count; changing either rebuilds the caches
+     *
+     * @param xMin Minimum x value
+     * @param xMax Maximum x value
+     * @param numPoints Points per curve at full density (at least 2)
+     */
+    void SetGrid(double xMin, double xMax, int numPoints);
+
+    /**
+     * Replaces the animated equations
+     *
+     * Tracks whose id, graph and other parameter values are unchanged keep
+     * their cached time-independent values.
+     *
+     * @param tracks Equations to animate
+     */
+    void SetTracks(std::vector<AnimationTrack> tracks);
+
+    /**
+     * Checks whether any equation is animated
+     *
+     * @return True if there are tracks
+     */
+    bool HasTracks() const { return !m_tracks.empty(); }
+
+    /**
+     * Samples every track at one time and adapts the density to the budget
+     *
+     * @param time Value of the time parameter
+     * @param curves Receives one curve per track, in track order
+     */
+    void Sample(double time, std::vector<SampleResult::Curve>& curves);
+
+    /**
+     * Forgets the frame timings, e.g. when playback stops
+     */
+    void Reset();
+
+    /**
+     * Gets the playback figures
+     *
+     * @return Figures as of the last Sample call
+     */
+    const AnimationStats& GetStats() const { return m_stats; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Track {
+        AnimationTrack track;
+        SweepCache cache;  ///< Time-independent values on the grid of the current level
+    };
+
+    int GetPointCount() const;
+    void UpdateRate(Clock::time_point now);
+
+    core::ThreadPool& m_pool;
+    std::vector<Track> m_tracks;
+    double m_xMin{0.0};
+    double m_xMax{0.0};
+    int m_numPoints{0};
+    double m_budgetMs{8.0};
+    int m_level{0};
+
+    AnimationStats m_stats;
+    Clock::time_point m_rateStart{};  ///< Start of the window fps is counted over
+    int m_rateFrames{0};
+};
+
+} // namespace plot_genius
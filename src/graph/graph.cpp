@@ -7,10 +7,159 @@
 
 #include "graph.hpp"
 #include "../core/logger.hpp"
+#include "../core/profiler.hpp"
+#include "../core/thread_pool.hpp"
 #include "../equation/parser.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace plot_genius {
 
+namespace {
+
+// Points per family task; members are split further until every worker has a few tasks
+constexpr ::std::size_t kFamilyTaskPoints = 256;
+constexpr ::std::size_t kFamilyTasksPerThread = 4;
+
+// Grid points per piece of the domain analysis, so it stays cheap next to the evaluation it saves
+constexpr ::std::size_t kSamplesPerDomainCell = 16;
+
+// Times a range column may be halved while that tightens its bounds
+constexpr int kRangeRefinements = 3;
+
+// Newton steps taken per root before giving up; bisection fallbacks halve the bracket each time
+constexpr int kNewtonIterations = 64;
+
+// Roots are refined to this fraction of the scanned cell, or to a few ulps
+constexpr double kSolveTolerance = 1e-12;
+
+// Finds a zero of f (or of f' for an extremum) in [a, b], where it changes sign
+double SolveBracketed(const Program& program, const double* parameters, double a, double b, bool extremum) {
+    auto evaluate = [&](double x, double& value, double& slope) {
+        const Dual dual = EvaluateDual(program, x, parameters);
+        value = extremum ? dual.first : dual.value;
+        slope = extremum ? dual.second : dual.first;
+    };
+    
+    double value = 0.0;
+    double slope = 0.0;
+    evaluate(a, value, slope);
+    const bool negativeAtA = value < 0.0;
+    const double tolerance = (b - a) * kSolveTolerance;
+    double x = a + (b - a) / 2.0;
+    for (int i = 0; i < kNewtonIterations; ++i) {
+        evaluate(x, value, slope);
+        if (value == 0.0) {
+            return x;
+        }
+        if ((value < 0.0) == negativeAtA) {
+            a = x;
+        } else {
+            b = x;
+        }
+        
+        double next = x - value / slope;
+        if (!(next > a && next < b)) {
+            next = a + (b - a) / 2.0;
+        }
+        const double step = ::std::abs(next - x);
+        x = next;
+        if (step <= ::std::max(tolerance, 4.0 * ::std::numeric_limits<double>::epsilon() * ::std::abs(x))) {
+            break;
+        }
+    }
+    return x;
+}
+
+// Range of f over [a, b] as the union of its halves, refined while the halves are narrower
+Interval RefineRange(const Program& program, double a, double b, const double* parameters,
+                     double yTolerance, int depth) {
+    Interval range = EvaluateInterval(program, {a, b, false}, parameters);
+    if (depth == 0 || range.IsEmpty() || (range.IsBounded() && range.hi - range.lo <= yTolerance)) {
+        return range;
+    }
+    const double middle = a + (b - a) / 2.0;
+    Interval left = RefineRange(program, a, middle, parameters, yTolerance, depth - 1);
+    Interval right = RefineRange(program, middle, b, parameters, yTolerance, depth - 1);
+    if (left.IsEmpty()) {
+        right.partial = true;
+        return right;
+    }
+    if (right.IsEmpty()) {
+        left.partial = true;
+        return left;
+    }
+    return {::std::min(left.lo, right.lo), ::std::max(left.hi, right.hi), left.partial || right.partial};
+}
+
+// Bisects cells of an adaptive sampling pass, appending each cell's right end point
+class AdaptiveSampler {
+public:
+    AdaptiveSampler(const Program& program, const double* parameters, double minWidth, double yTolerance,
+                    ::std::size_t maxPoints, ::std::vector<Point>& points)
+        : m_program(program), m_parameters(parameters), m_minWidth(minWidth), m_yTolerance(yTolerance),
+          m_maxPoints(maxPoints), m_points(points) {}
+
+    Dual Evaluate(double x) const { return EvaluateDual(m_program, x, m_parameters); }
+
+    void Refine(double a, const Dual& fa, double b, const Dual& fb) {
+        const double nan = ::std::numeric_limits<double>::quiet_NaN();
+        if (m_points.size() >= m_maxPoints) {
+            m_points.push_back({b, fb.value});
+            return;
+        }
+
+        const Interval range = EvaluateInterval(m_program, {a, b, false}, m_parameters);
+        if (range.IsEmpty()) {
+            m_points.push_back({a + (b - a) / 2.0, nan});  // Undefined throughout: nothing to draw
+            m_points.push_back({b, fb.value});
+            return;
+        }
+        const bool bounded = range.IsBounded() && !range.partial;
+        if (bounded && range.hi - range.lo <= m_yTolerance) {
+            m_points.push_back({b, fb.value});  // Provably flat: one segment is exact to a pixel
+            return;
+        }
+        
+        const double middle = a + (b - a) / 2.0;
+        if (b - a <= m_minWidth || middle <= a || middle >= b) {
+            if (!range.IsBounded()) {
+                m_points.push_back({middle, nan});  // Possible pole: do not join across it
+            }
+            m_points.push_back({b, fb.value});
+            return;
+        }
+        const Dual fm = Evaluate(middle);
+        if (bounded && IsStraight(a, fa, fm, b, fb)) {
+            m_points.push_back({b, fb.value});
+            return;
+        }
+        Refine(a, fa, middle, fm);
+        Refine(middle, fm, b, fb);
+    }
+
+private:
+    // Checks that the chord from a to b stays within the tolerance of the curve, judged by the tangents
+    bool IsStraight(double a, const Dual& fa, const Dual& fm, double b, const Dual& fb) const {
+        const double width = b - a;
+        const double slope = (fb.value - fa.value) / width;
+        const double bend = ::std::abs(fa.first - slope) + ::std::abs(fb.first - slope);
+        return ::std::abs(fm.value - (fa.value + fb.value) / 2.0) <= m_yTolerance &&
+               ::std::abs(fm.first - slope) * width / 4.0 <= m_yTolerance &&
+               bend * width / 8.0 <= m_yTolerance;
+    }
+
+    const Program& m_program;
+    const double* m_parameters;
+    double m_minWidth;
+    double m_yTolerance;
+    ::std::size_t m_maxPoints;
+    ::std::vector<Point>& m_points;
+};
+
+} // namespace
+
 Graph::Graph() : m_parser(::std::make_unique<EquationParser>()) {}
 
 Graph::~Graph() = default;
@@ -24,51 +173,433 @@ Graph::~Graph() = default;
  * @return True if parsing was successful, false otherwise
  */
 bool Graph::SetEquation(const ::std::string& equation) {
-    return m_parser->Parse(equation);
+    PLOT_GENIUS_PROFILE_SCOPE("Parse");
+    
+    m_equation = equation;
+    RegisterSampleStage();
+    
+    bool parsed = m_parser->Parse(equation);
+    const MathPrecision precision = m_program.GetPrecision();
+    m_program = m_parser->GetProgram();
+    m_program.SetPrecision(precision);
+    m_execution.Reset();
+    return parsed;
+}
+
+/**
+ * Sets an already compiled equation, skipping the parser
+ * 
+ * @param equation Source text of the equation
+ * @param program Validated program computing the equation
+ */
+void Graph::SetProgram(const ::std::string& equation, Program program) {
+    m_equation = equation;
+    RegisterSampleStage();
+    
+    const MathPrecision precision = m_program.GetPrecision();
+    m_program = ::std::move(program);
+    m_program.SetPrecision(precision);
+    m_execution.Reset();
+    m_decompiled.reset();
+}
+
+/**
+ * Sets how sampling computes the built-in functions
+ * 
+ * @param precision Precision of the equation's program
+ */
+void Graph::SetPrecision(MathPrecision precision) {
+    m_program.SetPrecision(precision);
+    m_execution.Reset();
+}
+
+/**
+ * Gets the expression tree, decompiling a restored program on first use
+ * 
+ * @return Root node, or nullptr if no equation is set
+ */
+const ExpressionNode* Graph::GetExpression() const {
+    if (const ExpressionNode* parsed = m_parser->GetExpression()) {
+        return parsed;
+    }
+    
+    ::std::lock_guard<::std::mutex> lock(m_decompileMutex);
+    if (!m_decompiled) {
+        m_decompiled = m_program.Decompile();
+    }
+    return m_decompiled.get();
 }
 
 /**
  * Evaluates the equation at a specific x value
  * 
  * @param x Input value
+ * @param parameters One value per parameter, or nullptr for defaults
  * @return Result of the expression evaluated at x
  */
-double Graph::Evaluate(double x) const {
-    return m_parser->Evaluate(x);
+double Graph::Evaluate(double x, const double* parameters) const {
+    return m_program.Evaluate(x, parameters);
 }
 
 /**
  * Generates a series of points for plotting within a specified range
  * 
  * Divides the x-range into equal intervals and evaluates the function at each point.
- * Handles evaluation errors by logging and skipping invalid points.
+ * Returns no points (and logs why) if the equation cannot be evaluated.
  * 
  * @param xMin Minimum x value
  * @param xMax Maximum x value
  * @param numPoints Number of points to generate
+ * @param parameters One value per parameter, or nullptr for defaults
  * @return Vector of points representing the function
  */
-::std::vector<Point> Graph::GeneratePoints(double xMin, double xMax, int numPoints) const {
+::std::vector<Point> Graph::GeneratePoints(double xMin, double xMax, int numPoints, const double* parameters) const {
+    PLOT_GENIUS_PROFILE_STAGE(m_sampleStage);
+    
+    ::std::vector<double> xs;
+    ::std::vector<double> ys;
     ::std::vector<Point> points;
-    points.reserve(numPoints);
 
     // Calculate step size for even distribution of points
     double step = (xMax - xMin) / (numPoints - 1);
-    for (int i = 0; i < numPoints; ++i) {
-        double x = xMin + i * step;
-        try {
-            double y = Evaluate(x);
-            points.push_back({x, y});
-        } catch (const ::std::exception& e) {
-            core::Logger::GetInstance().Error("Failed to evaluate point at x = {}: {}", x, e.what());
-            // Skip invalid points
-            continue;
+    try {
+        for (const auto& run : FindDefinedSamples(xMin, xMax, static_cast<::std::size_t>(numPoints), parameters)) {
+            if (!points.empty()) {
+                points.push_back({xMin + (static_cast<double>(run.first) - 0.5) * step,
+                                  ::std::numeric_limits<double>::quiet_NaN()});
+            }
+            xs.resize(run.second - run.first);
+            ys.resize(xs.size());
+            for (::std::size_t i = 0; i < xs.size(); ++i) {
+                xs[i] = xMin + static_cast<double>(run.first + i) * step;
+            }
+            m_execution.EvaluateBatch(xs.data(), ys.data(), xs.size(), parameters);
+            for (::std::size_t i = 0; i < xs.size(); ++i) {
+                points.push_back({xs[i], ys[i]});
+            }
+        }
+    } catch (const ::std::exception& e) {
+        PLOT_GENIUS_LOG_ERROR("Failed to evaluate {}: {}", m_equation, e.what());
+        return {};
+    }
+    return points;
+}
+
+/**
+ * Finds the grid points at which the equation may be defined
+ * 
+ * Ranges found by domain analysis are widened to the next grid point on
+ * each side, so rounding can only add points, never drop them.
+ * 
+ * @param xMin First grid point
+ * @param xMax Last grid point
+ * @param count Number of grid points
+ * @param parameters One value per parameter, or nullptr for defaults
+ * @return Half-open index ranges of grid points to evaluate
+ */
+::std::vector<::std::pair<::std::size_t, ::std::size_t>> Graph::FindDefinedSamples(double xMin, double xMax,
+                                                                                  ::std::size_t count,
+                                                                                  const double* parameters) const {
+    ::std::vector<::std::pair<::std::size_t, ::std::size_t>> runs;
+    if (count < 2 || m_program.IsEmpty()) {
+        return runs;
+    }
+    
+    const int cells = static_cast<int>(::std::min<::std::size_t>(kMaxDomainCells, count / kSamplesPerDomainCell));
+    const double step = (xMax - xMin) / static_cast<double>(count - 1);
+    for (const auto& range : FindDefinedRanges(m_program, xMin, xMax, ::std::max(cells, 1), parameters)) {
+        const double first = ::std::floor((range.first - xMin) / step);
+        const double last = ::std::ceil((range.second - xMin) / step) + 1.0;
+        const ::std::size_t begin = static_cast<::std::size_t>(::std::clamp(first, 0.0, static_cast<double>(count)));
+        const ::std::size_t end = static_cast<::std::size_t>(::std::clamp(last, 0.0, static_cast<double>(count)));
+        if (!runs.empty() && begin <= runs.back().second) {
+            runs.back().second = ::std::max(runs.back().second, end);
+        } else if (begin < end) {
+            runs.emplace_back(begin, end);
+        }
+    }
+    return runs;
+}
+
+/**
+ * Evaluates the equation at many x values
+ * 
+ * @param x Input values
+ * @param y Receives one result per input value
+ * @param count Number of values
+ * @param parameters One value per parameter, or nullptr for defaults
+ */
+void Graph::EvaluateBatch(const double* x, double* y, ::std::size_t count, const double* parameters) const {
+    m_execution.EvaluateBatch(x, y, count, parameters);
+}
+
+/**
+ * Samples the equation on an evenly spaced grid into caller buffers
+ * 
+ * @param xMin Minimum x value
+ * @param xMax Maximum x value
+ * @param count Number of points (at least 2)
+ * @param x Receives the x values, or nullptr if not needed
+ * @param y Receives the results
+ * @param parameters One value per parameter, or nullptr for defaults
+ */
+void Graph::SampleInto(double xMin, double xMax, ::std::size_t count, double* x, double* y,
+                       const double* parameters) const {
+    PLOT_GENIUS_PROFILE_STAGE(m_sampleStage);
+    
+    // Without a caller buffer the grid is built in y and overwritten in place
+    double* grid = x ? x : y;
+    double step = (xMax - xMin) / static_cast<double>(count - 1);
+    for (::std::size_t i = 0; i < count; ++i) {
+        grid[i] = xMin + static_cast<double>(i) * step;
+    }
+    m_execution.EvaluateBatch(grid, y, count, parameters);
+}
+
+/**
+ * Samples every member of a family on an evenly spaced grid
+ * 
+ * The (x, member) grid is cut into blocks of x values and member ranges
+ * that are evaluated independently, each writing its own part of y.
+ * 
+ * @param xMin Minimum x value
+ * @param xMax Maximum x value
+ * @param count Number of points per member (at least 2)
+ * @param parameters Values of the parameters, or nullptr for defaults
+ * @param sweep Parameter to vary and its members
+ * @param y Receives sweep.members * count results, member after member
+ * @param pool Pool to share the work with, or nullptr
+ */
+void Graph::SampleFamily(double xMin, double xMax, ::std::size_t count, const double* parameters,
+                         const Sweep& sweep, double* y, core::ThreadPool* pool) const {
+    PLOT_GENIUS_PROFILE_STAGE(m_sampleStage);
+    
+    const ::std::size_t members = sweep.members;
+    if (members == 0) {
+        return;
+    }
+    
+    ::std::vector<double> xs(count);
+    double step = (xMax - xMin) / static_cast<double>(count - 1);
+    for (::std::size_t i = 0; i < count; ++i) {
+        xs[i] = xMin + static_cast<double>(i) * step;
+    }
+    
+    ::std::vector<double> values(members);
+    double memberStep = members > 1 ? (sweep.max - sweep.min) / static_cast<double>(members - 1) : 0.0;
+    for (::std::size_t m = 0; m < members; ++m) {
+        values[m] = sweep.min + static_cast<double>(m) * memberStep;
+    }
+    
+    const ::std::size_t threads = pool ? pool->GetThreadCount() + 1 : 1;
+    const ::std::size_t pointBlocks = (count + kFamilyTaskPoints - 1) / kFamilyTaskPoints;
+    const ::std::size_t wanted = threads > 1 ? threads * kFamilyTasksPerThread : 1;
+    const ::std::size_t memberBlocks = ::std::min(members, ::std::max<::std::size_t>(1, wanted / pointBlocks));
+    const ::std::size_t membersPerBlock = (members + memberBlocks - 1) / memberBlocks;
+    
+    auto evaluateBlock = [&](::std::size_t block) {
+        const ::std::size_t first = (block % pointBlocks) * kFamilyTaskPoints;
+        const ::std::size_t firstMember = (block / pointBlocks) * membersPerBlock;
+        if (firstMember >= members) {
+            return;
+        }
+        m_program.EvaluateSweep(xs.data() + first, ::std::min(kFamilyTaskPoints, count - first), parameters,
+                                sweep.parameter, values.data() + firstMember,
+                                ::std::min(membersPerBlock, members - firstMember),
+                                y + firstMember * count + first, count);
+    };
+    
+    const ::std::size_t blocks = pointBlocks * memberBlocks;
+    if (pool && blocks > 1) {
+        pool->ParallelFor(blocks, evaluateBlock);
+    } else {
+        for (::std::size_t block = 0; block < blocks; ++block) {
+            evaluateBlock(block);
+        }
+    }
+}
+
+/**
+ * Samples the equation adaptively, guided by interval evaluation
+ * 
+ * @param xMin Minimum x value
+ * @param xMax Maximum x value
+ * @param minCells Initial number of cells
+ * @param maxCells Finest subdivision in cells across the range
+ * @param yTolerance Height below which a cell needs no further points
+ * @param parameters One value per parameter, or nullptr for defaults
+ * @return Points in increasing x, with NaN y at gaps
+ */
+::std::vector<Point> Graph::GenerateAdaptivePoints(double xMin, double xMax, int minCells, int maxCells,
+                                                   double yTolerance, const double* parameters) const {
+    PLOT_GENIUS_PROFILE_STAGE(m_sampleStage);
+    
+    minCells = ::std::max(minCells, 1);
+    maxCells = ::std::max(maxCells, minCells);
+    ::std::vector<Point> points;
+    try {
+        AdaptiveSampler sampler(m_program, parameters, (xMax - xMin) / static_cast<double>(maxCells),
+                                yTolerance, 2 * static_cast<::std::size_t>(maxCells), points);
+        
+        // Each defined stretch gets its share of the initial cells; undefined ones are skipped
+        for (const auto& range : FindDefinedRanges(m_program, xMin, xMax, kMaxDomainCells, parameters)) {
+            if (!points.empty()) {
+                points.push_back({range.first, ::std::numeric_limits<double>::quiet_NaN()});
+            }
+            const double span = range.second - range.first;
+            const int cells = ::std::max(1, static_cast<int>(::std::ceil(minCells * span / (xMax - xMin))));
+            const double width = span / cells;
+            Dual fa = sampler.Evaluate(range.first);
+            points.push_back({range.first, fa.value});
+            for (int cell = 0; cell < cells && span > 0.0; ++cell) {
+                const double a = range.first + cell * width;
+                const double b = cell + 1 == cells ? range.second : range.first + (cell + 1) * width;
+                const Dual fb = sampler.Evaluate(b);
+                sampler.Refine(a, fa, b, fb);
+                fa = fb;
+            }
         }
+    } catch (const ::std::exception& e) {
+        PLOT_GENIUS_LOG_ERROR("Failed to evaluate {}: {}", m_equation, e.what());
+        return {};
     }
+    return points;
+}
 
+/**
+ * Samples the first or second derivative on an evenly spaced grid
+ * 
+ * @param xMin Minimum x value
+ * @param xMax Maximum x value
+ * @param numPoints Number of points to generate
+ * @param order 1 for f', 2 for f''
+ * @param parameters One value per parameter, or nullptr for defaults
+ * @return Points of the derivative
+ */
+::std::vector<Point> Graph::GenerateDerivativePoints(double xMin, double xMax, int numPoints, int order,
+                                                     const double* parameters) const {
+    PLOT_GENIUS_PROFILE_STAGE(m_sampleStage);
+    
+    numPoints = ::std::max(numPoints, 2);
+    const double step = (xMax - xMin) / (numPoints - 1);
+    ::std::vector<Point> points;
+    try {
+        // The derivative is undefined wherever the equation is
+        for (const auto& run : FindDefinedSamples(xMin, xMax, static_cast<::std::size_t>(numPoints), parameters)) {
+            if (!points.empty()) {
+                points.push_back({xMin + (static_cast<double>(run.first) - 0.5) * step,
+                                  ::std::numeric_limits<double>::quiet_NaN()});
+            }
+            for (::std::size_t i = run.first; i < run.second; ++i) {
+                const double x = xMin + static_cast<double>(i) * step;
+                const Dual dual = EvaluateDual(m_program, x, parameters);
+                points.push_back({x, order == 2 ? dual.second : dual.first});
+            }
+        }
+    } catch (const ::std::exception& e) {
+        PLOT_GENIUS_LOG_ERROR("Failed to evaluate {}: {}", m_equation, e.what());
+        return {};
+    }
     return points;
 }
 
+/**
+ * Locates roots and extrema by scanning cells and refining sign changes
+ * 
+ * @param xMin Minimum x value
+ * @param xMax Maximum x value
+ * @param cells Number of cells scanned
+ * @param roots Receives the roots
+ * @param extrema Receives the local minima and maxima
+ * @param parameters One value per parameter, or nullptr for defaults
+ */
+void Graph::FindCriticalPoints(double xMin, double xMax, int cells, ::std::vector<Point>& roots,
+                               ::std::vector<Point>& extrema, const double* parameters) const {
+    PLOT_GENIUS_PROFILE_SCOPE("Find Critical Points");
+    
+    roots.clear();
+    extrema.clear();
+    cells = ::std::max(cells, 1);
+    const double width = (xMax - xMin) / cells;
+    try {
+        Dual fa = EvaluateDual(m_program, xMin, parameters);
+        for (int cell = 0; cell < cells; ++cell) {
+            const double a = xMin + cell * width;
+            const double b = cell + 1 == cells ? xMax : xMin + (cell + 1) * width;
+            const Dual fb = EvaluateDual(m_program, b, parameters);
+            
+            // Exact hits on the grid need no refinement; a constant function has none to report
+            if (fa.value == 0.0 && (fa.first != 0.0 || fa.second != 0.0)) {
+                roots.push_back({a, 0.0});
+            }
+            if (fa.first == 0.0 && fa.second != 0.0 && ::std::isfinite(fa.value)) {
+                extrema.push_back({a, fa.value});
+            }
+            
+            const bool rootInside = fa.value * fb.value < 0.0;
+            const bool extremumInside = fa.first * fb.first < 0.0;
+            if (rootInside || extremumInside) {
+                // A sign change is only a root if f is continuous across the cell, unlike 1/x at 0
+                const Interval range = EvaluateInterval(m_program, {a, b, false}, parameters);
+                if (range.IsBounded() && !range.partial) {
+                    if (rootInside) {
+                        roots.push_back({SolveBracketed(m_program, parameters, a, b, false), 0.0});
+                    }
+                    if (extremumInside) {
+                        const double x = SolveBracketed(m_program, parameters, a, b, true);
+                        extrema.push_back({x, m_program.Evaluate(x, parameters)});
+                    }
+                }
+            }
+            fa = fb;
+        }
+        if (fa.value == 0.0 && (fa.first != 0.0 || fa.second != 0.0)) {
+            roots.push_back({xMax, 0.0});
+        }
+    } catch (const ::std::exception& e) {
+        PLOT_GENIUS_LOG_ERROR("Failed to evaluate {}: {}", m_equation, e.what());
+        roots.clear();
+        extrema.clear();
+    }
+}
+
+/**
+ * Encloses the equation's values over equal columns of x
+ * 
+ * @param xMin Minimum x value
+ * @param xMax Maximum x value
+ * @param columns Number of columns
+ * @param yTolerance Height differences too small to refine for
+ * @param lower Receives the lower bound of each column
+ * @param upper Receives the upper bound of each column
+ * @param parameters One value per parameter, or nullptr for defaults
+ */
+void Graph::SampleRanges(double xMin, double xMax, ::std::size_t columns, double yTolerance,
+                         double* lower, double* upper, const double* parameters) const {
+    PLOT_GENIUS_PROFILE_STAGE(m_sampleStage);
+    
+    const DomainBounds bounds = AnalyzeDomain(m_program, parameters);
+    const double width = (xMax - xMin) / static_cast<double>(columns);
+    for (::std::size_t i = 0; i < columns; ++i) {
+        const double a = xMin + static_cast<double>(i) * width;
+        const double b = i + 1 == columns ? xMax : xMin + static_cast<double>(i + 1) * width;
+        if (b < bounds.lo || a > bounds.hi) {
+            lower[i] = upper[i] = ::std::numeric_limits<double>::quiet_NaN();
+            continue;
+        }
+        const Interval range = RefineRange(m_program, a, b, parameters, yTolerance, kRangeRefinements);
+        lower[i] = ::std::clamp(range.lo, -kRangeLimit, kRangeLimit);
+        upper[i] = ::std::clamp(range.hi, -kRangeLimit, kRangeLimit);
+    }
+}
+
+/**
+ * Registers the profiler stage that reports sampling time for this equation
+ */
+void Graph::RegisterSampleStage() {
+    m_sampleStage = PLOT_GENIUS_PROFILE_REGISTER("Sample " + m_equation);
+}
+
 /**
  * Gets the last error message from the equation parser
  * 
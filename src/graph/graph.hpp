@@ -6,12 +6,26 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <string>
+#include "../equation/domain.hpp"
+#include "../equation/dual.hpp"
+#include "../equation/interval.hpp"
 #include "../equation/parser.hpp"
+#include "../equation/program.hpp"
+#include "../equation/tiered_program.hpp"
+#include "../core/profiler.hpp"
 
 namespace plot_genius {
 
+namespace core {
+class ThreadPool;
+}
+
 /**
  * Represents a single point in a 2D coordinate system
  */
@@ -20,6 +34,19 @@ struct Point {
     double y;  ///< Y coordinate
 };
 
+/**
+ * Family of curves obtained by varying one parameter of an equation
+ */
+struct Sweep {
+    std::uint32_t parameter{0};  ///< Index of the varied parameter in the program
+    std::uint32_t members{0};    ///< Number of curves, 0 for none
+    double min{0.0};             ///< Parameter value of the first member
+    double max{0.0};             ///< Parameter value of the last member
+};
+
+/// Magnitude unbounded column ranges are clamped to, still finite as a float
+constexpr double kRangeLimit = 1e30;
+
 /**
  * Graph class for representing and evaluating mathematical functions
  * 
@@ -45,23 +72,202 @@ public:
      */
     bool SetEquation(const std::string& equation);
 
+    /**
+     * Sets an already compiled equation, skipping the parser
+     * 
+     * Used when restoring sessions; the expression tree is only rebuilt from
+     * the program if GetExpression is called.
+     * 
+     * @param equation Source text of the equation
+     * @param program Validated program computing the equation
+     */
+    void SetProgram(const std::string& equation, Program program);
+
+    /**
+     * Sets how sampling computes the built-in functions
+     * 
+     * Kept when the equation or program changes. Not thread-safe; set it
+     * before the graph is shared with sampling jobs.
+     * 
+     * @param precision Precision of the equation's program
+     */
+    void SetPrecision(MathPrecision precision);
+
+    /**
+     * Gets the source text of the equation
+     * 
+     * @return Equation text as passed to SetEquation or SetProgram
+     */
+    const std::string& GetEquation() const { return m_equation; }
+
+    /**
+     * Gets the compiled equation
+     * 
+     * @return Program, empty if no equation is set
+     */
+    const Program& GetProgram() const { return m_program; }
+
+    /**
+     * Gets the tiered execution of the equation
+     * 
+     * Uniform sampling and batch evaluation run on it; promoting it to a
+     * faster tier is left to the caller, which knows where to run the build.
+     * 
+     * @return Execution state, shared by every thread evaluating the graph
+     */
+    const TieredProgram& GetExecution() const { return m_execution; }
+
+    /**
+     * Gets the expression tree of the equation, decompiling it on first use
+     * 
+     * @return Root node, or nullptr if no equation is set
+     */
+    const ExpressionNode* GetExpression() const;
+
     /**
      * Evaluates the equation at a specific x value
      * 
      * @param x Input value
+     * @param parameters One value per name in GetProgram().GetParameters(), or nullptr for defaults
      * @return Result of the expression evaluated at x
      */
-    double Evaluate(double x) const;
+    double Evaluate(double x, const double* parameters = nullptr) const;
 
     /**
      * Generates a series of points for plotting within a specified range
      * 
+     * Only grid points where the equation may be defined are evaluated and
+     * returned; a point with NaN y stands in for each skipped stretch.
+     * 
      * @param xMin Minimum x value
      * @param xMax Maximum x value
-     * @param numPoints Number of points to generate (default: 100)
+     * @param numPoints Number of grid points (default: 100)
+     * @param parameters One value per parameter, or nullptr for defaults
      * @return Vector of points representing the function
      */
-    std::vector<Point> GeneratePoints(double xMin, double xMax, int numPoints = 100) const;
+    std::vector<Point> GeneratePoints(double xMin, double xMax, int numPoints = 100,
+                                      const double* parameters = nullptr) const;
+
+    /**
+     * Finds the points of an evenly spaced grid at which the equation may be defined
+     * 
+     * @param xMin First grid point
+     * @param xMax Last grid point
+     * @param count Number of grid points (at least 2)
+     * @param parameters One value per parameter, or nullptr for defaults
+     * @return Increasing, disjoint half-open index ranges; the equation is undefined at every other grid point
+     */
+    std::vector<std::pair<std::size_t, std::size_t>> FindDefinedSamples(double xMin, double xMax, std::size_t count,
+                                                                        const double* parameters = nullptr) const;
+
+    /**
+     * Evaluates the equation at many x values
+     * 
+     * @param x Input values
+     * @param y Receives one result per input value
+     * @param count Number of values
+     * @param parameters One value per parameter, or nullptr for defaults
+     */
+    void EvaluateBatch(const double* x, double* y, std::size_t count, const double* parameters = nullptr) const;
+
+    /**
+     * Samples the equation on the same evenly spaced grid as GeneratePoints
+     * 
+     * @param xMin Minimum x value
+     * @param xMax Maximum x value
+     * @param count Number of points (at least 2)
+     * @param x Receives the x values, or nullptr if not needed
+     * @param y Receives the results
+     * @param parameters One value per parameter, or nullptr for defaults
+     */
+    void SampleInto(double xMin, double xMax, std::size_t count, double* x, double* y,
+                    const double* parameters = nullptr) const;
+
+    /**
+     * Samples every member of a family on the same grid as SampleInto
+     * 
+     * One program evaluates the whole (x, member) grid in tiles, spread over
+     * the pool if one is given.
+     * 
+     * @param xMin Minimum x value
+     * @param xMax Maximum x value
+     * @param count Number of points per member (at least 2)
+     * @param parameters Values of the parameters, or nullptr for defaults
+     * @param sweep Parameter to vary; members are evenly spaced from sweep.min to sweep.max
+     * @param y Receives sweep.members * count results, member after member
+     * @param pool Pool to share the work with, or nullptr to run on the caller only
+     */
+    void SampleFamily(double xMin, double xMax, std::size_t count, const double* parameters,
+                      const Sweep& sweep, double* y, core::ThreadPool* pool = nullptr) const;
+
+    /**
+     * Samples the equation densely only where it is not provably flat
+     * 
+     * Starts from minCells equal cells and bisects each until interval
+     * evaluation shows the curve stays within yTolerance over it, the
+     * tangents at its ends and middle show it to be straight to within
+     * yTolerance, or the cell is maxCells-fine. Cells with no defined value are skipped and
+     * fine cells whose range is unbounded are treated as poles; both leave
+     * a point with NaN y so the curve is not joined across them.
+     * 
+     * @param xMin Minimum x value
+     * @param xMax Maximum x value
+     * @param minCells Cells the range is first divided into (at least 1)
+     * @param maxCells Finest subdivision, in cells across the range
+     * @param yTolerance Height below which a cell is drawn as one segment
+     * @param parameters One value per parameter, or nullptr for defaults
+     * @return Points in increasing x; at most about 2 * maxCells
+     */
+    std::vector<Point> GenerateAdaptivePoints(double xMin, double xMax, int minCells, int maxCells,
+                                              double yTolerance, const double* parameters = nullptr) const;
+
+    /**
+     * Samples a derivative of the equation, computed exactly by dual numbers
+     * 
+     * @param xMin Minimum x value
+     * @param xMax Maximum x value
+     * @param numPoints Number of points to generate (at least 2)
+     * @param order 1 for f', 2 for f''
+     * @param parameters One value per parameter, or nullptr for defaults
+     * @return Points of the derivative, or none if the equation cannot be evaluated
+     */
+    std::vector<Point> GenerateDerivativePoints(double xMin, double xMax, int numPoints, int order,
+                                                const double* parameters = nullptr) const;
+
+    /**
+     * Locates roots and local extrema of the equation
+     * 
+     * Scans cells for sign changes of f and f' and refines each by Newton
+     * steps, falling back to bisection when a step leaves the bracket.
+     * Sign changes across a pole or a gap in the domain are not reported.
+     * 
+     * @param xMin Minimum x value
+     * @param xMax Maximum x value
+     * @param cells Number of cells scanned; at most one root and one extremum are found per cell
+     * @param roots Receives the roots, in increasing x
+     * @param extrema Receives the local minima and maxima, in increasing x
+     * @param parameters One value per parameter, or nullptr for defaults
+     */
+    void FindCriticalPoints(double xMin, double xMax, int cells, std::vector<Point>& roots,
+                            std::vector<Point>& extrema, const double* parameters = nullptr) const;
+
+    /**
+     * Encloses the values of the equation over each of equal columns of x
+     * 
+     * Columns are bisected up to a few times while that narrows their
+     * range by more than yTolerance. Unbounded bounds are clamped to
+     * +-kRangeLimit; columns with no defined value get NaN bounds.
+     * 
+     * @param xMin Minimum x value
+     * @param xMax Maximum x value
+     * @param columns Number of columns (at least 1)
+     * @param yTolerance Height differences too small to refine for
+     * @param lower Receives the lower bound of each column
+     * @param upper Receives the upper bound of each column
+     * @param parameters One value per parameter, or nullptr for defaults
+     */
+    void SampleRanges(double xMin, double xMax, std::size_t columns, double yTolerance,
+                      double* lower, double* upper, const double* parameters = nullptr) const;
 
     /**
      * Gets the last error message from the equation parser
@@ -71,7 +277,15 @@ public:
     const std::string& GetLastError() const;
 
 private:
+    void RegisterSampleStage();
+
     std::unique_ptr<EquationParser> m_parser;  ///< Equation parser instance
+    std::string m_equation;                    ///< Source text of the equation
+    Program m_program;                         ///< Compiled equation used for evaluation
+    TieredProgram m_execution{m_program};      ///< Tier batch evaluation currently runs on
+    mutable std::unique_ptr<ExpressionNode> m_decompiled;  ///< Tree rebuilt from a restored program
+    mutable std::mutex m_decompileMutex;                   ///< Guards m_decompiled
+    core::ProfileStage m_sampleStage{core::kNoProfileStage};  ///< Profiler stage for sampling
 };
 
 } // namespace plot_genius 
\ No newline at end of file
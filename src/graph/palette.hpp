@@ -0,0 +1,59 @@
+/**
+ * Equation Palette Header
+ *
+ * Defines the colors equations are drawn in, shared by the window and the
+ * image renderer of the service so both show an equation alike.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace plot_genius {
+
+/**
+ * Packs a color in the ImU32 layout (red in the lowest byte)
+ *
+ * @param r Red, 0-255
+ * @param g Green, 0-255
+ * @param b Blue, 0-255
+ * @param a Alpha, 0-255
+ * @return Packed color
+ */
+constexpr std::uint32_t PackColor(std::uint32_t r, std::uint32_t g, std::uint32_t b, std::uint32_t a = 255) {
+    return (a << 24) | (b << 16) | (g << 8) | r;
+}
+
+/**
+ * Replaces the alpha of a packed color
+ *
+ * @param color Packed color
+ * @param a Alpha, 0-255
+ * @return Packed color with the new alpha
+ */
+constexpr std::uint32_t WithAlpha(std::uint32_t color, std::uint32_t a) {
+    return (color & 0x00FFFFFFu) | (a << 24);
+}
+
+// Cycled through for different equations
+constexpr std::size_t kNumEquationColors = 5;
+constexpr std::uint32_t kEquationColors[kNumEquationColors] = {
+    PackColor(0, 204, 51),   // Green
+    PackColor(51, 153, 255), // Blue
+    PackColor(255, 51, 51),  // Red
+    PackColor(255, 153, 51), // Orange
+    PackColor(153, 51, 255)  // Purple
+};
+
+/**
+ * Gets the default color of an equation
+ *
+ * @param index Position of the equation
+ * @return Packed color
+ */
+constexpr std::uint32_t GetEquationColor(std::size_t index) {
+    return kEquationColors[index % kNumEquationColors];
+}
+
+} // namespace plot_genius
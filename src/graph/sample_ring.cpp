@@ -0,0 +1,204 @@
+/**
+ * Shared Sample Ring Implementation
+ *
+ * Implements creation and attachment of the shared segment and the writer
+ * side of the slot seqlock.
+ */
+
+#include "sample_ring.hpp"
+#include <cerrno>
+#include <cstring>
+#include "../core/profiler.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PLOT_GENIUS_SAMPLE_RING_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace plot_genius {
+
+namespace {
+
+std::size_t GetSlotSize(std::uint32_t slotPoints) {
+    return sizeof(SlotHeader) + static_cast<std::size_t>(slotPoints) * sizeof(Point);
+}
+
+} // namespace
+
+SampleRingWriter::~SampleRingWriter() {
+#ifdef PLOT_GENIUS_SAMPLE_RING_POSIX
+    if (m_header) {
+        ::munmap(m_header, m_size);
+        ::shm_unlink(m_name.c_str());
+    }
+#endif
+}
+
+#ifdef PLOT_GENIUS_SAMPLE_RING_POSIX
+
+bool SampleRingWriter::Create(const std::string& name, std::uint32_t slotCount, std::uint32_t slotPoints,
+                              std::string& error) {
+    if (name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos) {
+        error = "Shared-memory name must be '/' followed by a name without slashes";
+        return false;
+    }
+    const std::size_t slotSize = GetSlotSize(slotPoints);
+    if (slotCount < 2 || slotPoints == 0 || slotSize > UINT32_MAX) {
+        error = "Sample ring needs at least 2 slots of at least 1 point";
+        return false;
+    }
+
+    // A segment left by a crashed run may still be mapped by readers; give it up rather than reuse it
+    ::shm_unlink(name.c_str());
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        error = "Cannot create " + name + ": " + std::strerror(errno);
+        return false;
+    }
+
+    const std::size_t size = sizeof(RingHeader) + slotCount * slotSize;
+    void* mapping = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    const int mapError = errno;
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        ::shm_unlink(name.c_str());
+        error = "Cannot map " + name + ": " + std::strerror(mapError);
+        return false;
+    }
+
+    // The new segment is zero-filled: every slot is empty with an even sequence
+    auto* header = static_cast<RingHeader*>(mapping);
+    header->version = kSampleRingVersion;
+    header->slotCount = slotCount;
+    header->slotPoints = slotPoints;
+    header->slotSize = static_cast<std::uint32_t>(slotSize);
+    header->published.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, kSampleRingMagic, sizeof(kSampleRingMagic));
+
+    m_header = header;
+    m_size = size;
+    m_name = name;
+    return true;
+}
+
+void SampleRingWriter::Publish(std::uint64_t generation, int equationId, std::string_view equation, double xMin,
+                               double xMax, const Point* points, std::size_t count) {
+    if (!m_header) {
+        return;
+    }
+    PLOT_GENIUS_PROFILE_SCOPE("Export Samples");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (generation < m_lastGeneration) {
+        return;
+    }
+    m_lastGeneration = generation;
+
+    char* slots = reinterpret_cast<char*>(m_header) + sizeof(RingHeader);
+    const std::size_t textLength = std::min(equation.size(), kSampleRingEquationLength - 1);
+    std::uint64_t block = m_header->published.load(std::memory_order_relaxed);
+    std::size_t first = 0;
+    do {
+        auto* slot = reinterpret_cast<SlotHeader*>(slots + (block % m_header->slotCount) * m_header->slotSize);
+        const std::size_t chunk = std::min<std::size_t>(count - first, m_header->slotPoints);
+
+        const std::uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+        slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot->block = block;
+        slot->generation = generation;
+        slot->equationId = equationId;
+        slot->pointCount = static_cast<std::uint32_t>(chunk);
+        slot->firstPoint = static_cast<std::uint32_t>(first);
+        slot->totalPoints = static_cast<std::uint32_t>(count);
+        slot->xMin = xMin;
+        slot->xMax = xMax;
+        std::memcpy(slot->equation, equation.data(), textLength);
+        slot->equation[textLength] = '\0';
+        if (chunk > 0) {
+            std::memcpy(reinterpret_cast<char*>(slot) + sizeof(SlotHeader), points + first, chunk * sizeof(Point));
+        }
+
+        slot->sequence.store(sequence + 2, std::memory_order_release);
+        m_header->published.store(++block, std::memory_order_release);
+        first += chunk;
+    } while (first < count);
+}
+
+SampleRingReader::~SampleRingReader() {
+    Detach();
+}
+
+bool SampleRingReader::Attach(const std::string& name, std::string& error) {
+    Detach();
+
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        error = "Cannot open " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat status;
+    void* mapping = MAP_FAILED;
+    if (::fstat(fd, &status) == 0 && static_cast<std::size_t>(status.st_size) >= sizeof(RingHeader)) {
+        mapping = ::mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        error = name + " is not a sample ring";
+        return false;
+    }
+
+    const auto* header = static_cast<const RingHeader*>(mapping);
+    const std::size_t size = static_cast<std::size_t>(status.st_size);
+    const bool valid = std::memcmp(header->magic, kSampleRingMagic, sizeof(kSampleRingMagic)) == 0 &&
+                       header->version == kSampleRingVersion && header->slotCount >= 2 &&
+                       header->slotSize == GetSlotSize(header->slotPoints) &&
+                       size >= sizeof(RingHeader) + static_cast<std::size_t>(header->slotCount) * header->slotSize;
+    if (!valid) {
+        ::munmap(mapping, size);
+        error = name + " is not a sample ring of version " + std::to_string(kSampleRingVersion);
+        return false;
+    }
+
+    m_header = header;
+    m_size = size;
+    return true;
+}
+
+void SampleRingReader::Detach() {
+    if (m_header) {
+        ::munmap(const_cast<RingHeader*>(m_header), m_size);
+        m_header = nullptr;
+        m_size = 0;
+    }
+}
+
+#else
+
+bool SampleRingWriter::Create(const std::string&, std::uint32_t, std::uint32_t, std::string& error) {
+    error = "Shared-memory sample export needs POSIX shared memory";
+    return false;
+}
+
+void SampleRingWriter::Publish(std::uint64_t, int, std::string_view, double, double, const Point*, std::size_t) {}
+
+SampleRingReader::~SampleRingReader() {}
+
+bool SampleRingReader::Attach(const std::string&, std::string& error) {
+    error = "Shared-memory sample export needs POSIX shared memory";
+    return false;
+}
+
+void SampleRingReader::Detach() {}
+
+#endif
+
+} // namespace plot_genius
@@ -0,0 +1,256 @@
+/**
+ * Shared Sample Ring Header
+ *
+ * Defines a POSIX shared-memory ring through which the sampler publishes
+ * every equation's points to other processes on the same host. Readers map
+ * the ring read-only and read blocks in place; the writer never waits for
+ * them, so a slow or stalled reader cannot hold up sampling or the UI. A
+ * reader that falls more than a ring behind loses the oldest blocks.
+ *
+ * Layout (native byte order), so readers need not link this code:
+ *
+ *     RingHeader                          64 bytes
+ *     slot[slotCount], each slotSize bytes:
+ *         SlotHeader                      192 bytes
+ *         Point points[slotPoints]        16 bytes each (double x, y)
+ *
+ * Each slot is a seqlock: its sequence is odd while the writer fills it. A
+ * reader reads the sequence, the block, then the sequence again, and keeps
+ * the block only if both reads are equal and even.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include "graph.hpp"
+
+namespace plot_genius {
+
+constexpr char kSampleRingMagic[8] = {'P', 'G', 'R', 'I', 'N', 'G', '\0', '\0'};
+constexpr std::uint32_t kSampleRingVersion = 1;
+constexpr std::size_t kSampleRingEquationLength = 128;
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "Shared-memory counters must be lock-free to work across processes");
+
+/**
+ * Start of the shared segment
+ */
+struct RingHeader {
+    char magic[8];                        ///< kSampleRingMagic
+    std::uint32_t version;                ///< kSampleRingVersion
+    std::uint32_t slotCount;              ///< Slots in the ring
+    std::uint32_t slotPoints;             ///< Point capacity of a slot
+    std::uint32_t slotSize;               ///< Bytes per slot, header included
+    std::atomic<std::uint64_t> published; ///< Blocks completed so far; block n is in slot n % slotCount
+    std::uint8_t reserved[32];
+};
+
+/**
+ * Start of a slot
+ *
+ * Equations longer than slotPoints are split over several consecutive
+ * blocks sharing generation and equationId.
+ */
+struct SlotHeader {
+    std::atomic<std::uint64_t> sequence;  ///< Odd while the slot is written
+    std::uint64_t block;                  ///< Block number held by the slot
+    std::uint64_t generation;             ///< Sampling pass; increases with every view or equation change
+    std::int32_t equationId;              ///< Equation identifier in the window
+    std::uint32_t pointCount;             ///< Points in this block
+    std::uint32_t firstPoint;             ///< Index of the first point within the equation
+    std::uint32_t totalPoints;            ///< Points of the whole equation
+    double xMin;                          ///< Sampled range of the pass
+    double xMax;
+    std::uint8_t reserved[8];
+    char equation[kSampleRingEquationLength];  ///< Equation text, NUL-terminated, truncated if longer
+};
+
+static_assert(sizeof(RingHeader) == 64, "RingHeader is part of the shared layout");
+static_assert(sizeof(SlotHeader) == 192, "SlotHeader is part of the shared layout");
+static_assert(sizeof(Point) == 16, "Point is part of the shared layout");
+
+/**
+ * Block read in place from the ring
+ *
+ * Pointers refer to the mapping and are only trustworthy if Read returns Ok.
+ */
+struct SampleBlock {
+    std::uint64_t block;
+    std::uint64_t generation;
+    int equationId;
+    std::uint32_t firstPoint;
+    std::uint32_t totalPoints;
+    double xMin;
+    double xMax;
+    std::string_view equation;
+    const Point* points;
+    std::size_t count;
+};
+
+/**
+ * Creates the ring and publishes blocks into it; one per process
+ */
+class SampleRingWriter {
+public:
+    SampleRingWriter() = default;
+
+    /**
+     * Unmaps and unlinks the ring; attached readers keep their mapping
+     */
+    ~SampleRingWriter();
+
+    SampleRingWriter(const SampleRingWriter&) = delete;
+    SampleRingWriter& operator=(const SampleRingWriter&) = delete;
+
+    /**
+     * Creates the shared segment, replacing one left by an earlier run
+     *
+     * @param name Shared-memory name, e.g. "/plot_genius_samples"
+     * @param slotCount Slots in the ring (at least 2)
+     * @param slotPoints Point capacity of a slot (at least 1)
+     * @param error Receives the reason on failure
+     * @return True if the ring is ready
+     */
+    bool Create(const std::string& name, std::uint32_t slotCount, std::uint32_t slotPoints, std::string& error);
+
+    /**
+     * Publishes the points of one equation, split into as many blocks as needed
+     *
+     * Thread-safe. Passes older than one already published are dropped, so
+     * readers see generations in increasing order.
+     *
+     * @param generation Sampling pass
+     * @param equationId Equation identifier
+     * @param equation Equation text
+     * @param xMin Sampled range
+     * @param xMax Sampled range
+     * @param points Points to copy into the ring
+     * @param count Number of points
+     */
+    void Publish(std::uint64_t generation, int equationId, std::string_view equation, double xMin, double xMax,
+                 const Point* points, std::size_t count);
+
+    /**
+     * Checks whether the ring exists
+     *
+     * @return True after a successful Create
+     */
+    bool IsOpen() const { return m_header != nullptr; }
+
+private:
+    RingHeader* m_header{nullptr};
+    std::size_t m_size{0};
+    std::string m_name;
+    std::mutex m_mutex;                ///< Serializes publishers
+    std::uint64_t m_lastGeneration{0};
+};
+
+/**
+ * Read-only view of a ring created by another process
+ */
+class SampleRingReader {
+public:
+    /**
+     * Result of reading a block
+     */
+    enum class ReadStatus {
+        Ok,           ///< The block was stable while it was read
+        Pending,      ///< The block has not been published yet
+        Overwritten   ///< The writer reused the slot; the block is lost
+    };
+
+    SampleRingReader() = default;
+    ~SampleRingReader();
+
+    SampleRingReader(const SampleRingReader&) = delete;
+    SampleRingReader& operator=(const SampleRingReader&) = delete;
+
+    /**
+     * Maps an existing ring read-only and validates its layout
+     *
+     * @param name Shared-memory name given to the writer
+     * @param error Receives the reason on failure
+     * @return True if attached
+     */
+    bool Attach(const std::string& name, std::string& error);
+
+    /**
+     * Unmaps the ring
+     */
+    void Detach();
+
+    /**
+     * Gets the number of blocks published so far
+     *
+     * @return Number of the next block to be published
+     */
+    std::uint64_t GetPublished() const { return m_header->published.load(std::memory_order_acquire); }
+
+    /**
+     * Gets the oldest block that may still be in the ring
+     *
+     * @return Block number a lagging reader should skip to
+     */
+    std::uint64_t GetOldest() const {
+        const std::uint64_t published = GetPublished();
+        return published > m_header->slotCount ? published - m_header->slotCount : 0;
+    }
+
+    /**
+     * Reads a block in place
+     *
+     * The visitor sees the block's memory while the writer may be replacing
+     * it; anything derived from it must be discarded unless Ok is returned.
+     *
+     * @param block Block number
+     * @param visit Called with a SampleBlock if the block is in its slot
+     * @return Whether the block was read consistently
+     */
+    template<typename Visitor>
+    ReadStatus Read(std::uint64_t block, Visitor&& visit) const {
+        if (block >= GetPublished()) {
+            return ReadStatus::Pending;
+        }
+
+        const SlotHeader* slot = GetSlot(block);
+        const std::uint64_t before = slot->sequence.load(std::memory_order_acquire);
+        if ((before & 1) != 0 || slot->block != block) {
+            return ReadStatus::Overwritten;
+        }
+
+        SampleBlock view;
+        view.block = block;
+        view.generation = slot->generation;
+        view.equationId = slot->equationId;
+        view.firstPoint = slot->firstPoint;
+        view.totalPoints = slot->totalPoints;
+        view.xMin = slot->xMin;
+        view.xMax = slot->xMax;
+        const char* end = std::find(slot->equation, slot->equation + kSampleRingEquationLength, '\0');
+        view.equation = std::string_view(slot->equation, static_cast<std::size_t>(end - slot->equation));
+        view.points = reinterpret_cast<const Point*>(slot + 1);
+        view.count = slot->pointCount <= m_header->slotPoints ? slot->pointCount : 0;
+        visit(static_cast<const SampleBlock&>(view));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot->sequence.load(std::memory_order_relaxed) == before ? ReadStatus::Ok : ReadStatus::Overwritten;
+    }
+
+private:
+    const SlotHeader* GetSlot(std::uint64_t block) const {
+        const char* base = reinterpret_cast<const char*>(m_header) + sizeof(RingHeader);
+        return reinterpret_cast<const SlotHeader*>(base + (block % m_header->slotCount) * m_header->slotSize);
+    }
+
+    const RingHeader* m_header{nullptr};
+    std::size_t m_size{0};
+};
+
+} // namespace plot_genius
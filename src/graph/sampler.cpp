@@ -0,0 +1,441 @@
+/**
+ * Sampler Implementation
+ *
+ * Implements asynchronous point generation on the worker pool. Each request
+ * is tagged with a generation so that only the newest one is published.
+ */
+
+#include "sampler.hpp"
+#include "sample_ring.hpp"
+#include "../core/logger.hpp"
+#include "../core/thread_pool.hpp"
+#include "../core/profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace plot_genius {
+
+namespace {
+
+// x values per task when a group is spread over the pool
+constexpr std::size_t kGroupTaskPoints = 1024;
+
+// Cells an adaptive pass starts from before refining
+constexpr int kAdaptiveInitialCells = 32;
+
+// Cells scanned for sign changes when locating roots and extrema
+constexpr int kCriticalPointCells = 512;
+
+// Samples the value range of each column; both column edges get a point so the band is drawn as steps
+void SampleRanges(const SampleRequest& request, const SampleRequest::Entry& entry, const double* parameters,
+                  SampleResult::Curve& curve) {
+    const std::size_t columns = static_cast<std::size_t>(std::max(request.numPoints, 1));
+    std::vector<double> lower(columns);
+    std::vector<double> upper(columns);
+    try {
+        entry.graph->SampleRanges(request.xMin, request.xMax, columns, request.yTolerance, lower.data(),
+                                  upper.data(), parameters);
+    } catch (const std::exception& e) {
+        PLOT_GENIUS_LOG_ERROR("Failed to evaluate {}: {}", entry.graph->GetEquation(), e.what());
+        return;
+    }
+    
+    const double width = (request.xMax - request.xMin) / static_cast<double>(columns);
+    curve.points.resize(2 * columns);
+    curve.upper.resize(2 * columns);
+    for (std::size_t i = 0; i < columns; ++i) {
+        const double left = request.xMin + static_cast<double>(i) * width;
+        const double right = i + 1 == columns ? request.xMax : left + width;
+        curve.points[2 * i] = {left, lower[i]};
+        curve.points[2 * i + 1] = {right, lower[i]};
+        curve.upper[2 * i] = {left, upper[i]};
+        curve.upper[2 * i + 1] = {right, upper[i]};
+    }
+}
+
+// Samples numPoints evenly spaced points from a proxy covering the request's range
+std::vector<Point> SampleProxy(const SampleRequest& request, const ChebyshevProxy& proxy) {
+    const std::size_t count = static_cast<std::size_t>(std::max(request.numPoints, 2));
+    std::vector<double> xs(count);
+    std::vector<double> ys(count);
+    const double step = (request.xMax - request.xMin) / static_cast<double>(count - 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        xs[i] = request.xMin + static_cast<double>(i) * step;
+    }
+    proxy.Evaluate(xs.data(), ys.data(), count);
+    
+    std::vector<Point> points(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        points[i] = {xs[i], ys[i]};
+    }
+    return points;
+}
+
+// Samples one request entry: a single curve, a family, or a family's envelope
+SampleResult::Curve SampleEntry(const SampleRequest& request, const SampleRequest::Entry& entry,
+                                core::ThreadPool& pool) {
+    SampleResult::Curve curve;
+    curve.id = entry.id;
+    const double* parameters = entry.parameters.empty() ? nullptr : entry.parameters.data();
+    if (entry.sweep.members == 0) {
+        switch (request.mode) {
+            case SampleMode::Uniform:
+                if (request.interactive && entry.proxy) {
+                    curve.points = SampleProxy(request, *entry.proxy);
+                    curve.approximate = true;
+                } else {
+                    curve.points = entry.graph->GeneratePoints(request.xMin, request.xMax, request.numPoints,
+                                                               parameters);
+                }
+                break;
+            case SampleMode::Adaptive:
+                curve.points = entry.graph->GenerateAdaptivePoints(request.xMin, request.xMax, kAdaptiveInitialCells,
+                                                                   request.numPoints, request.yTolerance, parameters);
+                break;
+            case SampleMode::Range:
+                SampleRanges(request, entry, parameters, curve);
+                break;
+        }
+        return curve;
+    }
+    
+    const std::size_t count = static_cast<std::size_t>(request.numPoints);
+    const std::size_t members = entry.sweep.members;
+    std::vector<double> ys(members * count);
+    try {
+        entry.graph->SampleFamily(request.xMin, request.xMax, count, parameters, entry.sweep, ys.data(), &pool);
+    } catch (const std::exception& e) {
+        PLOT_GENIUS_LOG_ERROR("Failed to evaluate {}: {}", entry.graph->GetEquation(), e.what());
+        return curve;
+    }
+    
+    const double step = (request.xMax - request.xMin) / static_cast<double>(count - 1);
+    auto xAt = [&](std::size_t i) { return request.xMin + static_cast<double>(i) * step; };
+    
+    if (entry.envelope) {
+        // Members run along rows, so the bounds are updated a whole row at a time
+        std::vector<double> lower(ys.begin(), ys.begin() + count);
+        std::vector<double> upper(lower);
+        for (std::size_t m = 1; m < members; ++m) {
+            const double* row = ys.data() + m * count;
+            for (std::size_t i = 0; i < count; ++i) {
+                lower[i] = std::fmin(lower[i], row[i]);
+                upper[i] = std::fmax(upper[i], row[i]);
+            }
+        }
+        curve.points.resize(count);
+        curve.upper.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            curve.points[i] = {xAt(i), lower[i]};
+            curve.upper[i] = {xAt(i), upper[i]};
+        }
+        return curve;
+    }
+    
+    curve.members.resize(members);
+    for (std::size_t m = 0; m < members; ++m) {
+        auto& points = curve.members[m];
+        points.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            points[i] = {xAt(i), ys[m * count + i]};
+        }
+    }
+    return curve;
+}
+
+// Samples every entry that belongs to the request's group in one pass over a shared x grid
+void SampleGroup(const SampleRequest& request, std::vector<SampleResult::Curve>& curves, core::ThreadPool& pool) {
+    PLOT_GENIUS_PROFILE_SCOPE("Sample Group");
+    
+    const ProgramGroup& group = *request.group;
+    const std::size_t count = static_cast<std::size_t>(request.numPoints);
+    std::vector<double> parameters(group.GetParameters().size(), kDefaultParameterValue);
+    for (const auto& entry : request.entries) {
+        if (entry.member >= 0 && !entry.parameters.empty()) {
+            group.SetMemberParameters(static_cast<std::size_t>(entry.member), entry.parameters.data(),
+                                      parameters.data());
+        }
+    }
+    
+    // Each member only needs the grid points where it may be defined; the group runs where any of them is
+    std::vector<std::vector<std::pair<std::size_t, std::size_t>>> runs(request.entries.size());
+    std::vector<char> needed(count, 0);
+    for (std::size_t i = 0; i < request.entries.size(); ++i) {
+        const auto& entry = request.entries[i];
+        if (entry.member < 0) {
+            continue;
+        }
+        const double* memberParameters = entry.parameters.empty() ? nullptr : entry.parameters.data();
+        runs[i] = entry.graph->FindDefinedSamples(request.xMin, request.xMax, count, memberParameters);
+        for (const auto& run : runs[i]) {
+            std::fill(needed.begin() + run.first, needed.begin() + run.second, 1);
+        }
+    }
+    
+    // Needed stretches are cut into tasks of at most kGroupTaskPoints for the pool
+    std::vector<std::pair<std::size_t, std::size_t>> tasks;
+    for (std::size_t i = 0; i < count;) {
+        if (!needed[i]) {
+            ++i;
+            continue;
+        }
+        std::size_t end = i;
+        while (end < count && needed[end] && end - i < kGroupTaskPoints) {
+            ++end;
+        }
+        tasks.emplace_back(i, end);
+        i = end;
+    }
+    
+    std::vector<double> xs(count);
+    const double step = (request.xMax - request.xMin) / static_cast<double>(count - 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        xs[i] = request.xMin + static_cast<double>(i) * step;
+    }
+    
+    std::vector<double> ys(group.GetSize() * count);
+    std::vector<double*> columns(group.GetSize());
+    for (std::size_t member = 0; member < columns.size(); ++member) {
+        columns[member] = ys.data() + member * count;
+    }
+    
+    // Ranges of x go to different workers; each writes its slice of every column
+    auto evaluateRange = [&](std::size_t task) {
+        const std::size_t first = tasks[task].first;
+        std::vector<double*> slices(columns);
+        for (double*& slice : slices) {
+            slice += first;
+        }
+        group.EvaluateBatch(xs.data() + first, tasks[task].second - first, parameters.data(), slices.data());
+    };
+    try {
+        if (tasks.size() > 1) {
+            pool.ParallelFor(tasks.size(), evaluateRange);
+        } else if (!tasks.empty()) {
+            evaluateRange(0);
+        }
+    } catch (const std::exception& e) {
+        PLOT_GENIUS_LOG_ERROR("Failed to evaluate equations: {}", e.what());
+        return;
+    }
+    
+    for (std::size_t i = 0; i < request.entries.size(); ++i) {
+        const int member = request.entries[i].member;
+        if (member < 0) {
+            continue;
+        }
+        const double* column = columns[static_cast<std::size_t>(member)];
+        auto& points = curves[i].points;
+        points.clear();
+        for (const auto& run : runs[i]) {
+            if (!points.empty()) {
+                points.push_back({xs[run.first] - step / 2.0, std::numeric_limits<double>::quiet_NaN()});
+            }
+            for (std::size_t k = run.first; k < run.second; ++k) {
+                points.push_back({xs[k], column[k]});
+            }
+        }
+    }
+}
+
+// Adds derivatives, roots and extrema to the single curves of a request
+void AnalyzeCurves(const SampleRequest& request, std::vector<SampleResult::Curve>& curves, core::ThreadPool& pool) {
+    PLOT_GENIUS_PROFILE_SCOPE("Analyze Curves");
+    
+    auto analyze = [&](std::size_t i) {
+        const auto& entry = request.entries[i];
+        if (entry.sweep.members > 0) {
+            return;
+        }
+        const double* parameters = entry.parameters.empty() ? nullptr : entry.parameters.data();
+        auto& curve = curves[i];
+        if (request.derivativeOrder > 0) {
+            curve.derivative = entry.graph->GenerateDerivativePoints(request.xMin, request.xMax, request.numPoints,
+                                                                     request.derivativeOrder, parameters);
+        }
+        if (request.criticalPoints) {
+            entry.graph->FindCriticalPoints(request.xMin, request.xMax, kCriticalPointCells, curve.roots,
+                                            curve.extrema, parameters);
+        }
+    };
+    if (curves.size() > 1) {
+        pool.ParallelFor(curves.size(), analyze);
+    } else if (!curves.empty()) {
+        analyze(0);
+    }
+}
+
+// Fits proxies around the requested range for the entries asking for one
+void FitProxies(const SampleRequest& request, std::vector<SampleResult::Curve>& curves, core::ThreadPool& pool) {
+    PLOT_GENIUS_PROFILE_SCOPE("Fit Proxies");
+    
+    const double center = 0.5 * (request.xMin + request.xMax);
+    const double halfSpan = 0.5 * (request.xMax - request.xMin) * request.proxySpan;
+    auto fit = [&](std::size_t i) {
+        const auto& entry = request.entries[i];
+        if (entry.proxyTolerance <= 0.0 || entry.sweep.members > 0) {
+            return;
+        }
+        try {
+            curves[i].proxy = std::make_shared<const ChebyshevProxy>(entry.graph->GetProgram(), center - halfSpan,
+                                                                     center + halfSpan, entry.proxyTolerance,
+                                                                     entry.parameters);
+        } catch (const std::exception& e) {
+            PLOT_GENIUS_LOG_ERROR("Failed to approximate {}: {}", entry.graph->GetEquation(), e.what());
+        }
+    };
+    if (curves.size() > 1) {
+        pool.ParallelFor(curves.size(), fit);
+    } else if (!curves.empty()) {
+        fit(0);
+    }
+}
+
+// Hands equations whose measurements call for a faster tier to the pool; the job holds the graph
+void SchedulePromotions(const SampleRequest& request, core::ThreadPool& pool) {
+    for (const auto& entry : request.entries) {
+        ExecutionTier tier;
+        if (entry.sweep.members > 0 || !entry.graph->GetExecution().TakePromotion(tier)) {
+            continue;
+        }
+        pool.Submit([graph = entry.graph, tier] {
+            PLOT_GENIUS_PROFILE_SCOPE("Promote Program");
+            const TierStats before = graph->GetExecution().GetStats();
+            try {
+                graph->GetExecution().Promote(tier);
+            } catch (const std::exception& e) {
+                PLOT_GENIUS_LOG_ERROR("Failed to promote {}: {}", graph->GetEquation(), e.what());
+                return;
+            }
+            PLOT_GENIUS_LOG_INFO("Promoted {} from {} to {} after {} samples at {} ns each", graph->GetEquation(),
+                                 GetTierName(before.tier), GetTierName(tier), before.samples,
+                                 before.nanosecondsPerSample);
+        });
+    }
+}
+
+} // namespace
+
+Sampler::Sampler(core::ThreadPool& pool) : m_pool(pool) {}
+
+Sampler::~Sampler() {
+    // Supersede everything queued so pending jobs return immediately
+    m_latestGeneration.fetch_add(1);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_drained.wait(lock, [this] { return m_inFlight == 0; });
+}
+
+void Sampler::SetCompletionCallback(std::function<void()> callback) {
+    m_completionCallback = std::move(callback);
+}
+
+void Sampler::SetSampleRing(std::shared_ptr<SampleRingWriter> ring) {
+    m_ring = std::move(ring);
+}
+
+std::uint64_t Sampler::Request(SampleRequest request) {
+    const std::uint64_t generation = m_latestGeneration.fetch_add(1) + 1;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_inFlight;
+    }
+
+    auto shared = std::make_shared<const SampleRequest>(std::move(request));
+    m_pool.Submit([this, generation, shared] { Run(generation, *shared); });
+    return generation;
+}
+
+bool Sampler::TakeResult(SampleResult& result) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_hasResult) {
+        return false;
+    }
+    result = std::move(m_result);
+    m_result = SampleResult{};
+    m_hasResult = false;
+    return true;
+}
+
+bool Sampler::HasResult() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hasResult;
+}
+
+bool Sampler::IsBusy() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_inFlight > 0;
+}
+
+void Sampler::Run(std::uint64_t generation, const SampleRequest& request) {
+    PLOT_GENIUS_PROFILE_SCOPE("Sample Job");
+    PLOT_GENIUS_TRACE_FLOW_END(request.traceFlow);
+    
+    bool published = false;
+
+    // Skip work that a newer request has already made obsolete
+    if (generation == m_latestGeneration.load()) {
+        SampleResult result;
+        result.generation = generation;
+        result.xMin = request.xMin;
+        result.xMax = request.xMax;
+        result.mode = request.mode;
+        result.curves.reserve(request.entries.size());
+        
+        // The group evaluates a shared uniform grid, so other modes sample each curve alone
+        const bool grouped = request.group && request.mode == SampleMode::Uniform;
+        for (const auto& entry : request.entries) {
+            if (grouped && entry.member >= 0) {
+                result.curves.emplace_back();
+                result.curves.back().id = entry.id;
+            } else {
+                result.curves.push_back(SampleEntry(request, entry, m_pool));
+            }
+        }
+        if (grouped) {
+            SampleGroup(request, result.curves, m_pool);
+        }
+        if (request.derivativeOrder > 0 || request.criticalPoints) {
+            AnalyzeCurves(request, result.curves, m_pool);
+        }
+        
+        // Fitting is skipped once a newer request supersedes this one
+        const bool fitProxies = std::any_of(request.entries.begin(), request.entries.end(),
+                                            [](const SampleRequest::Entry& entry) { return entry.proxyTolerance > 0.0; });
+        if (fitProxies && generation == m_latestGeneration.load()) {
+            FitProxies(request, result.curves, m_pool);
+        }
+        SchedulePromotions(request, m_pool);
+
+        // Export outside the lock so the render thread never waits on the copy; families and ranges are not exported
+        if (m_ring && generation == m_latestGeneration.load()) {
+            for (std::size_t i = 0; i < result.curves.size(); ++i) {
+                if (request.entries[i].sweep.members > 0 || !result.curves[i].upper.empty()) {
+                    continue;
+                }
+                const auto& points = result.curves[i].points;
+                m_ring->Publish(generation, result.curves[i].id, request.entries[i].graph->GetEquation(),
+                                request.xMin, request.xMax, points.data(), points.size());
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (generation == m_latestGeneration.load() && generation > m_result.generation) {
+            m_result = std::move(result);
+            m_hasResult = true;
+            published = true;
+        }
+    }
+
+    if (published && m_completionCallback) {
+        m_completionCallback();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (--m_inFlight == 0) {
+        m_drained.notify_all();
+    }
+}
+
+} // namespace plot_genius
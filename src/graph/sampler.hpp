@@ -0,0 +1,183 @@
+/**
+ * Sampler Header
+ *
+ * Defines the asynchronous sampler that generates plot points for a set of
+ * graphs on the worker pool, so the render thread never blocks on evaluation.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "graph.hpp"
+#include "../equation/chebyshev.hpp"
+#include "../equation/program_group.hpp"
+
+namespace plot_genius {
+
+namespace core {
+class ThreadPool;
+}
+
+class SampleRingWriter;
+
+/**
+ * How single curves of a request are sampled
+ */
+enum class SampleMode {
+    Uniform,   ///< numPoints evenly spaced points
+    Adaptive,  ///< Points only where interval bounds show detail; numPoints is the finest cell count
+    Range      ///< Guaranteed value range over each of numPoints columns, drawn as a band
+};
+
+/**
+ * A batch of graphs to sample over a common x range
+ */
+struct SampleRequest {
+    /**
+     * One graph to sample, identified by the caller's id
+     */
+    struct Entry {
+        int id;                               ///< Caller-defined identifier
+        std::shared_ptr<const Graph> graph;   ///< Immutable graph snapshot
+        std::vector<double> parameters;       ///< Values of the graph's parameters, empty for defaults
+        Sweep sweep;                          ///< Family to sample instead of one curve, if it has members
+        bool envelope{false};                 ///< Reduce the family to its lower and upper bound
+        int member{-1};                       ///< Index of the graph's program in group, -1 to sample it alone
+        std::shared_ptr<const ChebyshevProxy> proxy;  ///< Approximation to sample instead while interactive, or nullptr
+        double proxyTolerance{0.0};           ///< Fit a new proxy to this tolerance after sampling, 0 for none
+    };
+
+    std::vector<Entry> entries;  ///< Graphs to sample
+    std::shared_ptr<const ProgramGroup> group;  ///< Programs of single curves evaluated together, or nullptr
+    double xMin{0.0};            ///< Minimum x value
+    double xMax{0.0};            ///< Maximum x value
+    int numPoints{100};          ///< Points per graph
+    SampleMode mode{SampleMode::Uniform};  ///< How single curves are sampled; families are always uniform
+    double yTolerance{0.0};      ///< Height of one pixel, for the adaptive and range modes
+    int derivativeOrder{0};      ///< Derivative of single curves to sample as well (1 or 2), 0 for none
+    bool criticalPoints{false};  ///< Locate roots and extrema of single curves
+    bool interactive{false};     ///< The view is moving; uniform curves with a proxy use it
+    double proxySpan{3.0};       ///< Width of fitted proxies relative to the requested range
+    std::uint64_t traceFlow{0};  ///< Trace flow started by the requester (0 if none)
+};
+
+/**
+ * Points generated for a completed request
+ */
+struct SampleResult {
+    /**
+     * Points of one sampled graph
+     */
+    struct Curve {
+        int id{0};                  ///< Identifier from the request entry
+        std::vector<Point> points;  ///< Generated points; the lower bound of an envelope or range
+        std::vector<Point> upper;   ///< Upper bound of an envelope or range, empty otherwise
+        std::vector<std::vector<Point>> members;  ///< Curves of a family drawn individually
+        std::vector<Point> derivative;  ///< Requested derivative of a single curve
+        std::vector<Point> roots;       ///< Roots of a single curve, if requested
+        std::vector<Point> extrema;     ///< Local minima and maxima of a single curve, if requested
+        std::shared_ptr<const ChebyshevProxy> proxy;  ///< Proxy fitted for the entry, if one was requested
+        bool approximate{false};        ///< Points came from the entry's proxy
+    };
+
+    std::uint64_t generation{0};  ///< Generation of the request that produced this
+    double xMin{0.0};             ///< Minimum x value of the request
+    double xMax{0.0};             ///< Maximum x value of the request
+    SampleMode mode{SampleMode::Uniform};  ///< Mode of the request
+    std::vector<Curve> curves;    ///< One curve per request entry
+};
+
+/**
+ * Samples graphs on the worker pool, keeping only the most recent request
+ *
+ * A newer request supersedes older ones: stale requests are skipped if they
+ * have not started and their results are discarded if they finish late.
+ */
+class Sampler {
+public:
+    /**
+     * Creates a sampler that schedules work on the given pool
+     *
+     * @param pool Worker pool to run sampling jobs on
+     */
+    explicit Sampler(core::ThreadPool& pool);
+
+    /**
+     * Waits for jobs still referencing this sampler
+     */
+    ~Sampler();
+
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+
+    /**
+     * Sets a callback invoked on the worker thread when a result is ready
+     *
+     * @param callback Must be thread-safe (e.g. posting an empty window event)
+     */
+    void SetCompletionCallback(std::function<void()> callback);
+
+    /**
+     * Publishes every current result to a shared-memory ring as well
+     *
+     * Call before the first request. Publishing runs on the worker thread.
+     *
+     * @param ring Ring to copy the points into, or nullptr to stop exporting
+     */
+    void SetSampleRing(std::shared_ptr<SampleRingWriter> ring);
+
+    /**
+     * Schedules a sampling pass, superseding earlier requests
+     *
+     * @param request Graphs and range to sample
+     * @return Generation number assigned to the request
+     */
+    std::uint64_t Request(SampleRequest request);
+
+    /**
+     * Takes the latest completed result, if one is waiting
+     *
+     * @param result Receives the result
+     * @return True if a result was available
+     */
+    bool TakeResult(SampleResult& result);
+
+    /**
+     * Checks whether a completed result is waiting to be taken
+     *
+     * @return True if TakeResult would succeed
+     */
+    bool HasResult() const;
+
+    /**
+     * Checks whether any request is still being sampled
+     *
+     * @return True while jobs are queued or running
+     */
+    bool IsBusy() const;
+
+private:
+    /**
+     * Runs a request on a worker thread
+     */
+    void Run(std::uint64_t generation, const SampleRequest& request);
+
+    core::ThreadPool& m_pool;                    ///< Pool the jobs run on
+    std::function<void()> m_completionCallback;  ///< Wakes the consumer
+    std::shared_ptr<SampleRingWriter> m_ring;    ///< Optional export of results
+    std::atomic<std::uint64_t> m_latestGeneration{0};  ///< Most recent request
+
+    mutable std::mutex m_mutex;                  ///< Guards the fields below
+    std::condition_variable m_drained;           ///< Signalled when no job is in flight
+    int m_inFlight{0};                           ///< Jobs queued or running
+    bool m_hasResult{false};                     ///< A result awaits TakeResult
+    SampleResult m_result;                       ///< Latest completed result
+};
+
+} // namespace plot_genius
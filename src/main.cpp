@@ -6,17 +6,49 @@
  */
 
 #include "application/app.hpp"
+#include "application/daemon.hpp"
+#include "application/headless.hpp"
 #include <iostream>
 
 /**
  * Main application entry point
  * 
- * @param argc Command line argument count (unused)
- * @param argv Command line argument values (unused)
- * @return Exit status code (0 for success, 1 for failure)
+ * @param argc Command line argument count
+ * @param argv Command line argument values (--headless selects batch mode, --daemon the plot service)
+ * @return Exit status code (0 for success, 1 for failure, 2 for invalid arguments)
  */
-int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
+int main(int argc, char** argv) {
     try {
+        // Batch sampling without a window or GL context
+        if (plot_genius::application::IsHeadlessRequested(argc, argv)) {
+            plot_genius::application::HeadlessOptions options;
+            std::string error;
+            if (!plot_genius::application::ParseHeadlessOptions(argc, argv, options, error)) {
+                std::cerr << error << '\n' << plot_genius::application::GetHeadlessUsage();
+                return 2;
+            }
+            if (options.showHelp) {
+                std::cout << plot_genius::application::GetHeadlessUsage();
+                return 0;
+            }
+            return plot_genius::application::RunHeadless(options);
+        }
+        
+        // Plot service on a Unix socket
+        if (plot_genius::application::IsDaemonRequested(argc, argv)) {
+            plot_genius::application::DaemonOptions options;
+            std::string error;
+            if (!plot_genius::application::ParseDaemonOptions(argc, argv, options, error)) {
+                std::cerr << error << '\n' << plot_genius::application::GetDaemonUsage();
+                return 2;
+            }
+            if (options.showHelp) {
+                std::cout << plot_genius::application::GetDaemonUsage();
+                return 0;
+            }
+            return plot_genius::application::RunDaemon(options);
+        }
+        
         auto& app = plot_genius::application::App::GetInstance();
         
         if (!app.Initialize()) {
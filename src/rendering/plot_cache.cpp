@@ -0,0 +1,210 @@
+#include "plot_cache.hpp"
+#include <imgui_impl_opengl3.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "../core/logger.hpp"
+#include "../core/profiler.hpp"
+
+namespace plot_genius {
+namespace rendering {
+
+PlotCache::PlotCache() = default;
+
+PlotCache::~PlotCache() {
+    Shutdown();
+}
+
+void PlotCache::Shutdown() {
+    DestroyTargets();
+    if (m_drawList) {
+        m_drawList->_ClearFreeMemory();
+        m_drawList.reset();
+    }
+}
+
+bool PlotCache::Update(const ImVec2& canvasPos, const ImVec2& canvasSize, const View& view,
+                       std::uint64_t contentRevision, const DrawFunction& draw) {
+    m_lastRedrawPixels = 0;
+    if (m_failed) {
+        return false;
+    }
+
+    const ImVec2 fbScale = ImGui::GetIO().DisplayFramebufferScale;
+    const int width = static_cast<int>(std::lround(canvasSize.x * fbScale.x));
+    const int height = static_cast<int>(std::lround(canvasSize.y * fbScale.y));
+    if (width <= 0 || height <= 0 || view.maxX <= view.minX || view.maxY <= view.minY) {
+        return false;
+    }
+
+    if (!EnsureTargets(width, height)) {
+        core::Logger::GetInstance().Log(core::LogLevel::Warning,
+            "Offscreen plot cache unavailable, drawing the graph directly");
+        m_failed = true;
+        return false;
+    }
+
+    const RedrawPlanner::Plan plan = m_planner.Next(width, height, canvasSize.x, canvasSize.y, view, contentRevision);
+    m_lastRedrawPixels = plan.redrawPixels;
+    const ImVec2 canvasMax(canvasPos.x + canvasSize.x, canvasPos.y + canvasSize.y);
+    if (plan.full) {
+        RenderRegion(m_targets[m_front], canvasPos, canvasSize, canvasPos, canvasMax, draw);
+        return true;
+    }
+    if (plan.shiftX == 0 && plan.shiftY == 0) {
+        return true;
+    }
+
+    BlitShifted(plan.shiftX, plan.shiftY);
+
+    // Redraw only the strips the shift exposed (in screen coordinates)
+    const Target& target = m_targets[m_front];
+    if (plan.shiftX != 0) {
+        const float stripWidth = std::abs(plan.shiftX) / fbScale.x;
+        const float left = plan.shiftX > 0 ? canvasPos.x : canvasMax.x - stripWidth;
+        RenderRegion(target, canvasPos, canvasSize,
+                     ImVec2(left, canvasPos.y), ImVec2(left + stripWidth, canvasMax.y), draw);
+    }
+    if (plan.shiftY != 0) {
+        const float stripHeight = std::abs(plan.shiftY) / fbScale.y;
+        const float top = plan.shiftY > 0 ? canvasPos.y : canvasMax.y - stripHeight;
+        RenderRegion(target, canvasPos, canvasSize,
+                     ImVec2(canvasPos.x, top), ImVec2(canvasMax.x, top + stripHeight), draw);
+    }
+    return true;
+}
+
+void PlotCache::Present(ImDrawList* drawList, const ImVec2& canvasPos, const ImVec2& canvasSize) const {
+    // GL textures are stored bottom-up, so flip V
+    drawList->AddImage((ImTextureID)(intptr_t)m_targets[m_front].texture,
+                       canvasPos, ImVec2(canvasPos.x + canvasSize.x, canvasPos.y + canvasSize.y),
+                       ImVec2(0.0f, 1.0f), ImVec2(1.0f, 0.0f));
+}
+
+bool PlotCache::EnsureTargets(int width, int height) {
+    if (m_targets[0].framebuffer && m_width == width && m_height == height) {
+        return true;
+    }
+
+    DestroyTargets();
+
+    GLint previousTexture = 0;
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+    bool complete = true;
+    for (Target& target : m_targets) {
+        glGenTextures(1, &target.texture);
+        glBindTexture(GL_TEXTURE_2D, target.texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glGenFramebuffers(1, &target.framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.texture, 0);
+        complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture));
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+
+    if (!complete) {
+        DestroyTargets();
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_front = 0;
+    return true;
+}
+
+void PlotCache::DestroyTargets() {
+    for (Target& target : m_targets) {
+        if (target.framebuffer) {
+            glDeleteFramebuffers(1, &target.framebuffer);
+            target.framebuffer = 0;
+        }
+        if (target.texture) {
+            glDeleteTextures(1, &target.texture);
+            target.texture = 0;
+        }
+    }
+    m_width = 0;
+    m_height = 0;
+    m_planner.Invalidate();
+}
+
+void PlotCache::RenderRegion(const Target& target, const ImVec2& canvasPos, const ImVec2& canvasSize,
+                             const ImVec2& clipMin, const ImVec2& clipMax, const DrawFunction& draw) {
+    PLOT_GENIUS_PROFILE_SCOPE("Plot Redraw");
+    
+    if (!m_drawList) {
+        m_drawList = std::make_unique<ImDrawList>(ImGui::GetDrawListSharedData());
+    }
+
+    // Record the region with the same settings ImGui uses for window draw lists
+    ImDrawList& drawList = *m_drawList;
+    drawList._ResetForNewFrame();
+    drawList.Flags = ImGui::GetWindowDrawList()->Flags;
+    drawList.PushTextureID(ImGui::GetIO().Fonts->TexID);
+    drawList.PushClipRect(clipMin, clipMax);
+    draw(&drawList, clipMin, clipMax);
+    drawList.PopClipRect();
+    drawList.PopTextureID();
+
+    ImDrawData drawData;
+    drawData.Valid = true;
+    drawData.DisplayPos = canvasPos;
+    drawData.DisplaySize = canvasSize;
+    drawData.FramebufferScale = ImGui::GetIO().DisplayFramebufferScale;
+    drawData.AddDrawList(&drawList);
+
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target.framebuffer);
+    ImGui_ImplOpenGL3_RenderDrawData(&drawData);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+}
+
+void PlotCache::BlitShifted(int shiftX, int shiftY) {
+    const Target& source = m_targets[m_front];
+    const Target& destination = m_targets[1 - m_front];
+
+    GLint previousRead = 0;
+    GLint previousDraw = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousRead);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDraw);
+    const GLboolean scissorEnabled = glIsEnabled(GL_SCISSOR_TEST);
+    glDisable(GL_SCISSOR_TEST);
+
+    // shiftY is in screen space (down); GL rows grow upwards
+    const int srcX0 = std::max(0, -shiftX);
+    const int srcX1 = m_width - std::max(0, shiftX);
+    const int dstX0 = std::max(0, shiftX);
+    const int dstX1 = m_width + std::min(0, shiftX);
+    const int srcY0 = std::max(0, shiftY);
+    const int srcY1 = m_height + std::min(0, shiftY);
+    const int dstY0 = std::max(0, -shiftY);
+    const int dstY1 = m_height - std::max(0, shiftY);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, source.framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, destination.framebuffer);
+    glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1,
+                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(previousRead));
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(previousDraw));
+    if (scissorEnabled) {
+        glEnable(GL_SCISSOR_TEST);
+    }
+
+    m_front = 1 - m_front;
+}
+
+} // namespace rendering
+} // namespace plot_genius
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <glad/glad.h>
+#include <imgui.h>
+#include "redraw_planner.hpp"
+
+namespace plot_genius {
+namespace rendering {
+
+// Offscreen cache for the plotted content of the graph panel.
+//
+// The grid and curves are rendered into a framebuffer-backed texture that is
+// reused for as long as the canvas size, view and content revision stay the
+// same. When the view is only translated by a whole number of pixels, the
+// previous image is blitted into place and just the newly exposed strips are
+// redrawn. Anything else (zoom, resize, new data or style) redraws in full.
+// RedrawPlanner makes these decisions; this class owns the GL side.
+class PlotCache {
+public:
+    // Records geometry into the draw list. Only geometry intersecting the
+    // clip rectangle (screen space) needs to be emitted.
+    using DrawFunction = std::function<void(ImDrawList* drawList, const ImVec2& clipMin, const ImVec2& clipMax)>;
+
+    using View = RedrawPlanner::View;
+
+    PlotCache();
+    ~PlotCache();
+
+    PlotCache(const PlotCache&) = delete;
+    PlotCache& operator=(const PlotCache&) = delete;
+
+    // Brings the cached image up to date. Returns false if offscreen rendering
+    // is unavailable, in which case the caller should draw directly.
+    bool Update(const ImVec2& canvasPos, const ImVec2& canvasSize, const View& view,
+                std::uint64_t contentRevision, const DrawFunction& draw);
+
+    // Draws the cached image over the canvas
+    void Present(ImDrawList* drawList, const ImVec2& canvasPos, const ImVec2& canvasSize) const;
+
+    // Forces a full redraw on the next update
+    void Invalidate() { m_planner.Invalidate(); }
+
+    // X range the drawn content has data for, and whether the image has regions drawn beyond it
+    void SetDataRange(float minX, float maxX) { m_planner.SetDataRange(minX, maxX); }
+    bool LacksData() const { return m_planner.LacksData(); }
+
+    // Number of framebuffer pixels redrawn by the last update (0 when idle)
+    std::int64_t GetLastRedrawPixels() const { return m_lastRedrawPixels; }
+
+    void Shutdown();
+
+private:
+    struct Target {
+        GLuint framebuffer{0};
+        GLuint texture{0};
+    };
+
+    bool EnsureTargets(int width, int height);
+    void DestroyTargets();
+    void RenderRegion(const Target& target, const ImVec2& canvasPos, const ImVec2& canvasSize,
+                      const ImVec2& clipMin, const ImVec2& clipMax, const DrawFunction& draw);
+    void BlitShifted(int shiftX, int shiftY);
+
+    Target m_targets[2];
+    std::unique_ptr<ImDrawList> m_drawList;  // Reused between redraws
+    int m_front{0};
+    int m_width{0};
+    int m_height{0};
+    bool m_failed{false};
+
+    RedrawPlanner m_planner;  // State the front image was rendered for
+    std::int64_t m_lastRedrawPixels{0};
+};
+
+} // namespace rendering
+} // namespace plot_genius
@@ -0,0 +1,94 @@
+#include "redraw_planner.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace plot_genius {
+namespace rendering {
+
+namespace {
+
+// Largest sub-pixel residual (in framebuffer pixels) tolerated when reusing
+// the cached image after a pan; anything larger triggers a full redraw.
+constexpr float kShiftTolerance = 0.01f;
+
+// Relative tolerance used to decide whether the zoom level is unchanged
+constexpr float kScaleTolerance = 1e-5f;
+
+bool NearlyEqual(float a, float b, float relative) {
+    return std::abs(a - b) <= relative * std::max(std::abs(a), std::abs(b));
+}
+
+} // namespace
+
+RedrawPlanner::Plan RedrawPlanner::Next(int width, int height, float canvasWidth, float canvasHeight,
+                                        const View& view, std::uint64_t contentRevision) {
+    Plan plan;
+
+    // Framebuffer pixels per world unit
+    const float scaleX = width / (view.maxX - view.minX);
+    const float scaleY = height / (view.maxY - view.minY);
+
+    const bool reusable = m_valid &&
+        m_contentRevision == contentRevision &&
+        m_canvasWidth == canvasWidth && m_canvasHeight == canvasHeight &&
+        NearlyEqual(view.maxX - view.minX, m_view.maxX - m_view.minX, kScaleTolerance) &&
+        NearlyEqual(view.maxY - view.minY, m_view.maxY - m_view.minY, kScaleTolerance);
+
+    if (reusable) {
+        // Content moves right when the view moves left, and down when it moves up
+        const float shiftX = (m_view.minX - view.minX) * scaleX;
+        const float shiftY = (view.minY - m_view.minY) * scaleY;
+        const int pixelsX = static_cast<int>(std::lround(shiftX));
+        const int pixelsY = static_cast<int>(std::lround(shiftY));
+
+        if (std::abs(shiftX - pixelsX) <= kShiftTolerance &&
+            std::abs(shiftY - pixelsY) <= kShiftTolerance &&
+            std::abs(pixelsX) < width && std::abs(pixelsY) < height) {
+            plan.shiftX = pixelsX;
+            plan.shiftY = pixelsY;
+            if (pixelsX == 0 && pixelsY == 0) {
+                return plan;
+            }
+
+            // Anchor the cached view to the whole-pixel shift applied
+            const float worldX = pixelsX / scaleX;
+            const float worldY = pixelsY / scaleY;
+            m_view.minX -= worldX;
+            m_view.maxX -= worldX;
+            m_view.minY += worldY;
+            m_view.maxY += worldY;
+
+            // A strip on the left or right spans the pixels exposed; one at the top or bottom the whole width
+            if (pixelsX != 0) {
+                const float stripWidth = std::abs(pixelsX) / scaleX;
+                const float left = pixelsX > 0 ? m_view.minX : m_view.maxX - stripWidth;
+                m_lacksData = m_lacksData || !Covers(left, left + stripWidth);
+                plan.redrawPixels += static_cast<std::int64_t>(std::abs(pixelsX)) * height;
+            }
+            if (pixelsY != 0) {
+                m_lacksData = m_lacksData || !Covers(m_view.minX, m_view.maxX);
+                plan.redrawPixels += static_cast<std::int64_t>(std::abs(pixelsY)) * width;
+            }
+            return plan;
+        }
+    }
+
+    plan.full = true;
+    plan.redrawPixels = static_cast<std::int64_t>(width) * height;
+
+    m_view = view;
+    m_canvasWidth = canvasWidth;
+    m_canvasHeight = canvasHeight;
+    m_contentRevision = contentRevision;
+    m_valid = true;
+    m_lacksData = !Covers(view.minX, view.maxX);
+    return plan;
+}
+
+void RedrawPlanner::SetDataRange(float minX, float maxX) {
+    m_dataMinX = minX;
+    m_dataMaxX = maxX;
+}
+
+} // namespace rendering
+} // namespace plot_genius
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+namespace plot_genius {
+namespace rendering {
+
+// Decides how the plot cache brings its image up to date. Free of GL so the
+// decisions can be checked headless; PlotCache carries them out.
+//
+// The image is reused while the canvas size, zoom and content revision stay
+// the same. When the view is only translated by a whole number of pixels,
+// the image is shifted and just the newly exposed strips are redrawn. The
+// planner also remembers whether any region was drawn beyond the x range the
+// content had data for, e.g. a strip a pan exposed before the curves were
+// resampled, so the owner knows when new data must replace the image.
+class RedrawPlanner {
+public:
+    struct View {
+        float minX{0.0f};
+        float maxX{0.0f};
+        float minY{0.0f};
+        float maxY{0.0f};
+    };
+
+    struct Plan {
+        bool full{false};              // Redraw the whole canvas
+        int shiftX{0};                 // Otherwise shift the image right by this many framebuffer pixels,
+        int shiftY{0};                 // down by this many, and redraw the strips the shift exposed
+        std::int64_t redrawPixels{0};  // Framebuffer pixels redrawn
+    };
+
+    // Plans the update of a width x height framebuffer showing a canvas of the given layout size
+    Plan Next(int width, int height, float canvasWidth, float canvasHeight, const View& view,
+              std::uint64_t contentRevision);
+
+    // Forces a full redraw on the next update
+    void Invalidate() { m_valid = false; }
+
+    // X range the content has data for from now on
+    void SetDataRange(float minX, float maxX);
+
+    // Whether a region of the current image was drawn beyond the data range of its time
+    bool LacksData() const { return m_lacksData; }
+
+private:
+    bool Covers(float minX, float maxX) const { return m_dataMinX <= minX && maxX <= m_dataMaxX; }
+
+    // State the image was drawn for. m_view is kept anchored to the
+    // whole-pixel shifts actually applied so sub-pixel error never accumulates.
+    bool m_valid{false};
+    View m_view;
+    float m_canvasWidth{0.0f};
+    float m_canvasHeight{0.0f};
+    std::uint64_t m_contentRevision{0};
+
+    float m_dataMinX{0.0f};
+    float m_dataMaxX{0.0f};
+    bool m_lacksData{true};
+};
+
+} // namespace rendering
+} // namespace plot_genius
@@ -9,7 +9,6 @@
 namespace plot_genius {
 namespace rendering {
 
-using core::Logger;
 
 // OpenGL constants
 #define GL_ARRAY_BUFFER 0x8892
@@ -72,12 +71,12 @@ Renderer::~Renderer() {
 
 bool Renderer::Initialize() {
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        Logger::GetInstance().Error("Failed to initialize GLAD");
+        PLOT_GENIUS_LOG_ERROR("Failed to initialize GLAD");
         return false;
     }
 
     if (!SetupShaders()) {
-        Logger::GetInstance().Error("Failed to setup shaders");
+        PLOT_GENIUS_LOG_ERROR("Failed to setup shaders");
         return false;
     }
 
@@ -198,7 +197,7 @@ bool Renderer::CompileShader(const char* source, unsigned int type, unsigned int
     glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if (!success) {
         glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-        Logger::GetInstance().Error("Shader compilation failed: {}", infoLog);
+        PLOT_GENIUS_LOG_ERROR("Shader compilation failed: {}", infoLog);
         return false;
     }
     return true;
@@ -215,7 +214,7 @@ bool Renderer::LinkProgram(unsigned int vertexShader, unsigned int fragmentShade
     glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success) {
         glGetProgramInfoLog(program, 512, nullptr, infoLog);
-        Logger::GetInstance().Error("Shader program linking failed: {}", infoLog);
+        PLOT_GENIUS_LOG_ERROR("Shader program linking failed: {}", infoLog);
         return false;
     }
     return true;
@@ -0,0 +1,154 @@
+/**
+ * Service Protocol Implementation
+ *
+ * Implements parsing of request lines and formatting of response headers.
+ */
+
+#include "protocol.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+
+namespace plot_genius {
+namespace service {
+
+namespace {
+
+/**
+ * Splits a line into space-separated tokens
+ */
+std::vector<std::string_view> Tokenize(std::string_view line) {
+    std::vector<std::string_view> tokens;
+    std::size_t position = 0;
+    while (position < line.size()) {
+        position = line.find_first_not_of(" \t\r", position);
+        if (position == std::string_view::npos) {
+            break;
+        }
+        std::size_t end = line.find_first_of(" \t\r", position);
+        if (end == std::string_view::npos) {
+            end = line.size();
+        }
+        tokens.push_back(line.substr(position, end - position));
+        position = end;
+    }
+    return tokens;
+}
+
+bool ParseNumber(std::string_view text, double& value) {
+    std::string copy(text);
+    char* end = nullptr;
+    value = std::strtod(copy.c_str(), &end);
+    return !copy.empty() && *end == '\0' && std::isfinite(value);
+}
+
+template<typename T>
+bool ParseCount(std::string_view text, T& value) {
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+} // namespace
+
+const char* GetOutputKindName(OutputKind kind) {
+    switch (kind) {
+        case OutputKind::Samples: return "samples";
+        case OutputKind::Png: return "png";
+        case OutputKind::Svg: return "svg";
+        case OutputKind::Stats: return "stats";
+        default: return "unknown";
+    }
+}
+
+bool ParseRequest(std::string_view line, Request& request, std::string& error) {
+    const auto tokens = Tokenize(line);
+    if (tokens.empty()) {
+        error = "Empty request";
+        return false;
+    }
+    request.id = std::string(tokens[0]);
+    if (request.id.size() > kMaxIdLength) {
+        request.id = "-";
+        error = "Request ID is too long";
+        return false;
+    }
+    if (tokens.size() < 2) {
+        error = "Missing output kind";
+        return false;
+    }
+
+    const std::string_view kind = tokens[1];
+    std::size_t next = 2;
+    if (kind == "stats") {
+        request.kind = OutputKind::Stats;
+        if (tokens.size() != 2) {
+            error = "stats takes no arguments";
+            return false;
+        }
+        return true;
+    } else if (kind == "samples") {
+        request.kind = OutputKind::Samples;
+        if (tokens.size() < 6 || !ParseNumber(tokens[2], request.view.xMin) ||
+            !ParseNumber(tokens[3], request.view.xMax) || !ParseCount(tokens[4], request.points)) {
+            error = "Expected: ID samples XMIN XMAX POINTS EQUATION...";
+            return false;
+        }
+        if (request.points < 2 || request.points > kMaxPoints) {
+            error = "POINTS must be between 2 and " + std::to_string(kMaxPoints);
+            return false;
+        }
+        next = 5;
+    } else if (kind == "png" || kind == "svg") {
+        request.kind = kind == "png" ? OutputKind::Png : OutputKind::Svg;
+        ImageView& view = request.view;
+        if (tokens.size() < 9 || !ParseNumber(tokens[2], view.xMin) || !ParseNumber(tokens[3], view.xMax) ||
+            !ParseNumber(tokens[4], view.yMin) || !ParseNumber(tokens[5], view.yMax) ||
+            !ParseCount(tokens[6], view.width) || !ParseCount(tokens[7], view.height)) {
+            error = "Expected: ID " + std::string(kind) + " XMIN XMAX YMIN YMAX WIDTH HEIGHT EQUATION...";
+            return false;
+        }
+        if (view.yMin >= view.yMax) {
+            error = "YMIN must be below YMAX";
+            return false;
+        }
+        if (view.width < 2 || view.height < 2 || view.width > kMaxImageSize || view.height > kMaxImageSize) {
+            error = "WIDTH and HEIGHT must be between 2 and " + std::to_string(kMaxImageSize);
+            return false;
+        }
+        // One sample per pixel column, as in the window
+        request.points = view.width;
+        next = 8;
+    } else {
+        error = "Unknown output kind: " + std::string(kind);
+        return false;
+    }
+
+    if (request.view.xMin >= request.view.xMax) {
+        error = "XMIN must be below XMAX";
+        return false;
+    }
+    if (tokens.size() - next > kMaxEquations) {
+        error = "At most " + std::to_string(kMaxEquations) + " equations per request";
+        return false;
+    }
+    request.equations.assign(tokens.begin() + static_cast<std::ptrdiff_t>(next), tokens.end());
+    return true;
+}
+
+std::string FormatOkHeader(const std::string& id, std::size_t payloadSize, std::uint64_t latencyUs) {
+    return id + " ok " + std::to_string(payloadSize) + ' ' + std::to_string(latencyUs) + '\n';
+}
+
+std::string FormatError(const std::string& id, const std::string& message) {
+    std::string line = (id.empty() ? std::string("-") : id) + " error " + message;
+    for (char& c : line) {
+        if (c == '\n' || c == '\r') {
+            c = ' ';
+        }
+    }
+    return line + '\n';
+}
+
+} // namespace service
+} // namespace plot_genius
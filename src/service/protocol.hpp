@@ -0,0 +1,103 @@
+/**
+ * Service Protocol Header
+ *
+ * Defines the wire format of the plot service. Requests are single text
+ * lines, so clients can pipeline any number of them on one connection:
+ *
+ *     ID samples XMIN XMAX POINTS EQUATION...
+ *     ID png XMIN XMAX YMIN YMAX WIDTH HEIGHT EQUATION...
+ *     ID svg XMIN XMAX YMIN YMAX WIDTH HEIGHT EQUATION...
+ *     ID stats
+ *
+ * ID is any token chosen by the client and equations are separated by
+ * spaces, so they must not contain any. Responses may arrive in a different
+ * order than their requests and carry the request's ID:
+ *
+ *     ID ok BYTES LATENCY_US\n<BYTES bytes of payload>
+ *     ID error MESSAGE\n
+ *
+ * Sample payloads use the binary block layout of headless mode, one block per
+ * equation: uint32 equation, uint32 count, float x[count], float y[count].
+ * Stats payloads are "name value" text lines.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "render.hpp"
+
+namespace plot_genius {
+namespace service {
+
+// Limits that keep a single request from exhausting the service
+constexpr std::size_t kMaxLineLength = 1 << 20;
+constexpr std::size_t kMaxIdLength = 64;
+constexpr std::size_t kMaxEquations = 256;
+constexpr std::size_t kMaxPoints = 1 << 20;
+constexpr std::uint32_t kMaxImageSize = 8192;
+
+/**
+ * What a request asks for
+ */
+enum class OutputKind {
+    Samples,
+    Png,
+    Svg,
+    Stats,
+    Count
+};
+
+/**
+ * Parsed request line
+ */
+struct Request {
+    std::string id;
+    OutputKind kind{OutputKind::Samples};
+    ImageView view;                      ///< Only xMin and xMax are used for samples
+    std::size_t points{0};               ///< Samples per equation; the image width for images
+    std::vector<std::string> equations;
+};
+
+/**
+ * Gets the protocol name of an output kind
+ *
+ * @param kind Output kind
+ * @return Name as used in requests
+ */
+const char* GetOutputKindName(OutputKind kind);
+
+/**
+ * Parses a request line
+ *
+ * @param line Line without its newline
+ * @param request Receives the request; its id is set whenever the line has one
+ * @param error Receives the reason on failure
+ * @return True if the request is valid
+ */
+bool ParseRequest(std::string_view line, Request& request, std::string& error);
+
+/**
+ * Formats the header of a successful response
+ *
+ * @param id Request ID
+ * @param payloadSize Bytes following the header
+ * @param latencyUs Time from receiving the request to completing it
+ * @return Header line including its newline
+ */
+std::string FormatOkHeader(const std::string& id, std::size_t payloadSize, std::uint64_t latencyUs);
+
+/**
+ * Formats a failed response
+ *
+ * @param id Request ID, "-" if the line had none
+ * @param message Reason; line breaks are replaced by spaces
+ * @return Response line including its newline
+ */
+std::string FormatError(const std::string& id, const std::string& message);
+
+} // namespace service
+} // namespace plot_genius
@@ -0,0 +1,562 @@
+/**
+ * Image Renderer Implementation
+ *
+ * Curves are clipped to a margin around the image, then either rasterized
+ * with anti-aliased wide lines into an RGBA buffer or written as SVG
+ * polylines. PNG data is compressed with a single fixed-Huffman deflate
+ * block whose only matches repeat the previous pixel or the row above,
+ * which is enough for plots: mostly flat background with thin lines.
+ */
+
+#include "render.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace plot_genius {
+namespace service {
+
+namespace {
+
+constexpr std::uint32_t kBackgroundColor = 0xFF181818;
+constexpr std::uint32_t kGridColor = 0xFF3C3C3C;
+constexpr std::uint32_t kAxisColor = 0xFF8C8C8C;
+constexpr double kCurveWidth = 2.0;
+
+// Grid lines aimed for across the shorter range
+constexpr double kGridLines = 8.0;
+constexpr int kMaxGridLines = 200;
+
+/**
+ * Maps view coordinates to pixels
+ */
+struct Mapping {
+    double xScale;
+    double yScale;
+    double xMin;
+    double yMax;
+
+    explicit Mapping(const ImageView& view)
+        : xScale(view.width / (view.xMax - view.xMin)),
+          yScale(view.height / (view.yMax - view.yMin)),
+          xMin(view.xMin),
+          yMax(view.yMax) {}
+
+    double X(double x) const { return (x - xMin) * xScale; }
+    double Y(double y) const { return (yMax - y) * yScale; }
+};
+
+/**
+ * Clips a segment to a box (Liang-Barsky)
+ *
+ * @return False if the segment lies completely outside
+ */
+bool ClipSegment(double& x0, double& y0, double& x1, double& y1,
+                 double left, double top, double right, double bottom) {
+    const double dx = x1 - x0;
+    const double dy = y1 - y0;
+    double t0 = 0.0;
+    double t1 = 1.0;
+    const double p[4] = {-dx, dx, -dy, dy};
+    const double q[4] = {x0 - left, right - x0, y0 - top, bottom - y0};
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0) {
+                return false;
+            }
+            continue;
+        }
+        const double t = q[i] / p[i];
+        if (p[i] < 0.0) {
+            t0 = std::max(t0, t);
+        } else {
+            t1 = std::min(t1, t);
+        }
+        if (t0 > t1) {
+            return false;
+        }
+    }
+
+    const double startX = x0;
+    const double startY = y0;
+    x0 = startX + t0 * dx;
+    y0 = startY + t0 * dy;
+    x1 = startX + t1 * dx;
+    y1 = startY + t1 * dy;
+    return true;
+}
+
+/**
+ * Visits the visible pixel-space segments of a curve
+ *
+ * @param emit Called with (x0, y0, x1, y1, connected); connected is true if
+ *             the segment continues the previous one without a gap
+ */
+template<typename Emit>
+void TraceCurve(const ImageView& view, const Curve& curve, double margin, Emit emit) {
+    if (curve.count < 2) {
+        return;
+    }
+    const Mapping map(view);
+    const double step = (view.xMax - view.xMin) / static_cast<double>(curve.count - 1);
+    const double left = -margin;
+    const double top = -margin;
+    const double right = view.width + margin;
+    const double bottom = view.height + margin;
+
+    bool connected = false;
+    for (std::size_t i = 1; i < curve.count; ++i) {
+        const double ya = curve.y[i - 1];
+        const double yb = curve.y[i];
+        if (!std::isfinite(ya) || !std::isfinite(yb)) {
+            connected = false;
+            continue;
+        }
+
+        double x0 = map.X(view.xMin + static_cast<double>(i - 1) * step);
+        double y0 = map.Y(ya);
+        double x1 = map.X(view.xMin + static_cast<double>(i) * step);
+        double y1 = map.Y(yb);
+        const double endX = x1;
+        const double endY = y1;
+        const double startX = x0;
+        const double startY = y0;
+        if (!ClipSegment(x0, y0, x1, y1, left, top, right, bottom)) {
+            connected = false;
+            continue;
+        }
+
+        emit(x0, y0, x1, y1, connected && x0 == startX && y0 == startY);
+        connected = x1 == endX && y1 == endY;
+    }
+}
+
+/**
+ * Grid line positions for one axis
+ */
+template<typename Emit>
+void ForEachGridLine(double minValue, double maxValue, double step, Emit emit) {
+    const double first = std::ceil(minValue / step);
+    const double last = std::floor(maxValue / step);
+    for (double k = first; k <= last && k - first < kMaxGridLines; k += 1.0) {
+        emit(k * step);
+    }
+}
+
+double GridStep(const ImageView& view) {
+    const double range = std::min(view.xMax - view.xMin, view.yMax - view.yMin);
+    const double raw = range / kGridLines;
+    const double magnitude = std::pow(10.0, std::floor(std::log10(raw)));
+    const double normalized = raw / magnitude;
+    const double nice = normalized < 1.5 ? 1.0 : normalized < 3.5 ? 2.0 : normalized < 7.5 ? 5.0 : 10.0;
+    return nice * magnitude;
+}
+
+/**
+ * RGBA8 image with alpha blending
+ */
+class Canvas {
+public:
+    Canvas(std::uint32_t width, std::uint32_t height, std::uint32_t background)
+        : m_width(width), m_height(height), m_pixels(static_cast<std::size_t>(width) * height * 4) {
+        for (std::size_t i = 0; i < m_pixels.size(); i += 4) {
+            std::memcpy(&m_pixels[i], &background, 4);
+        }
+    }
+
+    std::uint32_t GetWidth() const { return m_width; }
+    std::uint32_t GetHeight() const { return m_height; }
+    const std::uint8_t* GetRow(std::uint32_t y) const { return &m_pixels[static_cast<std::size_t>(y) * m_width * 4]; }
+
+    void Blend(long x, long y, std::uint32_t color, double coverage) {
+        if (x < 0 || y < 0 || x >= static_cast<long>(m_width) || y >= static_cast<long>(m_height) || coverage <= 0.0) {
+            return;
+        }
+        std::uint8_t* pixel = &m_pixels[(static_cast<std::size_t>(y) * m_width + static_cast<std::size_t>(x)) * 4];
+        const double alpha = std::min(coverage, 1.0) * static_cast<double>(color >> 24) / 255.0;
+        for (int channel = 0; channel < 3; ++channel) {
+            const double source = static_cast<double>((color >> (8 * channel)) & 0xFF);
+            pixel[channel] = static_cast<std::uint8_t>(pixel[channel] + (source - pixel[channel]) * alpha + 0.5);
+        }
+    }
+
+    /**
+     * Draws an anti-aliased line of the given width
+     *
+     * Walks the major axis one pixel center at a time and covers the span of
+     * the line across the minor axis, weighting the end pixels by overlap.
+     * The end point is excluded so joined segments do not blend twice.
+     */
+    void DrawLine(double x0, double y0, double x1, double y1, std::uint32_t color, double width) {
+        const bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
+        if (steep) {
+            std::swap(x0, y0);
+            std::swap(x1, y1);
+        }
+        if (x0 > x1) {
+            std::swap(x0, x1);
+            std::swap(y0, y1);
+        }
+
+        const double gradient = x1 > x0 ? (y1 - y0) / (x1 - x0) : 0.0;
+        const double half = 0.5 * width * std::sqrt(1.0 + gradient * gradient);
+        const long majorLimit = static_cast<long>(steep ? m_height : m_width);
+        const long minorLimit = static_cast<long>(steep ? m_width : m_height);
+
+        const long first = std::max(0L, static_cast<long>(std::ceil(x0 - 0.5)));
+        const long last = std::min(majorLimit, static_cast<long>(std::ceil(x1 - 0.5)));
+        for (long major = first; major < last; ++major) {
+            const double center = y0 + gradient * (static_cast<double>(major) + 0.5 - x0);
+            const double low = center - half;
+            const double high = center + half;
+            const long from = std::max(0L, static_cast<long>(std::floor(low)));
+            const long to = std::min(minorLimit - 1, static_cast<long>(std::floor(high)));
+            for (long minor = from; minor <= to; ++minor) {
+                const double coverage = std::min(high, static_cast<double>(minor + 1)) -
+                                        std::max(low, static_cast<double>(minor));
+                if (steep) {
+                    Blend(minor, major, color, coverage);
+                } else {
+                    Blend(major, minor, color, coverage);
+                }
+            }
+        }
+    }
+
+private:
+    std::uint32_t m_width;
+    std::uint32_t m_height;
+    std::vector<std::uint8_t> m_pixels;
+};
+
+// --- PNG encoding ---
+
+constexpr std::array<std::uint32_t, 256> MakeCrcTable() {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t n = 0; n < 256; ++n) {
+        std::uint32_t c = n;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[n] = c;
+    }
+    return table;
+}
+
+constexpr std::array<std::uint32_t, 256> kCrcTable = MakeCrcTable();
+
+std::uint32_t Crc32(const char* data, std::size_t size) {
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = kCrcTable[(crc ^ static_cast<std::uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+std::uint32_t Adler32(const std::vector<std::uint8_t>& data) {
+    std::uint32_t a = 1;
+    std::uint32_t b = 0;
+    std::size_t i = 0;
+    while (i < data.size()) {
+        // 5552 bytes is the longest run that cannot overflow before the modulo
+        const std::size_t end = std::min(data.size(), i + 5552);
+        for (; i < end; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+void AppendBigEndian(std::string& out, std::uint32_t value) {
+    out += static_cast<char>(value >> 24);
+    out += static_cast<char>(value >> 16);
+    out += static_cast<char>(value >> 8);
+    out += static_cast<char>(value);
+}
+
+/**
+ * Writes deflate bits, least significant first
+ */
+class BitWriter {
+public:
+    explicit BitWriter(std::string& out) : m_out(out) {}
+
+    void Write(std::uint32_t value, int length) {
+        m_bits |= static_cast<std::uint64_t>(value) << m_count;
+        m_count += length;
+        while (m_count >= 8) {
+            m_out += static_cast<char>(m_bits & 0xFF);
+            m_bits >>= 8;
+            m_count -= 8;
+        }
+    }
+
+    // Huffman codes are stored most significant bit first
+    void WriteCode(std::uint32_t code, int length) {
+        std::uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i) {
+            reversed |= ((code >> i) & 1u) << (length - 1 - i);
+        }
+        Write(reversed, length);
+    }
+
+    void Flush() {
+        if (m_count > 0) {
+            m_out += static_cast<char>(m_bits & 0xFF);
+        }
+        m_bits = 0;
+        m_count = 0;
+    }
+
+private:
+    std::string& m_out;
+    std::uint64_t m_bits{0};
+    int m_count{0};
+};
+
+// Fixed Huffman literal/length code (RFC 1951, 3.2.6)
+void WriteSymbol(BitWriter& writer, std::uint32_t symbol) {
+    if (symbol < 144) {
+        writer.WriteCode(0x30 + symbol, 8);
+    } else if (symbol < 256) {
+        writer.WriteCode(0x190 + symbol - 144, 9);
+    } else if (symbol < 280) {
+        writer.WriteCode(symbol - 256, 7);
+    } else {
+        writer.WriteCode(0xC0 + symbol - 280, 8);
+    }
+}
+
+constexpr std::uint16_t kLengthBase[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                           31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                           2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr std::uint16_t kDistanceBase[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,   25,
+                                             33,   49,   65,   97,   129,  193,   257,   385,   513,  769,
+                                             1025, 1537, 2049, 3073, 4097, 6145,  8193,  12289, 16385, 24577};
+constexpr std::uint8_t kDistanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                             6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+constexpr std::size_t kMinMatch = 3;
+constexpr std::size_t kMaxMatch = 258;
+constexpr std::size_t kMaxDistance = 32768;
+
+void WriteMatch(BitWriter& writer, std::size_t length, std::size_t distance) {
+    int code = 28;
+    while (kLengthBase[code] > length) {
+        --code;
+    }
+    WriteSymbol(writer, 257 + static_cast<std::uint32_t>(code));
+    writer.Write(static_cast<std::uint32_t>(length - kLengthBase[code]), kLengthExtra[code]);
+
+    code = 29;
+    while (kDistanceBase[code] > distance) {
+        --code;
+    }
+    writer.WriteCode(static_cast<std::uint32_t>(code), 5);
+    writer.Write(static_cast<std::uint32_t>(distance - kDistanceBase[code]), kDistanceExtra[code]);
+}
+
+std::size_t MatchLength(const std::vector<std::uint8_t>& data, std::size_t position, std::size_t distance) {
+    if (distance > position || distance > kMaxDistance) {
+        return 0;
+    }
+    const std::size_t limit = std::min(kMaxMatch, data.size() - position);
+    std::size_t length = 0;
+    while (length < limit && data[position + length] == data[position + length - distance]) {
+        ++length;
+    }
+    return length;
+}
+
+/**
+ * Compresses to a zlib stream with one fixed-Huffman block
+ *
+ * @param pixelSize Bytes per pixel, a match candidate
+ * @param stride Bytes per filtered row, the other match candidate
+ */
+void Deflate(const std::vector<std::uint8_t>& data, std::size_t pixelSize, std::size_t stride, std::string& out) {
+    out += static_cast<char>(0x78);  // 32K window, deflate
+    out += static_cast<char>(0x01);  // Fastest, no dictionary; header is a multiple of 31
+
+    BitWriter writer(out);
+    writer.Write(1, 1);  // Final block
+    writer.Write(1, 2);  // Fixed Huffman codes
+
+    std::size_t position = 0;
+    while (position < data.size()) {
+        std::size_t length = MatchLength(data, position, pixelSize);
+        std::size_t distance = pixelSize;
+        const std::size_t above = MatchLength(data, position, stride);
+        if (above > length) {
+            length = above;
+            distance = stride;
+        }
+
+        if (length >= kMinMatch) {
+            WriteMatch(writer, length, distance);
+            position += length;
+        } else {
+            WriteSymbol(writer, data[position]);
+            ++position;
+        }
+    }
+    WriteSymbol(writer, 256);  // End of block
+    writer.Flush();
+
+    AppendBigEndian(out, Adler32(data));
+}
+
+void AppendChunk(std::string& out, const char* type, const std::string& data) {
+    AppendBigEndian(out, static_cast<std::uint32_t>(data.size()));
+    const std::size_t start = out.size();
+    out.append(type, 4);
+    out += data;
+    AppendBigEndian(out, Crc32(out.data() + start, out.size() - start));
+}
+
+void EncodePng(const Canvas& canvas, std::string& out) {
+    const std::size_t rowBytes = static_cast<std::size_t>(canvas.GetWidth()) * 4;
+    std::vector<std::uint8_t> filtered;
+    filtered.reserve((rowBytes + 1) * canvas.GetHeight());
+    for (std::uint32_t y = 0; y < canvas.GetHeight(); ++y) {
+        filtered.push_back(0);  // Filter type None
+        const std::uint8_t* row = canvas.GetRow(y);
+        filtered.insert(filtered.end(), row, row + rowBytes);
+    }
+
+    std::string header;
+    AppendBigEndian(header, canvas.GetWidth());
+    AppendBigEndian(header, canvas.GetHeight());
+    header += static_cast<char>(8);  // Bit depth
+    header += static_cast<char>(6);  // RGBA
+    header.append(3, '\0');          // Deflate, adaptive filtering, no interlace
+
+    std::string compressed;
+    Deflate(filtered, 4, rowBytes + 1, compressed);
+
+    out.append("\x89PNG\r\n\x1a\n", 8);
+    AppendChunk(out, "IHDR", header);
+    AppendChunk(out, "IDAT", compressed);
+    AppendChunk(out, "IEND", std::string());
+}
+
+// --- SVG writing ---
+
+void AppendCoordinate(std::string& out, double value) {
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed, 1);
+    out.append(digits, static_cast<std::size_t>(result.ptr - digits));
+}
+
+void AppendColor(std::string& out, std::uint32_t color) {
+    static const char kHex[] = "0123456789abcdef";
+    out += '#';
+    for (int channel = 0; channel < 3; ++channel) {
+        const std::uint32_t value = (color >> (8 * channel)) & 0xFF;
+        out += kHex[value >> 4];
+        out += kHex[value & 0xF];
+    }
+}
+
+void AppendLine(std::string& out, double x0, double y0, double x1, double y1) {
+    out += 'M';
+    AppendCoordinate(out, x0);
+    out += ' ';
+    AppendCoordinate(out, y0);
+    out += 'L';
+    AppendCoordinate(out, x1);
+    out += ' ';
+    AppendCoordinate(out, y1);
+}
+
+} // namespace
+
+void RenderPng(const ImageView& view, const std::vector<Curve>& curves, std::string& out) {
+    Canvas canvas(view.width, view.height, kBackgroundColor);
+    const Mapping map(view);
+    const double width = static_cast<double>(view.width);
+    const double height = static_cast<double>(view.height);
+
+    // Grid and axes sit on pixel centers so they stay one pixel wide
+    const double step = GridStep(view);
+    ForEachGridLine(view.xMin, view.xMax, step, [&](double x) {
+        const double px = std::floor(map.X(x)) + 0.5;
+        canvas.DrawLine(px, 0.0, px, height, x == 0.0 ? kAxisColor : kGridColor, 1.0);
+    });
+    ForEachGridLine(view.yMin, view.yMax, step, [&](double y) {
+        const double py = std::floor(map.Y(y)) + 0.5;
+        canvas.DrawLine(0.0, py, width, py, y == 0.0 ? kAxisColor : kGridColor, 1.0);
+    });
+
+    for (const Curve& curve : curves) {
+        TraceCurve(view, curve, kCurveWidth, [&](double x0, double y0, double x1, double y1, bool) {
+            canvas.DrawLine(x0, y0, x1, y1, curve.color, kCurveWidth);
+        });
+    }
+
+    EncodePng(canvas, out);
+}
+
+void RenderSvg(const ImageView& view, const std::vector<Curve>& curves, std::string& out) {
+    const Mapping map(view);
+    const double width = static_cast<double>(view.width);
+    const double height = static_cast<double>(view.height);
+    const std::string size = std::to_string(view.width) + "\" height=\"" + std::to_string(view.height);
+
+    out += "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" + size + "\" viewBox=\"0 0 " +
+           std::to_string(view.width) + ' ' + std::to_string(view.height) + "\">\n";
+    out += "<rect width=\"100%\" height=\"100%\" fill=\"";
+    AppendColor(out, kBackgroundColor);
+    out += "\"/>\n";
+
+    std::string grid;
+    std::string axes;
+    const double step = GridStep(view);
+    ForEachGridLine(view.xMin, view.xMax, step, [&](double x) {
+        const double px = std::floor(map.X(x)) + 0.5;
+        AppendLine(x == 0.0 ? axes : grid, px, 0.0, px, height);
+    });
+    ForEachGridLine(view.yMin, view.yMax, step, [&](double y) {
+        const double py = std::floor(map.Y(y)) + 0.5;
+        AppendLine(y == 0.0 ? axes : grid, 0.0, py, width, py);
+    });
+    for (const auto& [path, color] : {std::make_pair(&grid, kGridColor), std::make_pair(&axes, kAxisColor)}) {
+        if (!path->empty()) {
+            out += "<path fill=\"none\" stroke-width=\"1\" stroke=\"";
+            AppendColor(out, color);
+            out += "\" d=\"" + *path + "\"/>\n";
+        }
+    }
+
+    out += "<g fill=\"none\" stroke-width=\"2\" stroke-linejoin=\"round\" stroke-linecap=\"round\">\n";
+    for (const Curve& curve : curves) {
+        std::string path;
+        TraceCurve(view, curve, kCurveWidth, [&](double x0, double y0, double x1, double y1, bool connected) {
+            if (!connected) {
+                path += 'M';
+                AppendCoordinate(path, x0);
+                path += ' ';
+                AppendCoordinate(path, y0);
+            }
+            path += 'L';
+            AppendCoordinate(path, x1);
+            path += ' ';
+            AppendCoordinate(path, y1);
+        });
+        if (!path.empty()) {
+            out += "<path stroke=\"";
+            AppendColor(out, curve.color);
+            out += "\" d=\"" + path + "\"/>\n";
+        }
+    }
+    out += "</g>\n</svg>\n";
+}
+
+} // namespace service
+} // namespace plot_genius
@@ -0,0 +1,61 @@
+/**
+ * Image Renderer Header
+ *
+ * Defines software rendering of sampled curves to PNG and SVG for the
+ * service, which has no window or GL context to draw with.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace plot_genius {
+namespace service {
+
+/**
+ * Visible range and size of an image
+ */
+struct ImageView {
+    double xMin{-10.0};
+    double xMax{10.0};
+    double yMin{-10.0};
+    double yMax{10.0};
+    std::uint32_t width{800};   ///< Pixels
+    std::uint32_t height{600};  ///< Pixels
+};
+
+/**
+ * Sampled curve to draw
+ *
+ * The samples lie on `count` evenly spaced x values spanning the view's x range.
+ * Non-finite values break the curve.
+ */
+struct Curve {
+    const double* y;
+    std::size_t count;
+    std::uint32_t color;  ///< Packed RGBA color (ImU32 layout)
+};
+
+/**
+ * Draws curves over a grid and axes and encodes the image as an RGBA PNG
+ *
+ * @param view Visible range and image size
+ * @param curves Curves in drawing order
+ * @param out Receives the PNG file contents
+ */
+void RenderPng(const ImageView& view, const std::vector<Curve>& curves, std::string& out);
+
+/**
+ * Writes curves over a grid and axes as an SVG document
+ *
+ * @param view Visible range and image size
+ * @param curves Curves in drawing order
+ * @param out Receives the SVG text
+ */
+void RenderSvg(const ImageView& view, const std::vector<Curve>& curves, std::string& out);
+
+} // namespace service
+} // namespace plot_genius
@@ -0,0 +1,510 @@
+/**
+ * Plot Service Implementation
+ *
+ * Threads: one accept thread, one reader thread per connection and the
+ * worker pool. A connection's socket is written only under its write mutex
+ * and closed only by its reader, after every request it queued has been
+ * answered, so a response is never written to a reused descriptor.
+ */
+
+#include "server.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include "../core/logger.hpp"
+#include "../graph/palette.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PLOT_GENIUS_SERVICE_POSIX
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace plot_genius {
+namespace service {
+
+namespace {
+
+constexpr std::size_t kReadChunk = 64 * 1024;
+
+template<typename T>
+void AppendRaw(std::string& out, const T* values, std::size_t count) {
+    out.append(reinterpret_cast<const char*>(values), count * sizeof(T));
+}
+
+#ifdef PLOT_GENIUS_SERVICE_POSIX
+bool WriteAll(int fd, const char* data, std::size_t size) {
+#ifdef MSG_NOSIGNAL
+    constexpr int kFlags = MSG_NOSIGNAL;
+#else
+    constexpr int kFlags = 0;  // SIGPIPE is ignored by the daemon instead
+#endif
+    while (size > 0) {
+        ssize_t written = ::send(fd, data, size, kFlags);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+void SetCloseOnExec(int fd) {
+    ::fcntl(fd, F_SETFD, ::fcntl(fd, F_GETFD) | FD_CLOEXEC);
+}
+#endif
+
+} // namespace
+
+std::size_t SampleKeyHash::operator()(const SampleKey& key) const {
+    std::size_t hash = std::hash<std::string>()(key.equation);
+    for (std::size_t part : {std::hash<double>()(key.xMin), std::hash<double>()(key.xMax), key.count}) {
+        hash ^= part + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+/**
+ * Client connection
+ */
+struct Server::Connection {
+    int fd{-1};
+    std::thread reader;
+    std::mutex writeMutex;               ///< Keeps responses whole
+    std::mutex mutex;                    ///< Guards inFlight and closed
+    std::condition_variable changed;     ///< Signalled when a request completes
+    std::size_t inFlight{0};             ///< Requests queued or running
+    bool closed{false};                  ///< fd has been closed
+    std::atomic<bool> broken{false};     ///< A response could not be written
+    std::atomic<bool> finished{false};   ///< Reader has exited
+
+    // Makes the reader see end of input; pending responses are still written
+    void ShutdownRead() {
+#ifdef PLOT_GENIUS_SERVICE_POSIX
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!closed) {
+            ::shutdown(fd, SHUT_RD);
+        }
+#endif
+    }
+
+    void Send(const std::string& header, const std::string& payload) {
+#ifdef PLOT_GENIUS_SERVICE_POSIX
+        std::lock_guard<std::mutex> lock(writeMutex);
+        if (!WriteAll(fd, header.data(), header.size()) || !WriteAll(fd, payload.data(), payload.size())) {
+            // The client is gone; stop reading its requests and skip the queued ones
+            broken = true;
+            ShutdownRead();
+        }
+#else
+        (void)header;
+        (void)payload;
+#endif
+    }
+};
+
+Server::Server(const ServerOptions& options)
+    : m_options(options),
+      m_programs(options.programCacheEntries),
+      m_samples(options.sampleCacheBytes) {}
+
+Server::~Server() {
+    Stop();
+}
+
+#ifdef PLOT_GENIUS_SERVICE_POSIX
+
+bool Server::Start(std::string& error) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (m_options.socketPath.empty() || m_options.socketPath.size() >= sizeof(address.sun_path)) {
+        error = "Socket path must be 1 to " + std::to_string(sizeof(address.sun_path) - 1) + " characters";
+        return false;
+    }
+    std::memcpy(address.sun_path, m_options.socketPath.c_str(), m_options.socketPath.size() + 1);
+    const auto* socketAddress = reinterpret_cast<const sockaddr*>(&address);
+
+    // Replace a socket left behind by a crash, but never a live service or another file
+    struct stat status;
+    if (::lstat(m_options.socketPath.c_str(), &status) == 0) {
+        if (!S_ISSOCK(status.st_mode)) {
+            error = m_options.socketPath + " exists and is not a socket";
+            return false;
+        }
+        int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        const bool live = probe >= 0 && ::connect(probe, socketAddress, sizeof(address)) == 0;
+        if (probe >= 0) {
+            ::close(probe);
+        }
+        if (live) {
+            error = "A service is already listening on " + m_options.socketPath;
+            return false;
+        }
+        ::unlink(m_options.socketPath.c_str());
+    }
+
+    m_listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_listenFd < 0 || ::bind(m_listenFd, socketAddress, sizeof(address)) != 0 ||
+        ::listen(m_listenFd, SOMAXCONN) != 0 || ::pipe(m_wakePipe) != 0) {
+        error = "Cannot listen on " + m_options.socketPath + ": " + std::strerror(errno);
+        if (m_listenFd >= 0) {
+            ::close(m_listenFd);
+            m_listenFd = -1;
+        }
+        return false;
+    }
+    SetCloseOnExec(m_listenFd);
+    SetCloseOnExec(m_wakePipe[0]);
+    SetCloseOnExec(m_wakePipe[1]);
+
+    m_pool = std::make_unique<core::ThreadPool>(m_options.threads);
+    m_startTime = Clock::now();
+    m_running = true;
+    m_acceptThread = std::thread([this] { AcceptLoop(); });
+
+    PLOT_GENIUS_LOG_INFO("Plot service listening on {} with {} workers", m_options.socketPath,
+                         m_pool->GetThreadCount());
+    return true;
+}
+
+void Server::Stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+
+    const char wake = 1;
+    while (::write(m_wakePipe[1], &wake, 1) < 0 && errno == EINTR) {
+    }
+    m_acceptThread.join();
+
+    ReapConnections(true);
+    m_pool->WaitIdle();
+
+    ::close(m_listenFd);
+    ::close(m_wakePipe[0]);
+    ::close(m_wakePipe[1]);
+    m_listenFd = -1;
+    m_wakePipe[0] = m_wakePipe[1] = -1;
+    ::unlink(m_options.socketPath.c_str());
+
+    std::uint64_t requests = 0;
+    std::uint64_t failures = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        for (const auto& latency : m_latency) {
+            requests += latency.GetCount();
+        }
+        failures = m_failures;
+    }
+    const auto programs = m_programs.GetStats();
+    const auto samples = m_samples.GetStats();
+    PLOT_GENIUS_LOG_INFO("Plot service stopped after {} requests ({} failed); program cache {}/{} hits, "
+                         "sample cache {}/{} hits",
+                         requests, failures, programs.hits, programs.hits + programs.misses, samples.hits,
+                         samples.hits + samples.misses);
+}
+
+void Server::AcceptLoop() {
+    pollfd fds[2] = {{m_listenFd, POLLIN, 0}, {m_wakePipe[0], POLLIN, 0}};
+    while (true) {
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            PLOT_GENIUS_LOG_ERROR("Plot service stopped accepting: {}", std::strerror(errno));
+            return;
+        }
+        if (fds[1].revents != 0) {
+            return;
+        }
+        if ((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        int fd = ::accept(m_listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EMFILE || errno == ENFILE) {
+                // Out of descriptors; back off instead of spinning on the pending connection
+                PLOT_GENIUS_LOG_WARNING("Cannot accept connection: {}", std::strerror(errno));
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            continue;
+        }
+        SetCloseOnExec(fd);
+
+        ReapConnections(false);
+        auto connection = std::make_shared<Connection>();
+        connection->fd = fd;
+        std::lock_guard<std::mutex> lock(m_connectionsMutex);
+        m_connections.push_back(connection);
+        connection->reader = std::thread([this, connection] { ReadLoop(connection); });
+    }
+}
+
+void Server::ReadLoop(const std::shared_ptr<Connection>& connection) {
+    std::string buffer;
+    char chunk[kReadChunk];
+    while (true) {
+        ssize_t received = ::recv(connection->fd, chunk, sizeof(chunk), 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            break;
+        }
+        buffer.append(chunk, static_cast<std::size_t>(received));
+
+        // Every complete line is a request; the rest waits for more input
+        std::size_t start = 0;
+        std::size_t newline;
+        while ((newline = buffer.find('\n', start)) != std::string::npos) {
+            if (buffer.find_first_not_of(" \t\r", start) < newline) {
+                Dispatch(connection, buffer.substr(start, newline - start));
+            }
+            start = newline + 1;
+        }
+        buffer.erase(0, start);
+
+        if (buffer.size() > kMaxLineLength) {
+            Record(OutputKind::Count, Clock::duration::zero(), true);
+            connection->Send(FormatError("-", "Request line too long"), std::string());
+            break;
+        }
+    }
+
+    // Answer everything received before closing
+    std::unique_lock<std::mutex> lock(connection->mutex);
+    connection->changed.wait(lock, [&] { return connection->inFlight == 0; });
+    ::close(connection->fd);
+    connection->closed = true;
+    connection->finished = true;
+}
+
+void Server::ReapConnections(bool all) {
+    std::vector<std::shared_ptr<Connection>> done;
+    {
+        std::lock_guard<std::mutex> lock(m_connectionsMutex);
+        auto keep = std::partition(m_connections.begin(), m_connections.end(),
+                                   [all](const auto& connection) { return !all && !connection->finished; });
+        done.assign(keep, m_connections.end());
+        m_connections.erase(keep, m_connections.end());
+    }
+
+    for (const auto& connection : done) {
+        connection->ShutdownRead();
+    }
+    for (const auto& connection : done) {
+        connection->reader.join();
+    }
+}
+
+#else
+
+bool Server::Start(std::string& error) {
+    error = "The plot service needs Unix domain sockets, which this platform does not provide";
+    return false;
+}
+
+void Server::Stop() {}
+void Server::AcceptLoop() {}
+void Server::ReadLoop(const std::shared_ptr<Connection>&) {}
+void Server::ReapConnections(bool) {}
+
+#endif
+
+void Server::Dispatch(const std::shared_ptr<Connection>& connection, const std::string& line) {
+    const auto received = Clock::now();
+    Request request;
+    std::string error;
+    if (!ParseRequest(line, request, error)) {
+        Record(OutputKind::Count, Clock::duration::zero(), true);
+        connection->Send(FormatError(request.id, error), std::string());
+        return;
+    }
+
+    // Backpressure: stop reading this client until its oldest requests are answered
+    {
+        std::unique_lock<std::mutex> lock(connection->mutex);
+        connection->changed.wait(lock, [&] { return connection->inFlight < m_options.maxPipelined; });
+        ++connection->inFlight;
+    }
+
+    m_pool->Submit([this, connection, request = std::move(request), received] {
+        Handle(*connection, request, received);
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex);
+            --connection->inFlight;
+        }
+        connection->changed.notify_all();
+    });
+}
+
+void Server::Handle(Connection& connection, const Request& request, Clock::time_point received) {
+    if (connection.broken) {
+        return;
+    }
+
+    std::string payload;
+    std::string error;
+    bool succeeded = false;
+    try {
+        succeeded = Produce(request, payload, error);
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+
+    const auto latency = Clock::now() - received;
+    Record(request.kind, latency, !succeeded);
+    if (succeeded) {
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+        connection.Send(FormatOkHeader(request.id, payload.size(), static_cast<std::uint64_t>(us)), payload);
+    } else {
+        connection.Send(FormatError(request.id, error), std::string());
+    }
+}
+
+bool Server::Produce(const Request& request, std::string& payload, std::string& error) {
+    if (request.kind == OutputKind::Stats) {
+        payload = GetStatsText();
+        return true;
+    }
+
+    const double xMin = request.view.xMin;
+    const double xMax = request.view.xMax;
+    std::vector<std::shared_ptr<const std::vector<double>>> samples;
+    samples.reserve(request.equations.size());
+    for (std::size_t i = 0; i < request.equations.size(); ++i) {
+        const std::string& equation = request.equations[i];
+        auto graph = GetGraph(equation, error);
+        if (!graph) {
+            error = "Equation " + std::to_string(i) + ": " + error;
+            return false;
+        }
+        samples.push_back(GetSamples(equation, *graph, xMin, xMax, request.points));
+    }
+
+    if (request.kind == OutputKind::Samples) {
+        const std::size_t count = request.points;
+        const double step = (xMax - xMin) / static_cast<double>(count - 1);
+        std::vector<float> column(count);
+        payload.reserve(samples.size() * (2 * sizeof(std::uint32_t) + 2 * count * sizeof(float)));
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            const std::uint32_t header[2] = {static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(count)};
+            AppendRaw(payload, header, 2);
+            for (std::size_t j = 0; j < count; ++j) {
+                column[j] = static_cast<float>(xMin + static_cast<double>(j) * step);
+            }
+            AppendRaw(payload, column.data(), count);
+            std::copy(samples[i]->begin(), samples[i]->end(), column.begin());
+            AppendRaw(payload, column.data(), count);
+        }
+        return true;
+    }
+
+    std::vector<Curve> curves;
+    curves.reserve(samples.size());
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        curves.push_back(Curve{samples[i]->data(), samples[i]->size(), GetEquationColor(i)});
+    }
+    if (request.kind == OutputKind::Png) {
+        RenderPng(request.view, curves, payload);
+    } else {
+        RenderSvg(request.view, curves, payload);
+    }
+    return true;
+}
+
+std::shared_ptr<const Graph> Server::GetGraph(const std::string& equation, std::string& error) {
+    if (auto graph = m_programs.Get(equation)) {
+        return graph;
+    }
+
+    auto graph = std::make_shared<Graph>();
+    if (!graph->SetEquation(equation)) {
+        error = graph->GetLastError();
+        return nullptr;
+    }
+    m_programs.Put(equation, graph);
+    return graph;
+}
+
+std::shared_ptr<const std::vector<double>> Server::GetSamples(const std::string& equation, const Graph& graph,
+                                                              double xMin, double xMax, std::size_t count) {
+    SampleKey key{equation, xMin, xMax, count};
+    if (auto samples = m_samples.Get(key)) {
+        return samples;
+    }
+
+    auto samples = std::make_shared<std::vector<double>>(count);
+    graph.SampleInto(xMin, xMax, count, nullptr, samples->data());
+    const std::size_t cost = count * sizeof(double) + equation.size();
+    m_samples.Put(std::move(key), samples, cost);
+    return samples;
+}
+
+void Server::Record(OutputKind kind, Clock::duration latency, bool failed) {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    if (failed) {
+        ++m_failures;
+    } else if (kind != OutputKind::Count) {
+        m_latency[static_cast<std::size_t>(kind)].Add(latency);
+    }
+}
+
+std::string Server::GetStatsText() const {
+    std::string text;
+    auto line = [&text](const std::string& name, const std::string& value) {
+        text += name + ' ' + value + '\n';
+    };
+    auto number = [](double value) {
+        char digits[32];
+        std::snprintf(digits, sizeof(digits), "%.3f", value);
+        return std::string(digits);
+    };
+
+    core::LatencyHistogram total;
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        line("uptime_s", number(std::chrono::duration<double>(Clock::now() - m_startTime).count()));
+        line("failed", std::to_string(m_failures));
+        for (std::size_t kind = 0; kind < m_latency.size(); ++kind) {
+            const auto& latency = m_latency[kind];
+            total.Merge(latency);
+            if (latency.GetCount() == 0) {
+                continue;
+            }
+            const std::string prefix = GetOutputKindName(static_cast<OutputKind>(kind));
+            line(prefix + "_requests", std::to_string(latency.GetCount()));
+            line(prefix + "_p50_ms", number(latency.PercentileMs(0.5)));
+            line(prefix + "_p99_ms", number(latency.PercentileMs(0.99)));
+            line(prefix + "_max_ms", number(latency.MaxMs()));
+        }
+    }
+    line("requests", std::to_string(total.GetCount()));
+
+    const auto programs = m_programs.GetStats();
+    line("program_cache_hits", std::to_string(programs.hits));
+    line("program_cache_misses", std::to_string(programs.misses));
+    line("program_cache_entries", std::to_string(programs.entries));
+
+    const auto samples = m_samples.GetStats();
+    line("sample_cache_hits", std::to_string(samples.hits));
+    line("sample_cache_misses", std::to_string(samples.misses));
+    line("sample_cache_entries", std::to_string(samples.entries));
+    line("sample_cache_bytes", std::to_string(samples.cost));
+    return text;
+}
+
+} // namespace service
+} // namespace plot_genius
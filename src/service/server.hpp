@@ -0,0 +1,149 @@
+/**
+ * Plot Service Header
+ *
+ * Defines the Unix domain socket service behind `plot_genius --daemon`,
+ * which answers sample and image requests from other local processes (see
+ * protocol.hpp for the wire format).
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "protocol.hpp"
+#include "../core/latency_histogram.hpp"
+#include "../core/lru_cache.hpp"
+#include "../core/thread_pool.hpp"
+#include "../graph/graph.hpp"
+
+namespace plot_genius {
+namespace service {
+
+/**
+ * Settings of the service
+ */
+struct ServerOptions {
+    std::string socketPath = "/tmp/plot_genius.sock";
+    std::size_t threads = 0;                          ///< Worker threads, 0 for every core
+    std::size_t programCacheEntries = 4096;           ///< Compiled equations kept
+    std::size_t sampleCacheBytes = 256u << 20;        ///< Budget of the sampled points kept
+    std::size_t maxPipelined = 64;                    ///< Requests in flight per connection
+};
+
+/**
+ * Samples grid an equation was sampled on
+ */
+struct SampleKey {
+    std::string equation;
+    double xMin;
+    double xMax;
+    std::size_t count;
+
+    bool operator==(const SampleKey& other) const {
+        return count == other.count && xMin == other.xMin && xMax == other.xMax && equation == other.equation;
+    }
+};
+
+/**
+ * Hash of a sample grid
+ */
+struct SampleKeyHash {
+    std::size_t operator()(const SampleKey& key) const;
+};
+
+/**
+ * Socket service answering plot requests on a worker pool
+ *
+ * Each connection has a reader thread that parses request lines and queues
+ * them on the pool, blocking once maxPipelined requests are in flight so a
+ * fast client cannot queue unbounded work. Workers write each response as
+ * soon as it is ready. Compiled equations and sampled points are cached
+ * across all requests and connections.
+ */
+class Server {
+public:
+    /**
+     * Creates a stopped service
+     *
+     * @param options Settings
+     */
+    explicit Server(const ServerOptions& options);
+
+    /**
+     * Stops the service if it is running
+     */
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    /**
+     * Binds the socket and starts accepting connections
+     *
+     * A stale socket file left by a previous run is replaced; a socket with
+     * a live service behind it is not.
+     *
+     * @param error Receives the reason on failure
+     * @return True if the service is listening
+     */
+    bool Start(std::string& error);
+
+    /**
+     * Stops accepting, answers the requests already received, closes every
+     * connection and removes the socket file
+     */
+    void Stop();
+
+    /**
+     * Formats the request, latency and cache counters
+     *
+     * @return "name value" lines
+     */
+    std::string GetStatsText() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Connection;
+
+    void AcceptLoop();
+    void ReadLoop(const std::shared_ptr<Connection>& connection);
+    void Dispatch(const std::shared_ptr<Connection>& connection, const std::string& line);
+    void Handle(Connection& connection, const Request& request, Clock::time_point received);
+    bool Produce(const Request& request, std::string& payload, std::string& error);
+    std::shared_ptr<const Graph> GetGraph(const std::string& equation, std::string& error);
+    std::shared_ptr<const std::vector<double>> GetSamples(const std::string& equation, const Graph& graph,
+                                                          double xMin, double xMax, std::size_t count);
+    void Record(OutputKind kind, Clock::duration latency, bool failed);
+    void ReapConnections(bool all);
+
+    ServerOptions m_options;
+    core::LruCache<std::string, Graph> m_programs;
+    core::LruCache<SampleKey, std::vector<double>, SampleKeyHash> m_samples;
+
+    int m_listenFd{-1};
+    int m_wakePipe[2]{-1, -1};                        ///< Written by Stop to end the accept loop
+    std::thread m_acceptThread;
+    std::atomic<bool> m_running{false};
+
+    std::mutex m_connectionsMutex;
+    std::vector<std::shared_ptr<Connection>> m_connections;
+
+    mutable std::mutex m_statsMutex;
+    std::array<core::LatencyHistogram, static_cast<std::size_t>(OutputKind::Count)> m_latency;
+    std::uint64_t m_failures{0};
+    Clock::time_point m_startTime;
+
+    // Last member: destroyed first, so queued requests finish while the rest is alive
+    std::unique_ptr<core::ThreadPool> m_pool;
+};
+
+} // namespace service
+} // namespace plot_genius
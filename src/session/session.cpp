@@ -0,0 +1,509 @@
+/**
+ * Session File Implementation
+ *
+ * File layout (host byte order, checked through a byte-order tag):
+ *
+ *     Header          fixed 96 bytes, including a checksum of everything after it
+ *     Record table    one 48-byte record per equation
+ *     Data            equation text, program instructions and samples, each
+ *                     block aligned to 8 bytes and referenced by the records
+ *     Parameters      since version 2, a table of parameter names, values and
+ *                     slider ranges referenced by the header; Parameter
+ *                     instructions index this table rather than their program
+ *
+ * Sessions are written to a temporary file that replaces the old one, so an
+ * interrupted save never leaves a half-written session behind.
+ */
+
+#include "session.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PLOT_GENIUS_SESSION_MMAP 1
+#endif
+
+namespace plot_genius {
+namespace session {
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'G', 'S', 'E', 'S', 'S', '\r', '\n'};
+constexpr std::uint32_t kVersion = 2;
+constexpr std::uint32_t kMinVersion = 1;  // Version 1 files have no parameter table
+constexpr std::uint32_t kByteOrderTag = 0x01020304;
+
+constexpr std::uint32_t kHasSamples = 1;  // Header flag
+constexpr std::uint32_t kVisible = 1;     // Record flag
+constexpr std::uint32_t kPrecise = 2;     // Record flag: the equation overrides the math precision
+constexpr std::uint32_t kFast = 4;        // Record flag, as kPrecise; older readers ignore both
+constexpr std::uint32_t kSweepEnvelope = 0x80000000u;  // Parameter sweep flag
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t fileSize;
+    std::uint64_t checksum;  // FNV-1a of the bytes after the header
+    std::uint32_t equationCount;
+    std::uint32_t flags;
+    double view[4];          // xMin, xMax, yMin, yMax
+    double sampleXMin;
+    double sampleXMax;
+    std::uint64_t parametersOffset;  // FileParameterTable, 0 if none
+};
+
+struct FileRecord {
+    std::uint64_t textOffset;
+    std::uint32_t textLength;
+    std::uint32_t color;
+    std::uint64_t programOffset;
+    std::uint32_t instructionCount;
+    std::uint32_t flags;
+    std::uint64_t samplesOffset;
+    std::uint32_t sampleCount;
+    std::uint32_t reserved;
+};
+
+struct FileInstruction {
+    std::uint32_t op;
+    std::uint32_t lhs;
+    std::uint32_t rhs;
+    std::uint32_t reserved;
+    double value;
+};
+
+struct FileParameterTable {
+    std::uint32_t count;     // FileParameter entries that follow
+    std::uint32_t reserved;
+};
+
+struct FileParameter {
+    std::uint64_t nameOffset;
+    std::uint32_t nameLength;
+    std::uint32_t sweep;     // Swept family members, plus kSweepEnvelope
+    double value;
+    double min;
+    double max;
+};
+
+// The on-disk structs have no padding, so they can be copied as a whole
+static_assert(sizeof(FileHeader) == 96, "Unexpected session header layout");
+static_assert(sizeof(FileRecord) == 48, "Unexpected session record layout");
+static_assert(sizeof(FileInstruction) == 24, "Unexpected session instruction layout");
+static_assert(sizeof(FileParameterTable) == 8, "Unexpected session parameter table layout");
+static_assert(sizeof(FileParameter) == 40, "Unexpected session parameter layout");
+static_assert(sizeof(SamplePoint) == 8, "Unexpected sample layout");
+
+std::uint64_t Checksum(const char* data, std::size_t size) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::size_t AlignUp(std::size_t offset) {
+    return (offset + 7) & ~static_cast<std::size_t>(7);
+}
+
+// True if count elements of elementSize bytes at offset lie inside [begin, size)
+bool InBounds(std::uint64_t offset, std::uint64_t count, std::size_t elementSize,
+              std::size_t begin, std::size_t size) {
+    return offset >= begin && offset <= size && count <= (size - offset) / elementSize;
+}
+
+std::uint32_t FindOrAddParameter(std::vector<ParameterBinding>& parameters, const std::string& name) {
+    for (std::size_t i = 0; i < parameters.size(); ++i) {
+        if (parameters[i].name == name) {
+            return static_cast<std::uint32_t>(i);
+        }
+    }
+    ParameterBinding binding;
+    binding.name = name;
+    parameters.push_back(binding);
+    return static_cast<std::uint32_t>(parameters.size() - 1);
+}
+
+template<typename T>
+T ReadAt(const char* data, std::size_t offset) {
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+struct SessionReader::Record : FileRecord {};
+
+void SessionWriter::SetSampleRange(double xMin, double xMax) {
+    m_hasSampleRange = true;
+    m_sampleXMin = xMin;
+    m_sampleXMax = xMax;
+}
+
+void SessionWriter::AddEquation(const std::string& text, const EquationStyle& style, const Program& program,
+                                const std::vector<SamplePoint>& samples) {
+    // Stored programs refer to the session's parameter table instead of their own names
+    std::vector<Instruction> code = program.GetInstructions();
+    for (Instruction& instruction : code) {
+        if (instruction.op == OpCode::Parameter) {
+            instruction.lhs = FindOrAddParameter(m_parameters, program.GetParameters()[instruction.lhs]);
+        }
+    }
+    m_entries.push_back({text, style, std::move(code), samples});
+}
+
+bool SessionWriter::Save(const std::string& path) {
+    const bool hasSamples = m_hasSampleRange;
+
+    // Lay out the data blocks behind the header and record table
+    std::size_t offset = sizeof(FileHeader) + m_entries.size() * sizeof(FileRecord);
+    std::vector<FileRecord> records(m_entries.size());
+    for (std::size_t i = 0; i < m_entries.size(); ++i) {
+        const Entry& entry = m_entries[i];
+        FileRecord& record = records[i];
+        std::memset(&record, 0, sizeof(record));
+        record.color = entry.style.color;
+        record.flags = entry.style.visible ? kVisible : 0;
+        if (entry.style.precision) {
+            record.flags |= *entry.style.precision == MathPrecision::Fast ? kFast : kPrecise;
+        }
+
+        record.textOffset = offset;
+        record.textLength = static_cast<std::uint32_t>(entry.text.size());
+        offset = AlignUp(offset + entry.text.size());
+
+        record.programOffset = offset;
+        record.instructionCount = static_cast<std::uint32_t>(entry.code.size());
+        offset += entry.code.size() * sizeof(FileInstruction);
+
+        record.samplesOffset = offset;
+        record.sampleCount = hasSamples ? static_cast<std::uint32_t>(entry.samples.size()) : 0;
+        offset += record.sampleCount * sizeof(SamplePoint);
+    }
+
+    std::uint64_t parametersOffset = 0;
+    std::vector<FileParameter> parameters(m_parameters.size());
+    if (!m_parameters.empty()) {
+        parametersOffset = AlignUp(offset);
+        offset = parametersOffset + sizeof(FileParameterTable) + parameters.size() * sizeof(FileParameter);
+        for (std::size_t i = 0; i < parameters.size(); ++i) {
+            const ParameterBinding& binding = m_parameters[i];
+            const std::uint32_t sweep = binding.sweepMembers | (binding.envelope ? kSweepEnvelope : 0);
+            parameters[i] = {offset, static_cast<std::uint32_t>(binding.name.size()), sweep,
+                             binding.value, binding.min, binding.max};
+            offset += binding.name.size();
+        }
+    }
+
+    std::vector<char> file(offset, 0);
+    for (std::size_t i = 0; i < m_entries.size(); ++i) {
+        const Entry& entry = m_entries[i];
+        const FileRecord& record = records[i];
+        std::memcpy(file.data() + sizeof(FileHeader) + i * sizeof(FileRecord), &record, sizeof(record));
+        std::memcpy(file.data() + record.textOffset, entry.text.data(), entry.text.size());
+
+        for (std::size_t j = 0; j < entry.code.size(); ++j) {
+            const Instruction& instruction = entry.code[j];
+            FileInstruction stored{static_cast<std::uint32_t>(instruction.op), instruction.lhs, instruction.rhs, 0,
+                                   instruction.value};
+            std::memcpy(file.data() + record.programOffset + j * sizeof(FileInstruction), &stored, sizeof(stored));
+        }
+
+        if (record.sampleCount > 0) {
+            std::memcpy(file.data() + record.samplesOffset, entry.samples.data(),
+                        record.sampleCount * sizeof(SamplePoint));
+        }
+    }
+
+    if (parametersOffset != 0) {
+        const FileParameterTable table{static_cast<std::uint32_t>(parameters.size()), 0};
+        std::memcpy(file.data() + parametersOffset, &table, sizeof(table));
+        for (std::size_t i = 0; i < parameters.size(); ++i) {
+            std::memcpy(file.data() + parametersOffset + sizeof(table) + i * sizeof(FileParameter),
+                        &parameters[i], sizeof(FileParameter));
+            std::memcpy(file.data() + parameters[i].nameOffset, m_parameters[i].name.data(),
+                        m_parameters[i].name.size());
+        }
+    }
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = kByteOrderTag;
+    header.fileSize = file.size();
+    header.equationCount = static_cast<std::uint32_t>(m_entries.size());
+    header.flags = hasSamples ? kHasSamples : 0;
+    header.view[0] = m_view.xMin;
+    header.view[1] = m_view.xMax;
+    header.view[2] = m_view.yMin;
+    header.view[3] = m_view.yMax;
+    header.sampleXMin = m_sampleXMin;
+    header.sampleXMax = m_sampleXMax;
+    header.parametersOffset = parametersOffset;
+    header.checksum = Checksum(file.data() + sizeof(FileHeader), file.size() - sizeof(FileHeader));
+    std::memcpy(file.data(), &header, sizeof(header));
+
+    // Replace the previous session only once the new one is complete
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out.write(file.data(), static_cast<std::streamsize>(file.size())) || !out.flush()) {
+            m_lastError = "Cannot write " + temporary;
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        m_lastError = "Cannot replace " + path + ": " + error.message();
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+SessionReader::~SessionReader() {
+    Close();
+}
+
+bool SessionReader::Open(const std::string& path) {
+    Close();
+
+#ifdef PLOT_GENIUS_SESSION_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        m_lastError = "Cannot open " + path;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        ::close(fd);
+        m_lastError = path + " is not a session file";
+        return false;
+    }
+
+    m_size = static_cast<std::size_t>(info.st_size);
+    void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        m_size = 0;
+        m_lastError = "Cannot map " + path;
+        return false;
+    }
+    m_data = static_cast<const char*>(mapping);
+    m_mapped = true;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        m_lastError = "Cannot open " + path;
+        return false;
+    }
+    m_buffer.resize(static_cast<std::size_t>(in.tellg()));
+    in.seekg(0);
+    if (!in.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()))) {
+        m_lastError = "Cannot read " + path;
+        m_buffer.clear();
+        return false;
+    }
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#endif
+
+    if (!Validate()) {
+        m_lastError = path + ": " + m_lastError;
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void SessionReader::Close() {
+#ifdef PLOT_GENIUS_SESSION_MMAP
+    if (m_mapped) {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_buffer.clear();
+    m_equationCount = 0;
+    m_parameters.clear();
+}
+
+bool SessionReader::Validate() {
+    if (m_size < sizeof(FileHeader)) {
+        m_lastError = "not a session file";
+        return false;
+    }
+
+    const auto header = ReadAt<FileHeader>(m_data, 0);
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        m_lastError = "not a session file";
+        return false;
+    }
+    if (header.version < kMinVersion || header.version > kVersion || header.byteOrder != kByteOrderTag) {
+        m_lastError = "unsupported session version or byte order";
+        return false;
+    }
+    if (header.fileSize != m_size) {
+        m_lastError = "file is truncated";
+        return false;
+    }
+    if (header.checksum != Checksum(m_data + sizeof(FileHeader), m_size - sizeof(FileHeader))) {
+        m_lastError = "checksum mismatch";
+        return false;
+    }
+    if (!InBounds(sizeof(FileHeader), header.equationCount, sizeof(FileRecord), 0, m_size)) {
+        m_lastError = "equation table exceeds the file";
+        return false;
+    }
+
+    // Every reference must point into the data area, so accessors need no checks
+    m_equationCount = header.equationCount;
+    const std::size_t dataStart = sizeof(FileHeader) + m_equationCount * sizeof(FileRecord);
+    if (header.version >= 2 && header.parametersOffset != 0 && !ReadParameters(header.parametersOffset, dataStart)) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < m_equationCount; ++i) {
+        const Record record = ReadRecord(i);
+        const bool valid =
+            InBounds(record.textOffset, record.textLength, 1, dataStart, m_size) &&
+            InBounds(record.programOffset, record.instructionCount, sizeof(FileInstruction), dataStart, m_size) &&
+            InBounds(record.samplesOffset, record.sampleCount, sizeof(SamplePoint), dataStart, m_size);
+        if (!valid) {
+            m_lastError = "equation " + std::to_string(i) + " exceeds the file";
+            return false;
+        }
+
+        std::string error;
+        const Program program = GetProgram(i);
+        if (!Program::Validate(program.GetInstructions(), program.GetParameters().size(), error)) {
+            m_lastError = "equation " + std::to_string(i) + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SessionReader::ReadParameters(std::uint64_t offset, std::size_t dataStart) {
+    if (!InBounds(offset, 1, sizeof(FileParameterTable), dataStart, m_size)) {
+        m_lastError = "parameter table exceeds the file";
+        return false;
+    }
+    const auto table = ReadAt<FileParameterTable>(m_data, offset);
+    const std::uint64_t entries = offset + sizeof(FileParameterTable);
+    if (!InBounds(entries, table.count, sizeof(FileParameter), dataStart, m_size)) {
+        m_lastError = "parameter table exceeds the file";
+        return false;
+    }
+
+    m_parameters.resize(table.count);
+    for (std::size_t i = 0; i < table.count; ++i) {
+        const auto stored = ReadAt<FileParameter>(m_data, entries + i * sizeof(FileParameter));
+        if (stored.nameLength == 0 || !InBounds(stored.nameOffset, stored.nameLength, 1, dataStart, m_size)) {
+            m_lastError = "parameter " + std::to_string(i) + " exceeds the file";
+            return false;
+        }
+        ParameterBinding& binding = m_parameters[i];
+        binding.name.assign(m_data + stored.nameOffset, stored.nameLength);
+        binding.value = stored.value;
+        binding.min = stored.min;
+        binding.max = stored.max;
+        binding.sweepMembers = std::min(stored.sweep & ~kSweepEnvelope, kMaxSweepMembers);
+        binding.envelope = (stored.sweep & kSweepEnvelope) != 0;
+    }
+    return true;
+}
+
+SessionReader::Record SessionReader::ReadRecord(std::size_t index) const {
+    return ReadAt<Record>(m_data, sizeof(FileHeader) + index * sizeof(FileRecord));
+}
+
+ViewRange SessionReader::GetView() const {
+    const auto header = ReadAt<FileHeader>(m_data, 0);
+    return {header.view[0], header.view[1], header.view[2], header.view[3]};
+}
+
+bool SessionReader::GetSampleRange(double& xMin, double& xMax) const {
+    const auto header = ReadAt<FileHeader>(m_data, 0);
+    xMin = header.sampleXMin;
+    xMax = header.sampleXMax;
+    return (header.flags & kHasSamples) != 0;
+}
+
+std::string_view SessionReader::GetText(std::size_t index) const {
+    const Record record = ReadRecord(index);
+    return std::string_view(m_data + record.textOffset, record.textLength);
+}
+
+EquationStyle SessionReader::GetStyle(std::size_t index) const {
+    const Record record = ReadRecord(index);
+    EquationStyle style;
+    style.color = record.color;
+    style.visible = (record.flags & kVisible) != 0;
+    if (record.flags & kFast) {
+        style.precision = MathPrecision::Fast;
+    } else if (record.flags & kPrecise) {
+        style.precision = MathPrecision::Precise;
+    }
+    return style;
+}
+
+Program SessionReader::GetProgram(std::size_t index) const {
+    constexpr std::uint32_t kUnmapped = std::numeric_limits<std::uint32_t>::max();
+
+    const Record record = ReadRecord(index);
+    std::vector<Instruction> code(record.instructionCount);
+    std::vector<std::string> names;
+    std::vector<std::uint32_t> local(m_parameters.size(), kUnmapped);
+    for (std::size_t j = 0; j < code.size(); ++j) {
+        const auto stored = ReadAt<FileInstruction>(m_data, record.programOffset + j * sizeof(FileInstruction));
+        // Out-of-range op codes are caught by Program::Validate during Open
+        code[j].op = stored.op < static_cast<std::uint32_t>(OpCode::Count) ? static_cast<OpCode>(stored.op)
+                                                                           : OpCode::Count;
+        code[j].lhs = stored.lhs;
+        code[j].rhs = stored.rhs;
+        code[j].value = stored.value;
+
+        // Map session table indices to the program's own parameter list; an
+        // index past the table stays invalid for Program::Validate to reject
+        if (code[j].op == OpCode::Parameter) {
+            if (stored.lhs >= local.size()) {
+                code[j].lhs = kUnmapped;
+                continue;
+            }
+            if (local[stored.lhs] == kUnmapped) {
+                local[stored.lhs] = static_cast<std::uint32_t>(names.size());
+                names.push_back(m_parameters[stored.lhs].name);
+            }
+            code[j].lhs = local[stored.lhs];
+        }
+    }
+    return Program(std::move(code), std::move(names));
+}
+
+void SessionReader::GetSamples(std::size_t index, std::vector<SamplePoint>& samples) const {
+    const Record record = ReadRecord(index);
+    samples.resize(record.sampleCount);
+    if (record.sampleCount > 0) {
+        std::memcpy(samples.data(), m_data + record.samplesOffset, record.sampleCount * sizeof(SamplePoint));
+    }
+}
+
+} // namespace session
+} // namespace plot_genius
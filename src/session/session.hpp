@@ -0,0 +1,240 @@
+/**
+ * Session File Header
+ *
+ * Defines the binary session format that restores the equations, the view,
+ * per-equation style, the compiled programs, the parameter values and
+ * optionally the last sampled points at startup, without parsing or sampling
+ * anything.
+ *
+ * Files are memory-mapped and fully validated when opened (size, checksum and
+ * every table entry and program), so a truncated or foreign file is rejected
+ * instead of restored partially.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../equation/parameters.hpp"
+#include "../equation/program.hpp"
+
+namespace plot_genius {
+namespace session {
+
+/**
+ * Visible range of the plot
+ */
+struct ViewRange {
+    double xMin{-10.0};
+    double xMax{10.0};
+    double yMin{-10.0};
+    double yMax{10.0};
+};
+
+/**
+ * How an equation is drawn
+ */
+struct EquationStyle {
+    std::uint32_t color{0};  ///< Packed RGBA color (ImU32 layout)
+    bool visible{true};      ///< Whether the equation is plotted
+    std::optional<MathPrecision> precision;  ///< Math precision of the equation, if it overrides the global one
+};
+
+/**
+ * Sampled point as stored in the file (same layout as GraphPoint)
+ */
+struct SamplePoint {
+    float x;
+    float y;
+};
+
+/**
+ * Collects a session and writes it to disk
+ */
+class SessionWriter {
+public:
+    /**
+     * Sets the visible range of the plot
+     *
+     * @param view View to restore
+     */
+    void SetView(const ViewRange& view) { m_view = view; }
+
+    /**
+     * Sets the x range the stored samples were generated for
+     *
+     * @param xMin Minimum x value
+     * @param xMax Maximum x value
+     */
+    void SetSampleRange(double xMin, double xMax);
+
+    /**
+     * Sets the parameter values to restore
+     *
+     * Call before adding equations. Parameters of added equations that are
+     * not in the list are stored with default values.
+     *
+     * @param bindings Parameter bindings
+     */
+    void SetParameters(const std::vector<ParameterBinding>& bindings) { m_parameters = bindings; }
+
+    /**
+     * Adds an equation
+     *
+     * @param text Source text of the equation
+     * @param style Drawing style
+     * @param program Compiled equation; must not be empty
+     * @param samples Last sampled points, empty if none should be stored
+     */
+    void AddEquation(const std::string& text, const EquationStyle& style, const Program& program,
+                     const std::vector<SamplePoint>& samples = {});
+
+    /**
+     * Writes the session, replacing the file atomically
+     *
+     * @param path Destination file
+     * @return True if the file was written
+     */
+    bool Save(const std::string& path);
+
+    /**
+     * Gets the error of the last failed Save
+     *
+     * @return Error message
+     */
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    struct Entry {
+        std::string text;
+        EquationStyle style;
+        std::vector<Instruction> code;
+        std::vector<SamplePoint> samples;
+    };
+
+    ViewRange m_view;
+    std::vector<ParameterBinding> m_parameters;  ///< Session-wide table; instructions index it
+    bool m_hasSampleRange{false};
+    double m_sampleXMin{0.0};
+    double m_sampleXMax{0.0};
+    std::vector<Entry> m_entries;
+    std::string m_lastError;
+};
+
+/**
+ * Read-only view of a session file
+ *
+ * The file stays mapped while the reader is open; text and samples are read
+ * straight from the mapping.
+ */
+class SessionReader {
+public:
+    SessionReader() = default;
+    ~SessionReader();
+
+    SessionReader(const SessionReader&) = delete;
+    SessionReader& operator=(const SessionReader&) = delete;
+
+    /**
+     * Maps and validates a session file
+     *
+     * @param path File to open
+     * @return True if the file exists and is a valid session
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * Unmaps the file
+     */
+    void Close();
+
+    /**
+     * Gets the error of the last failed Open
+     *
+     * @return Error message
+     */
+    const std::string& GetLastError() const { return m_lastError; }
+
+    /**
+     * Gets the stored view
+     *
+     * @return Visible range of the plot
+     */
+    ViewRange GetView() const;
+
+    /**
+     * Checks whether sampled points were stored
+     *
+     * @param xMin Receives the x range the samples cover
+     * @param xMax Receives the x range the samples cover
+     * @return True if samples are available
+     */
+    bool GetSampleRange(double& xMin, double& xMax) const;
+
+    /**
+     * Gets the stored parameter bindings
+     *
+     * @return Bindings, empty for sessions without parameters
+     */
+    const std::vector<ParameterBinding>& GetParameters() const { return m_parameters; }
+
+    /**
+     * Gets the number of stored equations
+     *
+     * @return Equation count
+     */
+    std::size_t GetEquationCount() const { return m_equationCount; }
+
+    /**
+     * Gets the source text of an equation
+     *
+     * @param index Equation index
+     * @return Text inside the mapping, valid until Close
+     */
+    std::string_view GetText(std::size_t index) const;
+
+    /**
+     * Gets the style of an equation
+     *
+     * @param index Equation index
+     * @return Drawing style
+     */
+    EquationStyle GetStyle(std::size_t index) const;
+
+    /**
+     * Decodes the program of an equation (already validated by Open)
+     *
+     * @param index Equation index
+     * @return Compiled equation
+     */
+    Program GetProgram(std::size_t index) const;
+
+    /**
+     * Copies the stored samples of an equation
+     *
+     * @param index Equation index
+     * @param samples Receives the points; empty if none were stored
+     */
+    void GetSamples(std::size_t index, std::vector<SamplePoint>& samples) const;
+
+private:
+    struct Record;
+    Record ReadRecord(std::size_t index) const;
+    bool Validate();
+    bool ReadParameters(std::uint64_t offset, std::size_t dataStart);
+
+    const char* m_data{nullptr};     ///< Start of the mapped file
+    std::size_t m_size{0};           ///< Mapped length
+    bool m_mapped{false};            ///< m_data is a mapping rather than m_buffer
+    std::vector<char> m_buffer;      ///< File contents where mapping is unavailable
+    std::size_t m_equationCount{0};
+    std::vector<ParameterBinding> m_parameters;  ///< Decoded by Open
+    std::string m_lastError;
+};
+
+} // namespace session
+} // namespace plot_genius
@@ -16,6 +16,9 @@ ConfigPanel::ConfigPanel() {
     m_defaultConfig.axisColor = {0.5f, 0.5f, 0.5f, 1.0f};
     m_defaultConfig.graphColor = {0.0f, 0.8f, 0.2f, 1.0f};
     m_defaultConfig.defaultViewScaling = 20.0f;
+    m_defaultConfig.sampleMode = SampleMode::Uniform;
+    m_defaultConfig.derivativeOrder = 0;
+    m_defaultConfig.showCriticalPoints = false;
     
     // Set current config to defaults
     m_config = m_defaultConfig;
@@ -27,18 +30,23 @@ void ConfigPanel::Render() {
     
     // Create collapsing headers for different config sections
     if (ImGui::CollapsingHeader("Grid Settings", ImGuiTreeNodeFlags_DefaultOpen)) {
-        DrawGridSettings();
-        configChanged = true;
+        configChanged |= DrawGridSettings();
     }
     
     if (ImGui::CollapsingHeader("Appearance", ImGuiTreeNodeFlags_DefaultOpen)) {
-        DrawAppearanceSettings();
-        configChanged = true;
+        configChanged |= DrawAppearanceSettings();
     }
     
     if (ImGui::CollapsingHeader("View", ImGuiTreeNodeFlags_DefaultOpen)) {
-        DrawViewportSettings();
-        configChanged = true;
+        configChanged |= DrawViewportSettings();
+    }
+    
+    if (ImGui::CollapsingHeader("Sampling", ImGuiTreeNodeFlags_DefaultOpen)) {
+        configChanged |= DrawSamplingSettings();
+    }
+    
+    if (ImGui::CollapsingHeader("Analysis", ImGuiTreeNodeFlags_DefaultOpen)) {
+        configChanged |= DrawAnalysisSettings();
     }
     
     // Apply changes if any setting was modified
@@ -47,17 +55,19 @@ void ConfigPanel::Render() {
     }
 }
 
-void ConfigPanel::DrawGridSettings() {
+bool ConfigPanel::DrawGridSettings() {
+    bool changed = false;
+    
     // Grid visibility
     if (ImGui::Checkbox("Show Grid", &m_config.showGrid)) {
-        // Config will be updated at the end of Render
+        changed = true;  // Config will be updated at the end of Render
     }
     
     // Grid spacing slider
     ImGui::Text("Grid Spacing");
     ImGui::PushItemWidth(-1);
     if (ImGui::SliderFloat("##GridSpacing", &m_config.gridSpacing, 0.1f, 5.0f, "%.1f")) {
-        // Config will be updated at the end of Render
+        changed = true;  // Config will be updated at the end of Render
     }
     ImGui::PopItemWidth();
     
@@ -65,17 +75,21 @@ void ConfigPanel::DrawGridSettings() {
     ImGui::Text("Line Thickness");
     ImGui::PushItemWidth(-1);
     if (ImGui::SliderFloat("##LineThickness", &m_config.lineThickness, 1.0f, 5.0f, "%.1f")) {
-        // Config will be updated at the end of Render
+        changed = true;  // Config will be updated at the end of Render
     }
     ImGui::PopItemWidth();
+    
+    return changed;
 }
 
-void ConfigPanel::DrawAppearanceSettings() {
+bool ConfigPanel::DrawAppearanceSettings() {
+    bool changed = false;
+    
     // Grid color picker
     ImGui::Text("Grid Color");
     ImGui::PushItemWidth(-1);
     if (ImGui::ColorEdit3("##GridColor", (float*)&m_config.gridColor)) {
-        // Config will be updated at the end of Render
+        changed = true;  // Config will be updated at the end of Render
     }
     ImGui::PopItemWidth();
     
@@ -83,7 +97,7 @@ void ConfigPanel::DrawAppearanceSettings() {
     ImGui::Text("Axis Color");
     ImGui::PushItemWidth(-1);
     if (ImGui::ColorEdit3("##AxisColor", (float*)&m_config.axisColor)) {
-        // Config will be updated at the end of Render
+        changed = true;  // Config will be updated at the end of Render
     }
     ImGui::PopItemWidth();
     
@@ -91,7 +105,7 @@ void ConfigPanel::DrawAppearanceSettings() {
     ImGui::Text("Graph Color");
     ImGui::PushItemWidth(-1);
     if (ImGui::ColorEdit3("##GraphColor", (float*)&m_config.graphColor)) {
-        // Config will be updated at the end of Render
+        changed = true;  // Config will be updated at the end of Render
     }
     ImGui::PopItemWidth();
     
@@ -99,12 +113,16 @@ void ConfigPanel::DrawAppearanceSettings() {
     ImGui::Text("Background Color");
     ImGui::PushItemWidth(-1);
     if (ImGui::ColorEdit3("##BgColor", (float*)&m_config.backgroundColor)) {
-        // Config will be updated at the end of Render
+        changed = true;  // Config will be updated at the end of Render
     }
     ImGui::PopItemWidth();
+    
+    return changed;
 }
 
-void ConfigPanel::DrawViewportSettings() {
+bool ConfigPanel::DrawViewportSettings() {
+    bool changed = false;
+    
     ImGui::Text("Viewport Controls");
     
     // Reset viewport button
@@ -122,9 +140,57 @@ void ConfigPanel::DrawViewportSettings() {
     ImGui::Text("Default View Scaling");
     ImGui::PushItemWidth(-1);
     if (ImGui::SliderFloat("##DefaultScaling", &m_config.defaultViewScaling, 5.0f, 100.0f, "%.1f")) {
-        // Config will be updated at the end of Render
+        changed = true;  // Config will be updated at the end of Render
+    }
+    ImGui::PopItemWidth();
+    
+    return changed;
+}
+
+bool ConfigPanel::DrawSamplingSettings() {
+    static const char* const kModes[] = {"Uniform", "Adaptive", "Range bands"};
+    
+    // Adaptive places points where interval bounds show detail; range bands fill every value a pixel column takes
+    int mode = static_cast<int>(m_config.sampleMode);
+    ImGui::Text("Sampling Mode");
+    ImGui::PushItemWidth(-1);
+    bool changed = ImGui::Combo("##SampleMode", &mode, kModes, IM_ARRAYSIZE(kModes));
+    ImGui::PopItemWidth();
+    if (changed) {
+        m_config.sampleMode = static_cast<SampleMode>(mode);
+    }
+    
+    // Equations can override this from their right-click menu in the equation list
+    static const char* const kPrecisions[] = {"Precise", "Fast (within 4 ULP)"};
+    int precision = static_cast<int>(m_config.mathPrecision);
+    ImGui::Text("Math");
+    ImGui::PushItemWidth(-1);
+    if (ImGui::Combo("##MathPrecision", &precision, kPrecisions, IM_ARRAYSIZE(kPrecisions))) {
+        m_config.mathPrecision = static_cast<MathPrecision>(precision);
+        changed = true;
     }
     ImGui::PopItemWidth();
+    
+    return changed;
+}
+
+bool ConfigPanel::DrawAnalysisSettings() {
+    static const char* const kDerivatives[] = {"None", "First (f')", "Second (f'')"};
+    bool changed = false;
+    
+    // Derivatives are exact (dual numbers), not finite differences
+    ImGui::Text("Derivative");
+    ImGui::PushItemWidth(-1);
+    if (ImGui::Combo("##Derivative", &m_config.derivativeOrder, kDerivatives, IM_ARRAYSIZE(kDerivatives))) {
+        changed = true;
+    }
+    ImGui::PopItemWidth();
+    
+    if (ImGui::Checkbox("Mark Roots and Extrema", &m_config.showCriticalPoints)) {
+        changed = true;
+    }
+    
+    return changed;
 }
 
 void ConfigPanel::SetConfig(const GraphConfig& config) {
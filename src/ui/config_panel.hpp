@@ -3,6 +3,8 @@
 #include <glm/glm.hpp>
 #include <functional>
 #include <imgui.h>
+#include "../graph/sampler.hpp"
+#include "../equation/fast_math.hpp"
 
 namespace plot_genius {
 
@@ -29,6 +31,16 @@ struct GraphConfig {
     ImVec4 gridColor{0.3f, 0.3f, 0.3f, 1.0f};
     ImVec4 axisColor{0.5f, 0.5f, 0.5f, 1.0f};
     ImVec4 graphColor{0.0f, 0.8f, 0.2f, 1.0f};
+    
+    // How curves are sampled: evenly, adaptively, or as guaranteed value ranges per pixel column
+    SampleMode sampleMode{SampleMode::Uniform};
+    
+    // Fast computes sin, exp, pow and the other built-ins with vectorized kernels, within 4 ULP
+    MathPrecision mathPrecision{MathPrecision::Fast};
+    
+    // Analysis: derivative drawn with each curve (0 none, 1 first, 2 second) and markers at roots and extrema
+    int derivativeOrder{0};
+    bool showCriticalPoints{false};
 };
 
 class ConfigPanel {
@@ -44,9 +56,12 @@ public:
     void ClearResetFlag() { m_resetGraphView = false; }
     
 private:
-    void DrawGridSettings();
-    void DrawAppearanceSettings();
-    void DrawViewportSettings();
+    // Each returns true if a setting was modified this frame
+    bool DrawGridSettings();
+    bool DrawAppearanceSettings();
+    bool DrawViewportSettings();
+    bool DrawSamplingSettings();
+    bool DrawAnalysisSettings();
     
     GraphConfig m_config;
     GraphConfig m_defaultConfig;  // Store default values for reset
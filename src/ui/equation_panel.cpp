@@ -1,10 +1,18 @@
 #include "equation_panel.hpp"
+#include "../equation/parameters.hpp"
 #include "imgui.h"
 #include <algorithm>
 #include <sstream>
 
 namespace plot_genius {
 
+namespace {
+
+// Members of a family when sweeping is switched on
+constexpr int kDefaultSweepMembers = 50;
+
+} // namespace
+
 EquationPanel::EquationPanel() : m_hasError(false) {
     memset(m_inputBuffer, 0, sizeof(m_inputBuffer));
 }
@@ -15,6 +23,8 @@ void EquationPanel::Render() {
     ImGui::Separator();
     DrawEquationsList();
     ImGui::Separator();
+    DrawParameters();
+    ImGui::Separator();
     DrawHistory();
 }
 
@@ -26,6 +36,23 @@ void EquationPanel::SetRemoveCallback(std::function<void(int)> callback) {
     m_removeCallback = std::move(callback);
 }
 
+void EquationPanel::SetParameterTable(ParameterTable* table) {
+    m_parameters = table;
+}
+
+void EquationPanel::SetParameterCallback(std::function<void()> callback) {
+    m_parameterCallback = std::move(callback);
+}
+
+void EquationPanel::SetPlaybackCallback(std::function<void(bool)> callback) {
+    m_playbackCallback = std::move(callback);
+}
+
+void EquationPanel::SetPrecisionCallback(
+    std::function<void(const std::string&, std::optional<MathPrecision>)> callback) {
+    m_precisionCallback = std::move(callback);
+}
+
 void EquationPanel::DrawEquationInput() {
     ImGui::Text("Enter equation (format: y=f(x)):");
     
@@ -124,6 +151,12 @@ void EquationPanel::DrawEquationInput() {
         ImGui::Text("\nSupported constants:");
         ImGui::BulletText("pi (3.14159...)");
         ImGui::BulletText("e (2.71828...)");
+        ImGui::Text("\nDerivatives (d2/dx2 etc. for higher orders):");
+        ImGui::BulletText("y=d/dx(x*sin(x))");
+        ImGui::Text("\nAny other name is a parameter with a slider:");
+        ImGui::BulletText("y=a*sin(b*x+c)");
+        ImGui::Text("\nt is time; press Play next to its slider:");
+        ImGui::BulletText("y=sin(x-t)");
         ImGui::EndPopup();
     }
 }
@@ -155,6 +188,28 @@ void EquationPanel::DrawEquationsList() {
         // Display the equation
         ImGui::Text("%s", it->expression.c_str());
         
+        // Right-click to override the math precision set under Configuration > Sampling
+        if (ImGui::BeginPopupContextItem("precision")) {
+            ImGui::Text("Math for %s", it->expression.c_str());
+            std::optional<MathPrecision> precision = it->precision;
+            if (ImGui::RadioButton("Default", !precision)) {
+                precision.reset();
+            }
+            if (ImGui::RadioButton("Precise", precision == MathPrecision::Precise)) {
+                precision = MathPrecision::Precise;
+            }
+            if (ImGui::RadioButton("Fast", precision == MathPrecision::Fast)) {
+                precision = MathPrecision::Fast;
+            }
+            if (precision != it->precision) {
+                it->precision = precision;
+                if (m_precisionCallback) {
+                    m_precisionCallback(it->expression, precision);
+                }
+            }
+            ImGui::EndPopup();
+        }
+        
         // Add a remove button
         ImGui::SameLine(ImGui::GetWindowWidth() - 30);
         if (ImGui::Button("-")) {
@@ -174,6 +229,78 @@ void EquationPanel::DrawEquationsList() {
     }
 }
 
+void EquationPanel::DrawParameters() {
+    ImGui::Text("Parameters:");
+    
+    if (!m_parameters || m_parameters->GetBindings().empty()) {
+        ImGui::TextDisabled("Names other than x, pi and e become parameters");
+        return;
+    }
+    
+    bool changed = false;
+    for (auto& binding : m_parameters->GetBindings()) {
+        ImGui::PushID(binding.name.c_str());
+        
+        const bool isTime = binding.name == kTimeParameter;
+        if (isTime) {
+            if (ImGui::SmallButton(m_playing ? "Pause" : "Play")) {
+                m_playing = !m_playing;
+                if (m_playbackCallback) {
+                    m_playbackCallback(m_playing);
+                }
+            }
+            ImGui::SameLine();
+        }
+        
+        // Values only feed the next sampling pass; nothing is parsed again.
+        // During playback the animation picks up a moved time slider by itself.
+        ImGui::PushItemWidth(-30);
+        bool moved = ImGui::SliderScalar(binding.name.c_str(), ImGuiDataType_Double, &binding.value,
+                                         &binding.min, &binding.max, "%.3f");
+        changed |= moved && !(isTime && m_playing);
+        ImGui::PopItemWidth();
+        
+        // Right-click the slider to change its range or sweep over it
+        if (ImGui::BeginPopupContextItem("range")) {
+            ImGui::Text("Range of %s", binding.name.c_str());
+            changed |= ImGui::InputDouble("min", &binding.min, 0.0, 0.0, "%.3f");
+            changed |= ImGui::InputDouble("max", &binding.max, 0.0, 0.0, "%.3f");
+            if (binding.max < binding.min) {
+                std::swap(binding.min, binding.max);
+            }
+            binding.value = std::clamp(binding.value, binding.min, binding.max);
+            
+            bool sweep = binding.sweepMembers > 0;
+            if (ImGui::Checkbox("Sweep over range", &sweep)) {
+                binding.sweepMembers = sweep ? kDefaultSweepMembers : 0;
+                changed = true;
+            }
+            if (sweep) {
+                int members = static_cast<int>(binding.sweepMembers);
+                if (ImGui::InputInt("members", &members, 10, 100)) {
+                    binding.sweepMembers = static_cast<std::uint32_t>(
+                        std::clamp(members, 2, static_cast<int>(kMaxSweepMembers)));
+                    changed = true;
+                }
+                changed |= ImGui::Checkbox("Envelope", &binding.envelope);
+            }
+            ImGui::EndPopup();
+        }
+        
+        // A swept parameter takes every value in its range, so the slider value is unused
+        if (binding.sweepMembers > 0) {
+            ImGui::TextDisabled("  %u %s over [%.3g, %.3g]", binding.sweepMembers,
+                                binding.envelope ? "members as a band" : "curves", binding.min, binding.max);
+        }
+        
+        ImGui::PopID();
+    }
+    
+    if (changed && m_parameterCallback) {
+        m_parameterCallback();
+    }
+}
+
 void EquationPanel::DrawHistory() {
     ImGui::Text("History:");
     
@@ -252,6 +379,16 @@ void EquationPanel::AddEquation(const std::string& equation) {
     }
 }
 
+void EquationPanel::RestoreEquation(const std::string& equation, bool isActive,
+                                    std::optional<MathPrecision> precision) {
+    Equation restored;
+    restored.expression = equation;
+    restored.isActive = isActive;
+    restored.precision = precision;
+    restored.id = GetNextEquationId();
+    m_equations.push_back(restored);
+}
+
 void EquationPanel::RemoveEquation(int id) {
     // If we removed the last equation, we should handle it appropriately
     // Call the external remove callback if available
@@ -2,13 +2,18 @@
 
 #include <string>
 #include <functional>
+#include <optional>
 #include <vector>
+#include "../equation/fast_math.hpp"
 
 namespace plot_genius {
 
+class ParameterTable;
+
 struct Equation {
     std::string expression;
     bool isActive{true};
+    std::optional<MathPrecision> precision;  // Overrides the global math precision
     int id;
 };
 
@@ -20,11 +25,23 @@ public:
     void Render();
     void SetEquationCallback(std::function<void(const std::string&)> callback);
     void SetRemoveCallback(std::function<void(int)> callback);
+    // Shows a slider per binding; the callback runs whenever a value or range changes
+    void SetParameterTable(ParameterTable* table);
+    void SetParameterCallback(std::function<void()> callback);
+    // Play/Pause next to the time parameter; while playing, moving its slider only seeks
+    void SetPlaybackCallback(std::function<void(bool)> callback);
+    void SetPlaying(bool playing) { m_playing = playing; }
+    // Right-click an equation to give it its own math precision; nullopt follows the global setting
+    void SetPrecisionCallback(std::function<void(const std::string&, std::optional<MathPrecision>)> callback);
     void SetCurrentEquation(const std::string& equation);
+    // Lists an equation restored from a session without invoking the callback
+    void RestoreEquation(const std::string& equation, bool isActive,
+                         std::optional<MathPrecision> precision = std::nullopt);
     void DrawEquationInput();
 
 private:
     void DrawEquationsList();
+    void DrawParameters();
     void DrawHistory();
     bool ValidateEquation(const std::string& equation);
     void AddEquation(const std::string& equation);
@@ -36,6 +53,11 @@ private:
     std::vector<std::string> m_history;
     std::function<void(const std::string&)> m_equationCallback;
     std::function<void(int)> m_removeCallback;
+    ParameterTable* m_parameters{nullptr};
+    std::function<void()> m_parameterCallback;
+    std::function<void(bool)> m_playbackCallback;
+    std::function<void(const std::string&, std::optional<MathPrecision>)> m_precisionCallback;
+    bool m_playing{false};
     bool m_hasError{false};
     std::string m_errorMessage;
     int m_nextEquationId{0};
@@ -1,12 +1,22 @@
 #include "graph_panel.hpp"
 #include "imgui.h"
 #include "imgui_internal.h"
+#include "../graph/palette.hpp"
 #include <cmath>
-#include <iostream>
-#include <algorithm> // For std::find
+#include <algorithm> // For std::find_if
 
 namespace plot_genius {
 
+namespace {
+
+// Opacity of the area between the bounds of a band
+constexpr std::uint32_t kBandFillAlpha = 64;
+
+// Radius of root and extremum markers in pixels
+constexpr float kMarkerRadius = 4.0f;
+
+} // namespace
+
 GraphPanel::GraphPanel() {
     m_config = GraphConfig{};
 }
@@ -22,225 +32,30 @@ void GraphPanel::Render() {
         // Make sure we have a minimum size
         if (canvasSize.x < 50.0f) canvasSize.x = 50.0f;
         if (canvasSize.y < 50.0f) canvasSize.y = 50.0f;
-        
-        // Calculate scale factors - this is key to proper scaling
-        float scaleX = canvasSize.x / (m_viewMaxX - m_viewMinX);
-        float scaleY = canvasSize.y / (m_viewMaxY - m_viewMinY);
-        
-        // Log position and size for debugging
-        static int debugCounter = 0;
-        if (debugCounter++ % 100 == 0) {
-            ImVec2 pos = ImGui::GetCursorScreenPos();
-            std::string debugInfo = "GraphPanel: pos(" + std::to_string(pos.x) + "," + 
-                                   std::to_string(pos.y) + ") size(" + 
-                                   std::to_string(canvasSize.x) + "," +
-                                   std::to_string(canvasSize.y) + ")";
-            std::cout << debugInfo << std::endl;
-            std::cout << "View range: X[" << m_viewMinX << ", " << m_viewMaxX << "] "
-                     << "Y[" << m_viewMinY << ", " << m_viewMaxY << "]" << std::endl;
-        }
+        m_canvasSize = canvasSize;
         
         ImVec2 canvasPos = ImGui::GetCursorScreenPos();
+        ImVec2 canvasMax = ImVec2(canvasPos.x + canvasSize.x, canvasPos.y + canvasSize.y);
         ImDrawList* drawList = ImGui::GetWindowDrawList();
         
-        // Draw background
-        drawList->AddRectFilled(canvasPos, ImVec2(canvasPos.x + canvasSize.x, canvasPos.y + canvasSize.y),
-                              IM_COL32(m_config.backgroundColor.x * 255,
-                                      m_config.backgroundColor.y * 255,
-                                      m_config.backgroundColor.z * 255,
-                                      m_config.backgroundColor.w * 255));
+        // Grid and curves come from the offscreen cache, which only redraws what changed
+        rendering::PlotCache::View view{m_viewMinX, m_viewMaxX, m_viewMinY, m_viewMaxY};
+        auto drawContent = [&](ImDrawList* target, const ImVec2& clipMin, const ImVec2& clipMax) {
+            DrawGraph(target, canvasPos, canvasSize, clipMin, clipMax);
+        };
+        if (m_plotCache.Update(canvasPos, canvasSize, view, m_contentRevision, drawContent)) {
+            m_plotCache.Present(drawList, canvasPos, canvasSize);
+        } else {
+            DrawGraph(drawList, canvasPos, canvasSize, canvasPos, canvasMax);
+        }
         
+        // Labels are pinned to the canvas edges rather than the world, so they are drawn live
         if (m_config.showGrid) {
-            // Draw the grid with proper spacing
-            float worldSpacing = m_config.gridSpacing;
-            
-            // Calculate where to start drawing grid lines
-            float startX = std::ceil(m_viewMinX / worldSpacing) * worldSpacing;
-            float startY = std::ceil(m_viewMinY / worldSpacing) * worldSpacing;
-            
-            // Draw vertical grid lines
-            for (float x = startX; x <= m_viewMaxX; x += worldSpacing) {
-                // Skip the axis line which will be drawn separately
-                if (std::abs(x) < 0.001f) continue;
-                
-                float screenX = canvasPos.x + (x - m_viewMinX) * scaleX;
-                drawList->AddLine(
-                    ImVec2(screenX, canvasPos.y),
-                    ImVec2(screenX, canvasPos.y + canvasSize.y),
-                    IM_COL32(m_config.gridColor.x * 255,
-                            m_config.gridColor.y * 255,
-                            m_config.gridColor.z * 255,
-                            m_config.gridColor.w * 255),
-                    m_config.lineThickness * 0.5f
-                );
-                
-                // Draw coordinate label if it's a major grid line
-                if (std::fmod(std::abs(x), worldSpacing * 2.0f) < 0.001f) {
-                    char label[32];
-                    snprintf(label, sizeof(label), "%.1f", x);
-                    float labelY = canvasPos.y + canvasSize.y - 20.0f; // Position near bottom
-                    
-                    // Keep the labelY constant, no need for axisX
-                    drawList->AddText(
-                        ImVec2(screenX - 10.0f, labelY),
-                        IM_COL32(m_config.axisColor.x * 255,
-                                m_config.axisColor.y * 255,
-                                m_config.axisColor.z * 255,
-                                m_config.axisColor.w * 255),
-                        label
-                    );
-                }
-            }
-            
-            // Draw horizontal grid lines
-            for (float y = startY; y <= m_viewMaxY; y += worldSpacing) {
-                // Skip the axis line which will be drawn separately
-                if (std::abs(y) < 0.001f) continue;
-                
-                float screenY = canvasPos.y + canvasSize.y - (y - m_viewMinY) * scaleY;
-                drawList->AddLine(
-                    ImVec2(canvasPos.x, screenY),
-                    ImVec2(canvasPos.x + canvasSize.x, screenY),
-                    IM_COL32(m_config.gridColor.x * 255,
-                            m_config.gridColor.y * 255,
-                            m_config.gridColor.z * 255,
-                            m_config.gridColor.w * 255),
-                    m_config.lineThickness * 0.5f
-                );
-                
-                // Draw coordinate label if it's a major grid line
-                if (std::fmod(std::abs(y), worldSpacing * 2.0f) < 0.001f) {
-                    char label[32];
-                    snprintf(label, sizeof(label), "%.1f", y);
-                    float labelX = canvasPos.x + 5.0f; // Position near left edge
-                    
-                    // Keep the labelX constant, no need for axisY
-                    drawList->AddText(
-                        ImVec2(labelX, screenY - 10.0f),
-                        IM_COL32(m_config.axisColor.x * 255,
-                                m_config.axisColor.y * 255,
-                                m_config.axisColor.z * 255,
-                                m_config.axisColor.w * 255),
-                        label
-                    );
-                }
-            }
-            
-            // Draw X and Y axes with thicker lines
-            
-            // Draw X axis (y = 0) if within view
-            if (m_viewMinY <= 0 && m_viewMaxY >= 0) {
-                float yZero = canvasPos.y + canvasSize.y - (0 - m_viewMinY) * scaleY;
-                drawList->AddLine(
-                    ImVec2(canvasPos.x, yZero),
-                    ImVec2(canvasPos.x + canvasSize.x, yZero),
-                    IM_COL32(m_config.axisColor.x * 255,
-                            m_config.axisColor.y * 255,
-                            m_config.axisColor.z * 255,
-                            m_config.axisColor.w * 255),
-                    m_config.lineThickness * 1.5f  // Make axis lines thicker
-                );
-            }
-            
-            // Draw Y axis (x = 0) if within view
-            if (m_viewMinX <= 0 && m_viewMaxX >= 0) {
-                float xZero = canvasPos.x + (0 - m_viewMinX) * scaleX;
-                drawList->AddLine(
-                    ImVec2(xZero, canvasPos.y),
-                    ImVec2(xZero, canvasPos.y + canvasSize.y),
-                    IM_COL32(m_config.axisColor.x * 255,
-                            m_config.axisColor.y * 255,
-                            m_config.axisColor.z * 255,
-                            m_config.axisColor.w * 255),
-                    m_config.lineThickness * 1.5f  // Make axis lines thicker
-                );
-            }
+            DrawGridLabels(drawList, canvasPos, canvasSize);
         }
         
-        // Draw multiple equation points if available
-        if (!m_equationPoints.empty()) {
-            // Define equation colors - cycle through these for different equations
-            const int numColors = 5;
-            ImU32 colors[numColors] = {
-                IM_COL32(0, 204, 51, 255),   // Green
-                IM_COL32(51, 153, 255, 255), // Blue
-                IM_COL32(255, 51, 51, 255),  // Red
-                IM_COL32(255, 153, 51, 255), // Orange
-                IM_COL32(153, 51, 255, 255)  // Purple
-            };
-            
-            // Log points count for debugging
-            if (debugCounter % 100 == 0) {
-                std::cout << "Multiple equations to plot: " << m_equationPoints.size() << std::endl;
-            }
-            
-            // Draw each equation's points with a different color
-            for (size_t eq = 0; eq < m_equationPoints.size(); ++eq) {
-                const auto& points = m_equationPoints[eq];
-                ImU32 color = colors[eq % numColors];
-                
-                // Draw connecting lines between points for this equation
-                for (size_t i = 1; i < points.size(); ++i) {
-                    // Properly transform from world to screen coordinates
-                    float x1 = canvasPos.x + (points[i-1].x - m_viewMinX) * scaleX;
-                    float y1 = canvasPos.y + canvasSize.y - (points[i-1].y - m_viewMinY) * scaleY;
-                    float x2 = canvasPos.x + (points[i].x - m_viewMinX) * scaleX;
-                    float y2 = canvasPos.y + canvasSize.y - (points[i].y - m_viewMinY) * scaleY;
-                    
-                    // Only draw if at least one point is within view
-                    if ((x1 >= canvasPos.x && x1 <= canvasPos.x + canvasSize.x) ||
-                        (x2 >= canvasPos.x && x2 <= canvasPos.x + canvasSize.x)) {
-                        if ((y1 >= canvasPos.y && y1 <= canvasPos.y + canvasSize.y) ||
-                            (y2 >= canvasPos.y && y2 <= canvasPos.y + canvasSize.y)) {
-                            drawList->AddLine(
-                                ImVec2(x1, y1),
-                                ImVec2(x2, y2),
-                                color,
-                                m_config.lineThickness
-                            );
-                        }
-                    }
-                }
-            }
-        }
-        // Only use legacy single equation points if we don't have multi-equation points
-        else if (!m_points.empty()) {
-            // Log points count for debugging
-            if (debugCounter % 100 == 0) {
-                std::cout << "Points to plot: " << m_points.size() << std::endl;
-            }
-            
-            // Draw connecting lines between points
-            for (size_t i = 1; i < m_points.size(); ++i) {
-                // Properly transform from world to screen coordinates
-                float x1 = canvasPos.x + (m_points[i-1].x - m_viewMinX) * scaleX;
-                float y1 = canvasPos.y + canvasSize.y - (m_points[i-1].y - m_viewMinY) * scaleY;
-                float x2 = canvasPos.x + (m_points[i].x - m_viewMinX) * scaleX;
-                float y2 = canvasPos.y + canvasSize.y - (m_points[i].y - m_viewMinY) * scaleY;
-                
-                // Only draw if at least one point is within view
-                if ((x1 >= canvasPos.x && x1 <= canvasPos.x + canvasSize.x) ||
-                    (x2 >= canvasPos.x && x2 <= canvasPos.x + canvasSize.x)) {
-                    if ((y1 >= canvasPos.y && y1 <= canvasPos.y + canvasSize.y) ||
-                        (y2 >= canvasPos.y && y2 <= canvasPos.y + canvasSize.y)) {
-                            drawList->AddLine(
-                                ImVec2(x1, y1),
-                                ImVec2(x2, y2),
-                                IM_COL32(m_config.graphColor.x * 255,
-                                    m_config.graphColor.y * 255,
-                                    m_config.graphColor.z * 255,
-                                    m_config.graphColor.w * 255),
-                                m_config.lineThickness
-                            );
-                    }
-                }
-            }
-        } else {
+        if (m_equationPoints.empty() && m_points.empty()) {
             // Draw message if no points
-            if (debugCounter % 100 == 0) {
-                std::cout << "No points to plot" << std::endl;
-            }
-            
             ImVec2 msgPos = ImVec2(canvasPos.x + canvasSize.x * 0.5f - 60, canvasPos.y + canvasSize.y * 0.5f - 10);
             drawList->AddText(msgPos, IM_COL32(255, 255, 255, 255), "No data to display");
         }
@@ -251,18 +66,8 @@ void GraphPanel::Render() {
             ImGui::SetCursorPos(ImVec2(10, 30)); // Position below the title bar
             
             // Create a vertical list of all equations with their respective colors
-            const int numColors = 5;
-            ImU32 colors[numColors] = {
-                IM_COL32(0, 204, 51, 255),   // Green
-                IM_COL32(51, 153, 255, 255), // Blue
-                IM_COL32(255, 51, 51, 255),  // Red
-                IM_COL32(255, 153, 51, 255), // Orange
-                IM_COL32(153, 51, 255, 255)  // Purple
-            };
-            
-            for (size_t i = 0; i < m_equations.size(); ++i) {
-                ImVec4 color = ImGui::ColorConvertU32ToFloat4(colors[i % numColors]);
-                ImGui::TextColored(color, "%s", m_equations[i].c_str());
+            for (const auto& [equation, color] : m_equations) {
+                ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(color), "%s", equation.c_str());
             }
         }
         
@@ -279,40 +84,283 @@ void GraphPanel::Render() {
 
 void GraphPanel::SetPoints(const std::vector<GraphPoint>& points) {
     m_points = points;
+    ++m_contentRevision;
 }
 
-void GraphPanel::SetMultipleEquationPoints(const std::vector<std::vector<GraphPoint>>& equationPoints) {
+void GraphPanel::SetMultipleEquationPoints(const std::vector<std::vector<GraphPoint>>& equationPoints,
+                                           const std::vector<ImU32>& colors, bool resampledForView,
+                                           float sampledMinX, float sampledMaxX) {
     m_equationPoints = equationPoints;
+    m_equationColors = colors;
+    
+    // Resampling the same curves for a moved view keeps the cached pixels usable, unless a pan
+    // exposed a strip beyond the points these replace, which was drawn without the curve
+    if (!resampledForView || m_plotCache.LacksData()) {
+        ++m_contentRevision;
+    }
+    m_plotCache.SetDataRange(sampledMinX, sampledMaxX);
     
     // No longer flattening points to avoid creating the false third line
     // This prevents the issue where points from different equations are connected
 }
 
+void GraphPanel::SetBands(const std::vector<GraphBand>& bands) {
+    m_bands = bands;
+}
+
+void GraphPanel::SetMarkers(const std::vector<GraphMarker>& markers) {
+    m_markers = markers;
+}
+
 void GraphPanel::SetViewCallback(std::function<void(float, float, float, float)> callback) {
     m_viewCallback = std::move(callback);
 }
 
-void GraphPanel::SetEquation(const std::string& equation) {
+void GraphPanel::SetEquation(const std::string& equation, ImU32 color) {
     // Add this equation to our list if it's not already there
     bool found = false;
     for (const auto& eq : m_equations) {
-        if (eq == equation) {
+        if (eq.first == equation) {
             found = true;
             break;
         }
     }
     
     if (!found) {
-        m_equations.push_back(equation);
+        m_equations.emplace_back(equation, color);
     }
 }
 
 void GraphPanel::SetConfig(const GraphConfig& config) {
     m_config = config;
+    ++m_contentRevision;
 }
 
-void GraphPanel::DrawGraph() {
-    // Legacy method, now incorporated into Render()
+void GraphPanel::DrawGraph(ImDrawList* drawList, const ImVec2& canvasPos, const ImVec2& canvasSize,
+                           const ImVec2& clipMin, const ImVec2& clipMax) {
+    // Calculate scale factors - this is key to proper scaling
+    float scaleX = canvasSize.x / (m_viewMaxX - m_viewMinX);
+    float scaleY = canvasSize.y / (m_viewMaxY - m_viewMinY);
+    
+    // Only geometry touching the clip rectangle is emitted; lines reach a little past it
+    float margin = m_config.lineThickness * 1.5f;
+    
+    // Draw background
+    drawList->AddRectFilled(clipMin, clipMax,
+                          IM_COL32(m_config.backgroundColor.x * 255,
+                                  m_config.backgroundColor.y * 255,
+                                  m_config.backgroundColor.z * 255,
+                                  m_config.backgroundColor.w * 255));
+    
+    if (m_config.showGrid) {
+        ImU32 gridColor = IM_COL32(m_config.gridColor.x * 255,
+                                   m_config.gridColor.y * 255,
+                                   m_config.gridColor.z * 255,
+                                   m_config.gridColor.w * 255);
+        ImU32 axisColor = IM_COL32(m_config.axisColor.x * 255,
+                                   m_config.axisColor.y * 255,
+                                   m_config.axisColor.z * 255,
+                                   m_config.axisColor.w * 255);
+        float worldSpacing = m_config.gridSpacing;
+        
+        // World range covered by the clip rectangle. Lines are placed by index so
+        // a strip redraw lands on exactly the same pixels as a full redraw.
+        float clipMinX = m_viewMinX + (clipMin.x - margin - canvasPos.x) / scaleX;
+        float clipMaxX = m_viewMinX + (clipMax.x + margin - canvasPos.x) / scaleX;
+        float clipMinY = m_viewMinY + (canvasPos.y + canvasSize.y - clipMax.y - margin) / scaleY;
+        float clipMaxY = m_viewMinY + (canvasPos.y + canvasSize.y - clipMin.y + margin) / scaleY;
+        
+        // Draw vertical grid lines
+        long firstX = static_cast<long>(std::ceil(std::max(m_viewMinX, clipMinX) / worldSpacing));
+        long lastX = static_cast<long>(std::floor(std::min(m_viewMaxX, clipMaxX) / worldSpacing));
+        for (long i = firstX; i <= lastX; ++i) {
+            float x = i * worldSpacing;
+            // Skip the axis line which will be drawn separately
+            if (std::abs(x) < 0.001f) continue;
+            
+            float screenX = canvasPos.x + (x - m_viewMinX) * scaleX;
+            drawList->AddLine(
+                ImVec2(screenX, canvasPos.y),
+                ImVec2(screenX, canvasPos.y + canvasSize.y),
+                gridColor,
+                m_config.lineThickness * 0.5f
+            );
+        }
+        
+        // Draw horizontal grid lines
+        long firstY = static_cast<long>(std::ceil(std::max(m_viewMinY, clipMinY) / worldSpacing));
+        long lastY = static_cast<long>(std::floor(std::min(m_viewMaxY, clipMaxY) / worldSpacing));
+        for (long i = firstY; i <= lastY; ++i) {
+            float y = i * worldSpacing;
+            // Skip the axis line which will be drawn separately
+            if (std::abs(y) < 0.001f) continue;
+            
+            float screenY = canvasPos.y + canvasSize.y - (y - m_viewMinY) * scaleY;
+            drawList->AddLine(
+                ImVec2(canvasPos.x, screenY),
+                ImVec2(canvasPos.x + canvasSize.x, screenY),
+                gridColor,
+                m_config.lineThickness * 0.5f
+            );
+        }
+        
+        // Draw X and Y axes with thicker lines
+        
+        // Draw X axis (y = 0) if within view
+        if (m_viewMinY <= 0 && m_viewMaxY >= 0) {
+            float yZero = canvasPos.y + canvasSize.y - (0 - m_viewMinY) * scaleY;
+            drawList->AddLine(
+                ImVec2(canvasPos.x, yZero),
+                ImVec2(canvasPos.x + canvasSize.x, yZero),
+                axisColor,
+                m_config.lineThickness * 1.5f  // Make axis lines thicker
+            );
+        }
+        
+        // Draw Y axis (x = 0) if within view
+        if (m_viewMinX <= 0 && m_viewMaxX >= 0) {
+            float xZero = canvasPos.x + (0 - m_viewMinX) * scaleX;
+            drawList->AddLine(
+                ImVec2(xZero, canvasPos.y),
+                ImVec2(xZero, canvasPos.y + canvasSize.y),
+                axisColor,
+                m_config.lineThickness * 1.5f  // Make axis lines thicker
+            );
+        }
+    }
+    
+    // Draws connecting lines between points, skipping segments outside the clip rectangle
+    auto drawCurve = [&](const std::vector<GraphPoint>& points, ImU32 color) {
+        for (size_t i = 1; i < points.size(); ++i) {
+            // Properly transform from world to screen coordinates
+            float x1 = canvasPos.x + (points[i-1].x - m_viewMinX) * scaleX;
+            float y1 = canvasPos.y + canvasSize.y - (points[i-1].y - m_viewMinY) * scaleY;
+            float x2 = canvasPos.x + (points[i].x - m_viewMinX) * scaleX;
+            float y2 = canvasPos.y + canvasSize.y - (points[i].y - m_viewMinY) * scaleY;
+            
+            // Undefined points and poles break the curve
+            if (!std::isfinite(y1) || !std::isfinite(y2)) {
+                continue;
+            }
+            
+            // Only draw if at least one point is within view
+            if (!((x1 >= canvasPos.x && x1 <= canvasPos.x + canvasSize.x) ||
+                  (x2 >= canvasPos.x && x2 <= canvasPos.x + canvasSize.x))) {
+                continue;
+            }
+            if (!((y1 >= canvasPos.y && y1 <= canvasPos.y + canvasSize.y) ||
+                  (y2 >= canvasPos.y && y2 <= canvasPos.y + canvasSize.y))) {
+                continue;
+            }
+            
+            // ...and the segment reaches the region being redrawn
+            if (std::max(x1, x2) < clipMin.x - margin || std::min(x1, x2) > clipMax.x + margin ||
+                std::max(y1, y2) < clipMin.y - margin || std::min(y1, y2) > clipMax.y + margin) {
+                continue;
+            }
+            
+            drawList->AddLine(ImVec2(x1, y1), ImVec2(x2, y2), color, m_config.lineThickness);
+        }
+    };
+    
+    // Fill each band segment by segment; lower never exceeds upper, so every quad is convex
+    for (const auto& band : m_bands) {
+        ImU32 fill = WithAlpha(band.color, kBandFillAlpha);
+        std::size_t count = std::min(band.lower.size(), band.upper.size());
+        for (std::size_t i = 1; i < count; ++i) {
+            float x1 = canvasPos.x + (band.lower[i-1].x - m_viewMinX) * scaleX;
+            float x2 = canvasPos.x + (band.lower[i].x - m_viewMinX) * scaleX;
+            if (x2 < clipMin.x - margin || x1 > clipMax.x + margin) {
+                continue;
+            }
+            
+            // Clamp to a little beyond the canvas so huge values stay representable
+            auto toScreenY = [&](float y) {
+                float screenY = canvasPos.y + canvasSize.y - (y - m_viewMinY) * scaleY;
+                return std::clamp(screenY, canvasPos.y - canvasSize.y, canvasPos.y + 2.0f * canvasSize.y);
+            };
+            float lower1 = band.lower[i-1].y, lower2 = band.lower[i].y;
+            float upper1 = band.upper[i-1].y, upper2 = band.upper[i].y;
+            if (!std::isfinite(lower1) || !std::isfinite(lower2) || !std::isfinite(upper1) || !std::isfinite(upper2)) {
+                continue;
+            }
+            drawList->AddQuadFilled(ImVec2(x1, toScreenY(upper1)), ImVec2(x2, toScreenY(upper2)),
+                                    ImVec2(x2, toScreenY(lower2)), ImVec2(x1, toScreenY(lower1)), fill);
+        }
+        drawCurve(band.lower, band.color);
+        drawCurve(band.upper, band.color);
+    }
+    
+    // Draw multiple equation points if available
+    if (!m_equationPoints.empty()) {
+        // Draw each equation's points with a different color
+        for (size_t eq = 0; eq < m_equationPoints.size(); ++eq) {
+            drawCurve(m_equationPoints[eq], eq < m_equationColors.size() ? m_equationColors[eq]
+                                                                         : GetDefaultEquationColor(eq));
+        }
+    }
+    // Only use legacy single equation points if we don't have multi-equation points
+    else if (!m_points.empty()) {
+        drawCurve(m_points, IM_COL32(m_config.graphColor.x * 255,
+                                     m_config.graphColor.y * 255,
+                                     m_config.graphColor.z * 255,
+                                     m_config.graphColor.w * 255));
+    }
+    
+    for (const auto& marker : m_markers) {
+        ImVec2 center(canvasPos.x + (marker.x - m_viewMinX) * scaleX,
+                      canvasPos.y + canvasSize.y - (marker.y - m_viewMinY) * scaleY);
+        float reach = margin + kMarkerRadius;
+        if (!std::isfinite(center.y) || center.x < clipMin.x - reach || center.x > clipMax.x + reach ||
+            center.y < clipMin.y - reach || center.y > clipMax.y + reach) {
+            continue;
+        }
+        if (marker.filled) {
+            drawList->AddCircleFilled(center, kMarkerRadius, marker.color);
+        } else {
+            drawList->AddCircle(center, kMarkerRadius, marker.color, 0, m_config.lineThickness * 0.75f);
+        }
+    }
+}
+
+void GraphPanel::DrawGridLabels(ImDrawList* drawList, const ImVec2& canvasPos, const ImVec2& canvasSize) {
+    float scaleX = canvasSize.x / (m_viewMaxX - m_viewMinX);
+    float scaleY = canvasSize.y / (m_viewMaxY - m_viewMinY);
+    float worldSpacing = m_config.gridSpacing;
+    ImU32 labelColor = IM_COL32(m_config.axisColor.x * 255,
+                                m_config.axisColor.y * 255,
+                                m_config.axisColor.z * 255,
+                                m_config.axisColor.w * 255);
+    
+    // Labels on major vertical grid lines, positioned near the bottom
+    long firstX = static_cast<long>(std::ceil(m_viewMinX / worldSpacing));
+    long lastX = static_cast<long>(std::floor(m_viewMaxX / worldSpacing));
+    for (long i = firstX; i <= lastX; ++i) {
+        float x = i * worldSpacing;
+        if (std::abs(x) < 0.001f || std::fmod(std::abs(x), worldSpacing * 2.0f) >= 0.001f) continue;
+        
+        char label[32];
+        snprintf(label, sizeof(label), "%.1f", x);
+        float screenX = canvasPos.x + (x - m_viewMinX) * scaleX;
+        drawList->AddText(ImVec2(screenX - 10.0f, canvasPos.y + canvasSize.y - 20.0f), labelColor, label);
+    }
+    
+    // Labels on major horizontal grid lines, positioned near the left edge
+    long firstY = static_cast<long>(std::ceil(m_viewMinY / worldSpacing));
+    long lastY = static_cast<long>(std::floor(m_viewMaxY / worldSpacing));
+    for (long i = firstY; i <= lastY; ++i) {
+        float y = i * worldSpacing;
+        if (std::abs(y) < 0.001f || std::fmod(std::abs(y), worldSpacing * 2.0f) >= 0.001f) continue;
+        
+        char label[32];
+        snprintf(label, sizeof(label), "%.1f", y);
+        float screenY = canvasPos.y + canvasSize.y - (y - m_viewMinY) * scaleY;
+        drawList->AddText(ImVec2(canvasPos.x + 5.0f, screenY - 10.0f), labelColor, label);
+    }
+}
+
+void GraphPanel::Shutdown() {
+    m_plotCache.Shutdown();
 }
 
 void GraphPanel::HandleInput() {
@@ -416,9 +464,21 @@ void GraphPanel::ResetView() {
     UpdateView();
 }
 
+void GraphPanel::SetView(float minX, float maxX, float minY, float maxY) {
+    m_viewMinX = minX;
+    m_viewMaxX = maxX;
+    m_viewMinY = minY;
+    m_viewMaxY = maxY;
+}
+
+ImU32 GraphPanel::GetDefaultEquationColor(std::size_t index) {
+    return GetEquationColor(index);
+}
+
 void GraphPanel::RemoveEquation(const std::string& equation) {
     // Find and remove the equation from our list
-    auto it = std::find(m_equations.begin(), m_equations.end(), equation);
+    auto it = std::find_if(m_equations.begin(), m_equations.end(),
+                           [&](const auto& label) { return label.first == equation; });
     if (it != m_equations.end()) {
         m_equations.erase(it);
     }
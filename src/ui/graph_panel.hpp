@@ -3,7 +3,11 @@
 #include <vector>
 #include <functional>
 #include <string>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
 #include "config_panel.hpp"
+#include "../rendering/plot_cache.hpp"
 
 namespace plot_genius {
 
@@ -12,6 +16,21 @@ struct GraphPoint {
     float y;
 };
 
+// Region between two curves sampled at the same x values, e.g. a family envelope
+struct GraphBand {
+    std::vector<GraphPoint> lower;
+    std::vector<GraphPoint> upper;
+    ImU32 color{0};
+};
+
+// Point of interest on a curve; roots are drawn filled, extrema as rings
+struct GraphMarker {
+    float x;
+    float y;
+    ImU32 color{0};
+    bool filled{false};
+};
+
 class GraphPanel {
 public:
     GraphPanel();
@@ -19,31 +38,62 @@ public:
 
     void Render();
     void SetPoints(const std::vector<GraphPoint>& points);
-    void SetMultipleEquationPoints(const std::vector<std::vector<GraphPoint>>& equationPoints);
+    // Points resampled for a moved view over [sampledMinX, sampledMaxX] keep the cached pixels,
+    // unless a region of those was drawn beyond the range of the points it was drawn from
+    void SetMultipleEquationPoints(const std::vector<std::vector<GraphPoint>>& equationPoints,
+                                   const std::vector<ImU32>& colors, bool resampledForView = false,
+                                   float sampledMinX = 0.0f, float sampledMaxX = 0.0f);
+    // Bands are drawn beneath the curves and take effect with the next SetMultipleEquationPoints
+    void SetBands(const std::vector<GraphBand>& bands);
+    // Markers are drawn above the curves and, like bands, take effect with the next SetMultipleEquationPoints
+    void SetMarkers(const std::vector<GraphMarker>& markers);
     void SetViewCallback(std::function<void(float, float, float, float)> callback);
-    void SetEquation(const std::string& equation);
+    void SetEquation(const std::string& equation, ImU32 color);
     void RemoveEquation(const std::string& equation);
     void SetConfig(const GraphConfig& config);
     void ResetView();
     
+    // Moves the view without notifying the view callback (e.g. when restoring a session)
+    void SetView(float minX, float maxX, float minY, float maxY);
+    
+    // Color given to the equation with this index unless a session restores another
+    static ImU32 GetDefaultEquationColor(std::size_t index);
+    
+    // Releases GL resources; must run while the context is still current
+    void Shutdown();
+    
     // Viewport getters
     float GetViewMinX() const { return m_viewMinX; }
     float GetViewMaxX() const { return m_viewMaxX; }
     float GetViewMinY() const { return m_viewMinY; }
     float GetViewMaxY() const { return m_viewMaxY; }
+    
+    // Size of the plot area in pixels as of the last frame
+    float GetCanvasWidth() const { return m_canvasSize.x; }
+    float GetCanvasHeight() const { return m_canvasSize.y; }
 
 private:
     std::vector<GraphPoint> m_points;
     std::vector<std::vector<GraphPoint>> m_equationPoints;
-    std::vector<std::string> m_equations;  // Store all active equations
+    std::vector<ImU32> m_equationColors;  // Parallel to m_equationPoints
+    std::vector<GraphBand> m_bands;
+    std::vector<GraphMarker> m_markers;
+    std::vector<std::pair<std::string, ImU32>> m_equations;  // Labels of all active equations
     GraphConfig m_config;
     float m_viewMinX{-10.0f};
     float m_viewMaxX{10.0f};
     float m_viewMinY{-10.0f};
     float m_viewMaxY{10.0f};
+    ImVec2 m_canvasSize{800.0f, 600.0f};  // Until the first frame lays the panel out
     std::function<void(float, float, float, float)> m_viewCallback;
+    
+    // Plot content is cached offscreen and only redrawn when this revision changes
+    rendering::PlotCache m_plotCache;
+    std::uint64_t m_contentRevision{0};
 
-    void DrawGraph();
+    void DrawGraph(ImDrawList* drawList, const ImVec2& canvasPos, const ImVec2& canvasSize,
+                   const ImVec2& clipMin, const ImVec2& clipMax);
+    void DrawGridLabels(ImDrawList* drawList, const ImVec2& canvasPos, const ImVec2& canvasSize);
     void HandleInput();
     void HandlePanAndZoom();
     void UpdateView();
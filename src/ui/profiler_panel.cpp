@@ -0,0 +1,215 @@
+#include "profiler_panel.hpp"
+#include "../core/profiler.hpp"
+#include <imgui.h>
+#include <cfloat>
+
+namespace plot_genius {
+
+namespace {
+
+// Written to the working directory when a recording stops
+constexpr const char* kTracePath = "plot_genius_trace.json";
+
+} // namespace
+
+void ProfilerPanel::Render() {
+    if (ImGui::IsKeyPressed(ImGuiKey_F3, false)) {
+        m_visible = !m_visible;
+    }
+    if (ImGui::IsKeyPressed(ImGuiKey_F4, false)) {
+        ToggleTrace();
+    }
+    if (!m_visible) {
+        return;
+    }
+
+    // Semi-transparent overlay in the top-right corner
+    ImVec2 displaySize = ImGui::GetIO().DisplaySize;
+    ImGui::SetNextWindowPos(ImVec2(displaySize.x - 10.0f, 10.0f), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowBgAlpha(0.85f);
+    ImGuiWindowFlags flags = ImGuiWindowFlags_NoMove |
+                             ImGuiWindowFlags_NoCollapse |
+                             ImGuiWindowFlags_AlwaysAutoResize |
+                             ImGuiWindowFlags_NoSavedSettings |
+                             ImGuiWindowFlags_NoFocusOnAppearing;
+
+    if (ImGui::Begin("Profiler (F3)", &m_visible, flags)) {
+        DrawStatistics();
+        DrawAnimation();
+        DrawSharing();
+        DrawTiers();
+    }
+    ImGui::End();
+}
+
+void ProfilerPanel::DrawSharing() {
+    if (!m_group) {
+        return;
+    }
+    std::size_t separate = 0;
+    for (std::size_t i = 0; i < m_group->GetSize(); ++i) {
+        separate += m_group->GetStats(i).instructions;
+    }
+    ImGui::Separator();
+    ImGui::Text("Shared evaluation: %zu instructions instead of %zu", m_group->GetInstructionCount(), separate);
+    
+    if (ImGui::BeginTable("##sharing", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Equation");
+        ImGui::TableSetupColumn("Tree nodes");
+        ImGui::TableSetupColumn("Instructions");
+        ImGui::TableSetupColumn("Shared");
+        ImGui::TableHeadersRow();
+        
+        for (std::size_t i = 0; i < m_group->GetSize() && i < m_groupEquations.size(); ++i) {
+            const SharingStats& stats = m_group->GetStats(i);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(m_groupEquations[i].c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(stats.treeNodes));
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", stats.instructions);
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", stats.shared);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void ProfilerPanel::DrawTiers() {
+    if (m_tiers.empty()) {
+        return;
+    }
+    ImGui::Separator();
+    ImGui::TextUnformatted("Execution tiers");
+    
+    if (ImGui::BeginTable("##tiers", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Equation");
+        ImGui::TableSetupColumn("Tier");
+        ImGui::TableSetupColumn("Samples");
+        ImGui::TableSetupColumn("ns/sample");
+        ImGui::TableSetupColumn("Before");
+        ImGui::TableHeadersRow();
+        
+        for (const TierRow& row : m_tiers) {
+            const TierStats& stats = row.stats;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(row.equation.c_str());
+            ImGui::TableNextColumn();
+            if (row.grouped) {
+                ImGui::TextUnformatted("group");
+            } else {
+                ImGui::Text("%s%s", GetTierName(stats.tier), stats.promoting ? " (promoting)" : "");
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(stats.samples));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", stats.nanosecondsPerSample);
+            ImGui::TableNextColumn();
+            if (stats.promotedFrom > 0.0) {
+                ImGui::Text("%.1f", stats.promotedFrom);
+            } else {
+                ImGui::TextUnformatted("-");
+            }
+        }
+        ImGui::EndTable();
+    }
+}
+
+void ProfilerPanel::DrawAnimation() {
+    if (!m_playing) {
+        return;
+    }
+    ImGui::Separator();
+    ImGui::Text("Animation: %.1f fps, %zu equations, %.3f ms per frame", m_animation.fps, m_animation.tracks,
+                m_animation.lastSampleMs);
+    if (m_animation.densityLevel > 0) {
+        ImGui::Text("Density: 1/%d (%d points per curve)", 1 << m_animation.densityLevel,
+                    m_animation.pointsPerCurve);
+    } else {
+        ImGui::Text("Density: full (%d points per curve)", m_animation.pointsPerCurve);
+    }
+}
+
+#if defined(PLOT_GENIUS_WITH_PROFILER)
+
+void ProfilerPanel::ToggleTrace() {
+    auto& recorder = core::TraceRecorder::GetInstance();
+    if (recorder.IsRecording()) {
+        recorder.Stop(kTracePath);
+    } else {
+        recorder.Start();
+    }
+}
+
+void ProfilerPanel::DrawStatistics() {
+    auto statistics = core::Profiler::GetInstance().GetStatistics();
+
+    bool recording = core::TraceRecorder::GetInstance().IsRecording();
+    if (ImGui::Button(recording ? "Stop Trace (F4)" : "Record Trace (F4)")) {
+        ToggleTrace();
+    }
+    ImGui::SameLine();
+    ImGui::TextDisabled(recording ? "Recording..." : "Saved to %s", kTracePath);
+
+    if (ImGui::BeginTable("##stages", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Stage");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("Last ms");
+        ImGui::TableSetupColumn("p50 ms");
+        ImGui::TableSetupColumn("p90 ms");
+        ImGui::TableSetupColumn("p99 ms");
+        ImGui::TableSetupColumn("Max ms");
+        ImGui::TableHeadersRow();
+
+        for (const auto& stats : statistics) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            // Selecting a row shows its histogram below
+            if (ImGui::Selectable(stats.name.c_str(), stats.name == m_selectedStage)) {
+                m_selectedStage = stats.name;
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(stats.count));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.lastMs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.p50Ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.p90Ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.p99Ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.maxMs);
+        }
+        ImGui::EndTable();
+    }
+
+    for (const auto& stats : statistics) {
+        if (stats.name != m_selectedStage) {
+            continue;
+        }
+        ImGui::Text("%s: distribution over [0, %.3f] ms", stats.name.c_str(), stats.maxMs);
+        ImGui::PlotHistogram("##histogram", stats.histogram.data(),
+                             static_cast<int>(stats.histogram.size()), 0, nullptr,
+                             0.0f, FLT_MAX, ImVec2(420.0f, 80.0f));
+    }
+
+    auto dropped = core::Profiler::GetInstance().GetDroppedSamples();
+    if (dropped > 0) {
+        ImGui::TextDisabled("Dropped samples: %llu", static_cast<unsigned long long>(dropped));
+    }
+}
+
+#else
+
+void ProfilerPanel::ToggleTrace() {}
+
+void ProfilerPanel::DrawStatistics() {
+    ImGui::TextDisabled("Profiler compiled out (configure with ENABLE_PROFILER in a non-Release build)");
+}
+
+#endif
+
+} // namespace plot_genius
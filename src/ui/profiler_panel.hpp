@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "../equation/program_group.hpp"
+#include "../equation/tiered_program.hpp"
+#include "../graph/animator.hpp"
+
+namespace plot_genius {
+
+// Execution tier of one equation, for the tier table
+struct TierRow {
+    std::string equation;
+    TierStats stats;
+    bool grouped{false};  // Sampled through the shared program group instead
+};
+
+// Overlay showing rolling per-stage frame timings from core::Profiler
+class ProfilerPanel {
+public:
+    ProfilerPanel() = default;
+    ~ProfilerPanel() = default;
+
+    // Handles the toggle keys (F3 overlay, F4 trace) and draws the overlay when visible
+    void Render();
+
+    // Playback figures shown below the stages; cleared when playback stops
+    void SetAnimationStats(const AnimationStats& stats, bool playing) {
+        m_animation = stats;
+        m_playing = playing;
+    }
+
+    // Programs sampled together and the equation of each member, for the sharing table
+    void SetProgramGroup(std::shared_ptr<const ProgramGroup> group, std::vector<std::string> equations) {
+        m_group = std::move(group);
+        m_groupEquations = std::move(equations);
+    }
+
+    // Tier each equation runs on, with the measurements promotion is based on
+    void SetExecutionTiers(std::vector<TierRow> rows) { m_tiers = std::move(rows); }
+
+    void SetVisible(bool visible) { m_visible = visible; }
+    bool IsVisible() const { return m_visible; }
+
+private:
+    void DrawStatistics();
+    void DrawAnimation();
+    void DrawSharing();
+    void DrawTiers();
+
+    // Starts a trace recording, or stops it and writes the trace file
+    void ToggleTrace();
+
+    bool m_visible{false};
+    std::string m_selectedStage{"Frame"};  // Stage whose histogram is shown
+    std::shared_ptr<const ProgramGroup> m_group;
+    std::vector<std::string> m_groupEquations;
+    std::vector<TierRow> m_tiers;
+    AnimationStats m_animation;
+    bool m_playing{false};
+};
+
+} // namespace plot_genius
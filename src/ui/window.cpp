@@ -4,24 +4,100 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <algorithm>
+#include <cmath>
+#include <filesystem>
 
 #include "window.hpp"
+#include "../config/config.hpp"
 #include "../core/logger.hpp"
+#include "../core/profiler.hpp"
+#include "../core/thread_pool.hpp"
+#include "../graph/palette.hpp"
+#include "../graph/sample_ring.hpp"
+#include "../session/session.hpp"
 
 namespace plot_genius {
 
+namespace {
+
+// Frames rendered after each input event; ImGui needs a couple to settle hover
+// and activation state
+constexpr int kFramesAfterInput = 3;
+
+// Upper bound on how long the loop sleeps when nothing happens
+constexpr double kIdleTimeout = 1.0;
+
+// Wake-up interval while a text field is focused, for the cursor blink
+constexpr double kTextInputTimeout = 0.5;
+
+// Points generated per equation
+constexpr int kPointsPerEquation = 200;
+
+// Finest adaptive subdivision, relative to the canvas width
+constexpr int kAdaptiveCellsPerPixel = 2;
+
+// Curves are sampled this fraction of the view width beyond either side, so the strips a pan
+// exposes are drawn from sampled points and the resample for the new view keeps the cached plot
+constexpr double kSampleMargin = 0.25;
+
+// Time the view must rest before approximated curves are sampled exactly
+constexpr double kViewSettleSeconds = 0.25;
+
+// Proxies are fitted to a quarter pixel and used while still within half a pixel,
+// so zooming in by up to 2x keeps using them
+constexpr double kProxyFitPixels = 0.25;
+constexpr double kProxyMaxPixels = 0.5;
+
+// Opacity of the individual curves of a swept family
+constexpr std::uint32_t kFamilyMemberAlpha = 96;
+
+// Opacity of derivative curves, drawn in their equation's color
+constexpr std::uint32_t kDerivativeAlpha = 144;
+
+// Shared-memory export: 256 blocks of up to 4096 points (16 MiB)
+constexpr std::uint32_t kSampleRingSlots = 256;
+constexpr std::uint32_t kSampleRingSlotPoints = 4096;
+
+// Number of points to sample over the view and its margins for a density of viewPoints over the view
+int WithMargins(int viewPoints) {
+    return static_cast<int>(std::ceil(viewPoints * (1.0 + 2.0 * kSampleMargin)));
+}
+
+// Converts sampled points to the graph panel's format
+void ConvertPoints(const std::vector<Point>& from, std::vector<GraphPoint>& to) {
+    to.clear();
+    to.reserve(from.size());
+    for (const auto& point : from) {
+        to.push_back({static_cast<float>(point.x), static_cast<float>(point.y)});
+    }
+}
+
+void MarkActivity(GLFWwindow* glfwWindow) {
+    if (auto* window = static_cast<Window*>(glfwGetWindowUserPointer(glfwWindow))) {
+        window->RequestFrames(kFramesAfterInput);
+    }
+}
+
+} // namespace
+
 Window::Window()
     : m_window(nullptr)
     , m_graphPanel(std::make_unique<GraphPanel>())
     , m_equationPanel(std::make_unique<EquationPanel>())
-    , m_configPanel(std::make_unique<ConfigPanel>()) {}
+    , m_configPanel(std::make_unique<ConfigPanel>())
+    , m_profilerPanel(std::make_unique<ProfilerPanel>()) {}
 
 Window::~Window() {
     Shutdown();
 }
 
 void Window::Shutdown() {
+    // Jobs in flight post window events on completion, so drain them first
+    m_sampler.reset();
+    m_animator.reset();
+    
     if (m_window) {
+        m_graphPanel->Shutdown();
         ImGui_ImplOpenGL3_Shutdown();
         ImGui_ImplGlfw_Shutdown();
         ImGui::DestroyContext();
@@ -60,6 +136,10 @@ bool Window::Initialize() {
     glfwMakeContextCurrent(m_window);
     glfwSwapInterval(1); // Enable vsync
     
+    // Installed before ImGui so its GLFW backend chains to them
+    glfwSetWindowUserPointer(m_window, this);
+    InstallActivityCallbacks();
+    
     // Initialize GLAD
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
         core::Logger::GetInstance().Log(core::LogLevel::Error, "Failed to initialize GLAD");
@@ -85,6 +165,30 @@ bool Window::Initialize() {
         core::Logger::GetInstance().Log(core::LogLevel::Error, "Failed to initialize ImGui OpenGL3 implementation");
         return false;
     }
+    
+    // Set ImGui style
+    ImGui::StyleColorsDark();
+    ImGui::GetStyle().WindowRounding = 0.0f;
+    ImGui::GetStyle().FrameRounding = 4.0f;
+    ImGui::GetStyle().GrabRounding = 4.0f;
+    
+    // Sample on the worker pool and wake the main loop when points are ready
+    m_sampler = std::make_unique<Sampler>(core::ThreadPool::GetInstance());
+    m_sampler->SetCompletionCallback([] { glfwPostEmptyEvent(); });
+    m_animator = std::make_unique<Animator>(core::ThreadPool::GetInstance());
+
+    // Optionally mirror every sampling result into shared memory for other processes
+    const std::string& sampleExport = config::Config::GetInstance().GetUISettings().sampleExport;
+    if (!sampleExport.empty()) {
+        auto ring = std::make_shared<SampleRingWriter>();
+        std::string error;
+        if (ring->Create(sampleExport, kSampleRingSlots, kSampleRingSlotPoints, error)) {
+            m_sampler->SetSampleRing(std::move(ring));
+            PLOT_GENIUS_LOG_INFO("Exporting samples to shared memory {}", sampleExport);
+        } else {
+            PLOT_GENIUS_LOG_WARNING("Sample export disabled: {}", error);
+        }
+    }
 
     // Set up initial graph config
     GraphConfig defaultConfig;
@@ -95,6 +199,8 @@ bool Window::Initialize() {
     defaultConfig.xAxisScaling = 1.0f;       // Fixed value for X sensitivity
     defaultConfig.yAxisScaling = 0.01f;      // Fixed value for Y sensitivity
     m_graphPanel->SetConfig(defaultConfig);
+    
+    m_profilerPanel->SetVisible(config::Config::GetInstance().GetUISettings().showProfiler);
 
     // Set up panel callbacks
     m_equationPanel->SetEquationCallback([this](const std::string& equation) {
@@ -108,15 +214,47 @@ bool Window::Initialize() {
         RemoveEquation(id);
     });
 
+    // Moving a slider only resamples; programs look parameters up by name
+    m_equationPanel->SetParameterTable(&m_parameters);
+    m_equationPanel->SetParameterCallback([this]() {
+        UpdateActiveGraphPoints();
+    });
+    m_equationPanel->SetPlaybackCallback([this](bool playing) {
+        SetPlaying(playing);
+    });
+    m_equationPanel->SetPrecisionCallback([this](const std::string& equation,
+                                                 std::optional<MathPrecision> precision) {
+        for (auto& pair : m_equations) {
+            if (pair.second.equation == equation) {
+                pair.second.precision = precision;
+            }
+        }
+        ApplyMathPrecision();
+    });
+
     m_graphPanel->SetViewCallback([this](float minX, float maxX, float minY, float maxY) {
         // Regenerate points for all active equations with the new view
-        UpdateActiveGraphPoints();
+        m_viewMoving = true;
+        m_lastViewChange = glfwGetTime();
+        UpdateActiveGraphPoints(true);
     });
     
     // Set up config callback
     m_configPanel->SetConfigCallback([this](const GraphConfig& config) {
         m_graphPanel->SetConfig(config);
+        if (config.sampleMode != m_sampleMode || config.derivativeOrder != m_derivativeOrder ||
+            config.showCriticalPoints != m_criticalPoints) {
+            m_sampleMode = config.sampleMode;
+            m_derivativeOrder = config.derivativeOrder;
+            m_criticalPoints = config.showCriticalPoints;
+            UpdateActiveGraphPoints();
+        }
+        if (config.mathPrecision != m_mathPrecision) {
+            m_mathPrecision = config.mathPrecision;
+            ApplyMathPrecision();
+        }
     });
+    PLOT_GENIUS_LOG_INFO("Fast math kernels use {}", GetFastMathTarget());
 
     // No default equation - let user add one
     
@@ -125,99 +263,103 @@ bool Window::Initialize() {
 }
 
 void Window::Render() {
+    // Pick up points finished by the sampler since the last frame
+    ApplySampleResults();
+    AdvanceAnimation();
+    SettleView();
+    
     // Clear the framebuffer
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
     
-    ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
-    ImGui::NewFrame();
-    
-    // Set ImGui style
-    ImGui::StyleColorsDark();
-    ImGui::GetStyle().WindowRounding = 0.0f;
-    ImGui::GetStyle().FrameRounding = 4.0f;
-    ImGui::GetStyle().GrabRounding = 4.0f;
-    
-    // Get display size
-    ImVec2 displaySize = ImGui::GetIO().DisplaySize;
-    
-    // Calculate panel sizes
-    // Sidebar widths (equal on both sides)
-    const float minSidebarWidth = 200.0f;
-    const float maxGraphWidth = displaySize.x * 0.75f; // Max 75% for graph
-    const float minGraphWidth = displaySize.x * 0.5f;  // Min 50% for graph
-    
-    // Calculate graph size (should be square)
-    float graphSize = std::min(displaySize.y, maxGraphWidth); // Start with max possible square
-    graphSize = std::max(graphSize, minGraphWidth); // Ensure minimum width
-    
-    // Calculate sidebar widths based on remaining space
-    float remainingWidth = displaySize.x - graphSize;
-    float sidebarWidth = remainingWidth / 2.0f;
-    
-    // Ensure minimum sidebar width
-    if (sidebarWidth < minSidebarWidth) {
-        sidebarWidth = minSidebarWidth;
-        // Recalculate graph width
-        graphSize = displaySize.x - (sidebarWidth * 2.0f);
-    }
-    
-    // -------------------- LEFT PANEL (EQUATIONS) --------------------
-    ImGui::SetNextWindowPos(ImVec2(0, 0));
-    ImGui::SetNextWindowSize(ImVec2(sidebarWidth, displaySize.y));
-    ImGuiWindowFlags leftPanelFlags = ImGuiWindowFlags_NoCollapse | 
+    {
+        // Everything up to ImGui::Render builds draw lists, including plot cache redraws
+        PLOT_GENIUS_PROFILE_SCOPE("Build UI");
+        
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+        
+        // Get display size
+        ImVec2 displaySize = ImGui::GetIO().DisplaySize;
+        
+        // Calculate panel sizes
+        // Sidebar widths (equal on both sides)
+        const float minSidebarWidth = 200.0f;
+        const float maxGraphWidth = displaySize.x * 0.75f; // Max 75% for graph
+        const float minGraphWidth = displaySize.x * 0.5f;  // Min 50% for graph
+        
+        // Calculate graph size (should be square)
+        float graphSize = std::min(displaySize.y, maxGraphWidth); // Start with max possible square
+        graphSize = std::max(graphSize, minGraphWidth); // Ensure minimum width
+        
+        // Calculate sidebar widths based on remaining space
+        float remainingWidth = displaySize.x - graphSize;
+        float sidebarWidth = remainingWidth / 2.0f;
+        
+        // Ensure minimum sidebar width
+        if (sidebarWidth < minSidebarWidth) {
+            sidebarWidth = minSidebarWidth;
+            // Recalculate graph width
+            graphSize = displaySize.x - (sidebarWidth * 2.0f);
+        }
+        
+        // -------------------- LEFT PANEL (EQUATIONS) --------------------
+        ImGui::SetNextWindowPos(ImVec2(0, 0));
+        ImGui::SetNextWindowSize(ImVec2(sidebarWidth, displaySize.y));
+        ImGuiWindowFlags leftPanelFlags = ImGuiWindowFlags_NoCollapse | 
+                                         ImGuiWindowFlags_NoMove |
+                                         ImGuiWindowFlags_NoResize;
+        
+        if (ImGui::Begin("Equations", nullptr, leftPanelFlags)) {
+            m_equationPanel->Render();
+        }
+        ImGui::End();
+        
+        // -------------------- CENTER PANEL (GRAPH) --------------------
+        ImGui::SetNextWindowPos(ImVec2(sidebarWidth, 0));
+        ImGui::SetNextWindowSize(ImVec2(graphSize, displaySize.y));
+        ImGuiWindowFlags graphFlags = ImGuiWindowFlags_NoCollapse | 
                                      ImGuiWindowFlags_NoMove |
                                      ImGuiWindowFlags_NoResize;
-    
-    if (ImGui::Begin("Equations", nullptr, leftPanelFlags)) {
-        m_equationPanel->Render();
-    }
-    ImGui::End();
-    
-    // -------------------- CENTER PANEL (GRAPH) --------------------
-    ImGui::SetNextWindowPos(ImVec2(sidebarWidth, 0));
-    ImGui::SetNextWindowSize(ImVec2(graphSize, displaySize.y));
-    ImGuiWindowFlags graphFlags = ImGuiWindowFlags_NoCollapse | 
-                                 ImGuiWindowFlags_NoMove |
-                                 ImGuiWindowFlags_NoResize;
-    
-    if (ImGui::Begin("Graph", nullptr, graphFlags)) {
-        m_graphPanel->Render();
-    }
-    ImGui::End();
-    
-    // -------------------- RIGHT PANEL (CONFIG) --------------------
-    ImGui::SetNextWindowPos(ImVec2(sidebarWidth + graphSize, 0));
-    ImGui::SetNextWindowSize(ImVec2(sidebarWidth, displaySize.y));
-    ImGuiWindowFlags rightPanelFlags = ImGuiWindowFlags_NoCollapse | 
-                                      ImGuiWindowFlags_NoMove |
-                                      ImGuiWindowFlags_NoResize;
-    
-    // Config panel
-    if (ImGui::Begin("Configuration", nullptr, rightPanelFlags)) {
-        m_configPanel->Render();
-    }
-    ImGui::End();
-    
-    // Check if we should reset the graph view
-    if (m_configPanel->ShouldResetGraphView()) {
-        m_graphPanel->ResetView();
-        core::Logger::GetInstance().Log(core::LogLevel::Info, "Graph view reset");
-        m_configPanel->ClearResetFlag();
+        
+        if (ImGui::Begin("Graph", nullptr, graphFlags)) {
+            m_graphPanel->Render();
+        }
+        ImGui::End();
+        
+        // -------------------- RIGHT PANEL (CONFIG) --------------------
+        ImGui::SetNextWindowPos(ImVec2(sidebarWidth + graphSize, 0));
+        ImGui::SetNextWindowSize(ImVec2(sidebarWidth, displaySize.y));
+        ImGuiWindowFlags rightPanelFlags = ImGuiWindowFlags_NoCollapse | 
+                                          ImGuiWindowFlags_NoMove |
+                                          ImGuiWindowFlags_NoResize;
+        
+        // Config panel
+        if (ImGui::Begin("Configuration", nullptr, rightPanelFlags)) {
+            m_configPanel->Render();
+        }
+        ImGui::End();
+        
+        // Check if we should reset the graph view
+        if (m_configPanel->ShouldResetGraphView()) {
+            m_graphPanel->ResetView();
+            core::Logger::GetInstance().Log(core::LogLevel::Info, "Graph view reset");
+            m_configPanel->ClearResetFlag();
+        }
+        
+        // Optional overlay with per-stage frame timings (F3)
+        if (m_profilerPanel->IsVisible()) {
+            UpdateExecutionTiers();
+        }
+        m_profilerPanel->Render();
     }
-    
+        
     // Process rendering
-    ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-    
-    // Log frame rendering (useful for debugging)
-    static int frameCount = 0;
-    if (frameCount++ % 300 == 0) {
-        core::Logger::GetInstance().Log(core::LogLevel::Debug, 
-            "Layout: Graph=" + std::to_string(graphSize) + 
-            "x" + std::to_string(displaySize.y) +
-            ", Sidebars=" + std::to_string(sidebarWidth));
+    {
+        PLOT_GENIUS_PROFILE_SCOPE("ImGui Render");
+        ImGui::Render();
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
     }
 }
 
@@ -225,6 +367,13 @@ void Window::UpdateGraphPoints(const std::string& equation) {
     if (equation.empty()) return;
     
     try {
+        // Parse into a fresh graph so jobs still sampling the old one are unaffected
+        auto graph = std::make_shared<Graph>();
+        if (!graph->SetEquation(equation)) {
+            PLOT_GENIUS_LOG_ERROR("Failed to parse equation: {}", equation);
+            return;
+        }
+        
         // Find or create an entry for this equation
         int id = -1;
         for (const auto& pair : m_equations) {
@@ -239,79 +388,286 @@ void Window::UpdateGraphPoints(const std::string& equation) {
             id = m_equations.empty() ? 0 : m_equations.rbegin()->first + 1;
             m_equations[id] = EquationGraph{};
             m_equations[id].equation = equation;
-            m_equations[id].graph = std::make_unique<Graph>();
-            m_equations[id].isActive = true;
+            m_equations[id].color = GraphPanel::GetDefaultEquationColor(id);
+        }
+        
+        // New parameters get a slider with default value and range
+        for (const auto& name : graph->GetProgram().GetParameters()) {
+            m_parameters.Bind(name);
         }
         
-        // Set equation and generate points
         EquationGraph& eqGraph = m_equations[id];
-        if (eqGraph.graph->SetEquation(equation)) {
-            // Generate graph points
-            auto points = eqGraph.graph->GeneratePoints(
-                m_graphPanel->GetViewMinX(), 
-                m_graphPanel->GetViewMaxX(), 
-                200
-            );
-            
-            // Convert to GraphPoint format
-            eqGraph.points.clear();
-            for (const auto& point : points) {
-                eqGraph.points.push_back({static_cast<float>(point.x), static_cast<float>(point.y)});
-            }
+        graph->SetPrecision(eqGraph.precision.value_or(m_mathPrecision));
+        eqGraph.graph = std::move(graph);
+        eqGraph.proxy.reset();
+        eqGraph.isActive = true;
+        
+        m_graphPanel->SetEquation(equation, eqGraph.color); // Display the most recently added equation
+        
+        // Points arrive asynchronously through ApplySampleResults
+        UpdateActiveGraphPoints();
+        
+        PLOT_GENIUS_LOG_INFO("Sampling equation: {}", equation);
+    } catch (const std::exception& e) {
+        PLOT_GENIUS_LOG_ERROR("Failed to generate graph: {}", e.what());
+    }
+}
+
+void Window::UpdateActiveGraphPoints(bool viewChanged) {
+    PLOT_GENIUS_PROFILE_SCOPE("Request Sampling");
+    
+    // Regenerate points for all active equations with the current view
+    SampleRequest request;
+    GetSampleRange(request.xMin, request.xMax);
+    request.mode = m_sampleMode;
+    
+    // Adaptive and range sampling resolve the plot to a pixel
+    const int columns = std::max(static_cast<int>(m_graphPanel->GetCanvasWidth()), 1);
+    switch (m_sampleMode) {
+        case SampleMode::Uniform:
+            request.numPoints = WithMargins(kPointsPerEquation);
+            break;
+        case SampleMode::Adaptive:
+            request.numPoints = WithMargins(columns * kAdaptiveCellsPerPixel);
+            break;
+        case SampleMode::Range:
+            request.numPoints = WithMargins(columns);
+            break;
+    }
+    request.yTolerance = (m_graphPanel->GetViewMaxY() - m_graphPanel->GetViewMinY()) /
+                         std::max(m_graphPanel->GetCanvasHeight(), 1.0f);
+    request.derivativeOrder = m_derivativeOrder;
+    request.criticalPoints = m_criticalPoints;
+    request.interactive = viewChanged && m_viewMoving;
+    m_resampleOnSettle = false;
+    
+    AnimationTrack track;
+    for (const auto& pair : m_equations) {
+        if (GetAnimationTrack(pair.first, pair.second, track)) {
+            continue;  // Sampled every frame while playing
+        }
+        if (pair.second.isActive && pair.second.graph) {
+            const Program& program = pair.second.graph->GetProgram();
+            SampleRequest::Entry entry;
+            entry.id = pair.first;
+            entry.graph = pair.second.graph;
+            m_parameters.Resolve(program, entry.parameters);
             
-            // Collect points from all active equations
-            std::vector<std::vector<GraphPoint>> allEquationPoints;
-            for (const auto& pair : m_equations) {
-                if (pair.second.isActive) {
-                    allEquationPoints.push_back(pair.second.points);
+            // The first swept parameter turns the equation into a family
+            const auto& names = program.GetParameters();
+            for (std::size_t i = 0; i < names.size(); ++i) {
+                const ParameterBinding* binding = m_parameters.Find(names[i]);
+                if (binding && binding->sweepMembers > 0) {
+                    entry.sweep = {static_cast<std::uint32_t>(i), binding->sweepMembers, binding->min, binding->max};
+                    entry.envelope = binding->envelope;
+                    break;
                 }
             }
-            
-            // Update the graph panel with the points from all active equations
-            m_graphPanel->SetMultipleEquationPoints(allEquationPoints);
-            m_graphPanel->SetEquation(equation); // Display the most recently added equation
-            
-            // Log success
-            std::string message = "Generated " + std::to_string(eqGraph.points.size()) + 
-                                  " points for equation: " + equation;
-            core::Logger::GetInstance().Log(core::LogLevel::Info, message);
-        } else {
-            core::Logger::GetInstance().Log(core::LogLevel::Error, "Failed to parse equation: " + equation);
+            if (entry.sweep.members == 0 && m_sampleMode == SampleMode::Uniform &&
+                EstimateEvaluationCost(program) >= kMinProxyCost) {
+                SetProxy(pair.second.proxy, request, entry);
+            }
+            request.entries.push_back(std::move(entry));
         }
-    } catch (const std::exception& e) {
-        std::string message = "Failed to generate graph: ";
-        message += e.what();
-        core::Logger::GetInstance().Log(core::LogLevel::Error, message);
+    }
+    
+    SyncAnimationTracks();
+    if (request.entries.empty()) {
+        PublishPoints(viewChanged);
+        return;
+    }
+    GroupEntries(request);
+    
+    // Link this frame to the sampling job in recorded traces
+    request.traceFlow = viewChanged ? PLOT_GENIUS_TRACE_FLOW_BEGIN("View Change")
+                                    : PLOT_GENIUS_TRACE_FLOW_BEGIN("Equation Change");
+    
+    std::uint64_t generation = m_sampler->Request(std::move(request));
+    if (!viewChanged) {
+        // Remember that the plot content changes once this generation lands
+        m_pendingContentGeneration = generation;
     }
 }
 
-void Window::UpdateActiveGraphPoints() {
-    // Regenerate points for all active equations with the current view
-    std::vector<std::vector<GraphPoint>> allEquationPoints;
+void Window::GetSampleRange(double& xMin, double& xMax) const {
+    const double viewMinX = m_graphPanel->GetViewMinX();
+    const double viewMaxX = m_graphPanel->GetViewMaxX();
+    const double margin = (viewMaxX - viewMinX) * kSampleMargin;
+    xMin = viewMinX - margin;
+    xMax = viewMaxX + margin;
+}
+
+void Window::SetProxy(const std::shared_ptr<const ChebyshevProxy>& proxy, const SampleRequest& request,
+                      SampleRequest::Entry& entry) {
+    const bool usable = proxy && proxy->Matches(entry.parameters) && proxy->Covers(request.xMin, request.xMax) &&
+                        proxy->GetTolerance() <= request.yTolerance * kProxyMaxPixels;
+    if (request.interactive) {
+        if (usable) {
+            entry.proxy = proxy;
+        }
+        m_resampleOnSettle = true;
+    } else if (!usable) {
+        entry.proxyTolerance = request.yTolerance * kProxyFitPixels;
+    }
+}
+
+void Window::GroupEntries(SampleRequest& request) {
+    std::vector<std::shared_ptr<const Graph>> graphs;
+    for (const auto& entry : request.entries) {
+        if (entry.sweep.members == 0 && !entry.proxy) {
+            graphs.push_back(entry.graph);
+        }
+    }
+    
+    // A single curve gains nothing from a group
+    if (graphs.size() < 2) {
+        m_group.reset();
+        m_groupGraphs.clear();
+        m_profilerPanel->SetProgramGroup(nullptr, {});
+        return;
+    }
     
+    if (graphs != m_groupGraphs) {
+        std::vector<const Program*> programs;
+        std::vector<std::string> equations;
+        for (const auto& graph : graphs) {
+            programs.push_back(&graph->GetProgram());
+            equations.push_back(graph->GetEquation());
+        }
+        m_group = std::make_shared<const ProgramGroup>(programs);
+        m_groupGraphs = std::move(graphs);
+        m_profilerPanel->SetProgramGroup(m_group, std::move(equations));
+    }
+    
+    int member = 0;
+    for (auto& entry : request.entries) {
+        if (entry.sweep.members == 0 && !entry.proxy) {
+            entry.member = member++;
+        }
+    }
+    request.group = m_group;
+}
+
+void Window::ApplyMathPrecision() {
+    // Sampling jobs may still hold the old graphs, so changed ones are replaced rather than modified
+    bool changed = false;
     for (auto& pair : m_equations) {
-        auto& eqGraph = pair.second;
-        if (eqGraph.isActive) {
-            // Generate points for this equation
-            auto points = eqGraph.graph->GeneratePoints(
-                m_graphPanel->GetViewMinX(), 
-                m_graphPanel->GetViewMaxX(), 
-                200
-            );
-            
-            // Convert to GraphPoint format
-            eqGraph.points.clear();
-            for (const auto& point : points) {
-                eqGraph.points.push_back({static_cast<float>(point.x), static_cast<float>(point.y)});
+        EquationGraph& entry = pair.second;
+        const MathPrecision precision = entry.precision.value_or(m_mathPrecision);
+        if (!entry.graph || entry.graph->GetProgram().GetPrecision() == precision) {
+            continue;
+        }
+        auto graph = std::make_shared<Graph>();
+        graph->SetPrecision(precision);
+        graph->SetProgram(entry.equation, entry.graph->GetProgram());
+        entry.graph = std::move(graph);
+        changed = true;
+    }
+    if (changed) {
+        UpdateActiveGraphPoints();
+    }
+}
+
+void Window::UpdateExecutionTiers() {
+    std::vector<TierRow> rows;
+    for (const auto& pair : m_equations) {
+        const EquationGraph& entry = pair.second;
+        if (!entry.isActive || !entry.graph) {
+            continue;
+        }
+        TierRow row;
+        row.equation = entry.equation;
+        row.stats = entry.graph->GetExecution().GetStats();
+        row.grouped = std::find(m_groupGraphs.begin(), m_groupGraphs.end(), entry.graph) != m_groupGraphs.end();
+        rows.push_back(std::move(row));
+    }
+    m_profilerPanel->SetExecutionTiers(std::move(rows));
+}
+
+void Window::ApplySampleResults() {
+    SampleResult result;
+    if (!m_sampler || !m_sampler->TakeResult(result)) {
+        return;
+    }
+    
+    // Exact points replacing approximated ones change what is drawn even where the view did not move
+    bool replacesApproximation = false;
+    for (auto& curve : result.curves) {
+        auto it = m_equations.find(curve.id);
+        if (it == m_equations.end()) {
+            continue;  // Removed while it was being sampled
+        }
+        
+        replacesApproximation = replacesApproximation || (it->second.approximate && !curve.approximate);
+        it->second.approximate = curve.approximate;
+        ConvertPoints(curve.points, it->second.points);
+        ConvertPoints(curve.upper, it->second.upper);
+        it->second.members.resize(curve.members.size());
+        for (std::size_t i = 0; i < curve.members.size(); ++i) {
+            ConvertPoints(curve.members[i], it->second.members[i]);
+        }
+        ConvertPoints(curve.derivative, it->second.derivative);
+        ConvertPoints(curve.roots, it->second.roots);
+        ConvertPoints(curve.extrema, it->second.extrema);
+        if (curve.proxy) {
+            it->second.proxy = std::move(curve.proxy);
+        }
+    }
+    
+    m_hasSamples = true;
+    m_sampledXMin = result.xMin;
+    m_sampledXMax = result.xMax;
+    m_sampledMode = result.mode;
+    
+    // Results older than the last content change only reflect a moved view
+    bool viewChanged = !replacesApproximation;
+    if (m_pendingContentGeneration != 0 && result.generation >= m_pendingContentGeneration) {
+        viewChanged = false;
+        m_pendingContentGeneration = 0;
+    }
+    PublishPoints(viewChanged);
+}
+
+void Window::PublishPoints(bool viewChanged) {
+    // Collect points from all active equations
+    std::vector<std::vector<GraphPoint>> allEquationPoints;
+    std::vector<ImU32> colors;
+    std::vector<GraphBand> bands;
+    std::vector<GraphMarker> markers;
+    for (const auto& pair : m_equations) {
+        const EquationGraph& entry = pair.second;
+        if (!entry.isActive) {
+            continue;
+        }
+        if (!entry.upper.empty()) {
+            bands.push_back({entry.points, entry.upper, entry.color});
+        } else if (!entry.members.empty()) {
+            for (const auto& member : entry.members) {
+                allEquationPoints.push_back(member);
+                colors.push_back(WithAlpha(entry.color, kFamilyMemberAlpha));
             }
-            
-            // Add points to collection
-            allEquationPoints.push_back(eqGraph.points);
+        } else {
+            allEquationPoints.push_back(entry.points);
+            colors.push_back(entry.color);
+        }
+        
+        if (!entry.derivative.empty()) {
+            allEquationPoints.push_back(entry.derivative);
+            colors.push_back(WithAlpha(entry.color, kDerivativeAlpha));
+        }
+        for (const auto& root : entry.roots) {
+            markers.push_back({root.x, root.y, entry.color, true});
+        }
+        for (const auto& extremum : entry.extrema) {
+            markers.push_back({extremum.x, extremum.y, entry.color, false});
         }
     }
     
-    // Update the graph panel with all active points
-    m_graphPanel->SetMultipleEquationPoints(allEquationPoints);
+    // Update the graph panel with the points from all active equations
+    m_graphPanel->SetBands(bands);
+    m_graphPanel->SetMarkers(markers);
+    m_graphPanel->SetMultipleEquationPoints(allEquationPoints, colors, viewChanged,
+                                            static_cast<float>(m_sampledXMin), static_cast<float>(m_sampledXMax));
 }
 
 void Window::RemoveEquation(int id) {
@@ -323,22 +679,331 @@ void Window::RemoveEquation(int id) {
         
         // Remove from our collection
         m_equations.erase(it);
+        RemoveUnusedParameters();
+        SyncAnimationTracks();
         
-        // Update active graph points
-        UpdateActiveGraphPoints();
+        // The remaining curves are unchanged, so no resampling is needed
+        PublishPoints(false);
         
         // Also remove from the graph panel's equation list
         m_graphPanel->RemoveEquation(equationText);
     }
 }
 
+void Window::RemoveUnusedParameters() {
+    std::vector<const Program*> programs;
+    for (const auto& pair : m_equations) {
+        if (pair.second.graph) {
+            programs.push_back(&pair.second.graph->GetProgram());
+        }
+    }
+    m_parameters.RemoveUnused(programs);
+}
+
+bool Window::GetAnimationTrack(int id, const EquationGraph& entry, AnimationTrack& track) const {
+    if (!m_playing || !entry.isActive || !entry.graph) {
+        return false;
+    }
+    
+    // Families keep their time fixed; animating every member is left to the sampler
+    const Program& program = entry.graph->GetProgram();
+    const auto& names = program.GetParameters();
+    auto time = std::find(names.begin(), names.end(), kTimeParameter);
+    if (time == names.end()) {
+        return false;
+    }
+    for (const auto& name : names) {
+        const ParameterBinding* binding = m_parameters.Find(name);
+        if (binding && binding->sweepMembers > 0) {
+            return false;
+        }
+    }
+    
+    track.id = id;
+    track.graph = entry.graph;
+    track.timeParameter = static_cast<std::uint32_t>(time - names.begin());
+    m_parameters.Resolve(program, track.parameters);
+    return true;
+}
+
+void Window::SyncAnimationTracks() {
+    std::vector<AnimationTrack> tracks;
+    AnimationTrack track;
+    for (const auto& pair : m_equations) {
+        if (GetAnimationTrack(pair.first, pair.second, track)) {
+            tracks.push_back(track);
+        }
+    }
+    double xMin = 0.0;
+    double xMax = 0.0;
+    GetSampleRange(xMin, xMax);
+    m_animator->SetGrid(xMin, xMax, WithMargins(kPointsPerEquation));
+    m_animator->SetTracks(std::move(tracks));
+}
+
+void Window::SetPlaying(bool playing) {
+    if (m_playing == playing) {
+        return;
+    }
+    m_playing = playing;
+    m_equationPanel->SetPlaying(playing);
+    m_animator->Reset();
+    m_profilerPanel->SetAnimationStats(m_animator->GetStats(), playing);
+    
+    if (playing) {
+        // Static equations keep their points; only the animated ones move
+        m_lastAnimationTime = glfwGetTime();
+        SyncAnimationTracks();
+        RequestFrames(1);
+    } else {
+        // Curves may have been drawn with fewer points, so sample them in full again
+        SyncAnimationTracks();
+        UpdateActiveGraphPoints();
+    }
+}
+
+void Window::AdvanceAnimation() {
+    if (!m_playing) {
+        return;
+    }
+    
+    ParameterBinding* time = nullptr;
+    for (auto& binding : m_parameters.GetBindings()) {
+        if (binding.name == kTimeParameter) {
+            time = &binding;
+        }
+    }
+    if (!time) {
+        SetPlaying(false);  // The last equation using t was removed
+        return;
+    }
+    
+    // Advance by wall-clock time, looping over the slider range
+    double now = glfwGetTime();
+    time->value += now - m_lastAnimationTime;
+    m_lastAnimationTime = now;
+    if (time->value > time->max) {
+        double span = time->max - time->min;
+        time->value = span > 0.0 ? time->min + std::fmod(time->value - time->min, span) : time->min;
+    }
+    
+    if (m_animator->HasTracks()) {
+        m_animator->SetFrameBudget(config::Config::GetInstance().GetUISettings().animationBudgetMs);
+        std::vector<SampleResult::Curve> curves;
+        m_animator->Sample(time->value, curves);
+        for (const auto& curve : curves) {
+            auto it = m_equations.find(curve.id);
+            if (it != m_equations.end()) {
+                ConvertPoints(curve.points, it->second.points);
+                it->second.upper.clear();
+                it->second.members.clear();
+                it->second.derivative.clear();
+                it->second.roots.clear();
+                it->second.extrema.clear();
+            }
+        }
+        PublishPoints(false);
+    }
+    
+    m_profilerPanel->SetAnimationStats(m_animator->GetStats(), true);
+    RequestFrames(1);
+}
+
+void Window::SettleView() {
+    if (!m_viewMoving) {
+        return;
+    }
+    if (glfwGetTime() - m_lastViewChange < kViewSettleSeconds) {
+        RequestFrames(1);  // Keep the loop awake to notice the view coming to rest
+        return;
+    }
+    m_viewMoving = false;
+    if (m_resampleOnSettle) {
+        UpdateActiveGraphPoints(true);
+    }
+}
+
+bool Window::LoadSession(const std::string& path) {
+    PLOT_GENIUS_PROFILE_SCOPE("Load Session");
+    
+    session::SessionReader reader;
+    if (!reader.Open(path)) {
+        // A missing file just means there is nothing to restore
+        if (std::filesystem::exists(path)) {
+            PLOT_GENIUS_LOG_WARNING("Ignoring session: {}", reader.GetLastError());
+        }
+        return false;
+    }
+    
+    session::ViewRange view = reader.GetView();
+    m_graphPanel->SetView(static_cast<float>(view.xMin), static_cast<float>(view.xMax),
+                          static_cast<float>(view.yMin), static_cast<float>(view.yMax));
+    
+    // Stored points are only usable if they were sampled for the restored view
+    double sampleXMin = 0.0;
+    double sampleXMax = 0.0;
+    double viewXMin = 0.0;
+    double viewXMax = 0.0;
+    GetSampleRange(viewXMin, viewXMax);
+    bool samplesMatchView = reader.GetSampleRange(sampleXMin, sampleXMax) &&
+                            sampleXMin == viewXMin && sampleXMax == viewXMax &&
+                            m_sampleMode == SampleMode::Uniform;  // Stored samples are always uniform
+    
+    // Programs come straight from the file; nothing is parsed
+    m_equations.clear();
+    m_parameters = ParameterTable();
+    for (const auto& binding : reader.GetParameters()) {
+        m_parameters.Set(binding);
+    }
+    bool needsSampling = false;
+    std::vector<session::SamplePoint> samples;
+    for (std::size_t i = 0; i < reader.GetEquationCount(); ++i) {
+        std::string text(reader.GetText(i));
+        session::EquationStyle style = reader.GetStyle(i);
+        
+        auto graph = std::make_shared<Graph>();
+        graph->SetPrecision(style.precision.value_or(m_mathPrecision));
+        graph->SetProgram(text, reader.GetProgram(i));
+        
+        EquationGraph& entry = m_equations[static_cast<int>(i)];
+        entry.equation = text;
+        entry.graph = std::move(graph);
+        entry.color = style.color;
+        entry.isActive = style.visible;
+        entry.precision = style.precision;
+        
+        if (style.visible) {
+            reader.GetSamples(i, samples);
+            if (samplesMatchView && !samples.empty()) {
+                entry.points.reserve(samples.size());
+                for (const auto& sample : samples) {
+                    entry.points.push_back({sample.x, sample.y});
+                }
+            } else {
+                needsSampling = true;
+            }
+            m_graphPanel->SetEquation(text, style.color);
+        }
+        m_equationPanel->RestoreEquation(text, style.visible, style.precision);
+    }
+    
+    if (samplesMatchView) {
+        m_hasSamples = true;
+        m_sampledXMin = sampleXMin;
+        m_sampledXMax = sampleXMax;
+        m_sampledMode = SampleMode::Uniform;
+    }
+    
+    SyncAnimationTracks();
+    PublishPoints(false);
+    if (needsSampling) {
+        UpdateActiveGraphPoints();
+    }
+    
+    PLOT_GENIUS_LOG_INFO("Restored {} equations from {}", m_equations.size(), path);
+    return true;
+}
+
+bool Window::SaveSession(const std::string& path, bool includeSamples) const {
+    PLOT_GENIUS_PROFILE_SCOPE("Save Session");
+    
+    session::SessionWriter writer;
+    writer.SetParameters(m_parameters.GetBindings());
+    writer.SetView({m_graphPanel->GetViewMinX(), m_graphPanel->GetViewMaxX(),
+                    m_graphPanel->GetViewMinY(), m_graphPanel->GetViewMaxY()});
+    
+    // Points sampled for an older view would be thrown away on load anyway; only uniform samples are stored
+    double viewXMin = 0.0;
+    double viewXMax = 0.0;
+    GetSampleRange(viewXMin, viewXMax);
+    bool storeSamples = includeSamples && m_hasSamples && m_sampledMode == SampleMode::Uniform &&
+                        m_sampledXMin == viewXMin && m_sampledXMax == viewXMax;
+    if (storeSamples) {
+        writer.SetSampleRange(m_sampledXMin, m_sampledXMax);
+    }
+    
+    std::vector<session::SamplePoint> samples;
+    for (const auto& pair : m_equations) {
+        const EquationGraph& entry = pair.second;
+        if (!entry.graph || entry.graph->GetProgram().IsEmpty()) {
+            continue;
+        }
+        
+        // Families and curves still being animated are resampled on load rather than stored
+        samples.clear();
+        AnimationTrack track;
+        if (storeSamples && entry.isActive && entry.upper.empty() && entry.members.empty() &&
+            !GetAnimationTrack(pair.first, entry, track)) {
+            for (const auto& point : entry.points) {
+                samples.push_back({point.x, point.y});
+            }
+        }
+        session::EquationStyle style;
+        style.color = entry.color;
+        style.visible = entry.isActive;
+        style.precision = entry.precision;
+        writer.AddEquation(entry.equation, style, entry.graph->GetProgram(), samples);
+    }
+    
+    if (!writer.Save(path)) {
+        PLOT_GENIUS_LOG_WARNING("Failed to save session: {}", writer.GetLastError());
+        return false;
+    }
+    return true;
+}
+
+void Window::InstallActivityCallbacks() {
+    // Any input or window change means ImGui has something new to show
+    glfwSetCursorPosCallback(m_window, [](GLFWwindow* w, double, double) { MarkActivity(w); });
+    glfwSetMouseButtonCallback(m_window, [](GLFWwindow* w, int, int, int) { MarkActivity(w); });
+    glfwSetScrollCallback(m_window, [](GLFWwindow* w, double, double) { MarkActivity(w); });
+    glfwSetKeyCallback(m_window, [](GLFWwindow* w, int, int, int, int) { MarkActivity(w); });
+    glfwSetCharCallback(m_window, [](GLFWwindow* w, unsigned int) { MarkActivity(w); });
+    glfwSetWindowFocusCallback(m_window, [](GLFWwindow* w, int) { MarkActivity(w); });
+    glfwSetCursorEnterCallback(m_window, [](GLFWwindow* w, int) { MarkActivity(w); });
+    glfwSetFramebufferSizeCallback(m_window, [](GLFWwindow* w, int, int) { MarkActivity(w); });
+    glfwSetWindowRefreshCallback(m_window, [](GLFWwindow* w) { MarkActivity(w); });
+}
+
+bool Window::WaitForFrame(bool onDemand) {
+    if (!onDemand) {
+        PLOT_GENIUS_PROFILE_SCOPE("Input");
+        glfwPollEvents();
+        return true;
+    }
+    
+    bool sampleReady = m_sampler && m_sampler->HasResult();
+    if (m_framesToRender > 0 || sampleReady) {
+        PLOT_GENIUS_PROFILE_SCOPE("Input");
+        glfwPollEvents();
+    } else {
+        // Nothing to draw: sleep until input arrives or a sampling job posts an
+        // empty event. A focused text field still needs frames for its cursor.
+        bool textInput = ImGui::GetIO().WantTextInput;
+        glfwWaitEventsTimeout(textInput ? kTextInputTimeout : kIdleTimeout);
+        if (textInput) {
+            RequestFrames(1);
+        }
+    }
+    
+    sampleReady = m_sampler && m_sampler->HasResult();
+    if (m_framesToRender > 0) {
+        --m_framesToRender;
+        return true;
+    }
+    return sampleReady;
+}
+
+void Window::RequestFrames(int count) {
+    m_framesToRender = std::max(m_framesToRender, count);
+}
+
 bool Window::ShouldClose() const {
     return glfwWindowShouldClose(m_window);
 }
 
 void Window::SwapBuffers() {
     glfwSwapBuffers(m_window);
-    glfwPollEvents();
 }
 
 void Window::SetTitle(const std::string& title) {
@@ -4,19 +4,33 @@
 #include <memory>
 #include <GLFW/glfw3.h>
 #include <map>
+#include <optional>
+#include "../equation/parameters.hpp"
+#include "../graph/animator.hpp"
 #include "../graph/graph.hpp"
+#include "../graph/sampler.hpp"
 #include "../core/logger.hpp"
 #include "graph_panel.hpp"
 #include "equation_panel.hpp"
 #include "config_panel.hpp"
+#include "profiler_panel.hpp"
 
 namespace plot_genius {
 
 struct EquationGraph {
     std::string equation;
-    std::unique_ptr<Graph> graph;
-    std::vector<GraphPoint> points;
+    std::shared_ptr<Graph> graph;  // Shared with in-flight sampling jobs
+    std::vector<GraphPoint> points;                // Curve, or lower bound of an envelope
+    std::vector<GraphPoint> upper;                 // Upper bound of an envelope
+    std::vector<std::vector<GraphPoint>> members;  // Curves of a swept family
+    std::vector<GraphPoint> derivative;            // Derivative chosen under Analysis, if any
+    std::vector<GraphPoint> roots;
+    std::vector<GraphPoint> extrema;
+    std::shared_ptr<const ChebyshevProxy> proxy;   // Sampled instead of the equation while the view moves
+    std::optional<MathPrecision> precision;        // Overrides the global math precision
+    ImU32 color{0};
     bool isActive{true};
+    bool approximate{false};                       // Points came from the proxy
 };
 
 class Window {
@@ -39,19 +53,56 @@ public:
     // Swap buffers
     void SwapBuffers();
 
+    // Processes events, blocking while idle when on-demand rendering is enabled.
+    // Returns true if a frame should be rendered.
+    bool WaitForFrame(bool onDemand);
+
+    // Requests that at least this many more frames be rendered
+    void RequestFrames(int count);
+
     // Set window title
     void SetTitle(const std::string& title);
 
     // Get graph points
     std::vector<Point> GetGraphPoints() const;
 
+    // Restores equations, view and styles from a session file; stored samples
+    // matching the view are shown without resampling
+    bool LoadSession(const std::string& path);
+
+    // Writes the current equations, view and styles, plus the sampled points if requested
+    bool SaveSession(const std::string& path, bool includeSamples) const;
+
 private:
     void UpdateGraphPoints(const std::string& equation);
-    void UpdateActiveGraphPoints();
+    void UpdateActiveGraphPoints(bool viewChanged = false);
+    // X range sampled for the current view, which reaches kSampleMargin beyond it on either side
+    void GetSampleRange(double& xMin, double& xMax) const;
+    void ApplySampleResults();
+    void PublishPoints(bool viewChanged);
     void RemoveEquation(int id);
+    void RemoveUnusedParameters();
+    // Animated equations are sampled every frame by the animator instead of the sampler
+    bool GetAnimationTrack(int id, const EquationGraph& entry, AnimationTrack& track) const;
+    void SyncAnimationTracks();
+    // Samples an expensive curve from its proxy while the view moves, or asks for a fresh one
+    void SetProxy(const std::shared_ptr<const ChebyshevProxy>& proxy, const SampleRequest& request,
+                  SampleRequest::Entry& entry);
+    // Merges the programs of single curves so shared subexpressions are evaluated once
+    void GroupEntries(SampleRequest& request);
+    // Rebuilds the graphs whose math precision no longer matches their setting
+    void ApplyMathPrecision();
+    // Copies each equation's execution tier into the profiler overlay
+    void UpdateExecutionTiers();
+    void SetPlaying(bool playing);
+    void AdvanceAnimation();
+    // Resamples exactly once the view has stopped moving
+    void SettleView();
+    void InstallActivityCallbacks();
 
     ::GLFWwindow* m_window;  // Store window pointer
     std::map<int, EquationGraph> m_equations;
+    ParameterTable m_parameters;  // Values read whenever sampling is requested
     float m_xMin;
     float m_xMax;
     float m_yMin;
@@ -61,7 +112,37 @@ private:
     std::unique_ptr<GraphPanel> m_graphPanel;
     std::unique_ptr<EquationPanel> m_equationPanel;
     std::unique_ptr<ConfigPanel> m_configPanel;
+    std::unique_ptr<ProfilerPanel> m_profilerPanel;
     bool m_shouldClose;
+
+    // Background sampling
+    std::unique_ptr<Sampler> m_sampler;
+    std::uint64_t m_pendingContentGeneration{0};  // Request that carries new content, 0 if none
+    bool m_hasSamples{false};    // The points below were sampled over [m_sampledXMin, m_sampledXMax]
+    double m_sampledXMin{0.0};
+    double m_sampledXMax{0.0};
+    SampleMode m_sampledMode{SampleMode::Uniform};
+    SampleMode m_sampleMode{SampleMode::Uniform};  // Mode new requests use
+    int m_derivativeOrder{0};                      // Analysis new requests ask for
+    bool m_criticalPoints{false};
+    MathPrecision m_mathPrecision{MathPrecision::Fast};  // Equations without their own precision use this
+
+    // Pan and zoom sample proxies until the view rests for kViewSettleSeconds
+    bool m_viewMoving{false};
+    double m_lastViewChange{0.0};  // glfwGetTime of the latest view change
+    bool m_resampleOnSettle{false};  // Some curve was approximated or lacks a proxy for this view
+
+    // Merged programs of the last request, reused while the same graphs are sampled
+    std::shared_ptr<const ProgramGroup> m_group;
+    std::vector<std::shared_ptr<const Graph>> m_groupGraphs;  // Held so pointers cannot be reused
+
+    // Playback of equations using the time parameter
+    std::unique_ptr<Animator> m_animator;
+    bool m_playing{false};
+    double m_lastAnimationTime{0.0};  // glfwGetTime of the previous animated frame
+
+    // Frames still owed after input so ImGui can settle
+    int m_framesToRender{1};
 };
 
 } // namespace plot_genius 
\ No newline at end of file
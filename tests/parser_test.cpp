@@ -0,0 +1,62 @@
+/**
+ * Parser Test
+ *
+ * Checks that whitespace separates tokens: a function name must be
+ * followed by its parenthesized argument, so sin x is an error rather than
+ * a parameter named sinx, while spaces between tokens are still accepted.
+ */
+
+#include "equation/parser.hpp"
+#include <cmath>
+#include <cstdio>
+
+using plot_genius::EquationParser;
+
+int main() {
+    // Equations that must be rejected
+    const char* const invalid[] = {
+        "y=sin x",
+        "y=cos 2x",
+        "y=sin",
+        "y=2 3",
+        "y=x 2",
+        "y=s in(x)",
+    };
+    // Equations that must parse, with their value at x = 2
+    const struct {
+        const char* equation;
+        double value;
+    } valid[] = {
+        {"y=sin(x)", std::sin(2.0)},
+        {"y= sin (x) ", std::sin(2.0)},
+        {"y=cos( 2 * x )", std::cos(4.0)},
+        {"y=pow(x , 3)", 8.0},
+        {"y=x ^ 2 - 1", 3.0},
+        {"y=- x", -2.0},
+        {"y=d/dx(x^3)", 12.0},
+        {"y=d / dx (x^3)", 12.0},
+        {"y=d2/dx2 (x^3)", 12.0},
+    };
+
+    int failures = 0;
+    for (const char* equation : invalid) {
+        EquationParser parser;
+        if (parser.Parse(equation)) {
+            std::printf("FAIL %s: accepted\n", equation);
+            ++failures;
+        }
+    }
+    for (const auto& check : valid) {
+        EquationParser parser;
+        if (!parser.Parse(check.equation)) {
+            std::printf("FAIL %s: %s\n", check.equation, parser.GetLastError().c_str());
+            ++failures;
+        } else if (std::fabs(parser.Evaluate(2.0) - check.value) > 1e-12) {
+            std::printf("FAIL %s: %.17g, expected %.17g\n", check.equation, parser.Evaluate(2.0), check.value);
+            ++failures;
+        }
+    }
+
+    std::printf("%d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
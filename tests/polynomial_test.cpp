@@ -0,0 +1,92 @@
+/**
+ * Polynomial Rewriting Test
+ *
+ * Compiled programs evaluate the tree RewritePolynomials produces. Checks
+ * that it computes what the parsed tree does, in particular where a
+ * coefficient is NaN or infinite and a rewrite that assumes 0 * c = 0
+ * would turn the result into a number.
+ */
+
+#include "equation/parser.hpp"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+using plot_genius::EquationParser;
+using plot_genius::ExpressionNode;
+using plot_genius::OpCode;
+
+// Evaluates the parsed tree as written, without any rewriting
+double EvaluateTree(const ExpressionNode& node, double x) {
+    switch (node.op) {
+        case OpCode::Constant:
+            return node.value;
+        case OpCode::Variable:
+            return x;
+        case OpCode::Parameter:
+            return plot_genius::kDefaultParameterValue;
+        default:
+            return plot_genius::ApplyOp(node.op, EvaluateTree(*node.left, x),
+                                        node.right ? EvaluateTree(*node.right, x) : 0.0);
+    }
+}
+
+bool Same(double rewritten, double original) {
+    if (std::isnan(rewritten) || std::isnan(original)) {
+        return std::isnan(rewritten) && std::isnan(original);
+    }
+    if (std::isinf(rewritten) || std::isinf(original)) {
+        return rewritten == original;
+    }
+    return std::fabs(rewritten - original) <= 1e-12 * std::fmax(1.0, std::fabs(original));
+}
+
+} // namespace
+
+int main() {
+    const char* const equations[] = {
+        "y=log(-2.43)*(x-x)",
+        "y=(1/0)*(x-x)",
+        "y=(x-x)*(0/0)",
+        "y=(x-x)*log(0)",
+        "y=sqrt(-1)*(2*x-x-x)",
+        "y=(x-x)*(x^2+sqrt(-1))",
+        "y=(x-x)*(x^2+1/0)",
+        "y=(x-x)*(x+1)",
+        "y=(x-x)*a",
+        "y=(1/0)*x^2+x",
+        "y=log(0)*x^3-x+1",
+        "y=(x^2+0/0)*x",
+        "y=3*x^4-2*x^3+x-7",
+        "y=(x-1)^5/(1/0)",
+        "y=(x^2+1)/0",
+        "y=(x^2+1)*(1/0)",
+        "y=(x-x)/a",
+        "y=(x-x)/(1/0)",
+        "y=(2*x^3+x)/(0/0)",
+    };
+    const double xs[] = {-3.0, -1.0, -0.5, 0.0, 0.5, 1.0, 2.0};
+
+    int failures = 0;
+    for (const char* equation : equations) {
+        EquationParser parser;
+        if (!parser.Parse(equation)) {
+            std::printf("FAIL %s: %s\n", equation, parser.GetLastError().c_str());
+            ++failures;
+            continue;
+        }
+        for (double x : xs) {
+            const double rewritten = parser.Evaluate(x);
+            const double original = EvaluateTree(*parser.GetExpression(), x);
+            if (!Same(rewritten, original)) {
+                std::printf("FAIL %s at x = %g: rewritten %.17g, original %.17g\n", equation, x, rewritten,
+                            original);
+                ++failures;
+            }
+        }
+    }
+
+    std::printf("%d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
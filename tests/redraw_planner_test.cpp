@@ -0,0 +1,98 @@
+/**
+ * Redraw Planner Test
+ *
+ * Replays what the graph panel does while the view is dragged: each frame
+ * plans an update of the plot cache for the moved view, and the resample
+ * for that view arrives a few frames later. Curves are sampled with the
+ * window's margin beyond the view, so every update must stay at the size of
+ * the exposed strip and the arriving resample must not force a full redraw.
+ * A pan past the margin before the resample lands must be detected.
+ */
+
+#include "rendering/redraw_planner.hpp"
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+using plot_genius::rendering::RedrawPlanner;
+
+constexpr int kWidth = 800;
+constexpr int kHeight = 600;
+constexpr float kMargin = 0.25f;  // Fraction of the view width sampled beyond either side
+
+// Mirrors GraphPanel: content is redrawn for new data unless it is a resample that leaves no region lacking data
+struct Panel {
+    RedrawPlanner planner;
+    RedrawPlanner::View view{-10.0f, 10.0f, -7.5f, 7.5f};
+    std::uint64_t revision{0};
+
+    void Sample() {
+        const float margin = (view.maxX - view.minX) * kMargin;
+        planner.SetDataRange(view.minX - margin, view.maxX + margin);
+    }
+
+    void Resample() {
+        if (planner.LacksData()) {
+            ++revision;
+        }
+        Sample();
+    }
+
+    std::int64_t Frame() {
+        return planner.Next(kWidth, kHeight, static_cast<float>(kWidth), static_cast<float>(kHeight), view,
+                            revision).redrawPixels;
+    }
+
+    void Pan(int pixelsX, int pixelsY) {
+        const float worldX = pixelsX * (view.maxX - view.minX) / kWidth;
+        const float worldY = pixelsY * (view.maxY - view.minY) / kHeight;
+        view = {view.minX - worldX, view.maxX - worldX, view.minY + worldY, view.maxY + worldY};
+    }
+};
+
+} // namespace
+
+int main() {
+    int failures = 0;
+    auto check = [&](bool holds, const char* what) {
+        if (!holds) {
+            std::printf("FAIL %s\n", what);
+            ++failures;
+        }
+    };
+
+    Panel panel;
+    panel.Sample();
+    check(panel.Frame() == static_cast<std::int64_t>(kWidth) * kHeight, "first frame redraws in full");
+    check(!panel.planner.LacksData(), "first frame has data");
+
+    // Drag 8 pixels a frame each way; the resample for a view lands two frames later
+    const int steps[][2] = {{8, 0}, {-8, 0}, {0, 8}, {0, -8}, {8, 8}};
+    for (const auto& step : steps) {
+        for (int frame = 0; frame < 12; ++frame) {
+            panel.Pan(step[0], step[1]);
+            const std::int64_t strip = static_cast<std::int64_t>(step[0] != 0 ? 8 : 0) * kHeight +
+                                       static_cast<std::int64_t>(step[1] != 0 ? 8 : 0) * kWidth;
+            check(panel.Frame() == strip, "a pan redraws only the exposed strip");
+            if (frame % 2 == 1) {
+                panel.Resample();
+                check(panel.Frame() == 0, "a resample keeps the cached plot");
+            }
+        }
+    }
+    check(!panel.planner.LacksData(), "strips within the margin have data");
+
+    // A pan past the margin before the resample lands exposes a strip without the curve
+    for (int frame = 0; frame < 30; ++frame) {
+        panel.Pan(-8, 0);
+        panel.Frame();
+    }
+    check(panel.planner.LacksData(), "a strip beyond the margin lacks data");
+    panel.Resample();
+    check(panel.Frame() == static_cast<std::int64_t>(kWidth) * kHeight, "the resample then redraws in full");
+    check(!panel.planner.LacksData(), "the full redraw has data");
+
+    std::printf("%d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+/**
+ * Plot Service Client
+ *
+ * Stand-in client for the plot service. Sends the requests given on the
+ * command line (or one per stdin line) pipelined on one connection, prints
+ * one line per response and optionally saves the payloads:
+ *
+ *     plot_genius_client --out plots 1 png -10 10 -2 2 800 600 y=sin(x)
+ *     plot_genius_client 1 stats
+ */
+
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "service_connection.hpp"
+
+namespace {
+
+const char* kUsage =
+    "Usage: plot_genius_client [--socket PATH] [--out DIR] [REQUEST...]\n"
+    "  --socket PATH  Service socket (default: /tmp/plot_genius.sock)\n"
+    "  --out DIR      Save each payload as DIR/ID.bin|png|svg|txt\n"
+    "Without REQUEST arguments, requests are read from stdin, one per line.\n"
+    "A request is 'ID KIND ARGS...', see plot_genius --daemon --help.\n";
+
+std::string Extension(const std::string& kind) {
+    if (kind == "png" || kind == "svg") {
+        return kind;
+    }
+    return kind == "stats" ? "txt" : "bin";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string socketPath = "/tmp/plot_genius.sock";
+    std::string outputDirectory;
+    std::vector<std::string> requests;
+    std::string request;
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        if ((argument == "--socket" || argument == "--out") && i + 1 < argc) {
+            (argument == "--socket" ? socketPath : outputDirectory) = argv[++i];
+        } else if (argument == "--help") {
+            std::cout << kUsage;
+            return 0;
+        } else {
+            request += (request.empty() ? "" : " ") + argument;
+        }
+    }
+    if (!request.empty()) {
+        requests.push_back(request);
+    } else {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (line.find_first_not_of(" \t\r") != std::string::npos) {
+                requests.push_back(line);
+            }
+        }
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+    plot_genius::tools::ServiceConnection connection;
+    std::string error;
+    if (!connection.Connect(socketPath, error)) {
+        std::cerr << error << '\n';
+        return 1;
+    }
+
+    // Remember each request's kind to name its payload
+    std::unordered_map<std::string, std::string> kinds;
+    for (const std::string& line : requests) {
+        const std::size_t idEnd = line.find(' ');
+        const std::size_t kindEnd = line.find(' ', idEnd + 1);
+        if (idEnd != std::string::npos) {
+            kinds[line.substr(0, idEnd)] = line.substr(idEnd + 1, kindEnd - idEnd - 1);
+        }
+    }
+
+    std::thread sender([&] {
+        for (const std::string& line : requests) {
+            if (!connection.Send(line)) {
+                break;
+            }
+        }
+        connection.FinishSending();
+    });
+
+    int failures = 0;
+    std::size_t answered = 0;
+    plot_genius::tools::Response response;
+    while (answered < requests.size() && connection.Receive(response)) {
+        ++answered;
+        if (!response.ok) {
+            ++failures;
+            std::cout << response.id << " error " << response.payload << '\n';
+            continue;
+        }
+
+        std::cout << response.id << " ok " << response.payload.size() << " bytes in "
+                  << response.serverLatencyUs << " us\n";
+        const std::string& kind = kinds[response.id];
+        if (!outputDirectory.empty()) {
+            const std::string path = outputDirectory + "/" + response.id + "." + Extension(kind);
+            std::ofstream file(path, std::ios::binary);
+            if (!file.write(response.payload.data(), static_cast<std::streamsize>(response.payload.size()))) {
+                std::cerr << "Cannot write " << path << '\n';
+                ++failures;
+            }
+        } else if (kind == "stats") {
+            std::cout << response.payload;
+        }
+    }
+    sender.join();
+
+    if (answered < requests.size()) {
+        std::cerr << "Connection closed after " << answered << " of " << requests.size() << " responses\n";
+        return 1;
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,260 @@
+/**
+ * Plot Service Load Generator
+ *
+ * Opens several connections to the plot service and keeps a fixed number
+ * of requests in flight on each, then reports throughput, the latency seen
+ * by the client and by the service, and the service's own statistics.
+ *
+ * Requests cycle through a pool of distinct equations and a few views, so
+ * the run exercises both cache hits and misses; --equations and --views
+ * control the mix.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "core/latency_histogram.hpp"
+#include "service_connection.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* kUsage =
+    "Usage: plot_genius_loadgen [options]\n"
+    "  --socket PATH      Service socket (default: /tmp/plot_genius.sock)\n"
+    "  --connections N    Concurrent connections (default: 4)\n"
+    "  --requests N       Requests per connection (default: 1000)\n"
+    "  --depth N          Requests in flight per connection (default: 16)\n"
+    "  --kind KIND        samples, png, svg or mix (default: mix)\n"
+    "  --equations N      Distinct equations to cycle through (default: 64)\n"
+    "  --views N          Distinct views to cycle through (default: 4)\n"
+    "  --per-request N    Equations per request (default: 2)\n"
+    "  --points N         Points per equation for samples (default: 1000)\n";
+
+struct Settings {
+    std::string socketPath = "/tmp/plot_genius.sock";
+    std::size_t connections = 4;
+    std::size_t requests = 1000;
+    std::size_t depth = 16;
+    std::string kind = "mix";
+    std::size_t equations = 64;
+    std::size_t views = 4;
+    std::size_t perRequest = 2;
+    std::size_t points = 1000;
+};
+
+struct Totals {
+    std::mutex mutex;
+    plot_genius::core::LatencyHistogram client;
+    plot_genius::core::LatencyHistogram server;
+    std::uint64_t responses{0};
+    std::uint64_t failures{0};
+    std::uint64_t bytes{0};
+    std::string firstError;
+};
+
+std::string Equation(std::size_t index) {
+    static const char* kShapes[] = {"y=sin({k}*x)", "y=x*x/{k}-{k}", "y=cos(x/{k})*exp(-abs(x)/{k})",
+                                    "y=sqrt(abs(x))*{k}/10", "y=tan(x/{k})", "y=log(abs(x)+{k})"};
+    std::string text = kShapes[index % (sizeof(kShapes) / sizeof(kShapes[0]))];
+    const std::string k = std::to_string(index / 6 + 1);
+    for (std::size_t at; (at = text.find("{k}")) != std::string::npos;) {
+        text.replace(at, 3, k);
+    }
+    return text;
+}
+
+std::string MakeRequest(const Settings& settings, std::size_t connection, std::size_t sequence) {
+    const std::size_t serial = connection * settings.requests + sequence;
+    std::string kind = settings.kind;
+    if (kind == "mix") {
+        static const char* kKinds[] = {"samples", "png", "svg"};
+        kind = kKinds[serial % 3];
+    }
+
+    const double span = 10.0 * static_cast<double>(serial % settings.views + 1);
+    std::string line = std::to_string(sequence) + ' ' + kind + ' ' + std::to_string(-span) + ' ' +
+                       std::to_string(span) + ' ';
+    if (kind == "samples") {
+        line += std::to_string(settings.points);
+    } else {
+        line += std::to_string(-span / 2) + ' ' + std::to_string(span / 2) + " 640 480";
+    }
+    for (std::size_t i = 0; i < settings.perRequest; ++i) {
+        line += ' ' + Equation((serial * settings.perRequest + i) % settings.equations);
+    }
+    return line;
+}
+
+/**
+ * Runs one connection: a sender thread keeps `depth` requests in flight and
+ * this thread collects the responses
+ */
+void RunConnection(const Settings& settings, std::size_t index, Totals& totals) {
+    plot_genius::tools::ServiceConnection connection;
+    std::string error;
+    if (!connection.Connect(settings.socketPath, error)) {
+        std::lock_guard<std::mutex> lock(totals.mutex);
+        totals.failures += settings.requests;
+        totals.firstError = error;
+        return;
+    }
+
+    std::mutex mutex;
+    std::condition_variable window;
+    std::size_t inFlight = 0;
+    bool stopped = false;
+    std::unordered_map<std::string, Clock::time_point> sent;
+
+    std::thread sender([&] {
+        for (std::size_t sequence = 0; sequence < settings.requests; ++sequence) {
+            const std::string request = MakeRequest(settings, index, sequence);
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                window.wait(lock, [&] { return stopped || inFlight < settings.depth; });
+                if (stopped) {
+                    break;
+                }
+                ++inFlight;
+                sent[std::to_string(sequence)] = Clock::now();
+            }
+            if (!connection.Send(request)) {
+                break;
+            }
+        }
+        connection.FinishSending();
+    });
+
+    plot_genius::core::LatencyHistogram client;
+    plot_genius::core::LatencyHistogram server;
+    std::uint64_t responses = 0;
+    std::uint64_t failures = 0;
+    std::uint64_t bytes = 0;
+    plot_genius::tools::Response response;
+    while (responses < settings.requests && connection.Receive(response)) {
+        Clock::time_point start;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            start = sent[response.id];
+            sent.erase(response.id);
+            --inFlight;
+        }
+        window.notify_one();
+
+        ++responses;
+        client.Add(Clock::now() - start);
+        if (response.ok) {
+            server.Add(std::chrono::microseconds(response.serverLatencyUs));
+            bytes += response.payload.size();
+        } else {
+            ++failures;
+            std::lock_guard<std::mutex> lock(totals.mutex);
+            if (totals.firstError.empty()) {
+                totals.firstError = response.payload;
+            }
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+    }
+    window.notify_one();
+    sender.join();
+
+    std::lock_guard<std::mutex> lock(totals.mutex);
+    totals.client.Merge(client);
+    totals.server.Merge(server);
+    totals.responses += responses;
+    totals.failures += failures + (settings.requests - responses);
+    totals.bytes += bytes;
+}
+
+bool ParseSettings(int argc, char** argv, Settings& settings) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const std::string value = argv[++i];
+        std::size_t* count = argument == "--connections" ? &settings.connections
+                           : argument == "--requests"    ? &settings.requests
+                           : argument == "--depth"       ? &settings.depth
+                           : argument == "--equations"   ? &settings.equations
+                           : argument == "--views"       ? &settings.views
+                           : argument == "--per-request" ? &settings.perRequest
+                           : argument == "--points"      ? &settings.points
+                                                         : nullptr;
+        if (count) {
+            char* end = nullptr;
+            *count = std::strtoull(value.c_str(), &end, 10);
+            if (*end != '\0' || *count == 0) {
+                return false;
+            }
+        } else if (argument == "--socket") {
+            settings.socketPath = value;
+        } else if (argument == "--kind") {
+            if (value != "samples" && value != "png" && value != "svg" && value != "mix") {
+                return false;
+            }
+            settings.kind = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Settings settings;
+    if (!ParseSettings(argc, argv, settings)) {
+        std::cerr << kUsage;
+        return 2;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    Totals totals;
+    const auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < settings.connections; ++i) {
+        threads.emplace_back(RunConnection, std::cref(settings), i, std::ref(totals));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::printf("%llu responses (%llu failed) in %.3f s over %zu connections, depth %zu: %.0f requests/s, %.1f MB/s\n"
+                "Client latency:  p50 %.3f ms, p99 %.3f ms, max %.3f ms\n"
+                "Service latency: p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+                static_cast<unsigned long long>(totals.responses), static_cast<unsigned long long>(totals.failures),
+                seconds, settings.connections, settings.depth,
+                seconds > 0.0 ? static_cast<double>(totals.responses) / seconds : 0.0,
+                seconds > 0.0 ? static_cast<double>(totals.bytes) / seconds / 1e6 : 0.0,
+                totals.client.PercentileMs(0.5), totals.client.PercentileMs(0.99), totals.client.MaxMs(),
+                totals.server.PercentileMs(0.5), totals.server.PercentileMs(0.99), totals.server.MaxMs());
+    if (!totals.firstError.empty()) {
+        std::printf("First error: %s\n", totals.firstError.c_str());
+    }
+
+    // The service's own view, including its cache hit rates
+    plot_genius::tools::ServiceConnection connection;
+    std::string error;
+    plot_genius::tools::Response response;
+    if (connection.Connect(settings.socketPath, error) && connection.Send("stats stats") &&
+        connection.Receive(response) && response.ok) {
+        std::printf("Service statistics:\n%s", response.payload.c_str());
+    }
+    return totals.failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * Sample Ring Tap
+ *
+ * Stand-in consumer of the shared-memory sample export (ui.sampleExport).
+ * Follows the ring and prints one line per block with its y range, reading
+ * the points in place; blocks the writer reused before they were read are
+ * counted as lost.
+ *
+ *     plot_genius_tap --name /plot_genius_samples
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include "graph/sample_ring.hpp"
+
+int main(int argc, char** argv) {
+    std::string name = "/plot_genius_samples";
+    unsigned long long limit = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string argument = argv[i];
+        if (argument == "--name") {
+            name = argv[i + 1];
+        } else if (argument == "--blocks") {
+            limit = std::strtoull(argv[i + 1], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "Usage: plot_genius_tap [--name NAME] [--blocks N]\n");
+            return 2;
+        }
+    }
+
+    plot_genius::SampleRingReader reader;
+    std::string error;
+    if (!reader.Attach(name, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    // Start with what is still in the ring
+    std::uint64_t next = reader.GetOldest();
+    unsigned long long seen = 0;
+    unsigned long long lost = 0;
+    while (limit == 0 || seen + lost < limit) {
+        double yMin = 0.0;
+        double yMax = 0.0;
+        plot_genius::SampleBlock copy{};
+        const auto status = reader.Read(next, [&](const plot_genius::SampleBlock& block) {
+            copy = block;
+            yMin = INFINITY;
+            yMax = -INFINITY;
+            for (std::size_t i = 0; i < block.count; ++i) {
+                if (std::isfinite(block.points[i].y)) {
+                    yMin = std::fmin(yMin, block.points[i].y);
+                    yMax = std::fmax(yMax, block.points[i].y);
+                }
+            }
+        });
+
+        using Status = plot_genius::SampleRingReader::ReadStatus;
+        if (status == Status::Pending) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        if (status == Status::Overwritten) {
+            // Lapped by the writer: skip to the oldest block still present
+            const std::uint64_t oldest = std::max(next + 1, reader.GetOldest());
+            lost += oldest - next;
+            next = oldest;
+            continue;
+        }
+
+        ++seen;
+        ++next;
+        std::printf("block %llu gen %llu eq %d %.*s: points %u-%u of %u on [%g, %g], y in [%g, %g]\n",
+                    static_cast<unsigned long long>(copy.block), static_cast<unsigned long long>(copy.generation),
+                    copy.equationId, static_cast<int>(copy.equation.size()), copy.equation.data(), copy.firstPoint,
+                    copy.firstPoint + static_cast<unsigned>(copy.count), copy.totalPoints, copy.xMin, copy.xMax,
+                    yMin, yMax);
+        std::fflush(stdout);
+    }
+    std::fprintf(stderr, "%llu blocks read, %llu lost\n", seen, lost);
+    return 0;
+}
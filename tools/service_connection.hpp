@@ -0,0 +1,209 @@
+/**
+ * Service Connection Header
+ *
+ * Client side of the plot service protocol, shared by the stand-in client
+ * and the load generator.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace plot_genius {
+namespace tools {
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;  // Callers ignore SIGPIPE instead
+#endif
+
+/**
+ * Parsed response
+ */
+struct Response {
+    std::string id;
+    bool ok{false};
+    std::uint64_t serverLatencyUs{0};  ///< Reported by the service
+    std::string payload;               ///< Payload, or the error message
+};
+
+/**
+ * Connection to the plot service
+ *
+ * Send and Receive may run on different threads, which pipelined clients
+ * need: a client that only reads after writing everything can deadlock
+ * against the service's per-connection request limit.
+ */
+class ServiceConnection {
+public:
+    ServiceConnection() = default;
+    ~ServiceConnection() { Close(); }
+
+    ServiceConnection(const ServiceConnection&) = delete;
+    ServiceConnection& operator=(const ServiceConnection&) = delete;
+
+    /**
+     * Connects to the service
+     *
+     * @param path Socket path
+     * @param error Receives the reason on failure
+     * @return True if connected
+     */
+    bool Connect(const std::string& path, std::string& error) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            error = "Socket path is too long";
+            return false;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        m_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (m_fd < 0 || ::connect(m_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            error = "Cannot connect to " + path + ": " + std::strerror(errno);
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Sends one request line
+     *
+     * @param line Request without its newline
+     * @return False if the connection failed
+     */
+    bool Send(const std::string& line) {
+        std::string data = line + '\n';
+        const char* cursor = data.data();
+        std::size_t size = data.size();
+        while (size > 0) {
+            ssize_t written = ::send(m_fd, cursor, size, kSendFlags);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            cursor += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    /**
+     * Tells the service no more requests follow
+     */
+    void FinishSending() { ::shutdown(m_fd, SHUT_WR); }
+
+    /**
+     * Reads the next response
+     *
+     * @param response Receives the response
+     * @return False at the end of the stream or on a malformed response
+     */
+    bool Receive(Response& response) {
+        std::string header;
+        if (!ReadLine(header)) {
+            return false;
+        }
+
+        const std::size_t idEnd = header.find(' ');
+        if (idEnd == std::string::npos) {
+            return false;
+        }
+        response.id = header.substr(0, idEnd);
+        const std::string rest = header.substr(idEnd + 1);
+        if (rest.compare(0, 6, "error ") == 0) {
+            response.ok = false;
+            response.serverLatencyUs = 0;
+            response.payload = rest.substr(6);
+            return true;
+        }
+
+        char* end = nullptr;
+        if (rest.compare(0, 3, "ok ") != 0) {
+            return false;
+        }
+        const unsigned long long size = std::strtoull(rest.c_str() + 3, &end, 10);
+        response.ok = true;
+        response.serverLatencyUs = std::strtoull(end, nullptr, 10);
+        response.payload.resize(static_cast<std::size_t>(size));
+        return ReadExact(&response.payload[0], response.payload.size());
+    }
+
+    void Close() {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+private:
+    bool Fill() {
+        if (m_start == m_end) {
+            m_start = m_end = 0;
+        }
+        while (true) {
+            ssize_t received = ::recv(m_fd, m_buffer + m_end, sizeof(m_buffer) - m_end, 0);
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            if (received <= 0) {
+                return false;
+            }
+            m_end += static_cast<std::size_t>(received);
+            return true;
+        }
+    }
+
+    bool ReadLine(std::string& line) {
+        line.clear();
+        while (true) {
+            const char* begin = m_buffer + m_start;
+            const char* newline = static_cast<const char*>(std::memchr(begin, '\n', m_end - m_start));
+            if (newline) {
+                line.append(begin, newline);
+                m_start += static_cast<std::size_t>(newline - begin) + 1;
+                return true;
+            }
+            line.append(begin, m_end - m_start);
+            m_start = m_end;
+            if (!Fill()) {
+                return false;
+            }
+        }
+    }
+
+    bool ReadExact(char* out, std::size_t size) {
+        while (size > 0) {
+            if (m_start == m_end && !Fill()) {
+                return false;
+            }
+            const std::size_t take = std::min(size, m_end - m_start);
+            std::memcpy(out, m_buffer + m_start, take);
+            m_start += take;
+            out += take;
+            size -= take;
+        }
+        return true;
+    }
+
+    int m_fd{-1};
+    char m_buffer[64 * 1024];
+    std::size_t m_start{0};
+    std::size_t m_end{0};
+};
+
+} // namespace tools
+} // namespace plot_genius